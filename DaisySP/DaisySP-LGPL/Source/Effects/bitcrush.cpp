@@ -1,17 +1,14 @@
 #include "bitcrush.h"
-#include "fold.h"
 #include <math.h>
 
 using namespace daisysp;
 
-static Fold fold;
-
 void Bitcrush::Init(float sample_rate)
 {
     bit_depth_   = 8;
     crush_rate_  = 10000;
     sample_rate_ = sample_rate;
-    fold.Init();
+    fold_.Init();
 }
 
 float Bitcrush::Process(float in)
@@ -26,8 +23,8 @@ float Bitcrush::Process(float in)
     out = floor(out);
     out *= (65536.0f / bits) - 32768;
 
-    fold.SetIncrement(foldamt);
-    out = fold.Process(out);
+    fold_.SetIncrement(foldamt);
+    out = fold_.Process(out);
     out /= 65536.0;
 
     return out;
@@ -11,6 +11,7 @@ https://opensource.org/license/lgpl-2-1/
 #define DSY_BITCRUSH_H
 
 #include <stdint.h>
+#include "Effects/fold.h"
 #ifdef __cplusplus
 
 namespace daisysp
@@ -44,6 +45,7 @@ class Bitcrush
   private:
     float sample_rate_, crush_rate_;
     int   bit_depth_;
+    Fold  fold_;
 };
 } // namespace daisysp
 #endif
@@ -1,29 +1,40 @@
 #include "moogladder.h"
 #include "dsp.h"
+#ifdef DSY_FAST_MATH
+#include "Utility/fastmath.h"
+#endif
 
 using namespace daisysp;
 
-float MoogLadder::my_tanh(float x)
+void moogladder_internal::ComputeCoefficients(float  freq,
+                                              float  res,
+                                              float  sample_rate,
+                                              float& tune,
+                                              float& res4)
 {
-    int sign = 1;
-    if(x < 0)
-    {
-        sign = -1;
-        x    = -x;
-    }
-    if(x >= 4.0)
+    float f, fc, fc2, fc3, fcr, acr;
+    if(res < 0)
     {
-        return sign;
+        res = 0;
     }
-    if(x < 0.5)
-        return x * sign;
-    return sign * tanh(x);
+    fc  = (freq / sample_rate);
+    f   = 0.5f * fc;
+    fc2 = fc * fc;
+    fc3 = fc2 * fc2;
+
+    fcr = 1.8730f * fc3 + 0.4955f * fc2 - 0.6490f * fc + 0.9988f;
+    acr = -3.9364f * fc2 + 1.8409f * fc + 0.9968f;
+#ifdef DSY_FAST_MATH
+    tune = -expm1_lut(-((2 * PI_F) * f * fcr)) / kThermal;
+#else
+    tune = (1.0f - expf(-((2 * PI_F) * f * fcr))) / kThermal;
+#endif
+    res4 = 4.0f * res * acr;
 }
 
 void MoogLadder::Init(float sample_rate)
 {
     sample_rate_ = sample_rate;
-    istor_       = 0.0f;
     res_         = 0.4f;
     freq_        = 1000.0f;
 
@@ -33,70 +44,52 @@ void MoogLadder::Init(float sample_rate)
         tanhstg_[i % 3] = 0.0;
     }
 
-    old_freq_ = 0.0f;
-    old_res_  = -1.0f;
+    UpdateCoefficients();
 }
 
-float MoogLadder::Process(float in)
+void MoogLadder::UpdateCoefficients()
 {
-    float  freq = freq_;
-    float  res  = res_;
-    float  res4;
-    float* delay   = delay_;
-    float* tanhstg = tanhstg_;
-    float  stg[4];
-    float  acr, tune;
-
-    float THERMAL = 0.000025;
+    old_freq_ = freq_;
+    old_res_  = res_;
+    moogladder_internal::ComputeCoefficients(
+        freq_, res_, sample_rate_, tune_, res4_);
+}
 
-    if(res < 0)
+float MoogLadder::Process(float in)
+{
+    if(old_freq_ != freq_ || old_res_ != res_)
     {
-        res = 0;
+        UpdateCoefficients();
     }
+    return moogladder_internal::Tick(in, tune_, res4_, delay_, tanhstg_);
+}
 
-    if(old_freq_ != freq || old_res_ != res)
+void MoogLadder::ProcessBlock(const float* in, float* out, size_t size)
+{
+    if(old_freq_ != freq_ || old_res_ != res_)
     {
-        float f, fc, fc2, fc3, fcr;
-        old_freq_ = freq;
-        fc        = (freq / sample_rate_);
-        f         = 0.5f * fc;
-        fc2       = fc * fc;
-        fc3       = fc2 * fc2;
-
-        fcr  = 1.8730f * fc3 + 0.4955f * fc2 - 0.6490f * fc + 0.9988f;
-        acr  = -3.9364f * fc2 + 1.8409f * fc + 0.9968f;
-        tune = (1.0f - expf(-((2 * PI_F) * f * fcr))) / THERMAL;
-
-        old_res_  = res;
-        old_acr_  = acr;
-        old_tune_ = tune;
+        UpdateCoefficients();
     }
-    else
+    for(size_t i = 0; i < size; i++)
     {
-        res  = old_res_;
-        acr  = old_acr_;
-        tune = old_tune_;
+        out[i] = moogladder_internal::Tick(
+            in[i], tune_, res4_, delay_, tanhstg_);
     }
+}
 
-    res4 = 4.0f * res * acr;
-
-    for(int j = 0; j < 2; j++)
+void MoogLadder::ProcessBlock(const float* in,
+                              const float* freq,
+                              float*       out,
+                              size_t       size)
+{
+    for(size_t i = 0; i < size; i++)
     {
-        in -= res4 * delay[5];
-        delay[0] = stg[0]
-            = delay[0] + tune * (my_tanh(in * THERMAL) - tanhstg[0]);
-        for(int k = 1; k < 4; k++)
+        freq_ = freq[i];
+        if(old_freq_ != freq_ || old_res_ != res_)
         {
-            in     = stg[k - 1];
-            stg[k] = delay[k]
-                     + tune
-                           * ((tanhstg[k - 1] = my_tanh(in * THERMAL))
-                              - (k != 3 ? tanhstg[k]
-                                        : my_tanh(delay[k] * THERMAL)));
-            delay[k] = stg[k];
+            UpdateCoefficients();
         }
-        delay[5] = (stg[3] + delay[4]) * 0.5f;
-        delay[4] = stg[3];
+        out[i] = moogladder_internal::Tick(
+            in[i], tune_, res4_, delay_, tanhstg_);
     }
-    return delay[5];
 }
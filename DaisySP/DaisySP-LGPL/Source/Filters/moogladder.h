@@ -11,10 +11,122 @@ https://opensource.org/license/lgpl-2-1/
 #define DSY_MOOGLADDER_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include "Utility/dsp.h"
+#include "Utility/simd.h"
 #ifdef __cplusplus
 
 namespace daisysp
 {
+namespace moogladder_internal
+{
+    static constexpr float kThermal = 0.000025f;
+
+    /** Past this the rational tanh below reaches 1 */
+    static constexpr float kTanhClip = 4.97f;
+
+    /** Computes the ladder's integrator gain and resonance feedback.
+        \param freq Cutoff frequency in Hz
+        \param res Resonance, negative values are treated as 0
+        \param sample_rate Sample rate in Hz
+        \param tune Receives the integrator gain
+        \param res4 Receives the feedback amount
+    */
+    void ComputeCoefficients(float  freq,
+                             float  res,
+                             float  sample_rate,
+                             float& tune,
+                             float& res4);
+
+    inline float Constant(float x, float) { return x; }
+    inline Float4 Constant(float x, Float4) { return Float4::Broadcast(x); }
+
+    inline float Clamp(float x, float lo, float hi) { return fclamp(x, lo, hi); }
+    inline Float4 Clamp(Float4 x, Float4 lo, Float4 hi)
+    {
+        return Min(Max(x, lo), hi);
+    }
+
+    /** Below this tanh(x) rounds to x in single precision */
+    static constexpr float kTanhLinear = 3.0e-4f;
+
+    /** Rational (7, 6) approximation of tanh, from its continued fraction.
+        Within 1e-4 of tanh everywhere, and without branches, so it
+        runs on float and Float4 alike.
+    */
+    template <typename T>
+    inline T RationalTanh(T x)
+    {
+        x = Clamp(x, Constant(-kTanhClip, x), Constant(kTanhClip, x));
+        const T x2  = x * x;
+        const T num = Constant(135135.f, x)
+                      + x2
+                            * (Constant(17325.f, x)
+                               + x2 * (Constant(378.f, x) + x2));
+        const T den = Constant(135135.f, x)
+                      + x2
+                            * (Constant(62370.f, x)
+                               + x2
+                                     * (Constant(3150.f, x)
+                                        + x2 * Constant(28.f, x)));
+        return x * num / den;
+    }
+
+    /** tanh for the ladder stages. The thermal scaling keeps nearly all
+        inputs in the linear range, so the scalar version tests for that
+        first, while the Float4 version evaluates the rational for all lanes.
+    */
+    inline float FastTanh(float x)
+    {
+        return fabsf(x) < kTanhLinear ? x : RationalTanh(x);
+    }
+    inline Float4 FastTanh(Float4 x) { return RationalTanh(x); }
+
+    /** Runs one input sample through the 2x oversampled ladder.
+
+        The two passes are part of the model rather than anti-aliasing.
+        ComputeCoefficients() tunes the stages for twice the sample rate,
+        and the output is averaged over the passes. The stages are scaled
+        into the nearly linear part of tanh, so they add little to alias.
+        Routing the loop through an Oversampler would change the tuning and
+        the response, and add about 30 multiplies and 31 samples of latency
+        per sample. To run the whole filter at a higher rate, wrap it in
+        Oversampled<MoogLadder> and Init() it with sample_rate * factor.
+        \param delay Six state values: four stages, and two for the
+                     averaging of the oversampled output
+        \param tanhstg Saturated outputs of the first three stages
+        \return the filtered sample
+    */
+    template <typename T>
+    inline T Tick(T in, T tune, T res4, T* delay, T* tanhstg)
+    {
+        const T thermal = Constant(kThermal, in);
+        for(int j = 0; j < 2; j++)
+        {
+            in = in - res4 * delay[5];
+            const T stg0
+                = delay[0] + tune * (FastTanh(in * thermal) - tanhstg[0]);
+            tanhstg[0]    = FastTanh(stg0 * thermal);
+            const T stg1  = delay[1] + tune * (tanhstg[0] - tanhstg[1]);
+            tanhstg[1]    = FastTanh(stg1 * thermal);
+            const T stg2  = delay[2] + tune * (tanhstg[1] - tanhstg[2]);
+            tanhstg[2]    = FastTanh(stg2 * thermal);
+            const T stg3  = delay[3]
+                           + tune
+                                 * (tanhstg[2] - FastTanh(delay[3] * thermal));
+            // The second pass starts from the third stage, as it always has.
+            in       = stg2;
+            delay[0] = stg0;
+            delay[1] = stg1;
+            delay[2] = stg2;
+            delay[3] = stg3;
+            delay[5] = (stg3 + delay[4]) * Constant(0.5f, in);
+            delay[4] = stg3;
+        }
+        return delay[5];
+    }
+} // namespace moogladder_internal
+
 /** Moog ladder filter module*/
 class MoogLadder
 {
@@ -22,7 +134,7 @@ class MoogLadder
     MoogLadder() {}
     ~MoogLadder() {}
     /** Initializes the MoogLadder module.
-        sample_rate - The sample rate of the audio engine being run. 
+        sample_rate - The sample rate of the audio engine being run.
     */
     void Init(float sample_rate);
 
@@ -31,21 +143,205 @@ class MoogLadder
     */
     float Process(float in);
 
-    /** 
+    /** Processes a block at the current cutoff and resonance.
+        The coefficients are updated once for the whole block.
+        \param in Input buffer
+        \param out Output buffer, may be the same as in.
+        \param size Number of samples to process
+    */
+    void ProcessBlock(const float* in, float* out, size_t size);
+
+    /** Processes a block with a cutoff frequency for every sample.
+        The coefficients are only recomputed where the cutoff changes,
+        and the last cutoff is kept for later calls.
+        \param in Input buffer
+        \param freq Cutoff frequency in Hz for each sample
+        \param out Output buffer, may be the same as in.
+        \param size Number of samples to process
+    */
+    void
+    ProcessBlock(const float* in, const float* freq, float* out, size_t size);
+
+    /**
         Sets the cutoff frequency or half-way point of the filter.
         Arguments
         - freq - frequency value in Hz. Range: Any positive value.
     */
     inline void SetFreq(float freq) { freq_ = freq; }
-    /** 
+    /**
         Sets the resonance of the filter.
     */
     inline void SetRes(float res) { res_ = res; }
 
   private:
-    float istor_, res_, freq_, delay_[6], tanhstg_[3], old_freq_, old_res_,
-        sample_rate_, old_acr_, old_tune_;
-    float my_tanh(float x);
+    void UpdateCoefficients();
+
+    float res_, freq_, delay_[6], tanhstg_[3], old_freq_, old_res_,
+        sample_rate_, tune_, res4_;
+};
+
+/** Several MoogLadder filters run in lockstep, four at a time with Float4.
+    Each voice has its own input, cutoff and resonance. With SSE or NEON,
+    four voices cost about as much as a single MoogLadder.
+    \tparam num_voices Number of filters, a multiple of four
+*/
+template <int num_voices>
+class MoogLadderN
+{
+  public:
+    static_assert(num_voices > 0 && num_voices % Float4::kWidth == 0,
+                  "num_voices must be a multiple of 4");
+
+    MoogLadderN() {}
+    ~MoogLadderN() {}
+
+    /** Initializes all voices to a 1kHz cutoff with 0.4 resonance.
+        \param sample_rate The sample rate of the audio engine being run.
+    */
+    void Init(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        for(int v = 0; v < num_voices; v++)
+        {
+            freq_[v] = 1000.0f;
+            res_[v]  = 0.4f;
+            UpdateCoefficients(v);
+            for(int i = 0; i < 6; i++)
+            {
+                delay_[i][v] = 0.0f;
+            }
+            for(int i = 0; i < 3; i++)
+            {
+                tanhstg_[i][v] = 0.0f;
+            }
+        }
+    }
+
+    /** Sets the cutoff frequency of one voice.
+        \param voice Index of the voice
+        \param freq Frequency value in Hz. Range: Any positive value.
+    */
+    void SetFreq(int voice, float freq)
+    {
+        freq_[voice] = freq;
+        UpdateCoefficients(voice);
+    }
+
+    /** Sets the resonance of one voice.
+        \param voice Index of the voice
+        \param res Resonance
+    */
+    void SetRes(int voice, float res)
+    {
+        res_[voice] = res;
+        UpdateCoefficients(voice);
+    }
+
+    /** Processes one sample of every voice.
+        \param in One input sample per voice
+        \param out Receives one output sample per voice, may be the same as in.
+    */
+    void Process(const float* in, float* out)
+    {
+        for(int v = 0; v < num_voices; v += Float4::kWidth)
+        {
+            Group g = LoadGroup(v);
+            moogladder_internal::Tick(
+                Float4::Load(&in[v]), g.tune, g.res4, g.delay, g.tanhstg)
+                .Store(&out[v]);
+            StoreGroup(v, g);
+        }
+    }
+
+    /** Processes a block of every voice.
+        \param in One input buffer per voice
+        \param out One output buffer per voice, each may be the same as its input.
+        \param size Number of samples to process
+    */
+    void ProcessBlock(const float* const* in, float* const* out, size_t size)
+    {
+        // Groups are independent, so running them all for each sample
+        // lets their dependency chains overlap.
+        Group g[kNumGroups];
+        for(int k = 0; k < kNumGroups; k++)
+        {
+            g[k] = LoadGroup(k * Float4::kWidth);
+        }
+        for(size_t n = 0; n < size; n++)
+        {
+            float lanes[num_voices];
+            for(int v = 0; v < num_voices; v++)
+            {
+                lanes[v] = in[v][n];
+            }
+            for(int k = 0; k < kNumGroups; k++)
+            {
+                float* group_lanes = &lanes[k * Float4::kWidth];
+                moogladder_internal::Tick(Float4::Load(group_lanes),
+                                          g[k].tune,
+                                          g[k].res4,
+                                          g[k].delay,
+                                          g[k].tanhstg)
+                    .Store(group_lanes);
+            }
+            for(int v = 0; v < num_voices; v++)
+            {
+                out[v][n] = lanes[v];
+            }
+        }
+        for(int k = 0; k < kNumGroups; k++)
+        {
+            StoreGroup(k * Float4::kWidth, g[k]);
+        }
+    }
+
+  private:
+    static constexpr int kNumGroups = num_voices / Float4::kWidth;
+
+    /** State and coefficients of four voices */
+    struct Group
+    {
+        Float4 tune, res4, delay[6], tanhstg[3];
+    };
+
+    Group LoadGroup(int v) const
+    {
+        Group g;
+        g.tune = Float4::Load(&tune_[v]);
+        g.res4 = Float4::Load(&res4_[v]);
+        for(int i = 0; i < 6; i++)
+        {
+            g.delay[i] = Float4::Load(&delay_[i][v]);
+        }
+        for(int i = 0; i < 3; i++)
+        {
+            g.tanhstg[i] = Float4::Load(&tanhstg_[i][v]);
+        }
+        return g;
+    }
+
+    void StoreGroup(int v, const Group& g)
+    {
+        for(int i = 0; i < 6; i++)
+        {
+            g.delay[i].Store(&delay_[i][v]);
+        }
+        for(int i = 0; i < 3; i++)
+        {
+            g.tanhstg[i].Store(&tanhstg_[i][v]);
+        }
+    }
+
+    void UpdateCoefficients(int v)
+    {
+        moogladder_internal::ComputeCoefficients(
+            freq_[v], res_[v], sample_rate_, tune_[v], res4_[v]);
+    }
+
+    float sample_rate_;
+    float freq_[num_voices], res_[num_voices];
+    float tune_[num_voices], res4_[num_voices];
+    float delay_[6][num_voices], tanhstg_[3][num_voices];
 };
 } // namespace daisysp
 #endif
@@ -1,4 +1,6 @@
 #include "adsr.h"
+#include "dsp.h"
+#include "fastmath.h"
 #include <math.h>
 
 using namespace daisysp;
@@ -56,11 +58,21 @@ void Adsr::SetAttackTime(float timeInS, float shape)
         attackShape_ = shape;
         if(timeInS > 0.f)
         {
-            float x         = shape;
+            float x = shape;
+#ifdef DSY_FAST_MATH
+            float x2        = x * x;
+            float x4        = x2 * x2;
+            float target    = 9.f * (x4 * x4 * x2) + 0.3f * x + 1.01f;
+            attackTarget_   = target;
+            float logTarget = fastlog2f(1.f - (1.f / target))
+                              * 0.69314718f; // -1 for decay
+            attackD0_ = -expm1_lut(logTarget / (timeInS * sample_rate_));
+#else
             float target    = 9.f * powf(x, 10.f) + 0.3f * x + 1.01f;
             attackTarget_   = target;
             float logTarget = logf(1.f - (1.f / target)); // -1 for decay
             attackD0_       = 1.f - expf(logTarget / (timeInS * sample_rate_));
+#endif
         }
         else
             attackD0_ = 1.f; // instant change
@@ -83,8 +95,14 @@ void Adsr::SetTimeConstant(float timeInS, float& time, float& coeff)
         time = timeInS;
         if(time > 0.f)
         {
+#ifdef DSY_FAST_MATH
+            // logf(1 / e) is exactly -1. expm1_lut keeps the precision
+            // that 1 - exp_lut() would lose for long times.
+            coeff = -expm1_lut(-1.f / (time * sample_rate_));
+#else
             const float target = logf(1. / M_E);
             coeff              = 1.f - expf(target / (time * sample_rate_));
+#endif
         }
         else
             coeff = 1.f; // instant change
@@ -0,0 +1,462 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_DRUMRENDERCACHE_H
+#define DSY_DRUMRENDERCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+/** @file drumrendercache.h */
+
+namespace daisysp
+{
+/** Plays drum hits back from memory instead of synthesizing them again.
+
+A drum model that's triggered with the same parameters always plays the same
+hit. The cache keeps the output of recent hits in a caller-supplied buffer,
+e.g. in SDRAM, keyed by the parameters they were played with, and plays a hit
+from there the next time those parameters come up. Playback is a copy.
+
+Hits are recorded as they play live, so a miss costs no more than the plain
+model. Only hits that start with the model at rest are recorded, and a
+recording is dropped if the parameters change or the drum is triggered again
+before it ends. A parameter that moves between hits, e.g. one following a
+knob or an LFO, makes every hit a miss, so modulated drums play live.
+Prerender() renders a hit ahead of time instead, e.g. every kit at startup.
+Once the buffer is full, the least recently played hit makes room.
+
+Models with noise in them, like the snares and the hihat, repeat the same
+noise on every cached hit.
+
+The model type must provide Init(float sample_rate) and
+float Process(bool trigger), which covers the drums in DaisySP. Its
+parameters are set by a function taking the model and an array of
+num_params values:
+
+\code
+void SetKick(AnalogBassDrum& bd, const float* p)
+{
+    bd.SetFreq(p[0]);
+    bd.SetDecay(p[1]);
+}
+
+float DSY_SDRAM_BSS kick_memory[6 * 48000];
+DrumRenderCache<AnalogBassDrum, 2, 6> kick;
+
+kick.Init(sample_rate, SetKick, kick_memory, 6 * 48000);
+kick.SetParams(kit_params[kit]);
+out = kick.Process(trigger);
+\endcode
+
+\tparam T The drum model
+\tparam num_params Number of values describing a hit
+\tparam num_slots Number of hits kept. Each gets an equal share of the buffer.
+*/
+template <typename T, size_t num_params, size_t num_slots = 8>
+class DrumRenderCache
+{
+  public:
+    /** Sets the parameters of the model */
+    typedef void (*ApplyFunction)(T& model, const float* params);
+
+    DrumRenderCache() {}
+    ~DrumRenderCache() {}
+
+    /** Initializes the model and empties the cache
+        \param sample_rate Audio engine sample rate
+        \param apply Sets the model's parameters
+        \param buffer Memory for the hits
+        \param buffer_size Length of the buffer in samples. Hits longer than
+        buffer_size / num_slots play live.
+    */
+    void Init(float         sample_rate,
+              ApplyFunction apply,
+              float*        buffer,
+              size_t        buffer_size)
+    {
+        model_.Init(sample_rate);
+        sample_rate_   = sample_rate;
+        apply_         = apply;
+        slot_size_     = buffer_size / num_slots;
+        hold_samples_  = static_cast<size_t>(sample_rate * 0.05f);
+        counter_       = 0;
+        mode_          = IDLE;
+        model_at_rest_ = true;
+        playing_       = nullptr;
+        recording_     = nullptr;
+        for(size_t i = 0; i < num_slots; i++)
+        {
+            slots_[i].data      = buffer + i * slot_size_;
+            slots_[i].state     = EMPTY;
+            slots_[i].length    = 0;
+            slots_[i].last_used = 0;
+        }
+        have_params_ = false;
+    }
+
+    /** Sets the parameters of the following hits. They're passed on to the
+        model straight away if they changed.
+        \param params num_params values
+    */
+    void SetParams(const float* params)
+    {
+        if(have_params_ && Matches(params_, params))
+        {
+            return;
+        }
+        have_params_ = true;
+        for(size_t i = 0; i < num_params; i++)
+        {
+            params_[i] = params[i];
+        }
+        apply_(model_, params_);
+        DropRecording();
+    }
+
+    /** Sets a single parameter
+        \param idx 0 to num_params - 1
+        \param value New value
+    */
+    void SetParam(size_t idx, float value)
+    {
+        float params[num_params];
+        for(size_t i = 0; i < num_params; i++)
+        {
+            params[i] = params_[i];
+        }
+        params[idx] = value;
+        SetParams(params);
+    }
+
+    /** Starts a hit with the current parameters, from the cache if it's
+        there. Set the parameters with SetParams() first. */
+    void Trig()
+    {
+        counter_++;
+        DropRecording();
+        Slot* slot = Find(params_);
+        if(slot)
+        {
+            slot->last_used = counter_;
+        }
+        if(slot && slot->state == READY)
+        {
+            playing_ = slot;
+            pos_     = 0;
+            mode_    = CACHED;
+            return;
+        }
+
+        // Record the hit only if the model starts from rest, so the
+        // recording sounds like any other hit with these parameters.
+        if(!slot && model_at_rest_)
+        {
+            recording_            = Claim();
+            recording_->state     = RECORDING;
+            recording_->length    = 0;
+            recording_->last_used = counter_;
+            for(size_t i = 0; i < num_params; i++)
+            {
+                recording_->params[i] = params_[i];
+            }
+            loud_length_ = 0;
+        }
+        playing_        = nullptr;
+        mode_           = LIVE;
+        trig_           = true;
+        silent_samples_ = 0;
+        model_at_rest_  = false;
+    }
+
+    /** Get the next sample
+        \param trigger True starts a hit
+    */
+    float Process(bool trigger = false)
+    {
+        if(trigger)
+        {
+            Trig();
+        }
+        float out;
+        ProcessBlock(&out, 1);
+        return out;
+    }
+
+    /** Renders a block. Use Trig() to start a hit before it.
+        \param out Output buffer, overwritten
+        \param size Number of samples
+    */
+    void ProcessBlock(float* out, size_t size)
+    {
+        if(mode_ == CACHED)
+        {
+            size_t       n    = 0;
+            const size_t left = playing_->length - pos_;
+            const float* in   = playing_->data + pos_;
+            for(; n < size && n < left; n++)
+            {
+                out[n] = in[n];
+            }
+            pos_ += n;
+            if(pos_ >= playing_->length)
+            {
+                mode_    = IDLE;
+                playing_ = nullptr;
+            }
+            out += n;
+            size -= n;
+        }
+        if(mode_ == LIVE)
+        {
+            const size_t n = ProcessLive(out, size);
+            out += n;
+            size -= n;
+        }
+        // At rest, the model isn't run at all.
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = 0.f;
+        }
+    }
+
+    /** Renders a hit into the cache ahead of time, with the model at rest.
+        Call it before starting the audio, or from the audio callback.
+        A hit longer than a slot is marked to play live, and the model is
+        initialized again so later hits can still be rendered.
+        \param params num_params values
+        \return true if the hit is in the cache
+    */
+    bool Prerender(const float* params)
+    {
+        const Slot* cached = Find(params);
+        if(cached)
+        {
+            return cached->state == READY;
+        }
+        if(mode_ == LIVE || !model_at_rest_)
+        {
+            return false;
+        }
+
+        Slot* s = Claim();
+        apply_(model_, params);
+        bool   trig   = true;
+        size_t silent = 0, loud = 0, n = 0;
+        for(; n < slot_size_ && silent < hold_samples_; n++)
+        {
+            s->data[n] = model_.Process(trig);
+            trig       = false;
+            silent     = fabsf(s->data[n]) > kSilence ? 0 : silent + 1;
+            loud       = silent == 0 ? n + 1 : loud;
+        }
+        // A hit that didn't fit is still ringing. The model is only run
+        // by live hits, so it's started over instead of being left there.
+        if(silent < hold_samples_)
+        {
+            model_.Init(sample_rate_);
+        }
+        if(have_params_)
+        {
+            apply_(model_, params_);
+        }
+        for(size_t i = 0; i < num_params; i++)
+        {
+            s->params[i] = params[i];
+        }
+        s->length    = loud;
+        s->state     = silent >= hold_samples_ ? READY : TOO_LONG;
+        s->last_used = counter_;
+        return s->state == READY;
+    }
+
+    /** Empties the cache */
+    void Clear()
+    {
+        DropRecording();
+        mode_    = mode_ == CACHED ? IDLE : mode_;
+        playing_ = nullptr;
+        for(size_t i = 0; i < num_slots; i++)
+        {
+            slots_[i].state = EMPTY;
+        }
+    }
+
+    /** \return Whether the current hit plays from the cache */
+    inline bool IsCached() const { return mode_ == CACHED; }
+
+    /** \return The number of hits in the cache */
+    size_t GetNumCached() const
+    {
+        size_t count = 0;
+        for(size_t i = 0; i < num_slots; i++)
+        {
+            count += slots_[i].state == READY ? 1 : 0;
+        }
+        return count;
+    }
+
+    /** Access to the model. Set its parameters through SetParams(), so the
+        cache knows about them. */
+    inline T& GetModel() { return model_; }
+
+  private:
+    static constexpr float kSilence = 1e-4f; // -80dB
+
+    enum Mode
+    {
+        IDLE,   // silent, the model is at rest or left where it was
+        LIVE,   // the model is running
+        CACHED, // a hit plays from a slot
+    };
+
+    enum SlotState
+    {
+        EMPTY,
+        RECORDING,
+        READY,
+        TOO_LONG, // the hit didn't fit, so these parameters play live
+    };
+
+    struct Slot
+    {
+        float*    data;
+        size_t    length;
+        float     params[num_params];
+        uint32_t  last_used; // value of counter_ when last played
+        SlotState state;
+    };
+
+    static bool Matches(const float* a, const float* b)
+    {
+        for(size_t i = 0; i < num_params; i++)
+        {
+            if(a[i] != b[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** \return The slot holding, or recording, the hit for params */
+    Slot* Find(const float* params)
+    {
+        for(size_t i = 0; i < num_slots; i++)
+        {
+            if(slots_[i].state != EMPTY && Matches(slots_[i].params, params))
+            {
+                return &slots_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /** \return An empty slot, or else the least recently played one */
+    Slot* Claim()
+    {
+        Slot* best = &slots_[0];
+        for(size_t i = 0; i < num_slots; i++)
+        {
+            if(slots_[i].state == EMPTY)
+            {
+                best = &slots_[i];
+                break;
+            }
+            if(counter_ - slots_[i].last_used > counter_ - best->last_used)
+            {
+                best = &slots_[i];
+            }
+        }
+        if(best == playing_)
+        {
+            mode_    = IDLE;
+            playing_ = nullptr;
+        }
+        best->state = EMPTY;
+        return best;
+    }
+
+    void DropRecording()
+    {
+        if(recording_)
+        {
+            recording_->state = EMPTY;
+            recording_        = nullptr;
+        }
+    }
+
+    /** Runs the model until it comes to rest
+        \return Number of samples written
+    */
+    size_t ProcessLive(float* out, size_t size)
+    {
+        size_t n = 0;
+        for(; n < size && silent_samples_ < hold_samples_; n++)
+        {
+            out[n] = model_.Process(trig_);
+            trig_  = false;
+            silent_samples_
+                = fabsf(out[n]) > kSilence ? 0 : silent_samples_ + 1;
+        }
+        if(recording_)
+        {
+            Record(out, n);
+        }
+        if(silent_samples_ >= hold_samples_)
+        {
+            mode_          = IDLE;
+            model_at_rest_ = true;
+            if(recording_)
+            {
+                // Trailing silence isn't kept.
+                recording_->length = loud_length_;
+                recording_->state  = READY;
+                recording_         = nullptr;
+            }
+        }
+        return n;
+    }
+
+    void Record(const float* in, size_t size)
+    {
+        Slot* s = recording_;
+        for(size_t i = 0; i < size; i++)
+        {
+            if(s->length >= slot_size_)
+            {
+                s->state   = TOO_LONG;
+                recording_ = nullptr;
+                return;
+            }
+            s->data[s->length++] = in[i];
+            if(fabsf(in[i]) > kSilence)
+            {
+                loud_length_ = s->length;
+            }
+        }
+    }
+
+    T             model_;
+    ApplyFunction apply_;
+    Slot          slots_[num_slots];
+    float         params_[num_params];
+    float         sample_rate_;
+    size_t        slot_size_, hold_samples_;
+    size_t        silent_samples_, loud_length_, pos_;
+    uint32_t      counter_;
+    Mode          mode_;
+    Slot*         playing_;
+    Slot*         recording_;
+    bool          trig_, model_at_rest_, have_params_;
+};
+
+} // namespace daisysp
+#endif
@@ -0,0 +1,128 @@
+#include "convolutionreverb.h"
+
+using namespace daisysp;
+
+void ConvolutionReverb::CountPartitions(size_t  length,
+                                        size_t* early,
+                                        size_t* late)
+{
+    *early = 0;
+    *late  = 0;
+    if(length > kHeadSize)
+    {
+        const size_t early_taps = DSY_MIN(length, kLateBlockSize) - kHeadSize;
+        *early = (early_taps + kEarlyBlockSize - 1) / kEarlyBlockSize;
+    }
+    if(length > kLateBlockSize)
+    {
+        *late = (length - kLateBlockSize + kLateBlockSize - 1) / kLateBlockSize;
+    }
+}
+
+size_t ConvolutionReverb::GetMemorySize(size_t ir_length)
+{
+    size_t early, late;
+    CountPartitions(ir_length, &early, &late);
+    return ConvolutionStage<kEarlyBlockSize>::GetMemorySize(early)
+           + ConvolutionStage<kLateBlockSize>::GetMemorySize(late);
+}
+
+void ConvolutionReverb::Init(float* memory, size_t memory_size)
+{
+    memory_      = memory;
+    memory_size_ = memory_size;
+    length_      = 0;
+    pos_         = 0;
+    early_.Init(memory_, 0);
+    late_.Init(memory_, 0);
+}
+
+bool ConvolutionReverb::SetIR(const float* ir, size_t length)
+{
+    // Longest response that fits, the memory size only grows with the length.
+    size_t fit = length;
+    if(GetMemorySize(fit) > memory_size_)
+    {
+        size_t lo = 0, hi = length;
+        while(lo + 1 < hi)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            if(GetMemorySize(mid) <= memory_size_)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        fit = lo;
+    }
+    length_ = fit;
+
+    size_t early, late;
+    CountPartitions(length_, &early, &late);
+    early_.Init(memory_, early);
+    late_.Init(memory_ + ConvolutionStage<kEarlyBlockSize>::GetMemorySize(early),
+               late);
+
+    if(length_ > 0)
+    {
+        head_.SetIR(ir, DSY_MIN(length_, kHeadSize), true);
+    }
+    for(size_t k = 0; k < early; k++)
+    {
+        const size_t start = kHeadSize + k * kEarlyBlockSize;
+        early_.SetPartition(
+            k, &ir[start], DSY_MIN(length_ - start, kEarlyBlockSize));
+    }
+    for(size_t k = 0; k < late; k++)
+    {
+        const size_t start = kLateBlockSize + k * kLateBlockSize;
+        late_.SetPartition(
+            k, &ir[start], DSY_MIN(length_ - start, kLateBlockSize));
+    }
+    pos_ = 0;
+    return fit == length;
+}
+
+void ConvolutionReverb::Reset()
+{
+    head_.Reset();
+    early_.Reset();
+    late_.Reset();
+    pos_ = 0;
+}
+
+float ConvolutionReverb::Process(float in)
+{
+    float out;
+    ProcessBlock(&in, &out, 1);
+    return out;
+}
+
+void ConvolutionReverb::ProcessBlock(const float* in, float* out, size_t size)
+{
+    if(length_ == 0)
+    {
+        memset(out, 0, size * sizeof(float));
+        return;
+    }
+
+    // The late block size is a multiple of the early one, so chunks that stay
+    // within an early block never cross a boundary of either stage.
+    float dry[kEarlyBlockSize];
+    while(size > 0)
+    {
+        const size_t n = DSY_MIN(size, kEarlyBlockSize - pos_);
+        memcpy(dry, in, n * sizeof(float));
+        head_.ProcessBlock(dry, out, n);
+        early_.Process(dry, out, n);
+        late_.Process(dry, out, n);
+
+        pos_ = (pos_ + n) % kEarlyBlockSize;
+        in += n;
+        out += n;
+        size -= n;
+    }
+}
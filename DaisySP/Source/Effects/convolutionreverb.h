@@ -0,0 +1,299 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_CONVOLUTIONREVERB_H
+#define DSY_CONVOLUTIONREVERB_H
+#ifdef __cplusplus
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Utility/dsp.h"
+#include "Filters/fir.h"
+#include "Utility/fft.h"
+#include "Utility/simd.h"
+
+/** @file convolutionreverb.h */
+
+namespace daisysp
+{
+/**
+    @brief One block size of partitioned convolution. Used in ConvolutionReverb.
+
+    Applies consecutive partitions of block_size taps, starting block_size taps
+    into the response, using overlap-save FFTs of twice the block size.
+    The spectral multiply-accumulate for the older partitions is spread over
+    the samples of each block, so only the newest partition and the
+    transforms are left for the block boundary.
+*/
+template <size_t block_size>
+class ConvolutionStage
+{
+  public:
+    static constexpr size_t kFftSize = 2 * block_size;
+
+    ConvolutionStage() {}
+    ~ConvolutionStage() {}
+
+    /** Number of floats of memory needed for num_partitions partitions */
+    static constexpr size_t GetMemorySize(size_t num_partitions)
+    {
+        return num_partitions > 0
+                   ? 2 * num_partitions * kFftSize + 3 * kFftSize + block_size
+                   : 0;
+    }
+
+    /** Initialize the stage
+        \param memory At least GetMemorySize(num_partitions) floats
+        \param num_partitions Number of partitions, may be 0 to disable the stage
+    */
+    void Init(float* memory, size_t num_partitions)
+    {
+        fft_.Init();
+        num_partitions_ = num_partitions;
+        spectra_        = memory;
+        fdl_            = spectra_ + num_partitions * kFftSize;
+        frame_          = fdl_ + num_partitions * kFftSize;
+        pending_        = frame_ + kFftSize;
+        scratch_        = pending_ + kFftSize;
+        out_            = scratch_ + kFftSize;
+        Reset();
+    }
+
+    /** Sets the taps of one partition
+        \param idx Partition index
+        \param taps Up to block_size taps, in normal (head first) order
+        \param size Number of taps
+    */
+    void SetPartition(size_t idx, const float* taps, size_t size)
+    {
+        // The inverse FFT scaling is folded into the spectra.
+        const float scale = 1.0f / kFftSize;
+        for(size_t i = 0; i < kFftSize; i++)
+        {
+            scratch_[i] = i < size ? taps[i] * scale : 0.0f;
+        }
+        fft_.Forward(scratch_, scratch_);
+        ToSplit(scratch_, &spectra_[idx * kFftSize]);
+    }
+
+    /** Clears the input history and pending output */
+    void Reset()
+    {
+        if(num_partitions_ == 0)
+        {
+            return;
+        }
+        memset(fdl_, 0, num_partitions_ * kFftSize * sizeof(float));
+        memset(frame_, 0, kFftSize * sizeof(float));
+        memset(pending_, 0, kFftSize * sizeof(float));
+        memset(out_, 0, block_size * sizeof(float));
+        pos_     = 0;
+        fdl_pos_ = 0;
+        done_    = 1;
+    }
+
+    /** Feeds samples, adding the stage's output to out.
+        The samples must not cross a multiple of block_size.
+    */
+    void Process(const float* in, float* out, size_t size)
+    {
+        if(num_partitions_ == 0)
+        {
+            return;
+        }
+        memcpy(&frame_[block_size + pos_], in, size * sizeof(float));
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] += out_[pos_ + i];
+        }
+        pos_ += size;
+
+        // Keep up with the older partitions in proportion to the block.
+        const size_t target = 1 + (num_partitions_ - 1) * pos_ / block_size;
+        for(; done_ < target; done_++)
+        {
+            Accumulate(done_);
+        }
+        if(pos_ == block_size)
+        {
+            FinishBlock();
+        }
+    }
+
+  private:
+    /** Adds partition k times the input spectrum from k blocks ago */
+    void Accumulate(size_t k)
+    {
+        const size_t slot = (fdl_pos_ + num_partitions_ - k) % num_partitions_;
+        const float* x_re = &fdl_[slot * kFftSize];
+        const float* x_im = x_re + block_size;
+        const float* h_re = &spectra_[k * kFftSize];
+        const float* h_im = h_re + block_size;
+        float*       a_re = pending_;
+        float*       a_im = pending_ + block_size;
+
+        // Index 0 holds the purely real DC and Nyquist bins.
+        a_re[0] += x_re[0] * h_re[0];
+        a_im[0] += x_im[0] * h_im[0];
+        size_t i = 1;
+        for(; i < Float4::kWidth && i < block_size; i++)
+        {
+            a_re[i] += x_re[i] * h_re[i] - x_im[i] * h_im[i];
+            a_im[i] += x_re[i] * h_im[i] + x_im[i] * h_re[i];
+        }
+        for(; i + Float4::kWidth <= block_size; i += Float4::kWidth)
+        {
+            const Float4 xr = Float4::Load(&x_re[i]);
+            const Float4 xi = Float4::Load(&x_im[i]);
+            const Float4 hr = Float4::Load(&h_re[i]);
+            const Float4 hi = Float4::Load(&h_im[i]);
+            (Float4::Load(&a_re[i]) + xr * hr - xi * hi).Store(&a_re[i]);
+            (Float4::Load(&a_im[i]) + xr * hi + xi * hr).Store(&a_im[i]);
+        }
+    }
+
+    void FinishBlock()
+    {
+        for(; done_ < num_partitions_; done_++)
+        {
+            Accumulate(done_);
+        }
+
+        // Spectrum of the last two input blocks.
+        fft_.Forward(frame_, scratch_);
+        ToSplit(scratch_, &fdl_[fdl_pos_ * kFftSize]);
+        Accumulate(0);
+
+        // Overlap-save, the second half is the valid part.
+        FromSplit(pending_, scratch_);
+        fft_.Inverse(scratch_, scratch_);
+        memcpy(out_, &scratch_[block_size], block_size * sizeof(float));
+
+        memset(pending_, 0, kFftSize * sizeof(float));
+        memcpy(frame_, &frame_[block_size], block_size * sizeof(float));
+        fdl_pos_ = (fdl_pos_ + 1) % num_partitions_;
+        pos_     = 0;
+        done_    = 1;
+    }
+
+    /** Packed interleaved spectrum to separate real and imaginary halves */
+    static void ToSplit(const float* packed, float* split)
+    {
+        for(size_t k = 0; k < block_size; k++)
+        {
+            split[k]              = packed[2 * k];
+            split[block_size + k] = packed[2 * k + 1];
+        }
+    }
+
+    static void FromSplit(const float* split, float* packed)
+    {
+        for(size_t k = 0; k < block_size; k++)
+        {
+            packed[2 * k]     = split[k];
+            packed[2 * k + 1] = split[block_size + k];
+        }
+    }
+
+    RealFft<kFftSize> fft_;
+    float*            spectra_; /**< Partition spectra */
+    float*            fdl_;     /**< Input spectra, one per partition */
+    float*            frame_;   /**< Previous and current input block */
+    float*            pending_; /**< Spectral accumulator for the next block */
+    float*            scratch_;
+    float*            out_; /**< Output for the current block */
+    size_t            num_partitions_ = 0;
+    size_t            pos_, fdl_pos_, done_;
+};
+
+/**
+    @brief Convolution reverb with zero latency.
+    @author Electrosmith
+    @date 2020
+
+    Convolves the input with an impulse response, such as a sampled room,
+    using non-uniformly partitioned convolution:
+
+    - the first 128 taps are applied directly, so there is no latency
+    - taps up to 1024 in 128 sample partitions
+    - the rest in 1024 sample partitions
+
+    The partitions and their history live in memory provided by the caller,
+    which can be placed in SDRAM. GetMemorySize() gives the size needed for a response.
+    The output is fully wet and mono, use one instance per channel for stereo.
+
+    The impulse response is a buffer of floats, e.g. the decoded data chunk of a
+    WAV file parsed with libDaisy's WAV_FormatTypeDef.
+
+    SetIR() runs FFTs over the whole response, so it should not be called
+    from the audio callback.
+*/
+class ConvolutionReverb
+{
+  public:
+    ConvolutionReverb() {}
+    ~ConvolutionReverb() {}
+
+    /** Number of floats of memory needed for a response of the given length */
+    static size_t GetMemorySize(size_t ir_length);
+
+    /** Initialize the module
+        \param memory Buffer for the partitions, e.g. in SDRAM
+        \param memory_size Size of the buffer in floats
+    */
+    void Init(float* memory, size_t memory_size);
+
+    /** Loads an impulse response, replacing the previous one.
+        \param ir Response in normal order (first tap first)
+        \param length Number of taps
+        \return false if the memory was too small, in which case the
+                response is truncated to the longest that fits.
+    */
+    bool SetIR(const float* ir, size_t length);
+
+    /** Clears the reverb tail, but keeps the response */
+    void Reset();
+
+    /** Get the next sample
+        \param in Sample to process
+    */
+    float Process(float in);
+
+    /** Process a block of samples
+        \param in Input buffer
+        \param out Output buffer, may be the same as in
+        \param size Number of samples
+    */
+    void ProcessBlock(const float* in, float* out, size_t size);
+
+    /** Length of the loaded response, after any truncation */
+    inline size_t GetLength() const { return length_; }
+
+  private:
+    static constexpr size_t kHeadSize       = 128;
+    static constexpr size_t kEarlyBlockSize = 128;
+    static constexpr size_t kLateBlockSize  = 1024;
+    static constexpr size_t kMaxEarlyPartitions
+        = (kLateBlockSize - kEarlyBlockSize) / kEarlyBlockSize;
+
+    static void CountPartitions(size_t length, size_t* early, size_t* late);
+
+    FIRFilterImplGeneric<kHeadSize, kHeadSize> head_;
+    ConvolutionStage<kEarlyBlockSize>          early_;
+    ConvolutionStage<kLateBlockSize>           late_;
+    float*                                     memory_;
+    size_t                                     memory_size_;
+    size_t                                     length_;
+    size_t                                     pos_;
+};
+
+} // namespace daisysp
+#endif
+#endif
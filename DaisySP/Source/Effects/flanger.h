@@ -12,7 +12,7 @@ https://opensource.org/licenses/MIT.
 #ifdef __cplusplus
 
 #include <stdint.h>
-#include "Utility/delayline.h"
+#include "Utility/delayline_pow2.h"
 
 /** @file flanger.h */
 
@@ -74,7 +74,7 @@ class Flanger
 
     float delay_;
 
-    DelayLine<float, kDelayLength> del_;
+    DelayLinePow2<float, kDelayLength> del_;
 
     float ProcessLfo();
 };
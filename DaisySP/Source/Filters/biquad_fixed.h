@@ -0,0 +1,130 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_BIQUAD_FIXED_H
+#define DSY_BIQUAD_FIXED_H
+
+#include "Utility/dsp.h"
+
+namespace daisysp
+{
+namespace fixed
+{
+    /** Direct form I biquad filter on fixed point samples, e.g.
+        fixed::Biquad<q31>.
+
+        SetCutoff() and SetRes() make it a resonant lowpass, as with the
+        float Biquad in DaisySP-LGPL, though the response isn't the same.
+        SetCoefficients() takes any other design.
+
+        The coefficients are held as q2.29 for both sample types, since
+        16 bits can't place poles close enough to z = 1 for low cutoffs.
+        The accumulator can't overflow as long as the absolute values of the
+        five coefficients add up to less than 8.
+    */
+    template <typename T>
+    class Biquad
+    {
+      public:
+        Biquad() {}
+        ~Biquad() {}
+
+        /** Initializes the biquad module.
+            \param sample_rate - The sample rate of the audio engine being run.
+        */
+        void Init(float sample_rate)
+        {
+            sample_rate_ = sample_rate;
+            cutoff_      = 500.f;
+            res_         = 0.7f;
+            x1_ = x2_ = y1_ = y2_ = 0;
+            UpdateLowpass();
+        }
+
+        /** Filters the input signal
+            \return filtered output
+        */
+        T Process(T in)
+        {
+            const int64_t acc = static_cast<int64_t>(b0_) * in
+                                + static_cast<int64_t>(b1_) * x1_
+                                + static_cast<int64_t>(b2_) * x2_
+                                - static_cast<int64_t>(a1_) * y1_
+                                - static_cast<int64_t>(a2_) * y2_;
+            // Saturated to 32 bits first, so a q15 result can't wrap
+            const int64_t y   = fixed_round_shift(acc, kCoeffFracBits);
+            const T       out = fixed_sat<T>(fixed_sat<q31>(y));
+            x2_ = x1_;
+            x1_ = in;
+            y2_ = y1_;
+            y1_ = out;
+            return out;
+        }
+
+        /** Sets resonance amount
+            \param res : 0 to 1, for a Q from 0.5 to 25.
+        */
+        inline void SetRes(float res)
+        {
+            res_ = fclamp(res, 0.f, 1.f);
+            UpdateLowpass();
+        }
+
+        /** Sets filter cutoff in Hz
+            \param cutoff : Set filter cutoff.
+        */
+        inline void SetCutoff(float cutoff)
+        {
+            cutoff_ = cutoff;
+            UpdateLowpass();
+        }
+
+        /** Sets the coefficients of any biquad design, normalized to a0 = 1:
+            y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+        */
+        void SetCoefficients(float b0, float b1, float b2, float a1, float a2)
+        {
+            b0_ = ToCoefficient(b0);
+            b1_ = ToCoefficient(b1);
+            b2_ = ToCoefficient(b2);
+            a1_ = ToCoefficient(a1);
+            a2_ = ToCoefficient(a2);
+        }
+
+      private:
+        static constexpr int kCoeffFracBits = 29;
+
+        static int32_t ToCoefficient(float c)
+        {
+            const float scale = static_cast<float>(1 << kCoeffFracBits);
+            return fixed_sat<q31>(static_cast<int64_t>(c * scale));
+        }
+
+        /** RBJ cookbook lowpass */
+        void UpdateLowpass()
+        {
+            const float fc    = fclamp(cutoff_ / sample_rate_, 0.f, 0.49f);
+            const float w0    = TWOPI_F * fc;
+            const float q     = 0.5f / (1.f - 0.98f * res_);
+            const float cosw  = cosf(w0);
+            const float alpha = sinf(w0) / (2.f * q);
+            const float a0    = 1.f / (1.f + alpha);
+            const float b1    = (1.f - cosw) * a0;
+            SetCoefficients(
+                0.5f * b1, b1, 0.5f * b1, -2.f * cosw * a0, (1.f - alpha) * a0);
+        }
+
+        float   sample_rate_, cutoff_, res_;
+        int32_t b0_, b1_, b2_, a1_, a2_;
+        T       x1_, x2_, y1_, y2_;
+    };
+} // namespace fixed
+} // namespace daisysp
+
+#endif
@@ -14,6 +14,8 @@ https://opensource.org/licenses/MIT.
 #include <cstring> // for memset
 #include <cassert>
 #include <utility>
+#include "Utility/simd.h"
+#include "Utility/fft.h"
 
 #ifdef USE_ARM_DSP
 #include <arm_math.h> // required for platform-optimized version
@@ -32,12 +34,13 @@ namespace daisysp
 /** Helper class that defines the memory model - internal or user-provided 
  * \param max_size - maximal filter length
  * \param max_block - maximal length of the block processing
+ * \param extra_state - additional state length, beyond the minimum
  * if both parameters are 0, does NOT allocate any memory and instead
  * requires user-provided memory blocks to be passed as parameters.
  *
  * Not intended to be used directly, so constructor is not exposed
  */
-template <size_t max_size, size_t max_block>
+template <size_t max_size, size_t max_block, size_t extra_state = 0>
 struct FIRMemory
 {
     /* Public part of the API to be passed through to the FIR users */
@@ -81,15 +84,16 @@ struct FIRMemory
         return true;
     }
 
-    static constexpr size_t state_size_ = max_size + max_block - 1u;
+    static constexpr size_t state_size_
+        = max_size + max_block - 1u + extra_state;
     float                   state_[state_size_]; /*< Internal state buffer */
     float                   coefs_[max_size];    /*< Filter coefficients */
     size_t                  size_; /*< Active filter length (<= max_size) */
 };
 
 /* Specialization for user-provided memory */
-template <>
-struct FIRMemory<FIRFILTER_USER_MEMORY>
+template <size_t extra_state>
+struct FIRMemory<FIRFILTER_USER_MEMORY, extra_state>
 {
     /* Public part of the API to be passed through to the FIRFilter user */
   public:
@@ -98,6 +102,8 @@ struct FIRMemory<FIRFILTER_USER_MEMORY>
      * \param length - length of the provided memory block (in elements)
      * The length should be determined as follows 
      * length >= max_filter_size + max_processing_block - 1
+     * Longer buffers let the generic implementation move its history less often.
+     * Call SetIR() after changing the buffer.
      */
     void SetStateBuffer(float state[], size_t length)
     {
@@ -162,19 +168,30 @@ struct FIRMemory<FIRFILTER_USER_MEMORY>
  * Assumes the user will provide own memory buffers
  * via SetIR() and SetStateBuffer() functions
  * Otherwise statically allocates the necessary buffers itself
+ *
+ * New samples are appended to a sliding window in the state buffer,
+ * and the history is only moved back to the start when the window reaches the end.
+ * Internal storage reserves max_size extra samples for that, so the move
+ * happens once every max_size / block samples instead of after every block.
+ * The multiply-accumulate runs four taps at a time with Float4.
  */
 template <size_t max_size, size_t max_block>
-class FIRFilterImplGeneric : public FIRMemory<max_size, max_block>
+class FIRFilterImplGeneric : public FIRMemory<max_size, max_block, max_size>
 {
   private:
-    using FIRMem = FIRMemory<max_size, max_block>; // just a shorthand
+    using FIRMem
+        = FIRMemory<max_size, max_block, max_size>; // just a shorthand
 
   public:
     /* Default constructor */
-    FIRFilterImplGeneric() {}
+    FIRFilterImplGeneric() : offset_(0) {}
 
     /* Reset filter state (but not the coefficients) */
-    using FIRMem::Reset;
+    void Reset()
+    {
+        FIRMem::Reset();
+        offset_ = 0;
+    }
 
     /* FIR Latency is always 0, but API is unified with FFT and fast convolution */
     static constexpr size_t GetLatency() { return 0; }
@@ -182,23 +199,9 @@ class FIRFilterImplGeneric : public FIRMemory<max_size, max_block>
     /* Process one sample at a time */
     float Process(float in)
     {
-        assert(size_ > 0u);
-        /* Feed data into the buffer */
-        state_[size_ - 1u] = in;
-
-        /* Convolution loop */
-        float acc(0);
-        for(size_t i = 0; i < size_ - 1; i++)
-        {
-            acc += state_[i] * coefs_[i];
-            /** Shift the state simulatenously 
-             * (note: better solutions are available) 
-             */
-            state_[i] = state_[1 + i];
-        }
-        acc += in * coefs_[size_ - 1u];
-
-        return acc;
+        float out;
+        ProcessBlock(&in, &out, 1);
+        return out;
     }
 
     /* Process a block of data */
@@ -210,28 +213,25 @@ class FIRFilterImplGeneric : public FIRMemory<max_size, max_block>
         assert(nullptr != pSrc);
         assert(nullptr != pDst);
 
-        /* Process the block of data */
-        for(size_t j = 0; j < block; j++)
+        /* Move the history back to the start once the window runs out of room */
+        const size_t history = size_ - 1u;
+        if(offset_ + history + block > state_size_)
         {
-            /* Feed data into the buffer */
-            state_[size_ - 1u + j] = pSrc[j];
-
-            /* Convolution loop */
-            float acc = 0.0f;
-            for(size_t i = 0; i < size_; i++)
-            {
-                acc += state_[j + i] * coefs_[i];
-            }
-
-            /* Write output */
-            pDst[j] = acc;
+            memmove(state_, state_ + offset_, history * sizeof(state_[0]));
+            offset_ = 0;
         }
 
-        /* Copy data tail for the next block */
-        for(size_t i = 0; i < size_ - 1u; i++)
+        /* Feed data into the buffer */
+        float* window = state_ + offset_;
+        memcpy(window + history, pSrc, block * sizeof(pSrc[0]));
+
+        /* Convolution loop */
+        for(size_t j = 0; j < block; j++)
         {
-            state_[i] = state_[block + i];
+            pDst[j] = Dot(window + j, coefs_, size_);
         }
+
+        offset_ += block;
     }
 
     /** Set filter coefficients (aka Impulse Response)
@@ -257,9 +257,224 @@ class FIRFilterImplGeneric : public FIRMemory<max_size, max_block>
 
 
   protected:
-    using FIRMem::coefs_; /*< FIR coefficients buffer or pointer */
-    using FIRMem::size_;  /*< FIR length */
-    using FIRMem::state_; /*< FIR state buffer or pointer */
+    /* Dot product of two buffers, vectorized with a scalar tail */
+    static inline float Dot(const float* a, const float* b, size_t n)
+    {
+        Float4 acc0 = Float4::Zero();
+        Float4 acc1 = Float4::Zero();
+        size_t i    = 0;
+        for(; i + 8u <= n; i += 8u)
+        {
+            acc0 = acc0 + Float4::Load(a + i) * Float4::Load(b + i);
+            acc1 = acc1 + Float4::Load(a + i + 4u) * Float4::Load(b + i + 4u);
+        }
+        for(; i + 4u <= n; i += 4u)
+        {
+            acc0 = acc0 + Float4::Load(a + i) * Float4::Load(b + i);
+        }
+        float acc = (acc0 + acc1).Sum();
+        for(; i < n; i++)
+        {
+            acc += a[i] * b[i];
+        }
+        return acc;
+    }
+
+    using FIRMem::coefs_;      /*< FIR coefficients buffer or pointer */
+    using FIRMem::size_;       /*< FIR length */
+    using FIRMem::state_;      /*< FIR state buffer or pointer */
+    using FIRMem::state_size_; /*< FIR state buffer length */
+    size_t offset_; /*< Start of the current window in the state buffer */
+};
+
+
+/** FIR implementation for long filters, e.g. cabinet impulse responses
+ * \param max_size - maximal filter length
+ * \param max_block - maximal block size for ProcessBlock()
+ *
+ * Uniformly partitioned convolution with zero latency:
+ * the first kPartitionSize taps are applied directly with FIRFilterImplGeneric,
+ * the rest in the frequency domain, one partition of kPartitionSize taps at a time.
+ * The spectral work is done once every kPartitionSize samples,
+ * whatever the block size passed to ProcessBlock().
+ *
+ * FIR always uses FIRFilterImplGeneric, so pick this class explicitly.
+ * It usually pays off from about 1024 taps, but compared with the direct form:
+ * - it takes several times the memory, for the spectra of all partitions
+ * - only internal memory is supported
+ * - the CPU load peaks once every kPartitionSize samples instead of being even,
+ *   so size the audio callback for the block that does the spectral work
+ */
+template <size_t max_size, size_t max_block>
+class FIRFilterImplFFT
+{
+  public:
+    static constexpr size_t kPartitionSize = 256;
+
+    /* Default constructor */
+    FIRFilterImplFFT() : num_partitions_(0), pos_(0), fdl_pos_(0)
+    {
+        fft_.Init();
+    }
+
+    /* Reset filter state (but not the coefficients) */
+    void Reset()
+    {
+        head_.Reset();
+        memset(frame_, 0, sizeof(frame_));
+        memset(fdl_, 0, sizeof(fdl_));
+        memset(tail_out_, 0, sizeof(tail_out_));
+        pos_     = 0;
+        fdl_pos_ = 0;
+    }
+
+    /* Latency is 0, the first partition is computed directly */
+    static constexpr size_t GetLatency() { return 0; }
+
+    /* Process one sample at a time */
+    float Process(float in)
+    {
+        float out;
+        ProcessBlock(&in, &out, 1);
+        return out;
+    }
+
+    /* Process a block of data */
+    void ProcessBlock(const float* pSrc, float* pDst, size_t block)
+    {
+        assert(block <= max_block);
+        assert(nullptr != pSrc);
+        assert(nullptr != pDst);
+
+        while(block > 0)
+        {
+            const size_t n = DSY_MIN(block, kPartitionSize - pos_);
+
+            /* Keep the input before the head can overwrite it in place */
+            memcpy(frame_ + kPartitionSize + pos_, pSrc, n * sizeof(pSrc[0]));
+            head_.ProcessBlock(pSrc, pDst, n);
+            for(size_t i = 0; i < n; i++)
+            {
+                pDst[i] += tail_out_[pos_ + i];
+            }
+
+            pos_ += n;
+            if(pos_ == kPartitionSize)
+            {
+                ProcessPartitions();
+                pos_ = 0;
+            }
+            pSrc += n;
+            pDst += n;
+            block -= n;
+        }
+    }
+
+    /** Set filter coefficients (aka Impulse Response)
+     * Coefficients need to be in reversed order (tail-first),
+     * unless reverse is set. Longer responses are truncated to max_size.
+     */
+    bool SetIR(const float* ir, size_t len, bool reverse)
+    {
+        assert(nullptr != ir || 0 == len);
+        if(nullptr == ir && 0 != len)
+        {
+            return false;
+        }
+        len = DSY_MIN(len, max_size);
+
+        /* Head: the newest kPartitionSize taps */
+        const size_t head_len = DSY_MIN(len, kPartitionSize);
+        const bool   result   = reverse ? head_.SetIR(ir, head_len, true)
+                                        : head_.SetIR(ir + len - head_len, head_len, false);
+
+        /* Tail: one spectrum per partition, with the inverse FFT scaling folded in */
+        const float scale = 1.0f / kFftSize;
+        num_partitions_   = (len - head_len + kPartitionSize - 1) / kPartitionSize;
+        for(size_t p = 0; p < num_partitions_; p++)
+        {
+            float* spectrum = ir_spectra_[p];
+            memset(spectrum, 0, kFftSize * sizeof(spectrum[0]));
+            for(size_t i = 0; i < kPartitionSize; i++)
+            {
+                /* tap index in newest-first order */
+                const size_t tap = head_len + p * kPartitionSize + i;
+                if(tap < len)
+                {
+                    spectrum[i] = scale * (reverse ? ir[tap] : ir[len - 1u - tap]);
+                }
+            }
+            fft_.Forward(spectrum, spectrum);
+        }
+
+        Reset();
+        return result;
+    }
+
+    /* Create an alias to comply with DaisySP API conventions */
+    template <typename... Args>
+    inline auto Init(Args&&... args)
+        -> decltype(SetIR(std::forward<Args>(args)...))
+    {
+        return SetIR(std::forward<Args>(args)...);
+    }
+
+  private:
+    static constexpr size_t kFftSize = 2 * kPartitionSize;
+    static constexpr size_t kMaxPartitions
+        = max_size > kPartitionSize
+              ? (max_size - kPartitionSize + kPartitionSize - 1) / kPartitionSize
+              : 1;
+
+    /* Called once a full partition of input has been collected.
+     * Computes the tail contribution to the next kPartitionSize outputs.
+     */
+    void ProcessPartitions()
+    {
+        if(num_partitions_ > 0)
+        {
+            /* Spectrum of the last two input blocks, into the delay line */
+            float* newest = fdl_[fdl_pos_];
+            fft_.Forward(frame_, newest);
+
+            /* Multiply-accumulate every partition with its input spectrum */
+            memset(acc_, 0, sizeof(acc_));
+            size_t slot = fdl_pos_;
+            for(size_t p = 0; p < num_partitions_; p++)
+            {
+                const float* x = fdl_[slot];
+                const float* h = ir_spectra_[p];
+                acc_[0] += x[0] * h[0];
+                acc_[1] += x[1] * h[1];
+                for(size_t k = 2; k < kFftSize; k += 2)
+                {
+                    acc_[k] += x[k] * h[k] - x[k + 1] * h[k + 1];
+                    acc_[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+                }
+                slot = slot > 0 ? slot - 1 : num_partitions_ - 1;
+            }
+            fdl_pos_ = fdl_pos_ + 1 < num_partitions_ ? fdl_pos_ + 1 : 0;
+
+            /* Overlap-save: the second half is the valid part */
+            fft_.Inverse(acc_, acc_);
+            memcpy(tail_out_, acc_ + kPartitionSize, sizeof(tail_out_));
+        }
+
+        /* Slide the input frame by one partition */
+        memcpy(frame_, frame_ + kPartitionSize, kPartitionSize * sizeof(frame_[0]));
+    }
+
+    FIRFilterImplGeneric<kPartitionSize, DSY_MIN(max_block, kPartitionSize)>
+                      head_;
+    RealFft<kFftSize> fft_;
+    float             ir_spectra_[kMaxPartitions][kFftSize];
+    float             fdl_[kMaxPartitions][kFftSize]; /*< Input spectra, newest at fdl_pos_ */
+    float             frame_[kFftSize];          /*< Previous and current input block */
+    float             acc_[kFftSize];            /*< Spectral accumulator */
+    float             tail_out_[kPartitionSize]; /*< Tail output for the current block */
+    size_t            num_partitions_;
+    size_t            pos_;
+    size_t            fdl_pos_;
 };
 
 
@@ -339,7 +554,7 @@ using FIR = FIRFilterImplARM<max_size, max_block>;
 
 #else // USE_ARM_DSP
 
-/* default to generic implementation */
+/* default to generic implementation, see FIRFilterImplFFT for long filters */
 template <size_t max_size, size_t max_block>
 using FIR = FIRFilterImplGeneric<max_size, max_block>;
 
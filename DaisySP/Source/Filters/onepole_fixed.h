@@ -0,0 +1,115 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp, Emilie Gillet
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_ONEPOLE_FIXED_H
+#define DSY_ONEPOLE_FIXED_H
+
+#include <stddef.h>
+#include "Utility/dsp.h"
+
+namespace daisysp
+{
+namespace fixed
+{
+    /** One Pole Lowpass / Highpass Filter on fixed point samples.
+
+        The same filter and API as daisysp::OnePole, for q15 or q31 samples,
+        e.g. fixed::OnePole<q31>. Setting the frequency uses float math,
+        Process() only integer math.
+
+        The state saturates at full scale, which only happens for cutoffs
+        near Nyquist with full scale input.
+    */
+    template <typename T>
+    class OnePole
+    {
+      public:
+        OnePole() {}
+        ~OnePole() {}
+
+        /** Operational modes of the filter */
+        enum FilterMode
+        {
+            FILTER_MODE_LOW_PASS,
+            FILTER_MODE_HIGH_PASS
+        };
+
+        /** Initializes the module */
+        void Init()
+        {
+            Reset();
+            g_    = 0;
+            mode_ = FILTER_MODE_LOW_PASS;
+        }
+
+        /** Reset the module to its default state */
+        inline void Reset() { state_ = 0; }
+
+        /** Set the filter cutoff frequency
+        *   \param freq Cutoff frequency. Valid range from 0 to .497f
+        */
+        inline void SetFrequency(float freq)
+        {
+            freq = freq < 0.497f ? freq : 0.497f;
+
+            // g / (1 + g) stays below 1, where g itself can reach about 100
+            const float g = tanf(PI_F * freq);
+            g_            = float_to_fixed<T>(g / (1.f + g));
+        }
+
+        /** Set the filter mode
+        *   \param mode Filter mode. Can be lowpass or highpass
+        */
+        inline void SetFilterMode(FilterMode mode) { mode_ = mode; }
+
+        /** Process audio through the filter
+        *   \param in The next sample to be processed
+        */
+        inline T Process(T in)
+        {
+            // Fits the accumulator: |in - state_| < 2 and g_ < 1
+            const acc diff = static_cast<acc>(in) - state_;
+            const acc v    = fixed_round_shift(diff * g_, kFracBits);
+            const T   lp   = fixed_sat<T>(state_ + v);
+            state_         = fixed_sat<T>(lp + v);
+
+            switch(mode_)
+            {
+                case FILTER_MODE_LOW_PASS: return lp;
+                case FILTER_MODE_HIGH_PASS: return fixed_sub(in, lp);
+            }
+
+            return 0;
+        }
+
+        /** Process a block of audio through the filter
+        *   \param in_out Pointer to the block of samples to be processed
+        *   \param size Size of the block of samples to be processed.
+        */
+        inline void ProcessBlock(T* in_out, size_t size)
+        {
+            while(size--)
+            {
+                *in_out = Process(*in_out);
+                ++in_out;
+            }
+        }
+
+      private:
+        typedef typename fixed_traits<T>::acc acc;
+        static constexpr int kFracBits = fixed_traits<T>::kFracBits;
+
+        T          g_;
+        T          state_;
+        FilterMode mode_;
+    };
+} // namespace fixed
+} // namespace daisysp
+
+#endif // DSY_ONEPOLE_FIXED_H
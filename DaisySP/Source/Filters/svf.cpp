@@ -1,6 +1,7 @@
 #include <math.h>
 #include "svf.h"
 #include "dsp.h"
+#include "fastmath.h"
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
 using namespace daisysp;
@@ -59,12 +60,21 @@ void Svf::SetFreq(float f)
 {
     fc_ = fclamp(f, 1.0e-6, fc_max_);
     // Set Internal Frequency for fc_
+#ifdef DSY_FAST_MATH
+    // sin_lut takes cycles rather than radians. The cutoff always uses the
+    // cubic table: the nearest entry of the LOW tier is 0 below about 94Hz,
+    // and steps by about 188Hz above.
+    freq_ = 2.0f
+            * sin_lut<FastMathAccuracy::HIGH>(
+                0.5f * MIN(0.25f, fc_ / (sr_ * 2.0f)));
+#else
     freq_ = 2.0f
             * sinf(PI_F
                    * MIN(0.25f,
                          fc_ / (sr_ * 2.0f))); // fs*2 because double sampled
+#endif
     // recalculate damp
-    damp_ = MIN(2.0f * (1.0f - powf(res_, 0.25f)),
+    damp_ = MIN(2.0f * (1.0f - ResRoot()),
                 MIN(2.0f, 2.0f / freq_ - freq_ * 0.5f));
 }
 
@@ -73,11 +83,20 @@ void Svf::SetRes(float r)
     float res = fclamp(r, 0.f, 1.f);
     res_      = res;
     // recalculate damp
-    damp_  = MIN(2.0f * (1.0f - powf(res_, 0.25f)),
+    damp_  = MIN(2.0f * (1.0f - ResRoot()),
                 MIN(2.0f, 2.0f / freq_ - freq_ * 0.5f));
     drive_ = pre_drive_ * res_;
 }
 
+float Svf::ResRoot()
+{
+#ifdef DSY_FAST_MATH
+    return sqrtf(sqrtf(res_));
+#else
+    return powf(res_, 0.25f);
+#endif
+}
+
 void Svf::SetDrive(float d)
 {
     float drv  = fclamp(d * 0.1f, 0.f, 1.f);
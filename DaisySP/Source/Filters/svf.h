@@ -76,6 +76,8 @@ class Svf
     inline float Peak() { return out_peak_; }
 
   private:
+    float ResRoot();
+
     float sr_, fc_, res_, drive_, freq_, damp_;
     float notch_, low_, high_, band_, peak_;
     float input_;
@@ -0,0 +1,204 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SVF_FIXED_H
+#define DSY_SVF_FIXED_H
+
+#include "Utility/dsp.h"
+#ifdef DSY_FAST_MATH
+#include "Utility/fastmath.h"
+#endif
+
+namespace daisysp
+{
+namespace fixed
+{
+    /** Double Sampled, Stable State Variable Filter on fixed point samples.
+
+        The same filter and API as daisysp::Svf, for q15 or q31 samples,
+        e.g. fixed::Svf<q31>. The setters use float math to work out the
+        coefficients, Process() only integer math.
+
+        The states saturate at full scale, so with high resonance and loud
+        input the filter clips where the float version would go above 1.
+    */
+    template <typename T>
+    class Svf
+    {
+      public:
+        Svf() {}
+        ~Svf() {}
+
+        /** Initializes the filter
+            float sample_rate - sample rate of the audio engine being run, and the frequency that the Process function will be called.
+        */
+        void Init(float sample_rate)
+        {
+            sr_        = sample_rate;
+            fc_        = 200.0f;
+            res_       = 0.5f;
+            drive_     = 0.5f;
+            pre_drive_ = 0.5f;
+            freq_      = 0.25f;
+            damp_      = 0.0f;
+            notch_     = 0;
+            low_       = 0;
+            high_      = 0;
+            band_      = 0;
+            out_notch_ = 0;
+            out_low_   = 0;
+            out_high_  = 0;
+            out_peak_  = 0;
+            out_band_  = 0;
+            fc_max_    = sr_ / 3.f;
+            QuantizeCoefficients();
+        }
+
+        /** Process the input signal, updating all of the outputs.
+        */
+        void Process(T in)
+        {
+            // first pass
+            Step(in);
+            const acc low   = low_;
+            const acc high  = high_;
+            const acc band  = band_;
+            const acc notch = notch_;
+
+            // second pass, averaged with the first
+            Step(in);
+            out_low_   = static_cast<T>(fixed_round_shift(low + low_, 1));
+            out_high_  = static_cast<T>(fixed_round_shift(high + high_, 1));
+            out_band_  = static_cast<T>(fixed_round_shift(band + band_, 1));
+            out_notch_ = static_cast<T>(fixed_round_shift(notch + notch_, 1));
+            out_peak_  = fixed_sat<T>(
+                fixed_round_shift(low - high + low_ - high_, 1));
+        }
+
+        /** sets the frequency of the cutoff frequency.
+            f must be between 0.0 and sample_rate / 3
+        */
+        void SetFreq(float f)
+        {
+            fc_ = fclamp(f, 1.0e-6, fc_max_);
+            // fs*2 because double sampled
+            const float fc = fmin(0.25f, fc_ / (sr_ * 2.0f));
+#ifdef DSY_FAST_MATH
+            // sin_lut takes cycles rather than radians, and always the cubic
+            // table, as LOW would round low cutoffs to 0.
+            freq_ = 2.0f * sin_lut<FastMathAccuracy::HIGH>(0.5f * fc);
+#else
+            freq_ = 2.0f * sinf(PI_F * fc);
+#endif
+            UpdateDamp();
+        }
+
+        /** sets the resonance of the filter.
+            Must be between 0.0 and 1.0 to ensure stability.
+        */
+        void SetRes(float r)
+        {
+            res_   = fclamp(r, 0.f, 1.f);
+            drive_ = pre_drive_ * res_;
+            UpdateDamp();
+        }
+
+        /** sets the drive of the filter
+            affects the response of the resonance of the filter
+        */
+        void SetDrive(float d)
+        {
+            pre_drive_ = fclamp(d * 0.1f, 0.f, 1.f);
+            drive_     = pre_drive_ * res_;
+            QuantizeCoefficients();
+        }
+
+        /** lowpass output
+            \return low pass output of the filter
+        */
+        inline T Low() { return out_low_; }
+
+        /** highpass output
+            \return high pass output of the filter
+        */
+        inline T High() { return out_high_; }
+
+        /** bandpass output
+            \return band pass output of the filter
+        */
+        inline T Band() { return out_band_; }
+
+        /** notchpass output
+            \return notch pass output of the filter
+        */
+        inline T Notch() { return out_notch_; }
+
+        /** peak output
+            \return peak output of the filter
+        */
+        inline T Peak() { return out_peak_; }
+
+      private:
+        typedef typename fixed_traits<T>::acc acc;
+        static constexpr int kFracBits = fixed_traits<T>::kFracBits;
+
+        /** The damping reaches 2, so it has one fractional bit less */
+        static constexpr int kDampFracBits = kFracBits - 1;
+
+        static inline acc Mul(acc a, acc b)
+        {
+            return fixed_round_shift(a * b, kFracBits);
+        }
+
+        /** One pass of the filter. Every product is of two values below 2
+            in magnitude, so none of them overflow the accumulator.
+        */
+        inline void Step(T in)
+        {
+            const acc damped = fixed_round_shift(
+                static_cast<acc>(damp_q_) * band_, kDampFracBits);
+            const acc notch = in - damped;
+            const acc cubed = Mul(Mul(band_, band_), band_);
+            low_            = fixed_sat<T>(low_ + Mul(freq_q_, band_));
+            high_           = fixed_sat<T>(notch - low_);
+            band_           = fixed_sat<T>(Mul(freq_q_, high_) + band_
+                                 - Mul(drive_q_, cubed));
+            notch_          = fixed_sat<T>(notch);
+        }
+
+        void UpdateDamp()
+        {
+#ifdef DSY_FAST_MATH
+            const float res_root = sqrtf(sqrtf(res_));
+#else
+            const float res_root = powf(res_, 0.25f);
+#endif
+            damp_ = fmin(2.0f * (1.0f - res_root),
+                         fmin(2.0f, 2.0f / freq_ - freq_ * 0.5f));
+            QuantizeCoefficients();
+        }
+
+        void QuantizeCoefficients()
+        {
+            const float scale = static_cast<float>(acc(1) << kDampFracBits);
+            freq_q_           = float_to_fixed<T>(freq_);
+            damp_q_           = fixed_sat<T>(static_cast<acc>(damp_ * scale));
+            drive_q_          = float_to_fixed<T>(drive_);
+        }
+
+        float sr_, fc_, res_, drive_, freq_, damp_;
+        float pre_drive_, fc_max_;
+        T     freq_q_, damp_q_, drive_q_;
+        T     notch_, low_, high_, band_;
+        T     out_low_, out_high_, out_band_, out_peak_, out_notch_;
+    };
+} // namespace fixed
+} // namespace daisysp
+
+#endif
@@ -66,19 +66,73 @@ float ModalVoice::GetAux()
 
 float ModalVoice::Process(bool trigger)
 {
-    float brightness = brightness_ + 0.25f * accent_ * (1.0f - brightness_);
-    float damping    = damping_ + 0.25f * accent_ * (1.0f - damping_);
+    float brightness, damping, cutoff, q;
+    ComputeParameters(brightness, damping, cutoff, q);
 
-    const float range  = sustain_ ? 36.0f : 60.0f;
-    const float f      = sustain_ ? 4.0f * f0_ : 2.0f * f0_;
-    const float cutoff = fmin(
+    float temp = Excite(trigger, damping, cutoff);
+
+    const float one = 1.0f;
+    excitation_filter_.Process<ResonatorSvf<1>::LOW_PASS, false>(
+        &cutoff, &q, &one, temp, &temp);
+
+    aux_ = temp;
+
+    resonator_.SetBrightness(brightness);
+    resonator_.SetDamping(damping);
+
+    return resonator_.Process(temp);
+}
+
+void ModalVoice::ProcessBlock(float* out, size_t size, bool trigger)
+{
+    float brightness, damping, cutoff, q;
+    ComputeParameters(brightness, damping, cutoff, q);
+
+    resonator_.SetBrightness(brightness);
+    resonator_.SetDamping(damping);
+
+    const float one = 1.0f;
+    float       excitation[kMaxBlockSize];
+    while(size > 0)
+    {
+        const size_t n = size < kMaxBlockSize ? size : kMaxBlockSize;
+        for(size_t i = 0; i < n; i++)
+        {
+            excitation[i] = Excite(trigger, damping, cutoff);
+            trigger       = false;
+        }
+        excitation_filter_.ProcessBlock<ResonatorSvf<1>::LOW_PASS, false>(
+            &cutoff, &q, &one, excitation, excitation, n);
+
+        resonator_.ProcessBlock(excitation, out, n);
+
+        aux_ = excitation[n - 1];
+        out += n;
+        size -= n;
+    }
+}
+
+void ModalVoice::ComputeParameters(float& brightness,
+                                   float& damping,
+                                   float& cutoff,
+                                   float& q) const
+{
+    brightness = brightness_ + 0.25f * accent_ * (1.0f - brightness_);
+    damping    = damping_ + 0.25f * accent_ * (1.0f - damping_);
+
+    const float range = sustain_ ? 36.0f : 60.0f;
+    const float f     = sustain_ ? 4.0f * f0_ : 2.0f * f0_;
+    cutoff            = fmin(
         f
             * powf(2.f,
                    kOneTwelfth
                        * ((brightness * (2.0f - brightness) - 0.5f) * range)),
         0.499f);
-    const float q = sustain_ ? 0.7f : 1.5f;
+    q = sustain_ ? 0.7f : 1.5f;
+}
 
+float ModalVoice::Excite(bool trigger, float damping, float cutoff)
+{
     float temp = 0.f;
     // Synthesize excitation signal.
     if(sustain_)
@@ -95,15 +149,5 @@ float ModalVoice::Process(bool trigger)
                / cutoff;
         trig_ = false;
     }
-
-    const float one = 1.0f;
-    excitation_filter_.Process<ResonatorSvf<1>::LOW_PASS, false>(
-        &cutoff, &q, &one, temp, &temp);
-
-    aux_ = temp;
-
-    resonator_.SetBrightness(brightness);
-    resonator_.SetDamping(damping);
-
-    return resonator_.Process(temp);
-}
\ No newline at end of file
+    return temp;
+}
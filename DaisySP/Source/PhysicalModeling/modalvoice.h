@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_MODAL_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "Filters/svf.h"
 #include "PhysicalModeling/resonator.h"
 #include "Noise/dust.h"
@@ -46,6 +47,14 @@ class ModalVoice
     */
     float Process(bool trigger = false);
 
+    /** Fill a block of samples
+        The parameters are read once per block.
+        \param out Output buffer
+        \param size Number of samples to process
+        \param trigger Strike the resonator at the start of the block. Defaults to false.
+    */
+    void ProcessBlock(float* out, size_t size, bool trigger = false);
+
     /** Continually excite the resonator with noise.
         \param sustain True turns on the noise.
     */
@@ -90,6 +99,14 @@ class ModalVoice
     float density_, accent_;
     float aux_;
 
+    static constexpr size_t kMaxBlockSize = 32;
+
+    void  ComputeParameters(float& brightness,
+                            float& damping,
+                            float& cutoff,
+                            float& q) const;
+    float Excite(bool trigger, float damping, float cutoff);
+
     ResonatorSvf<1> excitation_filter_;
     Resonator       resonator_;
     Dust            dust_;
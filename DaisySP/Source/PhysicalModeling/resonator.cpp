@@ -14,15 +14,12 @@ void Resonator::Init(float position, int resolution, float sample_rate)
 
     resolution_ = fmin(resolution, kMaxNumModes);
 
-    for(int i = 0; i < resolution; ++i)
+    for(int i = 0; i < resolution_; ++i)
     {
         mode_amplitude_[i] = cos(position * TWOPI_F) * 0.25f;
     }
 
-    for(int i = 0; i < kMaxNumModes / kModeBatchSize; ++i)
-    {
-        mode_filters_[i].Init();
-    }
+    mode_filters_.Init();
 }
 
 inline float NthHarmonicCompensation(int n, float stiffness)
@@ -45,9 +42,33 @@ inline float NthHarmonicCompensation(int n, float stiffness)
 
 float Resonator::Process(const float in)
 {
-    //convert Hz to cycles / sample
     float out = 0.f;
 
+    float mode_f[kMaxNumModes];
+    float mode_q[kMaxNumModes];
+    float mode_a[kMaxNumModes];
+
+    const int num_modes = ComputeModes(mode_f, mode_q, mode_a);
+    mode_filters_.ProcessBlock<ResonatorSvf<kMaxNumModes>::BAND_PASS, false>(
+        mode_f, mode_q, mode_a, &in, &out, 1, num_modes);
+
+    return out;
+}
+
+void Resonator::ProcessBlock(const float* in, float* out, size_t size)
+{
+    float mode_f[kMaxNumModes];
+    float mode_q[kMaxNumModes];
+    float mode_a[kMaxNumModes];
+
+    const int num_modes = ComputeModes(mode_f, mode_q, mode_a);
+    mode_filters_.ProcessBlock<ResonatorSvf<kMaxNumModes>::BAND_PASS, false>(
+        mode_f, mode_q, mode_a, in, out, size, num_modes);
+}
+
+int Resonator::ComputeModes(float* mode_f, float* mode_q, float* mode_a)
+{
+    //convert Hz to cycles / sample
     float stiffness  = CalcStiff(structure_);
     float f0         = frequency_ * NthHarmonicCompensation(3, stiffness);
     float brightness = brightness_;
@@ -63,14 +84,10 @@ float Resonator::Process(const float in)
     brightness *= 1.0f - damping_ * 0.3f;
     float q_loss = brightness * (2.0f - brightness) * 0.85f + 0.15f;
 
-    float mode_q[kModeBatchSize];
-    float mode_f[kModeBatchSize];
-    float mode_a[kModeBatchSize];
-    int   batch_counter = 0;
-
-    ResonatorSvf<kModeBatchSize>* batch_processor = &mode_filters_[0];
+    // Modes past the last full batch are not rendered.
+    const int num_modes = resolution_ - resolution_ % kModeBatchSize;
 
-    for(int i = 0; i < resolution_; ++i)
+    for(int i = 0; i < num_modes; ++i)
     {
         float mode_frequency = harmonic * stretch_factor;
         if(mode_frequency >= 0.499f)
@@ -79,19 +96,9 @@ float Resonator::Process(const float in)
         }
         const float mode_attenuation = 1.0f - mode_frequency * 2.0f;
 
-        mode_f[batch_counter] = mode_frequency;
-        mode_q[batch_counter] = 1.0f + mode_frequency * q;
-        mode_a[batch_counter] = mode_amplitude_[i] * mode_attenuation;
-        ++batch_counter;
-
-        if(batch_counter == kModeBatchSize)
-        {
-            batch_counter = 0;
-            batch_processor
-                ->Process<ResonatorSvf<kModeBatchSize>::BAND_PASS, true>(
-                    mode_f, mode_q, mode_a, in, &out);
-            ++batch_processor;
-        }
+        mode_f[i] = mode_frequency;
+        mode_q[i] = 1.0f + mode_frequency * q;
+        mode_a[i] = mode_amplitude_[i] * mode_attenuation;
 
         stretch_factor += stiffness;
         if(stiffness < 0.0f)
@@ -108,7 +115,7 @@ float Resonator::Process(const float in)
         q *= q_loss;
     }
 
-    return out;
+    return num_modes;
 }
 
 void Resonator::SetFreq(float freq)
@@ -13,6 +13,7 @@ https://opensource.org/licenses/MIT.
 #include <stdint.h>
 #include <stddef.h>
 #include "Utility/dsp.h"
+#include "Utility/simd.h"
 #ifdef __cplusplus
 
 
@@ -20,8 +21,9 @@ https://opensource.org/licenses/MIT.
 
 namespace daisysp
 {
-// We render 4 modes simultaneously since there are enough registers to hold
-// all state variables.
+// Modes are rendered four at a time with Float4, which maps onto SSE/NEON
+// where available. Each group of four is an independent chain, so larger
+// batches keep more of them in flight.
 /**  
        @brief SVF for use in the Resonator Class \n 
        @author Ported by Ben Sergentanis 
@@ -53,6 +55,13 @@ class ResonatorSvf
         }
     }
 
+    /** Processes one sample through every mode in the batch.
+        \param f Frequency of each mode, in cycles per sample
+        \param q Resonance of each mode
+        \param gain Output gain of each mode
+        \param in Input sample, shared by all modes
+        \param out Receives the sum of the modes, or has it added when add is true
+    */
     template <FilterMode mode, bool add>
     void Process(const float* f,
                  const float* q,
@@ -60,46 +69,117 @@ class ResonatorSvf
                  const float  in,
                  float*       out)
     {
+        ProcessBlock<mode, add>(f, q, gain, &in, out, 1);
+    }
+
+    /** Processes a block with fixed mode settings.
+        The coefficients are computed once per call, and modes are
+        run four at a time with Float4, any remainder with scalar code.
+        \param f Frequency of each mode, in cycles per sample
+        \param q Resonance of each mode
+        \param gain Output gain of each mode
+        \param in Input buffer, shared by all modes
+        \param out Output buffer, may be the same as in.
+        \param size Number of samples to process
+        \param num_modes Number of modes to run, from the start of the batch.
+                         Defaults to all of them.
+    */
+    template <FilterMode mode, bool add>
+    void ProcessBlock(const float* f,
+                      const float* q,
+                      const float* gain,
+                      const float* in,
+                      float*       out,
+                      size_t       size,
+                      int          num_modes = batch_size)
+    {
+        const int num_vectors  = num_modes / Float4::kWidth;
+        const int vector_modes = num_vectors * Float4::kWidth;
+
         float g[batch_size];
-        float r[batch_size];
         float r_plus_g[batch_size];
         float h[batch_size];
-        float state_1[batch_size];
-        float state_2[batch_size];
-        float gains[batch_size];
-        for(int i = 0; i < batch_size; ++i)
+        for(int i = 0; i < num_modes; ++i)
         {
-            g[i]        = fasttan(f[i]);
-            r[i]        = 1.0f / q[i];
-            h[i]        = 1.0f / (1.0f + r[i] * g[i] + g[i] * g[i]);
-            r_plus_g[i] = r[i] + g[i];
-            state_1[i]  = state_1_[i];
-            state_2[i]  = state_2_[i];
-            gains[i]    = gain[i];
+            const float r = 1.0f / q[i];
+            g[i]          = fasttan(f[i]);
+            h[i]          = 1.0f / (1.0f + r * g[i] + g[i] * g[i]);
+            r_plus_g[i]   = r + g[i];
         }
 
-        float s_in  = in;
-        float s_out = 0.0f;
-        for(int i = 0; i < batch_size; ++i)
+        // At least one element, so the arrays stay valid when batch_size < 4.
+        Float4 vg[kNumVectors > 0 ? kNumVectors : 1];
+        Float4 vr_plus_g[kNumVectors > 0 ? kNumVectors : 1];
+        Float4 vh[kNumVectors > 0 ? kNumVectors : 1];
+        Float4 vgain[kNumVectors > 0 ? kNumVectors : 1];
+        Float4 vstate_1[kNumVectors > 0 ? kNumVectors : 1];
+        Float4 vstate_2[kNumVectors > 0 ? kNumVectors : 1];
+        for(int v = 0; v < num_vectors; ++v)
         {
-            const float hp
-                = (s_in - r_plus_g[i] * state_1[i] - state_2[i]) * h[i];
-            const float bp = g[i] * hp + state_1[i];
-            state_1[i]     = g[i] * hp + bp;
-            const float lp = g[i] * bp + state_2[i];
-            state_2[i]     = g[i] * bp + lp;
-            s_out += gains[i] * ((mode == LOW_PASS) ? lp : bp);
+            const int i  = v * Float4::kWidth;
+            vg[v]        = Float4::Load(&g[i]);
+            vr_plus_g[v] = Float4::Load(&r_plus_g[i]);
+            vh[v]        = Float4::Load(&h[i]);
+            vgain[v]     = Float4::Load(&gain[i]);
+            vstate_1[v]  = Float4::Load(&state_1_[i]);
+            vstate_2[v]  = Float4::Load(&state_2_[i]);
         }
-        if(add)
+
+        float state_1[batch_size];
+        float state_2[batch_size];
+        for(int i = vector_modes; i < num_modes; ++i)
         {
-            *out++ += s_out;
+            state_1[i] = state_1_[i];
+            state_2[i] = state_2_[i];
         }
-        else
+
+        for(size_t n = 0; n < size; ++n)
         {
-            *out++ = s_out;
+            const float s_in  = in[n];
+            float       s_out = 0.0f;
+            if(num_vectors > 0)
+            {
+                const Float4 v_in = Float4::Broadcast(s_in);
+                Float4       acc  = Float4::Zero();
+                for(int v = 0; v < num_vectors; ++v)
+                {
+                    const Float4 hp
+                        = (v_in - vr_plus_g[v] * vstate_1[v] - vstate_2[v])
+                          * vh[v];
+                    const Float4 bp = vg[v] * hp + vstate_1[v];
+                    vstate_1[v]     = vg[v] * hp + bp;
+                    const Float4 lp = vg[v] * bp + vstate_2[v];
+                    vstate_2[v]     = vg[v] * bp + lp;
+                    acc = acc + vgain[v] * ((mode == LOW_PASS) ? lp : bp);
+                }
+                s_out = acc.Sum();
+            }
+            for(int i = vector_modes; i < num_modes; ++i)
+            {
+                const float hp
+                    = (s_in - r_plus_g[i] * state_1[i] - state_2[i]) * h[i];
+                const float bp = g[i] * hp + state_1[i];
+                state_1[i]     = g[i] * hp + bp;
+                const float lp = g[i] * bp + state_2[i];
+                state_2[i]     = g[i] * bp + lp;
+                s_out += gain[i] * ((mode == LOW_PASS) ? lp : bp);
+            }
+            if(add)
+            {
+                out[n] += s_out;
+            }
+            else
+            {
+                out[n] = s_out;
+            }
         }
 
-        for(int i = 0; i < batch_size; ++i)
+        for(int v = 0; v < num_vectors; ++v)
+        {
+            vstate_1[v].Store(&state_1_[v * Float4::kWidth]);
+            vstate_2[v].Store(&state_2_[v * Float4::kWidth]);
+        }
+        for(int i = vector_modes; i < num_modes; ++i)
         {
             state_1_[i] = state_1[i];
             state_2_[i] = state_2[i];
@@ -107,6 +187,8 @@ class ResonatorSvf
     }
 
   private:
+    static constexpr int kNumVectors = batch_size / Float4::kWidth;
+
     static constexpr float kPiPow3 = PI_F * PI_F * PI_F;
     static constexpr float kPiPow5 = kPiPow3 * PI_F * PI_F;
     static inline float    fasttan(float f)
@@ -138,7 +220,8 @@ class Resonator
 
     /** Initialize the module
         \param position    Offset the phase of the amplitudes. 0-1
-        \param resolution Quality vs speed scalar
+        \param resolution Quality vs speed scalar, the number of modes (up to 64).
+                          Only whole batches of 4 modes are rendered.
         \param sample_rate Samplerate of the audio engine being run.
     */
     void Init(float position, int resolution, float sample_rate);
@@ -148,6 +231,15 @@ class Resonator
     */
     float Process(const float in);
 
+    /** Processes a block of samples.
+        The mode frequencies and resonances are computed once per block,
+        so parameter changes take effect at block boundaries.
+        \param in The signal to excite the resonant body
+        \param out Output buffer, must not overlap in
+        \param size Number of samples to process
+    */
+    void ProcessBlock(const float* in, float* out, size_t size);
+
     /** Resonator frequency.
         \param freq Frequency in Hz.
     */
@@ -172,8 +264,8 @@ class Resonator
     int   resolution_;
     float frequency_, brightness_, structure_, damping_;
 
-    static constexpr int   kMaxNumModes   = 24;
-    static constexpr int   kModeBatchSize = 4;
+    static constexpr int   kMaxNumModes   = 64;
+    static constexpr int   kModeBatchSize = 4; // modes are rendered in multiples of this
     static constexpr float ratiofrac_     = 1.f / 12.f;
     static constexpr float stiff_frac_    = 1.f / 64.f;
     static constexpr float stiff_frac_2   = 1.f / .6f;
@@ -182,8 +274,13 @@ class Resonator
 
     float CalcStiff(float sig);
 
+    /** Fills in the settings of every mode that is rendered
+        \return The number of modes to process
+    */
+    int ComputeModes(float* mode_f, float* mode_q, float* mode_a);
+
     float                        mode_amplitude_[kMaxNumModes];
-    ResonatorSvf<kModeBatchSize> mode_filters_[kMaxNumModes / kModeBatchSize];
+    ResonatorSvf<kMaxNumModes> mode_filters_;
 };
 
 } // namespace daisysp
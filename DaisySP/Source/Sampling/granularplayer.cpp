@@ -1,4 +1,5 @@
 #include "granularplayer.h"
+#include "fastmath.h"
 
 using namespace daisysp;
 
@@ -37,7 +38,11 @@ uint32_t GranularPlayer::WrapIdx(uint32_t idx, uint32_t sz)
 float GranularPlayer::CentsToRatio(float cents)
 {
     /*converts cents to  ratio*/
+#ifdef DSY_FAST_MATH
+    return cents_to_ratio(cents);
+#else
     return powf(2.0f, cents / 1200.0f);
+#endif
 }
 
 
@@ -24,6 +24,38 @@ void Fm2::Init(float samplerate)
 }
 
 float Fm2::Process()
+{
+    UpdateFrequencies();
+
+    float modval = mod_.Process();
+    car_.PhaseAdd(modval * idx_);
+    return car_.Process();
+}
+
+void Fm2::ProcessBlock(float* out, size_t size)
+{
+    UpdateFrequencies();
+
+    // The modulator output is scaled in place and then consumed
+    // as the carrier's phase modulation input.
+    mod_.ProcessBlock(out, size);
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] *= idx_;
+    }
+    car_.ProcessBlock(nullptr, out, out, size);
+}
+
+void Fm2::ProcessBlock(const float* freq, float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFrequency(freq[i]);
+        out[i] = Process();
+    }
+}
+
+void Fm2::UpdateFrequencies()
 {
     if(lratio_ != ratio_ || lfreq_ != freq_)
     {
@@ -32,10 +64,6 @@ float Fm2::Process()
         car_.SetFreq(lfreq_);
         mod_.SetFreq(lfreq_ * lratio_);
     }
-
-    float modval = mod_.Process();
-    car_.PhaseAdd(modval * idx_);
-    return car_.Process();
 }
 
 void Fm2::SetFrequency(float freq)
@@ -39,6 +39,20 @@ class Fm2
     */
     float Process();
 
+    /** Fills a block with output samples.
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fills a block with output samples, using a per-sample carrier frequency.
+        Equivalent to calling SetFrequency() before each call to Process().
+        \param freq Carrier frequency in Hz for each sample
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
     /** Carrier freq. setter
         \param freq Carrier frequency in Hz
     */
@@ -61,6 +75,8 @@ class Fm2
     void Reset();
 
   private:
+    void UpdateFrequencies();
+
     static constexpr float kIdxScalar      = 0.2f;
     static constexpr float kIdxScalarRecip = 1.f / kIdxScalar;
 
@@ -1,4 +1,5 @@
 #include "dsp.h"
+#include "fastmath.h"
 #include "formantosc.h"
 #include <math.h>
 
@@ -56,6 +57,23 @@ float FormantOscillator::Process()
     return this_sample;
 }
 
+void FormantOscillator::ProcessBlock(float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = Process();
+    }
+}
+
+void FormantOscillator::ProcessBlock(const float* freq, float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        SetCarrierFreq(freq[i]);
+        out[i] = Process();
+    }
+}
+
 void FormantOscillator::SetFormantFreq(float freq)
 {
     //convert from Hz to phase_inc / sample
@@ -81,7 +99,11 @@ void FormantOscillator::SetPhaseShift(float ps)
 
 inline float FormantOscillator::Sine(float phase)
 {
+#ifdef DSY_FAST_MATH
+    return sin_lut(phase);
+#else
     return sinf(phase * TWOPI_F);
+#endif
 }
 
 inline float FormantOscillator::ThisBlepSample(float t)
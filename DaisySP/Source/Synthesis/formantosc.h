@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_FORMANTOSCILLATOR_H
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 
 /** @file formantosc.h */
@@ -41,6 +42,20 @@ class FormantOscillator
     */
     float Process();
 
+    /** Fill a block with samples.
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fill a block with samples, using a per-sample carrier frequency.
+        Equivalent to calling SetCarrierFreq() before each call to Process().
+        \param freq Carrier frequency in Hz for each sample
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
     /** Set the formant frequency.
         \param freq Frequency in Hz
     */
@@ -1,48 +1,100 @@
 #include "dsp.h"
+#include "fastmath.h"
 #include "oscillator.h"
 
 using namespace daisysp;
 static inline float Polyblep(float phase_inc, float t);
 
-float Oscillator::Process()
+/** Computes a single sample of the given waveform at the given phase.
+    The waveform is a template argument so that block processing can
+    resolve the selection once, outside of the sample loop.
+*/
+template <uint8_t waveform>
+static inline float
+ComputeWaveform(float phase, float phase_inc, float pw, float &last_out)
 {
     float out, t;
-    switch(waveform_)
+    switch(waveform)
     {
-        case WAVE_SIN: out = sinf(phase_ * TWOPI_F); break;
-        case WAVE_TRI:
-            t   = -1.0f + (2.0f * phase_);
+        case Oscillator::WAVE_SIN:
+#ifdef DSY_FAST_MATH
+            out = sin_lut(phase);
+#else
+            out = sinf(phase * TWOPI_F);
+#endif
+            break;
+        case Oscillator::WAVE_TRI:
+            t   = -1.0f + (2.0f * phase);
             out = 2.0f * (fabsf(t) - 0.5f);
             break;
-        case WAVE_SAW: out = -1.0f * (((phase_ * 2.0f)) - 1.0f); break;
-        case WAVE_RAMP: out = ((phase_ * 2.0f)) - 1.0f; break;
-        case WAVE_SQUARE: out = phase_ < pw_ ? (1.0f) : -1.0f; break;
-        case WAVE_POLYBLEP_TRI:
-            t   = phase_;
-            out = phase_ < 0.5f ? 1.0f : -1.0f;
-            out += Polyblep(phase_inc_, t);
-            out -= Polyblep(phase_inc_, fastmod1f(t + 0.5f));
+        case Oscillator::WAVE_SAW: out = -1.0f * (((phase * 2.0f)) - 1.0f); break;
+        case Oscillator::WAVE_RAMP: out = ((phase * 2.0f)) - 1.0f; break;
+        case Oscillator::WAVE_SQUARE: out = phase < pw ? (1.0f) : -1.0f; break;
+        case Oscillator::WAVE_POLYBLEP_TRI:
+            t   = phase;
+            out = phase < 0.5f ? 1.0f : -1.0f;
+            out += Polyblep(phase_inc, t);
+            out -= Polyblep(phase_inc, fastmod1f(t + 0.5f));
             // Leaky Integrator:
             // y[n] = A + x[n] + (1 - A) * y[n-1]
-            out       = phase_inc_ * out + (1.0f - phase_inc_) * last_out_;
-            last_out_ = out;
+            out      = phase_inc * out + (1.0f - phase_inc) * last_out;
+            last_out = out;
             out *= 4.f; // normalize amplitude after leaky integration
             break;
-        case WAVE_POLYBLEP_SAW:
-            t   = phase_;
+        case Oscillator::WAVE_POLYBLEP_SAW:
+            t   = phase;
             out = (2.0f * t) - 1.0f;
-            out -= Polyblep(phase_inc_, t);
+            out -= Polyblep(phase_inc, t);
             out *= -1.0f;
             break;
-        case WAVE_POLYBLEP_SQUARE:
-            t   = phase_;
-            out = phase_ < pw_ ? 1.0f : -1.0f;
-            out += Polyblep(phase_inc_, t);
-            out -= Polyblep(phase_inc_, fastmod1f(t + (1.0f - pw_)));
+        case Oscillator::WAVE_POLYBLEP_SQUARE:
+            t   = phase;
+            out = phase < pw ? 1.0f : -1.0f;
+            out += Polyblep(phase_inc, t);
+            out -= Polyblep(phase_inc, fastmod1f(t + (1.0f - pw)));
             out *= 0.707f; // ?
             break;
         default: out = 0.0f; break;
     }
+    return out;
+}
+
+float Oscillator::Process()
+{
+    float out;
+    switch(waveform_)
+    {
+        case WAVE_SIN:
+            out = ComputeWaveform<WAVE_SIN>(phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_TRI:
+            out = ComputeWaveform<WAVE_TRI>(phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_SAW:
+            out = ComputeWaveform<WAVE_SAW>(phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_RAMP:
+            out = ComputeWaveform<WAVE_RAMP>(
+                phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_SQUARE:
+            out = ComputeWaveform<WAVE_SQUARE>(
+                phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_POLYBLEP_TRI:
+            out = ComputeWaveform<WAVE_POLYBLEP_TRI>(
+                phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_POLYBLEP_SAW:
+            out = ComputeWaveform<WAVE_POLYBLEP_SAW>(
+                phase_, phase_inc_, pw_, last_out_);
+            break;
+        case WAVE_POLYBLEP_SQUARE:
+            out = ComputeWaveform<WAVE_POLYBLEP_SQUARE>(
+                phase_, phase_inc_, pw_, last_out_);
+            break;
+        default: out = 0.0f; break;
+    }
     phase_ += phase_inc_;
     if(phase_ > 1.0f)
     {
@@ -58,6 +110,126 @@ float Oscillator::Process()
     return out * amp_;
 }
 
+void Oscillator::ProcessBlock(float *out, size_t size)
+{
+    ProcessBlock(nullptr, nullptr, out, size);
+}
+
+void Oscillator::ProcessBlock(const float *freq, float *out, size_t size)
+{
+    ProcessBlock(freq, nullptr, out, size);
+}
+
+void Oscillator::ProcessBlock(const float *freq,
+                              const float *pm,
+                              float       *out,
+                              size_t       size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+    switch(waveform_)
+    {
+        case WAVE_SIN: ProcessBlockWaveform<WAVE_SIN>(freq, pm, out, size); break;
+        case WAVE_TRI: ProcessBlockWaveform<WAVE_TRI>(freq, pm, out, size); break;
+        case WAVE_SAW: ProcessBlockWaveform<WAVE_SAW>(freq, pm, out, size); break;
+        case WAVE_RAMP:
+            ProcessBlockWaveform<WAVE_RAMP>(freq, pm, out, size);
+            break;
+        case WAVE_SQUARE:
+            ProcessBlockWaveform<WAVE_SQUARE>(freq, pm, out, size);
+            break;
+        case WAVE_POLYBLEP_TRI:
+            ProcessBlockWaveform<WAVE_POLYBLEP_TRI>(freq, pm, out, size);
+            break;
+        case WAVE_POLYBLEP_SAW:
+            ProcessBlockWaveform<WAVE_POLYBLEP_SAW>(freq, pm, out, size);
+            break;
+        case WAVE_POLYBLEP_SQUARE:
+            ProcessBlockWaveform<WAVE_POLYBLEP_SQUARE>(freq, pm, out, size);
+            break;
+        default:
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = 0.0f;
+            }
+            break;
+    }
+}
+
+template <uint8_t waveform>
+void Oscillator::ProcessBlockWaveform(const float *freq,
+                                      const float *pm,
+                                      float       *out,
+                                      size_t       size)
+{
+    if(freq != nullptr && pm != nullptr)
+    {
+        ProcessBlockImpl<waveform, true, true>(freq, pm, out, size);
+    }
+    else if(freq != nullptr)
+    {
+        ProcessBlockImpl<waveform, true, false>(freq, pm, out, size);
+    }
+    else if(pm != nullptr)
+    {
+        ProcessBlockImpl<waveform, false, true>(freq, pm, out, size);
+    }
+    else
+    {
+        ProcessBlockImpl<waveform, false, false>(freq, pm, out, size);
+    }
+}
+
+template <uint8_t waveform, bool freq_mod, bool phase_mod>
+void Oscillator::ProcessBlockImpl(const float *freq,
+                                  const float *pm,
+                                  float       *out,
+                                  size_t       size)
+{
+    // Work on local copies so the state stays in registers,
+    // the output buffer can't alias them.
+    float       phase     = phase_;
+    float       phase_inc = phase_inc_;
+    float       last_out  = last_out_;
+    const float pw        = pw_;
+    const float amp       = amp_;
+    const float sr_recip  = sr_recip_;
+    bool        eoc       = eoc_;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        if(freq_mod)
+        {
+            phase_inc = freq[i] * sr_recip;
+        }
+        if(phase_mod)
+        {
+            phase += pm[i];
+        }
+        const float sig
+            = ComputeWaveform<waveform>(phase, phase_inc, pw, last_out);
+        phase += phase_inc;
+        eoc = phase > 1.0f;
+        if(eoc)
+        {
+            phase -= 1.0f;
+        }
+        out[i] = sig * amp;
+    }
+
+    if(freq_mod)
+    {
+        freq_      = freq[size - 1];
+        phase_inc_ = phase_inc;
+    }
+    phase_    = phase;
+    last_out_ = last_out;
+    eoc_      = eoc;
+    eor_      = (phase - phase_inc < 0.5f && phase >= 0.5f);
+}
+
 float Oscillator::CalcPhaseInc(float f)
 {
     return f * sr_recip_;
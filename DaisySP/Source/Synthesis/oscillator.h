@@ -10,6 +10,7 @@ https://opensource.org/licenses/MIT.
 #ifndef DSY_OSCILLATOR_H
 #define DSY_OSCILLATOR_H
 #include <stdint.h>
+#include <stddef.h>
 #include "Utility/dsp.h"
 #ifdef __cplusplus
 
@@ -56,6 +57,7 @@ class Oscillator
         pw_        = 0.5f;
         phase_     = 0.0f;
         phase_inc_ = CalcPhaseInc(freq_);
+        last_out_  = 0.0f;
         waveform_  = WAVE_SIN;
         eoc_       = true;
         eor_       = true;
@@ -104,6 +106,31 @@ class Oscillator
     */
     float Process();
 
+    /** Fills a block with the waveform being generated.
+        The waveform selection is resolved once per block rather than once per sample.
+        \param out - output buffer of at least size samples
+        \param size - number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fills a block with the waveform, using a per-sample frequency.
+        Equivalent to calling SetFreq() before each call to Process().
+        \param freq - frequency in Hz for each sample
+        \param out - output buffer of at least size samples
+        \param size - number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
+    /** Fills a block with the waveform, using per-sample frequency and phase modulation.
+        Equivalent to calling SetFreq() and PhaseAdd() before each call to Process().
+        Either input may be nullptr, and pm may point to the same buffer as out.
+        \param freq - frequency in Hz for each sample, or nullptr to use the current frequency
+        \param pm - phase offset (0.0-1.0) added before each sample, or nullptr for none
+        \param out - output buffer of at least size samples
+        \param size - number of samples to generate
+    */
+    void ProcessBlock(const float* freq, const float* pm, float* out, size_t size);
+
 
     /** Adds a value 0.0-1.0 (equivalent to 0.0-TWO_PI) to the current phase. Useful for PM and "FM" synthesis.
     */
@@ -113,7 +140,20 @@ class Oscillator
     void Reset(float _phase = 0.0f) { phase_ = _phase; }
 
   private:
-    float   CalcPhaseInc(float f);
+    float CalcPhaseInc(float f);
+
+    template <uint8_t waveform>
+    void ProcessBlockWaveform(const float* freq,
+                              const float* pm,
+                              float*       out,
+                              size_t       size);
+
+    template <uint8_t waveform, bool freq_mod, bool phase_mod>
+    void ProcessBlockImpl(const float* freq,
+                          const float* pm,
+                          float*       out,
+                          size_t       size);
+
     uint8_t waveform_;
     float   amp_, freq_, pw_;
     float   sr_, sr_recip_, phase_, phase_inc_;
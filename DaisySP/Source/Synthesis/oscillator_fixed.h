@@ -0,0 +1,331 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_OSCILLATOR_FIXED_H
+#define DSY_OSCILLATOR_FIXED_H
+#include <stdint.h>
+#include <stddef.h>
+#include "Utility/dsp.h"
+#include "Utility/fastmath.h"
+
+namespace daisysp
+{
+namespace fixed
+{
+    namespace oscillator_internal
+    {
+        static constexpr size_t kSinTableSize = 1024;
+
+        /** One full cycle of q31 sine, with a guard point at the end */
+        struct SinTable
+        {
+            int32_t data[kSinTableSize + 1];
+        };
+
+        constexpr SinTable MakeSinTable()
+        {
+            SinTable t{};
+            for(size_t i = 0; i <= kSinTableSize; i++)
+            {
+                const double s = fastmath_internal::ConstexprSin(
+                    static_cast<double>(i) / kSinTableSize * 2.0
+                    * 3.14159265358979323846);
+                const double q = s * 2147483648.0 + (s < 0 ? -0.5 : 0.5);
+                t.data[i]
+                    = q >= 2147483647.0 ? INT32_MAX : static_cast<int32_t>(q);
+            }
+            return t;
+        }
+
+        /** Holder for the table, so it's defined in this header once */
+        template <typename T = void>
+        struct Tables
+        {
+            static constexpr SinTable kSin = MakeSinTable();
+        };
+
+        template <typename T>
+        constexpr SinTable Tables<T>::kSin;
+    } // namespace oscillator_internal
+
+    /** Synthesis of several waveforms, including polyBLEP bandlimited
+        waveforms, as fixed point samples.
+
+        The same waveforms and API as daisysp::Oscillator, for q15 or q31
+        samples, e.g. fixed::Oscillator<q15>. The phase is a 32 bit integer
+        that wraps around once per cycle, and the sine is read from a table
+        with linear interpolation, about 100dB below full scale.
+        Only the setters use float math.
+    */
+    template <typename T>
+    class Oscillator
+    {
+      public:
+        Oscillator() {}
+        ~Oscillator() {}
+        /** Choices for output waveforms, POLYBLEP are appropriately labeled. Others are naive forms.
+        */
+        enum
+        {
+            WAVE_SIN,
+            WAVE_TRI,
+            WAVE_SAW,
+            WAVE_RAMP,
+            WAVE_SQUARE,
+            WAVE_POLYBLEP_TRI,
+            WAVE_POLYBLEP_SAW,
+            WAVE_POLYBLEP_SQUARE,
+            WAVE_LAST,
+        };
+
+        /** Initializes the Oscillator
+
+            \param sample_rate - sample rate of the audio engine being run, and the frequency that the Process function will be called.
+
+            Defaults:
+            - freq_ = 100 Hz
+            - amp_ = 0.5
+            - waveform_ = sine wave.
+        */
+        void Init(float sample_rate)
+        {
+            sr_recip_ = 1.0f / sample_rate;
+            amp_      = float_to_fixed<T>(0.5f);
+            pw_       = kHalfCycle;
+            phase_    = 0;
+            last_out_ = 0;
+            waveform_ = WAVE_SIN;
+            eoc_      = true;
+            eor_      = true;
+            SetFreq(100.0f);
+        }
+
+        /** Changes the frequency of the Oscillator, and recalculates phase increment.
+        */
+        inline void SetFreq(const float f)
+        {
+            phase_inc_ = ToPhase(f * sr_recip_);
+        }
+
+        /** Sets the amplitude of the waveform.
+        */
+        inline void SetAmp(const float a) { amp_ = float_to_fixed<T>(a); }
+
+        /** Sets the waveform to be synthesized by the Process() function.
+        */
+        inline void SetWaveform(const uint8_t wf)
+        {
+            waveform_ = wf < WAVE_LAST ? wf : WAVE_SIN;
+        }
+
+        /** Sets the pulse width for WAVE_SQUARE and WAVE_POLYBLEP_SQUARE (range 0 - 1)
+         */
+        inline void SetPw(const float pw)
+        {
+            const float p = fclamp(pw, 0.0f, 1.0f);
+            pw_           = p < 1.0f ? ToPhase(p) : UINT32_MAX;
+        }
+
+        /** Returns true if cycle is at end of rise. Set during call to Process.
+        */
+        inline bool IsEOR() { return eor_; }
+
+        /** Returns true if cycle is at end of cycle. Set during call to Process.
+        */
+        inline bool IsEOC() { return eoc_; }
+
+        /** Returns true if cycle rising.
+        */
+        inline bool IsRising() { return phase_ < kHalfCycle; }
+
+        /** Returns true if cycle falling.
+        */
+        inline bool IsFalling() { return phase_ >= kHalfCycle; }
+
+        /** Processes the waveform to be generated, returning one sample. This should be called once per sample period.
+        */
+        T Process()
+        {
+            T out;
+            ProcessBlock(&out, 1);
+            return out;
+        }
+
+        /** Fills a block with the waveform being generated.
+            The waveform selection is resolved once per block rather than once per sample.
+            \param out - output buffer of at least size samples
+            \param size - number of samples to generate
+        */
+        void ProcessBlock(T* out, size_t size)
+        {
+            switch(waveform_)
+            {
+                case WAVE_SIN: ProcessBlockImpl<WAVE_SIN>(out, size); break;
+                case WAVE_TRI: ProcessBlockImpl<WAVE_TRI>(out, size); break;
+                case WAVE_SAW: ProcessBlockImpl<WAVE_SAW>(out, size); break;
+                case WAVE_RAMP: ProcessBlockImpl<WAVE_RAMP>(out, size); break;
+                case WAVE_SQUARE:
+                    ProcessBlockImpl<WAVE_SQUARE>(out, size);
+                    break;
+                case WAVE_POLYBLEP_TRI:
+                    ProcessBlockImpl<WAVE_POLYBLEP_TRI>(out, size);
+                    break;
+                case WAVE_POLYBLEP_SAW:
+                    ProcessBlockImpl<WAVE_POLYBLEP_SAW>(out, size);
+                    break;
+                case WAVE_POLYBLEP_SQUARE:
+                    ProcessBlockImpl<WAVE_POLYBLEP_SQUARE>(out, size);
+                    break;
+                default:
+                    for(size_t i = 0; i < size; i++)
+                    {
+                        out[i] = 0;
+                    }
+                    break;
+            }
+        }
+
+        /** Adds a value 0.0-1.0 (equivalent to 0.0-TWO_PI) to the current phase. Useful for PM and "FM" synthesis.
+        */
+        void PhaseAdd(float _phase) { phase_ += ToPhase(_phase); }
+
+        /** Resets the phase to the input argument. If no argumeNt is present, it will reset phase to 0.0;
+        */
+        void Reset(float _phase = 0.0f) { phase_ = ToPhase(_phase); }
+
+      private:
+        typedef typename fixed_traits<T>::acc acc;
+        static constexpr int      kFracBits  = fixed_traits<T>::kFracBits;
+        static constexpr uint32_t kHalfCycle = 0x80000000u;
+
+        /** Cycles to a phase, wrapping like the phase itself does */
+        static inline uint32_t ToPhase(float cycles)
+        {
+            return static_cast<uint32_t>(
+                static_cast<int64_t>(cycles * 4294967296.0f));
+        }
+
+        /** PolyBLEP residual as q31, for a phase and increment of a cycle */
+        static inline int64_t Polyblep(uint32_t phase_inc, uint32_t t)
+        {
+            const int64_t one = int64_t(1) << 31;
+            if(t < phase_inc)
+            {
+                // t / dt, from 0 to 1
+                const int64_t x = static_cast<int64_t>(t) * one / phase_inc;
+                return x + x - ((x * x) >> 31) - one;
+            }
+            else if(t > UINT32_MAX - phase_inc)
+            {
+                // (t - 1) / dt, from -1 to 0
+                const int64_t x
+                    = (static_cast<int64_t>(t) - (int64_t(1) << 32)) * one
+                      / phase_inc;
+                return ((x * x) >> 31) + x + x + one;
+            }
+            return 0;
+        }
+
+        /** Computes a sample of the waveform as q31, clamped to full scale */
+        template <uint8_t waveform>
+        inline int32_t ComputeWaveform(uint32_t phase, int32_t& last_out) const
+        {
+            using namespace oscillator_internal;
+            const int64_t one = int64_t(1) << 31;
+            // 2 * phase - 1, as q31
+            const int32_t ramp = static_cast<int32_t>(phase ^ kHalfCycle);
+            int64_t       out;
+            switch(waveform)
+            {
+                case WAVE_SIN:
+                {
+                    // 10 bits of index, then 16 bits of fraction
+                    const int32_t* p    = Tables<>::kSin.data + (phase >> 22);
+                    const int64_t  frac = (phase >> 6) & 0xffff;
+                    out = p[0] + (((int64_t(p[1]) - p[0]) * frac) >> 16);
+                    break;
+                }
+                case WAVE_TRI:
+                {
+                    const int64_t mag = ramp < 0 ? -int64_t(ramp) : ramp;
+                    out               = 2 * mag - one;
+                    break;
+                }
+                case WAVE_SAW: out = -int64_t(ramp); break;
+                case WAVE_RAMP: out = ramp; break;
+                case WAVE_SQUARE: out = phase < pw_ ? one : -one; break;
+                case WAVE_POLYBLEP_TRI:
+                {
+                    out = phase < kHalfCycle ? one : -one;
+                    out += Polyblep(phase_inc_, phase);
+                    out -= Polyblep(phase_inc_, phase + kHalfCycle);
+                    out = fixed_sat<q31>(out);
+                    // Leaky Integrator:
+                    // y[n] = A + x[n] + (1 - A) * y[n-1]
+                    const int64_t dt = phase_inc_ >> 1;
+                    last_out         = static_cast<int32_t>(
+                        (dt * out + (one - dt) * last_out) >> 31);
+                    // normalize amplitude after leaky integration
+                    out = int64_t(last_out) * 4;
+                    break;
+                }
+                case WAVE_POLYBLEP_SAW:
+                    out = Polyblep(phase_inc_, phase) - ramp;
+                    break;
+                case WAVE_POLYBLEP_SQUARE:
+                {
+                    out = phase < pw_ ? one : -one;
+                    out += Polyblep(phase_inc_, phase);
+                    out -= Polyblep(phase_inc_, phase - pw_);
+                    out = (out * 1518270939) >> 31; // 0.707
+                    break;
+                }
+                default: out = 0; break;
+            }
+            return fixed_sat<q31>(out);
+        }
+
+        template <uint8_t waveform>
+        void ProcessBlockImpl(T* out, size_t size)
+        {
+            // Work on local copies so the state stays in registers,
+            // the output buffer can't alias them.
+            uint32_t       phase     = phase_;
+            const uint32_t phase_inc = phase_inc_;
+            int32_t        last_out  = last_out_;
+            const acc      amp       = amp_;
+            bool           eoc       = eoc_;
+
+            for(size_t i = 0; i < size; i++)
+            {
+                const int32_t sig = ComputeWaveform<waveform>(phase, last_out);
+                const acc     s   = sig >> (31 - kFracBits);
+                out[i] = static_cast<T>(fixed_round_shift(s * amp, kFracBits));
+
+                const uint32_t next = phase + phase_inc;
+                eoc                 = next < phase;
+                phase               = next;
+            }
+
+            eor_      = phase - phase_inc < kHalfCycle && phase >= kHalfCycle;
+            phase_    = phase;
+            last_out_ = last_out;
+            eoc_      = eoc;
+        }
+
+        uint8_t  waveform_;
+        T        amp_;
+        float    sr_recip_;
+        uint32_t phase_, phase_inc_, pw_;
+        int32_t  last_out_;
+        bool     eor_, eoc_;
+    };
+} // namespace fixed
+} // namespace daisysp
+#endif
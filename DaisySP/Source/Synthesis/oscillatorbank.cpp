@@ -111,6 +111,23 @@ float OscillatorBank::Process()
     return 2.0f * this_sample_;
 }
 
+void OscillatorBank::ProcessBlock(float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = Process();
+    }
+}
+
+void OscillatorBank::ProcessBlock(const float* freq, float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFreq(freq[i]);
+        out[i] = Process();
+    }
+}
+
 void OscillatorBank::SetFreq(float freq)
 {
     freq       = freq / sample_rate_;
@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_OSCILLATORBANK_H
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 
 /** @file oscillatorbank.h */
@@ -42,6 +43,20 @@ class OscillatorBank
     */
     float Process();
 
+    /** Fill a block with samples.
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fill a block with samples, using a per-sample frequency.
+        Equivalent to calling SetFreq() before each call to Process().
+        \param freq Frequency in Hz for each sample
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
     /** Set oscillator frequency (8' oscillator)
         \param freq Frequency in Hz
     */
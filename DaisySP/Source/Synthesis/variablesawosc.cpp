@@ -20,16 +20,50 @@ void VariableSawOscillator::Init(float sample_rate)
 
 float VariableSawOscillator::Process()
 {
-    float next_sample = next_sample_;
+    const float triangle_amount = waveshape_;
+    const float notch_amount    = 1.0f - waveshape_;
+    const float slope_up        = 1.0f / (pw_);
+    const float slope_down      = 1.0f / (1.0f - pw_);
 
-    float this_sample = next_sample;
-    next_sample       = 0.0f;
+    return ProcessSample(slope_up, slope_down, triangle_amount, notch_amount);
+}
 
+void VariableSawOscillator::ProcessBlock(float* out, size_t size)
+{
     const float triangle_amount = waveshape_;
     const float notch_amount    = 1.0f - waveshape_;
     const float slope_up        = 1.0f / (pw_);
     const float slope_down      = 1.0f / (1.0f - pw_);
 
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i]
+            = ProcessSample(slope_up, slope_down, triangle_amount, notch_amount);
+    }
+}
+
+void VariableSawOscillator::ProcessBlock(const float* freq,
+                                         float*       out,
+                                         size_t       size)
+{
+    // SetFreq() can change the pw, so the slopes are recomputed per sample.
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFreq(freq[i]);
+        out[i] = Process();
+    }
+}
+
+inline float VariableSawOscillator::ProcessSample(float slope_up,
+                                                  float slope_down,
+                                                  float triangle_amount,
+                                                  float notch_amount)
+{
+    float next_sample = next_sample_;
+
+    float this_sample = next_sample;
+    next_sample       = 0.0f;
+
     phase_ += frequency_;
 
     if(!high_ && phase_ >= pw_)
@@ -22,6 +22,51 @@ void VariableShapeOscillator::Init(float sample_rate)
 }
 
 float VariableShapeOscillator::Process()
+{
+    const float square_amount   = fmax(waveshape_ - 0.5f, 0.0f) * 2.0f;
+    const float triangle_amount = fmax(1.0f - waveshape_ * 2.0f, 0.0f);
+    const float slope_up        = 1.0f / (pw_);
+    const float slope_down      = 1.0f / (1.0f - pw_);
+
+    return ProcessSample(slope_up, slope_down, triangle_amount, square_amount);
+}
+
+void VariableShapeOscillator::ProcessBlock(float* out, size_t size)
+{
+    const float square_amount   = fmax(waveshape_ - 0.5f, 0.0f) * 2.0f;
+    const float triangle_amount = fmax(1.0f - waveshape_ * 2.0f, 0.0f);
+    const float slope_up        = 1.0f / (pw_);
+    const float slope_down      = 1.0f / (1.0f - pw_);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = ProcessSample(
+            slope_up, slope_down, triangle_amount, square_amount);
+    }
+}
+
+void VariableShapeOscillator::ProcessBlock(const float* freq,
+                                           float*       out,
+                                           size_t       size)
+{
+    // The master freq. doesn't affect the shape terms, so they can still be hoisted.
+    const float square_amount   = fmax(waveshape_ - 0.5f, 0.0f) * 2.0f;
+    const float triangle_amount = fmax(1.0f - waveshape_ * 2.0f, 0.0f);
+    const float slope_up        = 1.0f / (pw_);
+    const float slope_down      = 1.0f / (1.0f - pw_);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFreq(freq[i]);
+        out[i] = ProcessSample(
+            slope_up, slope_down, triangle_amount, square_amount);
+    }
+}
+
+inline float VariableShapeOscillator::ProcessSample(float slope_up,
+                                                    float slope_down,
+                                                    float triangle_amount,
+                                                    float square_amount)
 {
     float next_sample = next_sample_;
 
@@ -32,11 +77,6 @@ float VariableShapeOscillator::Process()
     float this_sample = next_sample;
     next_sample       = 0.0f;
 
-    const float square_amount   = fmax(waveshape_ - 0.5f, 0.0f) * 2.0f;
-    const float triangle_amount = fmax(1.0f - waveshape_ * 2.0f, 0.0f);
-    const float slope_up        = 1.0f / (pw_);
-    const float slope_down      = 1.0f / (1.0f - pw_);
-
     if(enable_sync_)
     {
         master_phase_ += master_frequency_;
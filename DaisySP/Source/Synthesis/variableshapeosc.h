@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_VARIABLESHAPEOSCILLATOR_H
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 
 /** @file variableshapeosc.h */
@@ -41,6 +42,20 @@ class VariableShapeOscillator
     */
     float Process();
 
+    /** Fill a block with samples. Shape dependent terms are computed once per block.
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fill a block with samples, using a per-sample master freq.
+        Equivalent to calling SetFreq() before each call to Process().
+        \param freq Master freq in Hz for each sample
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
     /** Set master freq.
         \param frequency Freq in Hz.
     */
@@ -67,6 +82,11 @@ class VariableShapeOscillator
     void SetSyncFreq(float frequency);
 
   private:
+    inline float ProcessSample(float slope_up,
+                               float slope_down,
+                               float triangle_amount,
+                               float square_amount);
+
     float ComputeNaiveSample(float phase,
                              float pw,
                              float slope_up,
@@ -1,4 +1,5 @@
 #include "dsp.h"
+#include "fastmath.h"
 #include "vosim.h"
 #include <math.h>
 
@@ -19,6 +20,35 @@ void VosimOscillator::Init(float sample_rate)
 }
 
 float VosimOscillator::Process()
+{
+    float reset_phase     = 0.75f - 0.25f * carrier_shape_;
+    float reset_amplitude = Sine(reset_phase);
+    return ProcessSample(reset_phase, reset_amplitude);
+}
+
+void VosimOscillator::ProcessBlock(float* out, size_t size)
+{
+    const float reset_phase     = 0.75f - 0.25f * carrier_shape_;
+    const float reset_amplitude = Sine(reset_phase);
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = ProcessSample(reset_phase, reset_amplitude);
+    }
+}
+
+void VosimOscillator::ProcessBlock(const float* freq, float* out, size_t size)
+{
+    const float reset_phase     = 0.75f - 0.25f * carrier_shape_;
+    const float reset_amplitude = Sine(reset_phase);
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFreq(freq[i]);
+        out[i] = ProcessSample(reset_phase, reset_amplitude);
+    }
+}
+
+inline float VosimOscillator::ProcessSample(float reset_phase,
+                                            float reset_amplitude)
 {
     carrier_phase_ += carrier_frequency_;
     if(carrier_phase_ >= 1.0f)
@@ -42,9 +72,7 @@ float VosimOscillator::Process()
         }
     }
 
-    float carrier         = Sine(carrier_phase_ * 0.5f + 0.25f) + 1.0f;
-    float reset_phase     = 0.75f - 0.25f * carrier_shape_;
-    float reset_amplitude = Sine(reset_phase);
+    float carrier = Sine(carrier_phase_ * 0.5f + 0.25f) + 1.0f;
     float formant_0 = Sine(formant_1_phase_ + reset_phase) - reset_amplitude;
     float formant_1 = Sine(formant_2_phase_ + reset_phase) - reset_amplitude;
     return carrier * (formant_0 + formant_1) * 0.25f + reset_amplitude;
@@ -77,5 +105,9 @@ void VosimOscillator::SetShape(float shape)
 
 float VosimOscillator::Sine(float phase)
 {
+#ifdef DSY_FAST_MATH
+    return sin_lut(phase);
+#else
     return sinf(TWOPI_F * phase);
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ https://opensource.org/licenses/MIT.
 #define DSY_VOSIM_H
 
 #include <stdint.h>
+#include <stddef.h>
 #ifdef __cplusplus
 
 /** @file vosim.h */
@@ -41,6 +42,20 @@ class VosimOscillator
     */
     float Process();
 
+    /** Fill a block with samples. The shape dependent terms are computed once per block.
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size);
+
+    /** Fill a block with samples, using a per-sample carrier frequency.
+        Equivalent to calling SetFreq() before each call to Process().
+        \param freq Carrier frequency in Hz for each sample
+        \param out Output buffer of at least size samples
+        \param size Number of samples to generate
+    */
+    void ProcessBlock(const float* freq, float* out, size_t size);
+
     /** Set carrier frequency.
         \param freq Frequency in Hz.
     */
@@ -62,6 +77,8 @@ class VosimOscillator
     void SetShape(float shape);
 
   private:
+    inline float ProcessSample(float reset_phase, float reset_amplitude);
+
     float Sine(float phase);
 
     float sample_rate_;
@@ -0,0 +1,396 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_WAVETABLEOSC_H
+#define DSY_WAVETABLEOSC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "Utility/fft.h"
+
+/** @file wavetableosc.h */
+namespace daisysp
+{
+namespace wavetable_internal
+{
+    constexpr size_t Log2(size_t x) { return x > 1 ? 1 + Log2(x >> 1) : 0; }
+} // namespace wavetable_internal
+
+/** A set of single cycle waveforms, band-limited once per octave.
+
+    Build() takes num_tables cycles of table_size samples each, laid out one
+    after the other. That's the layout of the buffer filled by libDaisy's
+    WaveTableLoader, so with the loader set up for table_size samples:
+
+    bank.Build(loader.GetTable(0), num_tables);
+
+    Each table is transformed with an FFT, and stored again for every octave
+    with the harmonics that would alias there removed. Level 0 keeps up to
+    table_size / 2 - 1 harmonics, and each following level half as many,
+    down to the fundamental alone. DC is removed from every level.
+
+    The mipmaps take GetMemorySize(num_tables) floats, provided by the caller
+    so they can be placed in SDRAM. The source tables are only read during
+    Build(), so their buffer can be reused afterwards.
+
+    Several WavetableOscillators can play from the same bank.
+*/
+template <size_t table_size>
+class WavetableBank
+{
+  public:
+    static_assert(table_size >= 4 && (table_size & (table_size - 1)) == 0,
+                  "WavetableBank table_size must be a power of two");
+
+    /** Number of mipmap levels, one per octave down to a single harmonic */
+    static constexpr size_t kNumLevels
+        = wavetable_internal::Log2(table_size / 2);
+
+    /** Floats stored per table and level, one guard point before the cycle
+        and two after it, so interpolation never wraps the index.
+    */
+    static constexpr size_t kStride = table_size + 3;
+
+    WavetableBank() {}
+    ~WavetableBank() {}
+
+    /** Floats of memory needed for num_tables tables */
+    static constexpr size_t GetMemorySize(size_t num_tables)
+    {
+        return num_tables * kNumLevels * kStride;
+    }
+
+    /** Initializes the bank with the memory for its mipmaps.
+        \param mem buffer of mem_size floats, e.g. in SDRAM
+        \param mem_size number of floats in mem
+    */
+    void Init(float* mem, size_t mem_size)
+    {
+        mem_        = mem;
+        mem_size_   = mem_size;
+        num_tables_ = 0;
+        fft_.Init();
+    }
+
+    /** Band-limits the tables and stores their mipmaps.
+        This takes several FFTs per table, so it belongs outside of the
+        audio callback.
+        \param tables num_tables cycles of table_size samples each
+        \param num_tables number of tables, at least 1
+        \return false if the memory passed to Init() is too small
+    */
+    bool Build(const float* tables, size_t num_tables)
+    {
+        if(mem_ == nullptr || num_tables == 0
+           || GetMemorySize(num_tables) > mem_size_)
+        {
+            num_tables_ = 0;
+            return false;
+        }
+        num_tables_ = num_tables;
+
+        const float scale = 1.0f / table_size;
+        for(size_t t = 0; t < num_tables; t++)
+        {
+            fft_.Forward(tables + t * table_size, spectrum_);
+            // DC would only offset the output, and the Nyquist bin can't be
+            // played back at every phase.
+            spectrum_[0] = 0.0f;
+            spectrum_[1] = 0.0f;
+
+            size_t harmonics = table_size / 2;
+            for(size_t level = 0; level < kNumLevels; level++)
+            {
+                // Each level drops the top half of the remaining harmonics.
+                const size_t keep = table_size >> (level + 1);
+                for(size_t k = keep; k < harmonics; k++)
+                {
+                    spectrum_[2 * k]     = 0.0f;
+                    spectrum_[2 * k + 1] = 0.0f;
+                }
+                harmonics = keep;
+
+                float* dst = Table(t, level);
+                fft_.Inverse(spectrum_, dst);
+                for(size_t i = 0; i < table_size; i++)
+                {
+                    dst[i] *= scale;
+                }
+                dst[-1]             = dst[table_size - 1];
+                dst[table_size]     = dst[0];
+                dst[table_size + 1] = dst[1];
+            }
+        }
+        return true;
+    }
+
+    /** \return number of tables stored by the last successful Build() */
+    inline size_t GetNumTables() const { return num_tables_; }
+
+    /** \return the table_size samples of a table at a mipmap level.
+        One sample before and two after the cycle can be read too.
+    */
+    inline const float* GetTable(size_t table, size_t level) const
+    {
+        return mem_ + (level * num_tables_ + table) * kStride + 1;
+    }
+
+  private:
+    // Tables at the same level are next to each other, since they're read
+    // together when morphing.
+    inline float* Table(size_t table, size_t level)
+    {
+        return mem_ + (level * num_tables_ + table) * kStride + 1;
+    }
+
+    RealFft<table_size> fft_;
+    float               spectrum_[table_size];
+    float*              mem_;
+    size_t              mem_size_;
+    size_t              num_tables_;
+};
+
+template <size_t table_size>
+constexpr size_t WavetableBank<table_size>::kNumLevels;
+
+template <size_t table_size>
+constexpr size_t WavetableBank<table_size>::kStride;
+
+/** Band-limited wavetable oscillator.
+
+    Plays the tables of a WavetableBank, morphing between adjacent tables.
+    The mipmap level is picked in SetFreq() so that no harmonic reaches
+    Nyquist, which makes the output alias free up to the last level.
+    Samples are read with linear or cubic (Hermite) interpolation.
+
+    WavetableBank<2048> bank;
+    WavetableOscillator<2048> osc;
+
+    bank.Init(sdram_buffer, WavetableBank<2048>::GetMemorySize(num_tables));
+    bank.Build(loader.GetTable(0), num_tables);
+    osc.Init(sample_rate, &bank);
+*/
+template <size_t table_size>
+class WavetableOscillator
+{
+  public:
+    WavetableOscillator() {}
+    ~WavetableOscillator() {}
+
+    /** Interpolation between the samples of a table */
+    enum Interpolation
+    {
+        INTERPOLATION_LINEAR,
+        INTERPOLATION_CUBIC,
+    };
+
+    /** Initializes the oscillator.
+        \param sample_rate audio engine sample rate
+        \param bank tables to play, built before the first call to Process()
+
+        Defaults:
+        - freq = 100 Hz
+        - amp = 0.5
+        - morph = 0, the first table
+        - linear interpolation
+    */
+    void Init(float sample_rate, const WavetableBank<table_size>* bank)
+    {
+        sr_recip_      = 1.0f / sample_rate;
+        bank_          = bank;
+        phase_         = 0;
+        amp_           = 0.5f;
+        morph_         = 0.0f;
+        last_morph_    = 0.0f;
+        interpolation_ = INTERPOLATION_LINEAR;
+        SetFreq(100.0f);
+    }
+
+    /** Sets the frequency and picks the mipmap level for it.
+        \param freq frequency in Hz, negative values play backwards
+    */
+    inline void SetFreq(float freq)
+    {
+        const float cycles = freq * sr_recip_;
+        phase_inc_         = ToPhase(cycles);
+
+        // The lowest level whose top harmonic, table_size / 2^(k + 1) - 1,
+        // stays below Nyquist.
+        const float inc   = fabsf(cycles);
+        size_t      level = 0;
+        while(level + 1 < kNumLevels
+              && ((table_size >> (level + 1)) - 1) * inc >= 0.5f)
+        {
+            level++;
+        }
+        level_ = level;
+    }
+
+    /** Sets the amplitude of the output.
+    */
+    inline void SetAmp(float amp) { amp_ = amp; }
+
+    /** Sets the position between the tables of the bank.
+        Block processing glides to the new position over the next block.
+        \param morph 0 to 1, from the first to the last table
+    */
+    inline void SetMorph(float morph)
+    {
+        morph_ = morph < 0.0f ? 0.0f : (morph > 1.0f ? 1.0f : morph);
+    }
+
+    /** Sets the interpolation between samples. Cubic costs more, but keeps
+        smaller tables clean at low frequencies.
+    */
+    inline void SetInterpolation(Interpolation interpolation)
+    {
+        interpolation_ = interpolation;
+    }
+
+    /** Resets the phase, from 0 to 1.
+    */
+    inline void Reset(float phase = 0.0f)
+    {
+        phase_ = ToPhase(phase - floorf(phase));
+    }
+
+    /** Processes one sample.
+    */
+    float Process()
+    {
+        float out;
+        ProcessBlock(&out, 1);
+        return out;
+    }
+
+    /** Fills a block with samples. The mipmap level and interpolation are
+        resolved once per block.
+        \param out output buffer of at least size samples
+        \param size number of samples to generate
+    */
+    void ProcessBlock(float* out, size_t size)
+    {
+        if(bank_ == nullptr || bank_->GetNumTables() == 0)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = 0.0f;
+            }
+            return;
+        }
+        if(interpolation_ == INTERPOLATION_CUBIC)
+        {
+            ProcessBlockImpl<true>(out, size);
+        }
+        else
+        {
+            ProcessBlockImpl<false>(out, size);
+        }
+    }
+
+  private:
+    static constexpr size_t kNumLevels = WavetableBank<table_size>::kNumLevels;
+
+    // The phase is a 32 bit integer that wraps around once per cycle,
+    // its top bits index the table and the rest are the fraction.
+    static constexpr int kFracBits
+        = 32 - static_cast<int>(wavetable_internal::Log2(table_size));
+    static constexpr uint32_t kFracMask
+        = (static_cast<uint32_t>(1) << kFracBits) - 1;
+
+    static inline uint32_t ToPhase(float cycles)
+    {
+        return static_cast<uint32_t>(
+            static_cast<int64_t>(cycles * 4294967296.0f));
+    }
+
+    template <bool cubic>
+    static inline float Read(const float* table, uint32_t index, float frac)
+    {
+        const float* p = table + index;
+        if(cubic)
+        {
+            const float xm1 = p[-1];
+            const float x0  = p[0];
+            const float x1  = p[1];
+            const float x2  = p[2];
+            const float c   = (x1 - xm1) * 0.5f;
+            const float v   = x0 - x1;
+            const float w   = c + v;
+            const float a   = w + v + (x2 - x0) * 0.5f;
+            const float b   = w + a;
+            return (((a * frac) - b) * frac + c) * frac + x0;
+        }
+        return p[0] + (p[1] - p[0]) * frac;
+    }
+
+    template <bool cubic>
+    void ProcessBlockImpl(float* out, size_t size)
+    {
+        const size_t   num_tables = bank_->GetNumTables();
+        const float    last_table = static_cast<float>(num_tables - 1);
+        // morph = 1 lands on the last table, still read as part of this pair
+        const size_t   last_pair  = num_tables > 1 ? num_tables - 2 : 0;
+        const float    frac_scale = 1.0f / (kFracMask + 1.0f);
+        const uint32_t phase_inc  = phase_inc_;
+        const float    amp        = amp_;
+        const float    pos_inc    = (morph_ - last_morph_) * last_table / size;
+        float          pos        = last_morph_ * last_table;
+        uint32_t       phase      = phase_;
+
+        // The block is split where the morph crosses a table, so the pair of
+        // tables is only looked up once per segment.
+        while(size > 0)
+        {
+            size_t t        = static_cast<size_t>(pos);
+            t               = t < last_pair ? t : last_pair;
+            const size_t t1 = t + 1 < num_tables ? t + 1 : t;
+
+            size_t n = size;
+            if(pos_inc != 0.0f)
+            {
+                const float room
+                    = (pos_inc > 0.0f ? t + 1 - pos : pos - t) / fabsf(pos_inc);
+                n = room < n ? static_cast<size_t>(room) + 1 : n;
+            }
+
+            const float* a  = bank_->GetTable(t, level_);
+            const float* b  = bank_->GetTable(t1, level_);
+            float        mf = pos - t;
+            for(size_t i = 0; i < n; i++)
+            {
+                const uint32_t idx  = phase >> kFracBits;
+                const float    frac = static_cast<float>(
+                                       static_cast<int32_t>(phase & kFracMask))
+                                   * frac_scale;
+                const float sa = Read<cubic>(a, idx, frac);
+                const float sb = Read<cubic>(b, idx, frac);
+                out[i]         = (sa + (sb - sa) * mf) * amp;
+                phase += phase_inc;
+                mf += pos_inc;
+            }
+            pos += pos_inc * n;
+            out += n;
+            size -= n;
+        }
+
+        phase_      = phase;
+        last_morph_ = morph_;
+    }
+
+    const WavetableBank<table_size>* bank_;
+    Interpolation                    interpolation_;
+    float                            sr_recip_, amp_, morph_, last_morph_;
+    uint32_t                         phase_, phase_inc_;
+    size_t                           level_;
+};
+
+} // namespace daisysp
+#endif
@@ -1,4 +1,5 @@
 #include "dsp.h"
+#include "fastmath.h"
 #include "zoscillator.h"
 #include <math.h>
 
@@ -89,9 +90,30 @@ float ZOscillator::Process()
     return this_sample;
 }
 
+void ZOscillator::ProcessBlock(float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = Process();
+    }
+}
+
+void ZOscillator::ProcessBlock(const float* freq, float* out, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        SetFreq(freq[i]);
+        out[i] = Process();
+    }
+}
+
 inline float ZOscillator::Sine(float phase)
 {
+#ifdef DSY_FAST_MATH
+    return sin_lut(phase);
+#else
     return sinf(phase * TWOPI_F);
+#endif
 }
 
 void ZOscillator::SetFreq(float freq)
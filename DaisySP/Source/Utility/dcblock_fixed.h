@@ -0,0 +1,58 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_DCBLOCK_FIXED_H
+#define DSY_DCBLOCK_FIXED_H
+
+#include "Utility/dsp.h"
+
+namespace daisysp
+{
+namespace fixed
+{
+    /** Removes DC component of a signal, on fixed point samples.
+        The same filter and API as daisysp::DcBlock, e.g. fixed::DcBlock<q15>.
+    */
+    template <typename T>
+    class DcBlock
+    {
+      public:
+        DcBlock() {}
+        ~DcBlock() {}
+
+        /** Initializes DcBlock module
+        */
+        void Init(float sample_rate)
+        {
+            output_ = 0;
+            input_  = 0;
+            gain_   = float_to_fixed<T>(0.99f);
+        }
+
+        /** performs DcBlock Process
+        */
+        T Process(T in)
+        {
+            const acc feedback = static_cast<acc>(gain_) * output_;
+            output_            = fixed_sat<T>(static_cast<acc>(in) - input_
+                                   + fixed_round_shift(feedback, kFracBits));
+            input_             = in;
+            return output_;
+        }
+
+      private:
+        typedef typename fixed_traits<T>::acc acc;
+        static constexpr int kFracBits = fixed_traits<T>::kFracBits;
+
+        T input_, output_, gain_;
+    };
+} // namespace fixed
+} // namespace daisysp
+
+#endif
@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_DELAY_FIXED_H
+#define DSY_DELAY_FIXED_H
+#include <stdlib.h>
+#include <stdint.h>
+#include "Utility/dsp.h"
+
+namespace daisysp
+{
+namespace fixed
+{
+    /** Simple Delay line on fixed point samples.
+
+        The same API as daisysp::DelayLine, for q15 or q31 samples:
+
+        fixed::DelayLine<q31, SAMPLE_RATE> del;
+
+        Delay times are still given as floats, but the interpolation and
+        the allpass only use integer math.
+    */
+    template <typename T, size_t max_size>
+    class DelayLine
+    {
+      public:
+        DelayLine() {}
+        ~DelayLine() {}
+        /** initializes the delay line by clearing the values within, and setting delay to 1 sample.
+        */
+        void Init() { Reset(); }
+        /** clears buffer, sets write ptr to 0, and delay to 1 sample.
+        */
+        void Reset()
+        {
+            for(size_t i = 0; i < max_size; i++)
+            {
+                line_[i] = 0;
+            }
+            write_ptr_ = 0;
+            delay_     = 1;
+            frac_      = 0;
+        }
+
+        /** sets the delay time in samples
+        */
+        inline void SetDelay(size_t delay)
+        {
+            frac_  = 0;
+            delay_ = delay < max_size ? delay : max_size - 1;
+        }
+
+        /** sets the delay time in samples
+            The fractional part is used to interpolate the delay line.
+        */
+        inline void SetDelay(float delay)
+        {
+            int32_t     int_delay = static_cast<int32_t>(delay);
+            const float frac      = delay - static_cast<float>(int_delay);
+            frac_                 = float_to_fixed<T>(frac);
+            delay_ = static_cast<size_t>(int_delay) < max_size ? int_delay
+                                                               : max_size - 1;
+        }
+
+        /** writes the sample of type T to the delay line, and advances the write ptr
+        */
+        inline void Write(const T sample)
+        {
+            line_[write_ptr_] = sample;
+            write_ptr_        = (write_ptr_ - 1 + max_size) % max_size;
+        }
+
+        /** returns the next sample of type T in the delay line, interpolated if necessary.
+        */
+        inline const T Read() const
+        {
+            const T a = line_[(write_ptr_ + delay_) % max_size];
+            const T b = line_[(write_ptr_ + delay_ + 1) % max_size];
+            return Lerp(a, b, frac_);
+        }
+
+        /** Read from a set location */
+        inline const T Read(float delay) const
+        {
+            int32_t delay_integral = static_cast<int32_t>(delay);
+            const T delay_fractional
+                = float_to_fixed<T>(delay - static_cast<float>(delay_integral));
+            const T a = line_[(write_ptr_ + delay_integral) % max_size];
+            const T b = line_[(write_ptr_ + delay_integral + 1) % max_size];
+            return Lerp(a, b, delay_fractional);
+        }
+
+        inline const T ReadHermite(float delay) const
+        {
+            int32_t delay_integral = static_cast<int32_t>(delay);
+            float   delay_frac     = delay - static_cast<float>(delay_integral);
+
+            // The terms reach 16 times full scale, so the fraction only has
+            // 27 bits, which keeps every product within 64 bits.
+            const float   scale = static_cast<float>(1 << kHermiteFracBits);
+            const int64_t f     = static_cast<int64_t>(delay_frac * scale);
+
+            int32_t       t     = (write_ptr_ + delay_integral + max_size);
+            const int64_t xm1   = line_[(t - 1) % max_size];
+            const int64_t x0    = line_[(t) % max_size];
+            const int64_t x1    = line_[(t + 1) % max_size];
+            const int64_t x2    = line_[(t + 2) % max_size];
+            const int64_t c     = (x1 - xm1) >> 1;
+            const int64_t v     = x0 - x1;
+            const int64_t w     = c + v;
+            const int64_t a     = w + v + ((x2 - x0) >> 1);
+            const int64_t b_neg = w + a;
+
+            int64_t out = Mul(a, f) - b_neg;
+            out         = Mul(out, f) + c;
+            out         = Mul(out, f) + x0;
+            return fixed_sat<T>(fixed_sat<q31>(out));
+        }
+
+        inline const T
+        Allpass(const T sample, size_t delay, const T coefficient)
+        {
+            T read  = line_[(write_ptr_ + delay) % max_size];
+            T write = fixed_add(sample, fixed_mul(coefficient, read));
+            Write(write);
+            return fixed_sub(read, fixed_mul(write, coefficient));
+        }
+
+      private:
+        typedef typename fixed_traits<T>::acc acc;
+        static constexpr int kFracBits        = fixed_traits<T>::kFracBits;
+        static constexpr int kHermiteFracBits = 27;
+
+        /** a + (b - a) * frac, where b - a doesn't fit T but fits acc */
+        static inline T Lerp(T a, T b, T frac)
+        {
+            const acc diff = static_cast<acc>(b) - a;
+            return static_cast<T>(
+                a + fixed_round_shift(diff * frac, kFracBits));
+        }
+
+        static inline int64_t Mul(int64_t x, int64_t f)
+        {
+            return fixed_round_shift(x * f, kHermiteFracBits);
+        }
+
+        T      frac_;
+        size_t write_ptr_;
+        size_t delay_;
+        T      line_[max_size];
+    };
+} // namespace fixed
+} // namespace daisysp
+#endif
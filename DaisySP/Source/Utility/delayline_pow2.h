@@ -0,0 +1,217 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_DELAY_POW2_H
+#define DSY_DELAY_POW2_H
+#include <stdlib.h>
+#include <stdint.h>
+namespace daisysp
+{
+/** Smallest power of two greater than or equal to n */
+constexpr size_t DelayLineNextPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while(p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
+
+/** Delay line with a power-of-two capacity.
+
+Same interface as DelayLine, but the capacity is rounded up to the
+next power of two so that every index wraps with a bitmask
+instead of an integer division. Also offers block and multi-tap reads.
+
+declaration example: (1 second of floats, 65536 samples allocated)
+
+DelayLinePow2<float, SAMPLE_RATE> del;
+
+*/
+template <typename T, size_t max_size>
+class DelayLinePow2
+{
+  public:
+    /** Number of samples actually allocated, max_size rounded up to a power of two */
+    static constexpr size_t kCapacity = DelayLineNextPowerOfTwo(max_size);
+
+    DelayLinePow2() {}
+    ~DelayLinePow2() {}
+    /** initializes the delay line by clearing the values within, and setting delay to 1 sample.
+    */
+    void Init() { Reset(); }
+    /** clears buffer, sets write ptr to 0, and delay to 1 sample.
+    */
+    void Reset()
+    {
+        for(size_t i = 0; i < kCapacity; i++)
+        {
+            line_[i] = T(0);
+        }
+        write_ptr_ = 0;
+        delay_     = 1;
+        frac_      = 0.0f;
+    }
+
+    /** sets the delay time in samples
+        If a float is passed in, a fractional component will be calculated for interpolating the delay line.
+    */
+    inline void SetDelay(size_t delay)
+    {
+        frac_  = 0.0f;
+        delay_ = delay < kCapacity ? delay : kCapacity - 1;
+    }
+
+    /** sets the delay time in samples
+        If a float is passed in, a fractional component will be calculated for interpolating the delay line.
+    */
+    inline void SetDelay(float delay)
+    {
+        int32_t int_delay = static_cast<int32_t>(delay);
+        frac_             = delay - static_cast<float>(int_delay);
+        delay_ = static_cast<size_t>(int_delay) < kCapacity ? int_delay
+                                                            : kCapacity - 1;
+    }
+
+    /** writes the sample of type T to the delay line, and advances the write ptr
+    */
+    inline void Write(const T sample)
+    {
+        line_[write_ptr_] = sample;
+        write_ptr_        = (write_ptr_ - 1) & kMask;
+    }
+
+    /** writes a block of samples to the delay line, oldest first.
+        Equivalent to calling Write() for each sample.
+    */
+    inline void WriteBlock(const T* in, size_t size)
+    {
+        size_t w = write_ptr_;
+        for(size_t i = 0; i < size; i++)
+        {
+            line_[w] = in[i];
+            w        = (w - 1) & kMask;
+        }
+        write_ptr_ = w;
+    }
+
+    /** returns the next sample of type T in the delay line, interpolated if necessary.
+    */
+    inline const T Read() const
+    {
+        T a = line_[(write_ptr_ + delay_) & kMask];
+        T b = line_[(write_ptr_ + delay_ + 1) & kMask];
+        return a + (b - a) * frac_;
+    }
+
+    /** Read from a set location */
+    inline const T Read(float delay) const
+    {
+        return ReadAt(write_ptr_, delay);
+    }
+
+    inline const T ReadHermite(float delay) const
+    {
+        return ReadHermiteAt(write_ptr_, delay);
+    }
+
+    inline const T Allpass(const T sample, size_t delay, const T coefficient)
+    {
+        T read  = line_[(write_ptr_ + delay) & kMask];
+        T write = sample + coefficient * read;
+        Write(write);
+        return -write * coefficient + read;
+    }
+
+    /** Reads one modulated tap over the block most recently written with WriteBlock().
+        out[i] is what Read(delay[i]) would have returned just before the i-th sample
+        of that block was written, so delays must be at least 1 sample,
+        and delay + size must stay below kCapacity.
+        \param delay Per-sample delay times in samples
+        \param out Output buffer of at least size samples
+        \param size Number of samples, must match the last WriteBlock()
+    */
+    inline void ReadBlock(const float* delay, T* out, size_t size) const
+    {
+        size_t base = write_ptr_ + size;
+        for(size_t i = 0; i < size; i++, base--)
+        {
+            out[i] = ReadAt(base, delay[i]);
+        }
+    }
+
+    /** Same as ReadBlock(), with 4-point Hermite interpolation.
+        Delays must be at least 2 samples here, since the interpolator looks one sample ahead.
+    */
+    inline void ReadBlockHermite(const float* delay, T* out, size_t size) const
+    {
+        size_t base = write_ptr_ + size;
+        for(size_t i = 0; i < size; i++, base--)
+        {
+            out[i] = ReadHermiteAt(base, delay[i]);
+        }
+    }
+
+    /** Reads num_taps modulated taps over the block most recently written with WriteBlock().
+        Each tap follows the same rules as ReadBlock().
+        \param delays num_taps buffers of per-sample delay times in samples
+        \param outs num_taps output buffers of at least size samples
+        \param num_taps Number of taps to read
+        \param size Number of samples, must match the last WriteBlock()
+    */
+    inline void ReadTaps(const float* const* delays,
+                         T* const*           outs,
+                         size_t              num_taps,
+                         size_t              size) const
+    {
+        for(size_t tap = 0; tap < num_taps; tap++)
+        {
+            ReadBlock(delays[tap], outs[tap], size);
+        }
+    }
+
+  private:
+    static constexpr size_t kMask = kCapacity - 1;
+
+    inline const T ReadAt(size_t base, float delay) const
+    {
+        int32_t delay_integral   = static_cast<int32_t>(delay);
+        float   delay_fractional = delay - static_cast<float>(delay_integral);
+        const T a = line_[(base + delay_integral) & kMask];
+        const T b = line_[(base + delay_integral + 1) & kMask];
+        return a + (b - a) * delay_fractional;
+    }
+
+    inline const T ReadHermiteAt(size_t base, float delay) const
+    {
+        int32_t delay_integral   = static_cast<int32_t>(delay);
+        float   delay_fractional = delay - static_cast<float>(delay_integral);
+
+        size_t      t     = (base + delay_integral);
+        const T     xm1   = line_[(t - 1) & kMask];
+        const T     x0    = line_[(t)&kMask];
+        const T     x1    = line_[(t + 1) & kMask];
+        const T     x2    = line_[(t + 2) & kMask];
+        const float c     = (x1 - xm1) * 0.5f;
+        const float v     = x0 - x1;
+        const float w     = c + v;
+        const float a     = w + v + (x2 - x0) * 0.5f;
+        const float b_neg = w + a;
+        const float f     = delay_fractional;
+        return (((a * f) - b_neg) * f + c) * f + x0;
+    }
+
+    float  frac_;
+    size_t write_ptr_;
+    size_t delay_;
+    T      line_[kCapacity];
+};
+} // namespace daisysp
+#endif
@@ -344,6 +344,125 @@ constexpr uint32_t get_next_power2(uint32_t x)
     return x;
 }
 
+/** Fixed point samples, as signed fractions from -1 to just below 1.
+    q15 has 15 fractional bits, q31 has 31.
+*/
+typedef int16_t q15;
+typedef int32_t q31;
+
+/** Properties of the fixed point sample types.
+    acc is the accumulator type, wide enough for the product
+    or the sum of two samples of type T.
+*/
+template <typename T>
+struct fixed_traits;
+
+template <>
+struct fixed_traits<q15>
+{
+    typedef int32_t      acc;
+    static constexpr int kFracBits = 15;
+    static constexpr acc kMax      = INT16_MAX;
+    static constexpr acc kMin      = INT16_MIN;
+};
+
+template <>
+struct fixed_traits<q31>
+{
+    typedef int64_t      acc;
+    static constexpr int kFracBits = 31;
+    static constexpr acc kMax      = INT32_MAX;
+    static constexpr acc kMin      = INT32_MIN;
+};
+
+/** Saturates an accumulator to the range of the fixed point type T.
+    T has to be given, e.g. fixed_sat<q15>(a * b >> 15).
+*/
+template <typename T>
+inline T fixed_sat(typename fixed_traits<T>::acc x)
+{
+    const auto max = fixed_traits<T>::kMax;
+    const auto min = fixed_traits<T>::kMin;
+    return static_cast<T>(x > max ? max : (x < min ? min : x));
+}
+
+/** Divides x by 2^shift, rounding to the nearest rather than down,
+    so recursive filters don't drift towards -1 LSB.
+*/
+template <typename A>
+inline A fixed_round_shift(A x, int shift)
+{
+    return (x + (A(1) << (shift - 1))) >> shift;
+}
+
+/** Saturating addition of two fixed point samples */
+template <typename T>
+inline T fixed_add(T a, T b)
+{
+    typedef typename fixed_traits<T>::acc acc;
+    return fixed_sat<T>(static_cast<acc>(a) + b);
+}
+
+/** Saturating subtraction of two fixed point samples */
+template <typename T>
+inline T fixed_sub(T a, T b)
+{
+    typedef typename fixed_traits<T>::acc acc;
+    return fixed_sat<T>(static_cast<acc>(a) - b);
+}
+
+#ifdef __arm__
+template <>
+inline q31 fixed_add(q31 a, q31 b)
+{
+    q31 r;
+    asm("qadd %[d], %[n], %[m]" : [d] "=r"(r) : [n] "r"(a), [m] "r"(b) :);
+    return r;
+}
+
+template <>
+inline q31 fixed_sub(q31 a, q31 b)
+{
+    q31 r;
+    asm("qsub %[d], %[n], %[m]" : [d] "=r"(r) : [n] "r"(a), [m] "r"(b) :);
+    return r;
+}
+#endif // __arm__
+
+/** Rounded product of two fixed point samples.
+    Only -1 * -1 saturates.
+*/
+template <typename T>
+inline T fixed_mul(T a, T b)
+{
+    typedef typename fixed_traits<T>::acc acc;
+    return fixed_sat<T>(fixed_round_shift(static_cast<acc>(a) * b,
+                                          fixed_traits<T>::kFracBits));
+}
+
+/** Converts a float to a fixed point sample, rounding to the nearest.
+    Values outside of -1 to 1 saturate.
+*/
+template <typename T>
+inline T float_to_fixed(float x)
+{
+    typedef typename fixed_traits<T>::acc acc;
+    const int   bits    = fixed_traits<T>::kFracBits;
+    const float scale   = static_cast<float>(acc(1) << bits);
+    const float clamped = x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+    const float rounded = clamped * scale + (clamped < 0.0f ? -0.5f : 0.5f);
+    return fixed_sat<T>(static_cast<acc>(rounded));
+}
+
+/** Converts a fixed point sample to a float from -1 to 1 */
+template <typename T>
+inline float fixed_to_float(T x)
+{
+    typedef typename fixed_traits<T>::acc acc;
+    return static_cast<float>(x)
+           * (1.0f / static_cast<float>(acc(1) << fixed_traits<T>::kFracBits));
+}
+
 } // namespace daisysp
 #endif
 
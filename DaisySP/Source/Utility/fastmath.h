@@ -0,0 +1,297 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+/** Lookup table based approximations of sin/cos, exp2, pitch ratios and tanh.
+
+The tables are generated at compile time, so nothing needs to be initialized at runtime.
+Each function takes an optional FastMathAccuracy template argument:
+
+- LOW    - nearest table entry, cheapest
+- MEDIUM - linear interpolation
+- HIGH   - 4-point cubic interpolation
+
+Modules that call sinf/powf/expf in their hot paths switch to these
+functions when the library is built with DSY_FAST_MATH defined.
+The accuracy they use can be picked with DSY_FAST_MATH_ACCURACY (LOW, MEDIUM or HIGH).
+*/
+#pragma once
+#ifndef DSY_FASTMATH_H
+#define DSY_FASTMATH_H
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef DSY_FAST_MATH_ACCURACY
+#define DSY_FAST_MATH_ACCURACY MEDIUM
+#endif
+
+namespace daisysp
+{
+/** Interpolation used when reading the lookup tables */
+enum class FastMathAccuracy
+{
+    LOW,
+    MEDIUM,
+    HIGH,
+};
+
+/** Accuracy used by modules built with DSY_FAST_MATH */
+static constexpr FastMathAccuracy kFastMathAccuracy
+    = FastMathAccuracy::DSY_FAST_MATH_ACCURACY;
+
+namespace fastmath_internal
+{
+    static constexpr size_t kSinTableSize  = 1024;
+    static constexpr size_t kExp2TableSize = 256;
+    static constexpr size_t kTanhTableSize = 512;
+    static constexpr float  kTanhRange     = 6.0f;
+
+    /** Tables hold one guard point before and three after the range,
+        so the cubic interpolator never needs to wrap or clamp.
+    */
+    template <size_t size>
+    struct Table
+    {
+        float data[size + 4];
+    };
+
+    constexpr double ConstexprSin(double x)
+    {
+        const double kPi = 3.14159265358979323846;
+        while(x > kPi)
+        {
+            x -= 2.0 * kPi;
+        }
+        while(x < -kPi)
+        {
+            x += 2.0 * kPi;
+        }
+        double term = x;
+        double sum  = x;
+        for(int n = 1; n < 16; n++)
+        {
+            term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double ConstexprExp(double x)
+    {
+        // Scale down so the series converges quickly, then square back up.
+        int squarings = 0;
+        while(x > 0.5 || x < -0.5)
+        {
+            x *= 0.5;
+            squarings++;
+        }
+        double term = 1.0;
+        double sum  = 1.0;
+        for(int n = 1; n < 20; n++)
+        {
+            term *= x / n;
+            sum += term;
+        }
+        for(int i = 0; i < squarings; i++)
+        {
+            sum *= sum;
+        }
+        return sum;
+    }
+
+    constexpr Table<kSinTableSize> MakeSinTable()
+    {
+        Table<kSinTableSize> t{};
+        for(size_t i = 0; i < kSinTableSize + 4; i++)
+        {
+            const double phase = (static_cast<double>(i) - 1.0) / kSinTableSize;
+            t.data[i] = static_cast<float>(
+                ConstexprSin(phase * 2.0 * 3.14159265358979323846));
+        }
+        return t;
+    }
+
+    constexpr Table<kExp2TableSize> MakeExp2Table()
+    {
+        Table<kExp2TableSize> t{};
+        for(size_t i = 0; i < kExp2TableSize + 4; i++)
+        {
+            const double x = (static_cast<double>(i) - 1.0) / kExp2TableSize;
+            t.data[i] = static_cast<float>(ConstexprExp(x * 0.69314718055994531));
+        }
+        return t;
+    }
+
+    constexpr Table<kTanhTableSize> MakeTanhTable()
+    {
+        Table<kTanhTableSize> t{};
+        for(size_t i = 0; i < kTanhTableSize + 4; i++)
+        {
+            const double x = ((static_cast<double>(i) - 1.0) / kTanhTableSize
+                              * 2.0
+                              - 1.0)
+                             * kTanhRange;
+            const double e = ConstexprExp(2.0 * x);
+            t.data[i]      = static_cast<float>((e - 1.0) / (e + 1.0));
+        }
+        return t;
+    }
+
+    /** Holder for the tables. Being a template lets the definitions
+        live in this header while the linker keeps a single copy.
+    */
+    template <typename T = void>
+    struct Tables
+    {
+        static constexpr Table<kSinTableSize>  kSin  = MakeSinTable();
+        static constexpr Table<kExp2TableSize> kExp2 = MakeExp2Table();
+        static constexpr Table<kTanhTableSize> kTanh = MakeTanhTable();
+    };
+
+    template <typename T>
+    constexpr Table<kSinTableSize> Tables<T>::kSin;
+    template <typename T>
+    constexpr Table<kExp2TableSize> Tables<T>::kExp2;
+    template <typename T>
+    constexpr Table<kTanhTableSize> Tables<T>::kTanh;
+
+    /** Reads a table at position idx + frac, where idx is in table units
+        (the guard point offset is applied here).
+    */
+    template <FastMathAccuracy accuracy>
+    inline float Lookup(const float* table, int32_t idx, float frac)
+    {
+        const float* p = table + idx + 1;
+        switch(accuracy)
+        {
+            case FastMathAccuracy::LOW: return frac < 0.5f ? p[0] : p[1];
+            case FastMathAccuracy::MEDIUM: return p[0] + (p[1] - p[0]) * frac;
+            case FastMathAccuracy::HIGH:
+            default:
+            {
+                const float xm1   = p[-1];
+                const float x0    = p[0];
+                const float x1    = p[1];
+                const float x2    = p[2];
+                const float c     = (x1 - xm1) * 0.5f;
+                const float v     = x0 - x1;
+                const float w     = c + v;
+                const float a     = w + v + (x2 - x0) * 0.5f;
+                const float b_neg = w + a;
+                return (((a * frac) - b_neg) * frac + c) * frac + x0;
+            }
+        }
+    }
+} // namespace fastmath_internal
+
+/** Sine of a phase given in cycles, i.e. sin_lut(x) = sinf(x * TWOPI_F).
+    Any phase is accepted, it is wrapped to 0-1 internally.
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float sin_lut(float phase)
+{
+    using namespace fastmath_internal;
+    phase -= static_cast<float>(static_cast<int32_t>(phase));
+    phase += phase < 0.0f ? 1.0f : 0.0f;
+    const float   pos  = phase * kSinTableSize;
+    const int32_t idx  = static_cast<int32_t>(pos);
+    const float   frac = pos - static_cast<float>(idx);
+    return Lookup<accuracy>(Tables<>::kSin.data, idx, frac);
+}
+
+/** Cosine of a phase given in cycles, i.e. cos_lut(x) = cosf(x * TWOPI_F).
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float cos_lut(float phase)
+{
+    return sin_lut<accuracy>(phase + 0.25f);
+}
+
+/** 2 raised to the power of x. Valid for -126 < x < 128.
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float exp2_lut(float x)
+{
+    using namespace fastmath_internal;
+    x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+    int32_t integral = static_cast<int32_t>(x);
+    integral -= x < static_cast<float>(integral) ? 1 : 0;
+    const float   pos  = (x - static_cast<float>(integral)) * kExp2TableSize;
+    const int32_t idx  = static_cast<int32_t>(pos);
+    const float   frac = pos - static_cast<float>(idx);
+
+    // 2^integral, built directly from the exponent bits.
+    const uint32_t bits  = static_cast<uint32_t>(integral + 127) << 23;
+    float          scale = 0.0f;
+    memcpy(&scale, &bits, sizeof(scale));
+    return Lookup<accuracy>(Tables<>::kExp2.data, idx, frac) * scale;
+}
+
+/** e raised to the power of x. Valid for roughly -87 < x < 88.
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float exp_lut(float x)
+{
+    return exp2_lut<accuracy>(x * 1.44269504088896341f);
+}
+
+/** e raised to the power of x, minus 1. Valid for roughly -87 < x < 88.
+    exp_lut(x) - 1 cancels out for small x, which is where one pole
+    coefficients like 1 - e^(-1 / (time * sample_rate)) live, so
+    |x| < 1/8 uses the series instead, within 2e-6 of the result.
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float expm1_lut(float x)
+{
+    if(x > -0.125f && x < 0.125f)
+    {
+        const float x2 = x * x;
+        return x + x2 * (0.5f + x * (1.0f / 6.0f) + x2 * (1.0f / 24.0f));
+    }
+    return exp_lut<accuracy>(x) - 1.0f;
+}
+
+/** Frequency ratio for a pitch offset in semitones, i.e. 2^(st / 12).
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float semitones_to_ratio(float semitones)
+{
+    return exp2_lut<accuracy>(semitones * (1.0f / 12.0f));
+}
+
+/** Frequency ratio for a pitch offset in cents, i.e. 2^(cents / 1200).
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float cents_to_ratio(float cents)
+{
+    return exp2_lut<accuracy>(cents * (1.0f / 1200.0f));
+}
+
+/** Hyperbolic tangent. Inputs beyond +/-6 saturate to +/-1.
+*/
+template <FastMathAccuracy accuracy = kFastMathAccuracy>
+inline float tanh_lut(float x)
+{
+    using namespace fastmath_internal;
+    if(x >= kTanhRange)
+    {
+        return 1.0f;
+    }
+    if(x <= -kTanhRange)
+    {
+        return -1.0f;
+    }
+    const float pos
+        = (x * (1.0f / kTanhRange) + 1.0f) * (0.5f * kTanhTableSize);
+    const int32_t idx  = static_cast<int32_t>(pos);
+    const float   frac = pos - static_cast<float>(idx);
+    return Lookup<accuracy>(Tables<>::kTanh.data, idx, frac);
+}
+
+} // namespace daisysp
+#endif
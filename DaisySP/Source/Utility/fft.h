@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_FFT_H
+#define DSY_FFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+namespace daisysp
+{
+/** Radix-2 FFT of real signals.
+
+size must be a power of two, of at least 4.
+Spectra are stored packed in size floats:
+
+- out[0] is the DC bin, out[1] the Nyquist bin (both are purely real)
+- out[2k] and out[2k + 1] are the real and imaginary parts of bin k, for 0 < k < size / 2
+
+The transforms are unnormalized, Inverse(Forward(x)) returns x scaled by size.
+
+declaration example:
+
+RealFft<512> fft;
+
+*/
+template <size_t size>
+class RealFft
+{
+  public:
+    static_assert(size >= 4 && (size & (size - 1)) == 0,
+                  "RealFft size must be a power of two of at least 4");
+
+    RealFft() {}
+    ~RealFft() {}
+
+    /** Computes the twiddle and bit reversal tables. */
+    void Init()
+    {
+        for(size_t k = 0; k < kHalf; k++)
+        {
+            const double phase = -2.0 * 3.14159265358979323846 * k / size;
+            w_re_[k]           = static_cast<float>(cos(phase));
+            w_im_[k]           = static_cast<float>(sin(phase));
+        }
+        size_t bits = 0;
+        while((static_cast<size_t>(1) << bits) < kHalf)
+        {
+            bits++;
+        }
+        for(size_t i = 0; i < kHalf; i++)
+        {
+            size_t r = 0;
+            for(size_t b = 0; b < bits; b++)
+            {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            rev_[i] = static_cast<uint32_t>(r);
+        }
+    }
+
+    /** Transforms size real samples into a packed spectrum.
+        \param in size samples
+        \param out size floats, may be the same buffer as in
+    */
+    void Forward(const float* in, float* out) const
+    {
+        // Treat the even/odd samples as one complex signal of half the length.
+        if(in != out)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = in[i];
+            }
+        }
+        Transform(out, false);
+
+        const float z0_re = out[0];
+        const float z0_im = out[1];
+        out[0]            = z0_re + z0_im;
+        out[1]            = z0_re - z0_im;
+        for(size_t k = 1; k <= kHalf / 2; k++)
+        {
+            const size_t j    = kHalf - k;
+            const float  a_re = out[2 * k], a_im = out[2 * k + 1];
+            const float  b_re = out[2 * j], b_im = out[2 * j + 1];
+
+            // Even and odd parts of bin k, twiddled odd part added.
+            const float e_re = 0.5f * (a_re + b_re);
+            const float e_im = 0.5f * (a_im - b_im);
+            const float o_re = 0.5f * (a_im + b_im);
+            const float o_im = -0.5f * (a_re - b_re);
+            const float t_re = w_re_[k] * o_re - w_im_[k] * o_im;
+            const float t_im = w_re_[k] * o_im + w_im_[k] * o_re;
+
+            out[2 * k]     = e_re + t_re;
+            out[2 * k + 1] = e_im + t_im;
+            // Bin size/2 - k is built from the same pair.
+            out[2 * j]     = e_re - t_re;
+            out[2 * j + 1] = -(e_im - t_im);
+        }
+    }
+
+    /** Transforms a packed spectrum back into size real samples, scaled by size.
+        \param in size floats
+        \param out size samples, may be the same buffer as in
+    */
+    void Inverse(const float* in, float* out) const
+    {
+        const float x0 = in[0];
+        const float xn = in[1];
+        float       tmp_k_re, tmp_k_im, tmp_j_re, tmp_j_im;
+        for(size_t k = 1; k <= kHalf / 2; k++)
+        {
+            const size_t j    = kHalf - k;
+            const float  a_re = in[2 * k], a_im = in[2 * k + 1];
+            const float  b_re = in[2 * j], b_im = in[2 * j + 1];
+
+            const float e_re = a_re + b_re;
+            const float e_im = a_im - b_im;
+            const float d_re = a_re - b_re;
+            const float d_im = a_im + b_im;
+            // Odd part, with the conjugate twiddle.
+            const float o_re = w_re_[k] * d_re + w_im_[k] * d_im;
+            const float o_im = w_re_[k] * d_im - w_im_[k] * d_re;
+
+            tmp_k_re = e_re - o_im;
+            tmp_k_im = e_im + o_re;
+            tmp_j_re = e_re + o_im;
+            tmp_j_im = -(e_im - o_re);
+
+            out[2 * k]     = tmp_k_re;
+            out[2 * k + 1] = tmp_k_im;
+            out[2 * j]     = tmp_j_re;
+            out[2 * j + 1] = tmp_j_im;
+        }
+        out[0] = x0 + xn;
+        out[1] = x0 - xn;
+        Transform(out, true);
+    }
+
+  private:
+    static constexpr size_t kHalf = size / 2;
+
+    /** In-place complex FFT of kHalf interleaved points */
+    void Transform(float* d, bool inverse) const
+    {
+        for(size_t i = 0; i < kHalf; i++)
+        {
+            const size_t r = rev_[i];
+            if(r > i)
+            {
+                float t      = d[2 * i];
+                d[2 * i]     = d[2 * r];
+                d[2 * r]     = t;
+                t            = d[2 * i + 1];
+                d[2 * i + 1] = d[2 * r + 1];
+                d[2 * r + 1] = t;
+            }
+        }
+        const float sign = inverse ? -1.0f : 1.0f;
+        for(size_t len = 2; len <= kHalf; len <<= 1)
+        {
+            const size_t half = len / 2;
+            // Twiddles are tabulated for size points, the complex FFT uses every other one.
+            const size_t step = 2 * (kHalf / len);
+            for(size_t j = 0; j < half; j++)
+            {
+                const float wr = w_re_[j * step];
+                const float wi = sign * w_im_[j * step];
+                for(size_t i = j; i < kHalf; i += len)
+                {
+                    float*      a    = &d[2 * i];
+                    float*      b    = &d[2 * (i + half)];
+                    const float t_re = b[0] * wr - b[1] * wi;
+                    const float t_im = b[0] * wi + b[1] * wr;
+                    b[0]             = a[0] - t_re;
+                    b[1]             = a[1] - t_im;
+                    a[0] += t_re;
+                    a[1] += t_im;
+                }
+            }
+        }
+    }
+
+    float    w_re_[kHalf];
+    float    w_im_[kHalf];
+    uint32_t rev_[kHalf];
+};
+
+} // namespace daisysp
+#endif
@@ -0,0 +1,127 @@
+#include "multitapdelay.h"
+
+using namespace daisysp;
+
+void MultiTapDelay::Init(float* buffer, size_t size, Interpolation interpolation)
+{
+    size_t length = 1;
+    while(length * 2 <= size)
+    {
+        length *= 2;
+    }
+    buffer_        = buffer;
+    mask_          = length - 1;
+    interpolation_ = interpolation;
+    Reset();
+}
+
+void MultiTapDelay::Reset()
+{
+    for(size_t i = 0; i <= mask_; i++)
+    {
+        buffer_[i] = 0.f;
+    }
+    for(size_t i = 0; i < kMaxTaps; i++)
+    {
+        allpass_[i] = 0.f;
+    }
+    write_pos_ = 0;
+}
+
+void MultiTapDelay::Write(const float* in, size_t size)
+{
+    // At most two straight copies, either side of the wrap.
+    while(size > 0)
+    {
+        const size_t room = mask_ + 1 - write_pos_;
+        const size_t n    = size < room ? size : room;
+        float*       dst  = buffer_ + write_pos_;
+        for(size_t i = 0; i < n; i++)
+        {
+            dst[i] = in[i];
+        }
+        write_pos_ = (write_pos_ + n) & mask_;
+        in += n;
+        size -= n;
+    }
+}
+
+void MultiTapDelay::ReadTap(size_t       tap,
+                            const float* delay,
+                            float*       out,
+                            size_t       size)
+{
+    const size_t pos = write_pos_;
+    switch(interpolation_)
+    {
+        case LINEAR:
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadLinear(pos + i, delay[i]);
+            }
+            break;
+        case HERMITE:
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadHermite(pos + i, delay[i]);
+            }
+            break;
+        case ALLPASS:
+        {
+            float state = allpass_[tap];
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadAllpass(pos + i, delay[i], state);
+            }
+            allpass_[tap] = state;
+            break;
+        }
+    }
+}
+
+void MultiTapDelay::ReadTap(size_t tap, float delay, float* out, size_t size)
+{
+    const size_t d     = static_cast<size_t>(delay);
+    const float  frac  = delay - static_cast<float>(d);
+    const size_t start = (write_pos_ - d) & mask_;
+
+    // Unless the block wraps, a linear tap at a fixed delay is a straight
+    // run through the buffer with constant weights.
+    if(interpolation_ == LINEAR && start >= 1 && start + size <= mask_ + 1)
+    {
+        const float* x     = buffer_ + start;
+        const float* older = x - 1;
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = x[i] + (older[i] - x[i]) * frac;
+        }
+        return;
+    }
+
+    const size_t pos = write_pos_;
+    switch(interpolation_)
+    {
+        case LINEAR:
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadLinear(pos + i, delay);
+            }
+            break;
+        case HERMITE:
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadHermite(pos + i, delay);
+            }
+            break;
+        case ALLPASS:
+        {
+            float state = allpass_[tap];
+            for(size_t i = 0; i < size; i++)
+            {
+                out[i] = ReadAllpass(pos + i, delay, state);
+            }
+            allpass_[tap] = state;
+            break;
+        }
+    }
+}
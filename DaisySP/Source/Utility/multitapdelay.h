@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_MULTITAPDELAY_H
+#define DSY_MULTITAPDELAY_H
+
+#include <stddef.h>
+
+/** @file multitapdelay.h */
+
+namespace daisysp
+{
+/** Delay line with one write head and several modulated read heads.
+
+The line lives in caller-supplied memory, e.g. in SDRAM, so a long line
+doesn't take up internal RAM, and one line can feed several voices, like
+the voices of a chorus or the taps of a multitap echo, instead of each of
+them keeping a copy of the same signal. Its length is the buffer size
+rounded down to a power of two, so indices wrap with a mask.
+
+Everything works a block at a time. Each tap is read with a buffer of
+delay times, one per sample, so modulation is worked out by the caller for
+the whole block, e.g. from an LFO, and a tap with a fixed delay takes a
+quicker path.
+
+Taps read relative to the write head, the same way DelayLine::Read() does
+before DelayLine::Write(): out[i] is the signal delay[i] samples before the
+i-th sample of the next Write(). So a feedback loop reads a block, mixes
+it into the input and writes that:
+
+\code
+float DSY_SDRAM_BSS memory[65536];
+MultiTapDelay       delay;
+
+delay.Init(memory, 65536);
+
+// in the audio callback
+for(size_t i = 0; i < size; i++)
+    times[i] = base + depth * lfo.Process();
+delay.ReadTap(0, times, wet, size);
+for(size_t i = 0; i < size; i++)
+    fb[i] = in[i] + wet[i] * feedback;
+delay.Write(fb, size);
+\endcode
+
+Reading a block before writing it, delay times must be at least size
+samples, and one more with HERMITE or ALLPASS interpolation. Taps shorter
+than that are read after Write(), with size added to their delay times.
+Delay times must also leave room for the block, they go up to
+GetLength() - size - 2.
+*/
+class MultiTapDelay
+{
+  public:
+    static constexpr size_t kMaxTaps = 8;
+
+    /** How taps read between samples */
+    enum Interpolation
+    {
+        LINEAR,  /**< Cheapest, dulls the highs a little while modulated */
+        HERMITE, /**< 4 point cubic, for pitch shifting and deep modulation */
+        ALLPASS, /**< First order allpass, keeps the highs, for slowly
+                      modulated taps like chorus voices */
+    };
+
+    MultiTapDelay() {}
+    ~MultiTapDelay() {}
+
+    /** Initializes the line and clears the memory
+        \param buffer Memory for the line
+        \param size Length of buffer in samples. Only the largest power of
+        two that fits is used.
+        \param interpolation How the taps read between samples
+    */
+    void Init(float*        buffer,
+              size_t        size,
+              Interpolation interpolation = LINEAR);
+
+    /** Clears the line and the state of the taps */
+    void Reset();
+
+    /** \param interpolation How the taps read between samples */
+    inline void SetInterpolation(Interpolation interpolation)
+    {
+        interpolation_ = interpolation;
+    }
+
+    /** Writes a block at the write head and moves it on
+        \param in size samples
+        \param size Number of samples
+    */
+    void Write(const float* in, size_t size);
+
+    /** Reads a modulated tap
+        \param tap 0 to kMaxTaps - 1, keeps the ALLPASS state of the tap
+        \param delay Delay time in samples for each sample of the block
+        \param out Output, size samples
+        \param size Number of samples
+    */
+    void ReadTap(size_t tap, const float* delay, float* out, size_t size);
+
+    /** Reads a tap with a fixed delay time
+        \param tap 0 to kMaxTaps - 1, keeps the ALLPASS state of the tap
+        \param delay Delay time in samples
+        \param out Output, size samples
+        \param size Number of samples
+    */
+    void ReadTap(size_t tap, float delay, float* out, size_t size);
+
+    /** Writes a single sample, for feedback loops shorter than a block */
+    inline void Write(float in)
+    {
+        buffer_[write_pos_] = in;
+        write_pos_          = (write_pos_ + 1) & mask_;
+    }
+
+    /** Reads a single sample before the next Write(float), with linear
+        interpolation
+        \param delay Delay time in samples, at least 1
+    */
+    inline float Read(float delay) const
+    {
+        return ReadLinear(write_pos_, delay);
+    }
+
+    /** \return Length of the line in samples */
+    inline size_t GetLength() const { return mask_ + 1; }
+
+  private:
+    /** The sample delay samples before position pos */
+    inline float ReadLinear(size_t pos, float delay) const
+    {
+        const size_t d    = static_cast<size_t>(delay);
+        const float  frac = delay - static_cast<float>(d);
+        const float  a    = buffer_[(pos - d) & mask_];
+        const float  b    = buffer_[(pos - d - 1) & mask_];
+        return a + (b - a) * frac;
+    }
+
+    inline float ReadHermite(size_t pos, float delay) const
+    {
+        const size_t d     = static_cast<size_t>(delay);
+        const float  f     = delay - static_cast<float>(d);
+        const size_t t     = pos - d;
+        const float  xm1   = buffer_[(t + 1) & mask_];
+        const float  x0    = buffer_[t & mask_];
+        const float  x1    = buffer_[(t - 1) & mask_];
+        const float  x2    = buffer_[(t - 2) & mask_];
+        const float  c     = (x1 - xm1) * 0.5f;
+        const float  v     = x0 - x1;
+        const float  w     = c + v;
+        const float  a     = w + v + (x2 - x0) * 0.5f;
+        const float  b_neg = w + a;
+        return (((a * f) - b_neg) * f + c) * f + x0;
+    }
+
+    inline float ReadAllpass(size_t pos, float delay, float& state) const
+    {
+        // Keeps the fractional delay between 0.5 and 1.5, where the
+        // coefficient stays small and the filter well behaved.
+        size_t d    = static_cast<size_t>(delay);
+        float  frac = delay - static_cast<float>(d);
+        if(frac < 0.5f && d > 0)
+        {
+            d--;
+            frac += 1.f;
+        }
+        const float coef = (1.f - frac) / (1.f + frac);
+        const float x0   = buffer_[(pos - d) & mask_];
+        const float x1   = buffer_[(pos - d - 1) & mask_];
+        state            = x1 + coef * (x0 - state);
+        return state;
+    }
+
+    float*        buffer_;
+    size_t        mask_, write_pos_;
+    float         allpass_[kMaxTaps];
+    Interpolation interpolation_;
+};
+
+} // namespace daisysp
+#endif
@@ -0,0 +1,100 @@
+#include <math.h>
+#include "dsp.h"
+#include "oversampler.h"
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float kKaiserBeta = 8.f; // about 80dB of stopband rejection
+
+/** Zeroth order modified Bessel function of the first kind */
+float BesselI0(float x)
+{
+    float sum = 1.f, term = 1.f;
+    for(int k = 1; k < 32 && term > 1e-9f * sum; k++)
+    {
+        const float half = x / (2.f * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+} // namespace
+
+void HalfbandFilter::Init(size_t num_pairs)
+{
+    num_pairs_ = num_pairs;
+    if(num_pairs_ < 1)
+    {
+        num_pairs_ = 1;
+    }
+    if(num_pairs_ > kMaxPairs)
+    {
+        num_pairs_ = kMaxPairs;
+    }
+    length_ = 2 * num_pairs_;
+
+    // The odd taps of a windowed sinc with its cutoff at a quarter of the
+    // rate, scaled so they add up to the 0.5 of the centre tap.
+    const float half_length = static_cast<float>(length_);
+    float       sum         = 0.f;
+    for(size_t i = 0; i < num_pairs_; i++)
+    {
+        const float d      = 2.f * i + 1.f;
+        const float r      = d / half_length;
+        const float window = BesselI0(kKaiserBeta * sqrtf(1.f - r * r))
+                             / BesselI0(kKaiserBeta);
+        const float sinc   = (i % 2 == 0 ? 1.f : -1.f) / (PI_F * d);
+        coefs_[i]          = sinc * window;
+        sum += coefs_[i];
+    }
+    for(size_t i = 0; i < num_pairs_; i++)
+    {
+        coefs_[i] *= 0.25f / sum;
+    }
+    Reset();
+}
+
+void HalfbandFilter::Reset()
+{
+    for(size_t i = 0; i < 2 * length_; i++)
+    {
+        history_[i] = 0.f;
+    }
+    for(size_t i = 0; i < num_pairs_; i++)
+    {
+        delay_[i] = 0.f;
+    }
+    pos_       = 0;
+    delay_pos_ = 0;
+}
+
+void HalfbandFilter::Upsample(const float* in, float* out, size_t size)
+{
+    // Zero stuffing doubles the samples and halves the level, which the
+    // gain of 2 makes up for: a copy on the even phase, and twice the
+    // odd taps on the odd one.
+    for(size_t i = 0; i < size; i++)
+    {
+        const float* window = Push(in[i]);
+        out[2 * i]          = window[num_pairs_ - 1];
+        out[2 * i + 1]      = 2.f * Convolve(window);
+    }
+}
+
+void HalfbandFilter::Downsample(const float* in, float* out, size_t size)
+{
+    // Even samples only meet the centre tap, odd ones the others.
+    for(size_t i = 0; i < size; i++)
+    {
+        const float even = in[2 * i];
+        const float odd  = in[2 * i + 1];
+
+        delay_[delay_pos_] = even;
+        delay_pos_         = delay_pos_ + 1 < num_pairs_ ? delay_pos_ + 1 : 0;
+        const float centre = delay_[delay_pos_];
+
+        out[i] = 0.5f * centre + Convolve(Push(odd));
+    }
+}
@@ -0,0 +1,323 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_OVERSAMPLER_H
+#define DSY_OVERSAMPLER_H
+
+#include <stddef.h>
+
+/** @file oversampler.h */
+
+namespace daisysp
+{
+/** Halfband lowpass that doubles or halves the sample rate.
+
+Every other coefficient of a halfband filter is zero, and the remaining ones
+are symmetric, so each output takes num_pairs multiplies. Interpolating, the
+even outputs are a plain copy of the delayed input. Decimating, only the
+outputs that are kept are worked out.
+
+The cutoff is a quarter of the higher rate. The filter is a Kaiser windowed
+sinc, num_pairs sets its length (4 * num_pairs - 1 taps) and so the width of
+the transition band. Oversampler picks the lengths for each stage of its
+cascade, use this class directly for a single stage with a length of your own.
+
+An instance keeps state for one direction, use one for Upsample() and another
+one for Downsample().
+*/
+class HalfbandFilter
+{
+  public:
+    static constexpr size_t kMaxPairs = 16;
+
+    HalfbandFilter() {}
+    ~HalfbandFilter() {}
+
+    /** Designs the filter and clears its state
+        \param num_pairs 1 to kMaxPairs. 16 gives about 75dB of rejection,
+        with the passband ending at 0.21 of the higher rate and the stopband
+        starting at 0.29.
+    */
+    void Init(size_t num_pairs);
+
+    /** Clears the state, keeping the coefficients */
+    void Reset();
+
+    /** Doubles the sample rate
+        \param in size samples
+        \param out 2 * size samples, not overlapping in
+        \param size Number of input samples
+    */
+    void Upsample(const float* in, float* out, size_t size);
+
+    /** Halves the sample rate. out may be the same buffer as in.
+        \param in 2 * size samples
+        \param out size samples
+        \param size Number of output samples
+    */
+    void Downsample(const float* in, float* out, size_t size);
+
+    /** \return Number of coefficient pairs. Upsample() delays by as many
+        input samples, Downsample() by one less output sample. */
+    inline size_t GetNumPairs() const { return num_pairs_; }
+
+  private:
+    /** Adds a sample to the history, returns the window oldest first */
+    inline const float* Push(float in)
+    {
+        history_[pos_]           = in;
+        history_[pos_ + length_] = in;
+        pos_                     = pos_ + 1 < length_ ? pos_ + 1 : 0;
+        return &history_[pos_];
+    }
+
+    /** Sum of the symmetric taps around the middle of the window */
+    inline float Convolve(const float* window) const
+    {
+        const float* lo  = window + num_pairs_ - 1;
+        const float* hi  = window + num_pairs_;
+        float        sum = 0.f;
+        for(size_t i = 0; i < num_pairs_; i++)
+        {
+            sum += coefs_[i] * (lo[-static_cast<ptrdiff_t>(i)] + hi[i]);
+        }
+        return sum;
+    }
+
+    float  coefs_[kMaxPairs];
+    float  history_[4 * kMaxPairs]; // written twice, so windows don't wrap
+    float  delay_[kMaxPairs];       // the centre tap, when decimating
+    size_t num_pairs_, length_, pos_, delay_pos_;
+};
+
+/** Polyphase 2x, 4x or 8x oversampling for nonlinear processing.
+
+Distortion creates harmonics above Nyquist, which fold back down as aliases.
+Running the nonlinearity at a higher rate, with lowpass filters on the way
+up and down, keeps them out of the audio band. The rate is doubled and
+halved by a cascade of HalfbandFilter stages. The stage next to the base rate
+does the real work, the stages above it only have to reject the images of
+the audio band and get by with short filters. 8x costs about 44 multiplies
+per base rate sample in each direction, 4x about 28.
+
+Blocks are handed over max_block base rate samples at a time, ProcessBlock()
+splits longer ones up.
+
+\code
+Oversampler<4> os;
+Overdrive      drive;
+
+os.Init();
+drive.Init();
+
+// in the audio callback
+os.ProcessBlock(in[0], out[0], size, [](float x) { return drive.Process(x); });
+\endcode
+
+Modules that depend on the sample rate are initialized with
+sample_rate * factor. See also Oversampled, which wraps a module.
+
+\tparam factor 2, 4 or 8
+\tparam max_block Largest block at the base rate
+*/
+template <size_t factor, size_t max_block = 48>
+class Oversampler
+{
+  public:
+    static_assert(factor == 2 || factor == 4 || factor == 8,
+                  "Oversampler factor must be 2, 4 or 8");
+
+    static constexpr size_t kNumStages = factor == 2 ? 1 : factor == 4 ? 2 : 3;
+
+    Oversampler() {}
+    ~Oversampler() {}
+
+    /** Designs the filters and clears their state */
+    void Init()
+    {
+        // Stage 0 sets the passband, up to 20kHz at 48kHz. Above it, only
+        // the images of the audio band need rejecting.
+        static constexpr size_t kPairs[3] = {16, 6, 4};
+        for(size_t s = 0; s < kNumStages; s++)
+        {
+            up_[s].Init(kPairs[s]);
+            down_[s].Init(kPairs[s]);
+        }
+    }
+
+    /** Clears the filter state */
+    void Reset()
+    {
+        for(size_t s = 0; s < kNumStages; s++)
+        {
+            up_[s].Reset();
+            down_[s].Reset();
+        }
+    }
+
+    /** Raises the sample rate by factor
+        \param in size samples
+        \param out size * factor samples
+        \param size Number of input samples, up to max_block
+    */
+    void Upsample(const float* in, float* out, size_t size)
+    {
+        // Alternate between out and scratch_ so the last stage ends in out.
+        const float* src = in;
+        for(size_t s = 0; s < kNumStages; s++)
+        {
+            float* dst = (kNumStages - 1 - s) % 2 == 0 ? out : scratch_;
+            up_[s].Upsample(src, dst, size << s);
+            src = dst;
+        }
+    }
+
+    /** Lowers the sample rate by factor. in may be the same buffer as out,
+        and is overwritten.
+        \param in size * factor samples
+        \param out size samples
+        \param size Number of output samples, up to max_block
+    */
+    void Downsample(float* in, float* out, size_t size)
+    {
+        for(size_t s = kNumStages; s-- > 1;)
+        {
+            down_[s].Downsample(in, in, size << s);
+        }
+        down_[0].Downsample(in, out, size);
+    }
+
+    /** Runs a function at the higher rate
+        \param in Input, size samples
+        \param out Output, size samples, may be the same buffer as in
+        \param size Number of samples, any length
+        \param process float(float), called size * factor times
+    */
+    template <typename F>
+    void ProcessBlock(const float* in, float* out, size_t size, F&& process)
+    {
+        while(size > 0)
+        {
+            const size_t n = size < max_block ? size : max_block;
+            Upsample(in, oversampled_, n);
+            for(size_t i = 0; i < n * factor; i++)
+            {
+                oversampled_[i] = process(oversampled_[i]);
+            }
+            Downsample(oversampled_, out, n);
+            in += n;
+            out += n;
+            size -= n;
+        }
+    }
+
+    /** Runs a function at the higher rate for a single sample. Prefer
+        ProcessBlock(), the filters are quicker over a block.
+        \param in Input sample
+        \param process float(float), called factor times
+        \return Output sample
+    */
+    template <typename F>
+    float Process(float in, F&& process)
+    {
+        float out;
+        ProcessBlock(&in, &out, 1, process);
+        return out;
+    }
+
+    /** \return Delay from input to output at the base rate, in samples */
+    float GetLatency() const
+    {
+        // Each stage delays by its pairs on the way up and one less on the
+        // way down, in samples of the lower of its two rates.
+        float latency = 0.f;
+        for(size_t s = 0; s < kNumStages; s++)
+        {
+            const size_t pairs = up_[s].GetNumPairs();
+            latency += static_cast<float>(2 * pairs - 1) / (1 << s);
+        }
+        return latency;
+    }
+
+  private:
+    HalfbandFilter up_[kNumStages], down_[kNumStages];
+    float          oversampled_[max_block * factor];
+    float          scratch_[max_block * factor / 2];
+};
+
+/** A nonlinear module run at a multiple of the sample rate.
+
+Wraps a module with a float Process(float) method, e.g. Overdrive,
+Wavefolder, or Fold and Bitcrush from DaisySP-LGPL, and runs it through an
+Oversampler. The module itself is set up through GetModel(). One that
+depends on the sample rate is initialized with sample_rate * factor.
+
+Modules that hold samples for a number of calls run their holds at the
+higher rate too. Bitcrush keeps its crush rate when initialized with
+sample_rate * factor, and Fold keeps its hold when its increment is
+multiplied by factor. Decimator's downsampling can't be scaled that way,
+wrapped it holds factor times shorter, only its bit crushing is unchanged.
+
+\code
+Oversampled<Overdrive, 4> drive;
+
+drive.Init();
+drive.GetModel().Init();
+drive.GetModel().SetDrive(0.8f);
+
+// in the audio callback
+drive.ProcessBlock(in[0], out[0], size);
+\endcode
+
+\tparam T The module
+\tparam factor 2, 4 or 8
+\tparam max_block Largest block at the base rate
+*/
+template <typename T, size_t factor = 4, size_t max_block = 48>
+class Oversampled
+{
+  public:
+    Oversampled() {}
+    ~Oversampled() {}
+
+    /** Initializes the filters. The module is initialized separately. */
+    void Init() { os_.Init(); }
+
+    /** Get the next sample
+        \param in Input sample
+    */
+    float Process(float in)
+    {
+        return os_.Process(in, [this](float x) { return model_.Process(x); });
+    }
+
+    /** Processes a block
+        \param in Input, size samples
+        \param out Output, size samples, may be the same buffer as in
+        \param size Number of samples
+    */
+    void ProcessBlock(const float* in, float* out, size_t size)
+    {
+        os_.ProcessBlock(
+            in, out, size, [this](float x) { return model_.Process(x); });
+    }
+
+    /** \return Delay from input to output at the base rate, in samples */
+    inline float GetLatency() const { return os_.GetLatency(); }
+
+    /** Access to the wrapped module */
+    inline T& GetModel() { return model_; }
+
+  private:
+    T                              model_;
+    Oversampler<factor, max_block> os_;
+};
+
+} // namespace daisysp
+#endif
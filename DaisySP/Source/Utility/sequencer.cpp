@@ -0,0 +1,117 @@
+#include "sequencer.h"
+
+using namespace daisysp;
+
+void SequencerClock::Init(float sample_rate, float bpm)
+{
+    sample_rate_     = sample_rate;
+    bpm_             = bpm;
+    target_bpm_      = bpm;
+    bpm_per_tick_    = 0.f;
+    pulse_interval_  = 60.f * sample_rate / (bpm * kPulsesPerBeat);
+    next_tick_       = 0.f;
+    tick_            = 0;
+    time_            = 0;
+    pulses_          = 0;
+    last_pulse_time_ = 0;
+    running_         = true;
+    external_        = false;
+    waiting_         = false;
+    pulse_seen_      = false;
+}
+
+void SequencerClock::SetTempo(float bpm, float ramp_time)
+{
+    target_bpm_ = bpm;
+    if(ramp_time <= 0.f)
+    {
+        bpm_          = bpm;
+        bpm_per_tick_ = 0.f;
+        return;
+    }
+    // The ramp is spread over the ticks it takes at the average tempo.
+    const float ticks = ramp_time * (bpm_ + bpm) * 0.5f / 60.f * kTicksPerBeat;
+    bpm_per_tick_     = (bpm - bpm_) / (ticks > 1.f ? ticks : 1.f);
+}
+
+float SequencerClock::GetTempo() const
+{
+    return external_ ? 60.f * sample_rate_ / (pulse_interval_ * kPulsesPerBeat)
+                     : bpm_;
+}
+
+void SequencerClock::SetExternal(bool external)
+{
+    external_ = external;
+    waiting_  = false;
+    pulses_   = tick_ / kTicksPerPulse;
+}
+
+void SequencerClock::ExternalPulse(size_t offset)
+{
+    const uint32_t now = time_ + static_cast<uint32_t>(offset);
+    if(pulse_seen_)
+    {
+        // Smooth out the jitter of pulses that arrive once per block.
+        const float interval = static_cast<float>(now - last_pulse_time_);
+        pulse_interval_ += 0.25f * (interval - pulse_interval_);
+    }
+    last_pulse_time_ = now;
+    pulse_seen_      = true;
+
+    // Clock keeps coming while stopped, only the tempo follows it then.
+    if(!running_)
+    {
+        return;
+    }
+    pulses_++;
+    if(waiting_)
+    {
+        next_tick_ = static_cast<float>(offset);
+        waiting_   = false;
+    }
+}
+
+void SequencerClock::Start()
+{
+    tick_      = 0;
+    pulses_    = 0;
+    next_tick_ = 0.f;
+    running_   = true;
+    waiting_   = false;
+}
+
+void SequencerClock::Stop()
+{
+    running_ = false;
+}
+
+void SequencerClock::Continue()
+{
+    running_ = true;
+}
+
+float SequencerClock::SamplesPerTick() const
+{
+    if(!external_)
+    {
+        return 60.f * sample_rate_ / (bpm_ * kTicksPerBeat);
+    }
+    const float per_tick = pulse_interval_ / kTicksPerPulse;
+    // Twice as fast while more than a pulse behind
+    const bool behind = static_cast<int32_t>(pulses_ * kTicksPerPulse - tick_)
+                        > static_cast<int32_t>(kTicksPerPulse);
+    return behind ? per_tick * 0.5f : per_tick;
+}
+
+float SequencerClock::Ramp(float bpm) const
+{
+    if(bpm_per_tick_ == 0.f)
+    {
+        return bpm;
+    }
+    bpm += bpm_per_tick_;
+    const bool done = bpm_per_tick_ > 0.f ? bpm >= target_bpm_
+                                          : bpm <= target_bpm_;
+    return done ? target_bpm_ : bpm;
+}
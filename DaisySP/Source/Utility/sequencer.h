@@ -0,0 +1,429 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SEQUENCER_H
+#define DSY_SEQUENCER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @file sequencer.h */
+
+namespace daisysp
+{
+/** Something that happens at a given sample */
+struct SequencerEvent
+{
+    uint32_t time;  /**< Sample time, see SequencerClock::GetTime() */
+    uint32_t step;  /**< Steps since the sequencer restarted */
+    uint16_t track; /**< Track of the event */
+    float    value; /**< Value of the step, e.g. a velocity */
+};
+
+/** Fixed capacity queue of events, kept in time order.
+
+Events that are pushed in time order, as a sequencer does, go straight to
+the back. Events with the same time come out in the order they went in.
+Times wrap around, so only events less than 2^31 samples apart compare
+correctly.
+*/
+template <size_t capacity>
+class EventQueue
+{
+  public:
+    EventQueue() {}
+    ~EventQueue() {}
+
+    /** Empties the queue */
+    void Init()
+    {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    /** Adds an event in time order
+        \param event Event to add
+        \return false if the queue is full and the event was dropped
+    */
+    bool Push(const SequencerEvent& event)
+    {
+        if(size_ == capacity)
+        {
+            return false;
+        }
+        // Move later events up by one
+        size_t i = size_;
+        while(i > 0 && IsBefore(event.time, At(i - 1).time))
+        {
+            At(i) = At(i - 1);
+            i--;
+        }
+        At(i) = event;
+        size_++;
+        return true;
+    }
+
+    /** \return The earliest event. The queue must not be empty. */
+    inline const SequencerEvent& Front() const { return events_[head_]; }
+
+    /** Removes the earliest event */
+    inline void Pop()
+    {
+        head_ = head_ + 1 < capacity ? head_ + 1 : 0;
+        size_--;
+    }
+
+    /** \return Whether the earliest event is due before time
+        \param time Sample time
+    */
+    inline bool IsDueBefore(uint32_t time) const
+    {
+        return size_ > 0 && IsBefore(Front().time, time);
+    }
+
+    inline bool   IsEmpty() const { return size_ == 0; }
+    inline size_t GetSize() const { return size_; }
+
+    /** \return Whether a comes before b, allowing for wrap around */
+    static inline bool IsBefore(uint32_t a, uint32_t b)
+    {
+        return static_cast<int32_t>(a - b) < 0;
+    }
+
+  private:
+    inline SequencerEvent& At(size_t i)
+    {
+        const size_t idx = head_ + i;
+        return events_[idx < capacity ? idx : idx - capacity];
+    }
+
+    SequencerEvent events_[capacity];
+    size_t         head_, size_;
+};
+
+/** Tick clock for sequencing, with tempo ramps and MIDI clock sync.
+
+The clock divides beats into kTicksPerBeat ticks, and finds the sample
+each tick falls on, so sequences stay in time whatever the block size.
+
+With SetExternal(true), it follows MIDI clock instead. Call ExternalPulse()
+for every Timing Clock message, and Start(), Stop() and Continue() for the
+transport messages. The tempo is measured from the pulses, and the ticks
+between pulses are spread out evenly. The clock never runs ahead of the
+pulses, and catches up when it falls behind. With libDaisy's MidiHandler,
+which passes on the sample each pulse falls on:
+
+\code
+midi.ProcessEvents(size, [](const MidiEvent& msg, size_t offset) {
+    if(msg.type == SystemRealTime)
+    {
+        switch(msg.srt_type)
+        {
+            case TimingClock: clock.ExternalPulse(offset); break;
+            case Start: clock.Start(); break;
+            case Stop: clock.Stop(); break;
+            case Continue: clock.Continue(); break;
+            default: break;
+        }
+    }
+});
+\endcode
+
+Handle the MIDI events in the audio callback, before Process(), or make sure
+they don't run at the same time.
+*/
+class SequencerClock
+{
+  public:
+    static constexpr uint32_t kTicksPerBeat  = 96; /**< Resolution */
+    static constexpr uint32_t kPulsesPerBeat = 24; /**< MIDI clock rate */
+    static constexpr uint32_t kTicksPerPulse = kTicksPerBeat / kPulsesPerBeat;
+
+    SequencerClock() {}
+    ~SequencerClock() {}
+
+    /** Initializes the clock, running from tick 0
+        \param sample_rate Audio engine sample rate
+        \param bpm Tempo in beats per minute
+    */
+    void Init(float sample_rate, float bpm = 120.f);
+
+    /** Changes the tempo, at once or gradually
+        \param bpm Tempo in beats per minute
+        \param ramp_time Seconds to get there, 0 for an immediate change
+    */
+    void SetTempo(float bpm, float ramp_time = 0.f);
+
+    /** \return The current tempo in beats per minute. In external mode,
+        the tempo measured from the MIDI clock. */
+    float GetTempo() const;
+
+    /** Follows MIDI clock pulses instead of the tempo
+        \param external true for MIDI clock
+    */
+    void SetExternal(bool external);
+
+    /** Counts a MIDI Timing Clock pulse
+        \param offset Sample offset of the pulse in the next block
+    */
+    void ExternalPulse(size_t offset = 0);
+
+    /** Restarts from tick 0. In external mode, tick 0 falls on the next
+        pulse. */
+    void Start();
+
+    /** Stops, keeping the position */
+    void Stop();
+
+    /** Carries on from where Stop() left off */
+    void Continue();
+
+    /** \return Whether the clock is running */
+    inline bool IsRunning() const { return running_; }
+
+    /** \return The next tick to come */
+    inline uint32_t GetTick() const { return tick_; }
+
+    /** \return The sample time at the start of the next block */
+    inline uint32_t GetTime() const { return time_; }
+
+    /** Advances by a block, finding the ticks in it
+        \param size Block size
+        \param on_tick Called as on_tick(offset, tick) for each tick, in
+        order, with the tick's offset in the block
+    */
+    template <typename F>
+    void Process(size_t size, F&& on_tick)
+    {
+        if(running_)
+        {
+            const float len = static_cast<float>(size);
+            float       t   = next_tick_;
+            while(t < len)
+            {
+                if(external_ && !EnoughPulses())
+                {
+                    // Wait for the next pulse
+                    waiting_ = true;
+                    break;
+                }
+                on_tick(static_cast<size_t>(t), tick_);
+                tick_++;
+                t += SamplesPerTick();
+                bpm_ = Ramp(bpm_);
+            }
+            next_tick_ = waiting_ ? 0.f : t - len;
+        }
+        time_ += static_cast<uint32_t>(size);
+    }
+
+  private:
+    inline bool EnoughPulses() const
+    {
+        return static_cast<int32_t>(pulses_ * kTicksPerPulse - tick_) > 0;
+    }
+
+    float SamplesPerTick() const;
+    float Ramp(float bpm) const;
+
+    float    sample_rate_, bpm_, target_bpm_, bpm_per_tick_;
+    float    next_tick_; // samples from the block start to the next tick
+    float    pulse_interval_;
+    uint32_t tick_, time_, pulses_, last_pulse_time_;
+    bool     running_, external_, waiting_, pulse_seen_;
+};
+
+/** Step sequencer that splits audio blocks at its events.
+
+Tracks hold a value per step, 0 for a rest. Process() renders the block in
+pieces, calling the event function at the exact sample of each step, so the
+voices are triggered on time without checking for triggers every sample:
+
+\code
+StepSequencer<3, 16> seq;
+
+seq.Process(
+    size,
+    [](const SequencerEvent& e) { drums[e.track].Trig(); },
+    [&](size_t offset, size_t length) {
+        for(size_t i = offset; i < offset + length; i++)
+            out[0][i] = out[1][i] = drums[0].Process() + drums[1].Process();
+    });
+\endcode
+
+Odd steps can be swung, and one-off events scheduled with Schedule().
+
+\tparam num_tracks Number of tracks
+\tparam max_steps Longest pattern
+\tparam queue_size Events that can be pending at once
+*/
+template <size_t num_tracks, size_t max_steps, size_t queue_size = 32>
+class StepSequencer
+{
+  public:
+    StepSequencer() {}
+    ~StepSequencer() {}
+
+    /** Initializes an empty pattern of max_steps sixteenth notes
+        \param sample_rate Audio engine sample rate
+        \param bpm Tempo in beats per minute
+    */
+    void Init(float sample_rate, float bpm = 120.f)
+    {
+        clock_.Init(sample_rate, bpm);
+        queue_.Init();
+        length_      = max_steps;
+        step_ticks_  = SequencerClock::kTicksPerBeat / 4;
+        swing_       = 0.5f;
+        swing_ticks_ = 0;
+        for(size_t t = 0; t < num_tracks; t++)
+        {
+            for(size_t s = 0; s < max_steps; s++)
+            {
+                steps_[t][s] = 0.f;
+            }
+        }
+    }
+
+    /** \return The clock, for the tempo and MIDI sync */
+    inline SequencerClock& GetClock() { return clock_; }
+
+    /** \param steps Pattern length, 1 to max_steps */
+    inline void SetLength(size_t steps)
+    {
+        length_ = steps < 1 ? 1 : (steps > max_steps ? max_steps : steps);
+    }
+
+    /** \param ticks Length of a step in ticks, 24 for sixteenth notes */
+    inline void SetStepTicks(uint32_t ticks)
+    {
+        step_ticks_ = ticks > 0 ? ticks : 1;
+        SetSwing(swing_);
+    }
+
+    /** Delays every odd step
+        \param swing 0.5 for straight time, 0.75 at most. 2/3 gives triplets.
+    */
+    inline void SetSwing(float swing)
+    {
+        swing_       = swing < 0.5f ? 0.5f : (swing > 0.75f ? 0.75f : swing);
+        swing_ticks_ = static_cast<uint32_t>(
+            (swing_ - 0.5f) * 2.f * step_ticks_ + 0.5f);
+    }
+
+    /** \param track Track
+        \param step Step
+        \param value Value passed with the event, 0 for a rest
+    */
+    inline void SetStep(size_t track, size_t step, float value)
+    {
+        steps_[track][step] = value;
+    }
+
+    /** \return The value of a step */
+    inline float GetStep(size_t track, size_t step) const
+    {
+        return steps_[track][step];
+    }
+
+    /** Starts the pattern over at the start of the next block */
+    void Restart()
+    {
+        clock_.Start();
+        queue_.Init();
+    }
+
+    /** Schedules a one-off event
+        \param delay Samples from the start of the next block
+        \param track Track passed with the event
+        \param value Value passed with the event
+        \return false if the queue is full
+    */
+    bool Schedule(uint32_t delay, uint16_t track, float value)
+    {
+        return queue_.Push({clock_.GetTime() + delay, 0, track, value});
+    }
+
+    /** Runs a block, splitting it at the events that fall in it
+        \param size Block size
+        \param on_event Called as on_event(const SequencerEvent&) for each
+        event, before the samples from the event on are rendered
+        \param render Called as render(offset, length) for each piece of
+        the block, in order. The pieces cover the whole block.
+    */
+    template <typename EventFunc, typename RenderFunc>
+    void Process(size_t size, EventFunc&& on_event, RenderFunc&& render)
+    {
+        const uint32_t start = clock_.GetTime();
+        clock_.Process(size, [this, start](size_t offset, uint32_t tick) {
+            uint32_t step;
+            if(IsStep(tick, step))
+            {
+                const size_t idx = step % length_;
+                for(size_t t = 0; t < num_tracks; t++)
+                {
+                    if(steps_[t][idx] != 0.f)
+                    {
+                        queue_.Push({start + static_cast<uint32_t>(offset),
+                                     step,
+                                     static_cast<uint16_t>(t),
+                                     steps_[t][idx]});
+                    }
+                }
+            }
+        });
+
+        size_t pos = 0;
+        while(pos < size)
+        {
+            while(queue_.IsDueBefore(start + static_cast<uint32_t>(pos) + 1))
+            {
+                on_event(queue_.Front());
+                queue_.Pop();
+            }
+            size_t next = size;
+            if(queue_.IsDueBefore(start + static_cast<uint32_t>(size)))
+            {
+                next = queue_.Front().time - start;
+            }
+            render(pos, next - pos);
+            pos = next;
+        }
+    }
+
+  private:
+    /** \return Whether a step starts on the tick, allowing for swing */
+    inline bool IsStep(uint32_t tick, uint32_t& step) const
+    {
+        if(tick % step_ticks_ == 0
+           && (swing_ticks_ == 0 || (tick / step_ticks_) % 2 == 0))
+        {
+            step = tick / step_ticks_;
+            return true;
+        }
+        const uint32_t late = tick - swing_ticks_;
+        if(swing_ticks_ > 0 && tick >= swing_ticks_ && late % step_ticks_ == 0
+           && (late / step_ticks_) % 2 == 1)
+        {
+            step = late / step_ticks_;
+            return true;
+        }
+        return false;
+    }
+
+    SequencerClock         clock_;
+    EventQueue<queue_size> queue_;
+    float                  steps_[num_tracks][max_steps];
+    size_t                 length_;
+    uint32_t               step_ticks_, swing_ticks_;
+    float                  swing_;
+};
+
+} // namespace daisysp
+#endif
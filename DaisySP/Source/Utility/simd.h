@@ -0,0 +1,208 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+/** Minimal 4-lane float vector used by the batched DSP kernels.
+
+Maps onto SSE on x86 and NEON on ARM cores that have it.
+Everywhere else (including the Cortex-M7 on the Daisy) it falls back to
+plain scalar code behind the same interface, which the compiler is free to unroll.
+Define DSY_NO_SIMD to force the scalar fallback.
+*/
+#pragma once
+#ifndef DSY_SIMD_H
+#define DSY_SIMD_H
+
+#if !defined(DSY_NO_SIMD) && (defined(__SSE__) || defined(_M_X64))
+#define DSY_SIMD_SSE
+#include <xmmintrin.h>
+#elif !defined(DSY_NO_SIMD) && defined(__ARM_NEON)
+#define DSY_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace daisysp
+{
+/** Four floats processed in lockstep.
+    Load() and Store() accept unaligned pointers.
+*/
+class Float4
+{
+  public:
+    static constexpr int kWidth = 4;
+
+    Float4() {}
+
+    static inline Float4 Zero() { return Broadcast(0.0f); }
+
+#if defined(DSY_SIMD_SSE)
+    static inline Float4 Broadcast(float x) { return Float4(_mm_set1_ps(x)); }
+    static inline Float4 Load(const float* p) { return Float4(_mm_loadu_ps(p)); }
+    inline void          Store(float* p) const { _mm_storeu_ps(p, v_); }
+
+    /** Sum of the four lanes */
+    inline float Sum() const
+    {
+        __m128 s = _mm_add_ps(v_, _mm_movehl_ps(v_, v_));
+        s        = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+        return _mm_cvtss_f32(s);
+    }
+
+    friend inline Float4 operator+(Float4 a, Float4 b)
+    {
+        return Float4(_mm_add_ps(a.v_, b.v_));
+    }
+    friend inline Float4 operator-(Float4 a, Float4 b)
+    {
+        return Float4(_mm_sub_ps(a.v_, b.v_));
+    }
+    friend inline Float4 operator*(Float4 a, Float4 b)
+    {
+        return Float4(_mm_mul_ps(a.v_, b.v_));
+    }
+    friend inline Float4 operator/(Float4 a, Float4 b)
+    {
+        return Float4(_mm_div_ps(a.v_, b.v_));
+    }
+    friend inline Float4 Min(Float4 a, Float4 b)
+    {
+        return Float4(_mm_min_ps(a.v_, b.v_));
+    }
+    friend inline Float4 Max(Float4 a, Float4 b)
+    {
+        return Float4(_mm_max_ps(a.v_, b.v_));
+    }
+
+  private:
+    explicit Float4(__m128 v) : v_(v) {}
+    __m128 v_;
+
+#elif defined(DSY_SIMD_NEON)
+    static inline Float4 Broadcast(float x) { return Float4(vdupq_n_f32(x)); }
+    static inline Float4 Load(const float* p) { return Float4(vld1q_f32(p)); }
+    inline void          Store(float* p) const { vst1q_f32(p, v_); }
+
+    /** Sum of the four lanes */
+    inline float Sum() const
+    {
+#if defined(__aarch64__)
+        return vaddvq_f32(v_);
+#else
+        float32x2_t s = vadd_f32(vget_low_f32(v_), vget_high_f32(v_));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+    }
+
+    friend inline Float4 operator+(Float4 a, Float4 b)
+    {
+        return Float4(vaddq_f32(a.v_, b.v_));
+    }
+    friend inline Float4 operator-(Float4 a, Float4 b)
+    {
+        return Float4(vsubq_f32(a.v_, b.v_));
+    }
+    friend inline Float4 operator*(Float4 a, Float4 b)
+    {
+        return Float4(vmulq_f32(a.v_, b.v_));
+    }
+    friend inline Float4 operator/(Float4 a, Float4 b)
+    {
+#if defined(__aarch64__)
+        return Float4(vdivq_f32(a.v_, b.v_));
+#else
+        // Reciprocal estimate refined with two Newton-Raphson steps.
+        float32x4_t r = vrecpeq_f32(b.v_);
+        r             = vmulq_f32(vrecpsq_f32(b.v_, r), r);
+        r             = vmulq_f32(vrecpsq_f32(b.v_, r), r);
+        return Float4(vmulq_f32(a.v_, r));
+#endif
+    }
+    friend inline Float4 Min(Float4 a, Float4 b)
+    {
+        return Float4(vminq_f32(a.v_, b.v_));
+    }
+    friend inline Float4 Max(Float4 a, Float4 b)
+    {
+        return Float4(vmaxq_f32(a.v_, b.v_));
+    }
+
+  private:
+    explicit Float4(float32x4_t v) : v_(v) {}
+    float32x4_t v_;
+
+#else
+    static inline Float4 Broadcast(float x)
+    {
+        Float4 r;
+        for(int i = 0; i < kWidth; i++)
+        {
+            r.v_[i] = x;
+        }
+        return r;
+    }
+    static inline Float4 Load(const float* p)
+    {
+        Float4 r;
+        for(int i = 0; i < kWidth; i++)
+        {
+            r.v_[i] = p[i];
+        }
+        return r;
+    }
+    inline void Store(float* p) const
+    {
+        for(int i = 0; i < kWidth; i++)
+        {
+            p[i] = v_[i];
+        }
+    }
+
+    /** Sum of the four lanes */
+    inline float Sum() const { return (v_[0] + v_[2]) + (v_[1] + v_[3]); }
+
+    friend inline Float4 operator+(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x + y; });
+    }
+    friend inline Float4 operator-(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x - y; });
+    }
+    friend inline Float4 operator*(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x * y; });
+    }
+    friend inline Float4 operator/(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x / y; });
+    }
+    friend inline Float4 Min(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x < y ? x : y; });
+    }
+    friend inline Float4 Max(Float4 a, Float4 b)
+    {
+        return Apply(a, b, [](float x, float y) { return x > y ? x : y; });
+    }
+
+  private:
+    template <typename Op>
+    static inline Float4 Apply(Float4 a, Float4 b, Op op)
+    {
+        Float4 r;
+        for(int i = 0; i < kWidth; i++)
+        {
+            r.v_[i] = op(a.v_[i], b.v_[i]);
+        }
+        return r;
+    }
+    float v_[kWidth];
+#endif
+};
+
+} // namespace daisysp
+#endif
@@ -0,0 +1,147 @@
+#include "smoothedvalue.h"
+#include <math.h>
+
+using namespace daisysp;
+
+void SmoothedValue::Init(float sample_rate, float time, Mode mode, float value)
+{
+    sample_rate_ = sample_rate;
+    mode_        = mode;
+    value_       = value;
+    target_      = value;
+    reported_    = value;
+    inc_         = 0.f;
+    remaining_   = 0;
+    dirty_       = true;
+    SetTime(time);
+}
+
+void SmoothedValue::SetTime(float time)
+{
+    time          = time > 0.f ? time : 0.f;
+    ramp_samples_ = static_cast<size_t>(time * sample_rate_ + 0.5f);
+    // 1% of the distance left after ramp_samples_
+    gain_ = ramp_samples_ > 0 ? expf(logf(0.01f) / ramp_samples_) : 0.f;
+    block_size_ = 0;
+}
+
+void SmoothedValue::SetTarget(float target)
+{
+    if(target == target_)
+    {
+        return;
+    }
+    target_ = target;
+    if(ramp_samples_ == 0)
+    {
+        value_     = target;
+        remaining_ = 0;
+        return;
+    }
+    if(mode_ == LINEAR)
+    {
+        remaining_ = ramp_samples_;
+        inc_       = (target_ - value_) / ramp_samples_;
+    }
+    else
+    {
+        // By then the step has shrunk to -80dB
+        remaining_ = 2 * ramp_samples_;
+    }
+}
+
+void SmoothedValue::SetValue(float value)
+{
+    value_     = value;
+    target_    = value;
+    remaining_ = 0;
+    dirty_     = true;
+}
+
+float SmoothedValue::Process()
+{
+    if(remaining_ > 0)
+    {
+        value_ = mode_ == LINEAR ? value_ + inc_
+                                 : target_ + (value_ - target_) * gain_;
+        if(--remaining_ == 0)
+        {
+            value_ = target_;
+        }
+    }
+    return value_;
+}
+
+bool SmoothedValue::ProcessBlock(float* out, size_t size)
+{
+    const size_t n = remaining_ < size ? remaining_ : size;
+    if(mode_ == LINEAR)
+    {
+        // No dependency between the samples, so this vectorizes.
+        const float start = value_, inc = inc_;
+        for(size_t i = 0; i < n; i++)
+        {
+            out[i] = start + inc * static_cast<float>(i + 1);
+        }
+        value_ = start + inc * static_cast<float>(n);
+    }
+    else
+    {
+        const float target = target_, gain = gain_;
+        float       d      = value_ - target;
+        for(size_t i = 0; i < n; i++)
+        {
+            d *= gain;
+            out[i] = target + d;
+        }
+        value_ = target + d;
+    }
+    remaining_ -= n;
+    if(remaining_ == 0)
+    {
+        value_ = target_;
+    }
+    for(size_t i = n; i < size; i++)
+    {
+        out[i] = value_;
+    }
+    return Changed();
+}
+
+bool SmoothedValue::Advance(size_t size)
+{
+    const size_t n = remaining_ < size ? remaining_ : size;
+    remaining_ -= n;
+    if(remaining_ == 0)
+    {
+        value_ = target_;
+    }
+    else if(mode_ == LINEAR)
+    {
+        value_ += inc_ * static_cast<float>(n);
+    }
+    else
+    {
+        value_ = target_ + (value_ - target_) * BlockGain(n);
+    }
+    return Changed();
+}
+
+bool SmoothedValue::Changed()
+{
+    const bool changed = dirty_ || value_ != reported_;
+    reported_          = value_;
+    dirty_             = false;
+    return changed;
+}
+
+float SmoothedValue::BlockGain(size_t size)
+{
+    // Blocks are usually all the same size, so this is worked out once.
+    if(size != block_size_)
+    {
+        block_size_ = size;
+        block_gain_ = powf(gain_, static_cast<float>(size));
+    }
+    return block_gain_;
+}
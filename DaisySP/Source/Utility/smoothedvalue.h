@@ -0,0 +1,128 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_SMOOTHEDVALUE_H
+#define DSY_SMOOTHEDVALUE_H
+
+#include <stddef.h>
+
+/** @file smoothedvalue.h */
+
+namespace daisysp
+{
+/** Parameter smoothing for values set at control rate.
+
+Controls are read once per block, and SetTarget() passes the new value on.
+The value then glides there, either in a straight line or exponentially.
+A value that's used per sample, like a gain, is rendered into a buffer for
+the audio loop with ProcessBlock(). A value that goes into a module's
+coefficients, like a filter cutoff, is stepped once per block with
+Advance(), and the coefficients are only worked out again when it moved:
+
+\code
+// once per block, e.g. right after hw.ProcessAnalogControls()
+cutoff.SetTarget(cutoff_knob.Value());
+gain.SetTarget(gain_knob.Value());
+
+if(cutoff.Advance(size))
+    filter.SetFreq(cutoff.GetValue());
+gain.ProcessBlock(gain_buf, size);
+
+for(size_t i = 0; i < size; i++)
+{
+    filter.Process(in[0][i]);
+    out[0][i] = filter.Low() * gain_buf[i];
+}
+\endcode
+*/
+class SmoothedValue
+{
+  public:
+    /** Shape of the glide */
+    enum Mode
+    {
+        LINEAR,   /**< Straight line, arriving after the glide time */
+        ONE_POLE, /**< Exponential, 99% of the way after the glide time, and
+                        there after twice the glide time */
+    };
+
+    SmoothedValue() {}
+    ~SmoothedValue() {}
+
+    /** Initializes the value, at rest
+        \param sample_rate Audio engine sample rate
+        \param time Glide time in seconds
+        \param mode Shape of the glide
+        \param value Starting value
+    */
+    void Init(float sample_rate,
+              float time  = 0.01f,
+              Mode  mode  = LINEAR,
+              float value = 0.f);
+
+    /** \param time Glide time in seconds, 0 to jump straight to targets.
+        Takes effect from the next target on. */
+    void SetTime(float time);
+
+    /** Glides to a new value. Setting the same target again doesn't
+        restart the glide.
+        \param target New value
+    */
+    void SetTarget(float target);
+
+    /** Jumps to a value, without gliding
+        \param value New value
+    */
+    void SetValue(float value);
+
+    /** \return The next sample of the glide */
+    float Process();
+
+    /** Renders a block of the glide
+        \param out Output buffer, size samples long
+        \param size Number of samples
+        \return Whether the value changed since the last block
+    */
+    bool ProcessBlock(float* out, size_t size);
+
+    /** Moves on by a block without rendering it, for values that are used
+        once per block
+        \param size Number of samples
+        \return Whether the value changed since the last block. The first
+        call after Init() or SetValue() returns true.
+    */
+    bool Advance(size_t size);
+
+    /** \return Whether the value is still on its way to the target */
+    inline bool IsSmoothing() const { return remaining_ > 0; }
+
+    /** \return The current value */
+    inline float GetValue() const { return value_; }
+
+    /** \return The value being glided to */
+    inline float GetTarget() const { return target_; }
+
+  private:
+    bool  Changed();
+    float BlockGain(size_t size);
+
+    float  sample_rate_;
+    float  value_, target_, reported_;
+    float  inc_;            // per sample, linear
+    float  gain_;           // per sample, one pole
+    float  block_gain_;     // gain_ ^ block_size_
+    size_t block_size_;     // size block_gain_ was worked out for
+    size_t ramp_samples_;   // length of a linear glide
+    size_t remaining_;      // samples left of the glide
+    Mode   mode_;
+    bool   dirty_;
+};
+
+} // namespace daisysp
+#endif
@@ -0,0 +1,364 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+#pragma once
+#ifndef DSY_VOICEPOOL_H
+#define DSY_VOICEPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Utility/dsp.h"
+#include "Control/adsr.h"
+#include "Synthesis/oscillator.h"
+
+namespace daisysp
+{
+/** Polyphonic voice pool with note stealing.
+
+Voices that have gone silent are skipped entirely, so an idle voice costs nothing to render.
+When every voice is busy, a new note steals one according to the StealMode.
+
+The voice type must provide:
+
+- void Init(float sample_rate)
+- void NoteOn(float note, float velocity), note is a MIDI note number, velocity is 0-1
+- void NoteOff()
+- bool IsActive() const, false once the voice is silent
+- void ProcessBlock(float* out, size_t size), overwriting out
+
+OscillatorAdsrVoice and TriggeredVoice below adapt the existing DaisySP modules to this interface.
+
+declaration example:
+
+VoicePool<TriggeredVoice<StringVoice>, 8> strings;
+
+*/
+template <typename VoiceType, size_t num_voices>
+class VoicePool
+{
+  public:
+    /** Which voice a new note takes over when none are free */
+    enum StealMode
+    {
+        STEAL_OLDEST,    /**< The voice that was started first */
+        STEAL_QUIETEST,  /**< The voice with the lowest output level */
+        STEAL_SAME_NOTE, /**< Retrigger a voice already playing the note, otherwise the oldest */
+    };
+
+    VoicePool() {}
+    ~VoicePool() {}
+
+    /** Initializes every voice
+        \param sample_rate Audio engine sample rate
+    */
+    void Init(float sample_rate)
+    {
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            voices_[i].Init(sample_rate);
+            state_[i].note  = -1.f;
+            state_[i].age   = 0;
+            state_[i].level = 0.f;
+            state_[i].gate  = false;
+        }
+        counter_ = 0;
+        mode_    = STEAL_OLDEST;
+    }
+
+    /** Sets how voices are stolen when all of them are busy
+        \param mode One of the StealMode values
+    */
+    inline void SetStealMode(StealMode mode) { mode_ = mode; }
+
+    /** Starts a note on a free voice, stealing one if necessary
+        \param note MIDI note number
+        \param velocity 0-1
+        \return Index of the voice that plays the note
+    */
+    size_t NoteOn(float note, float velocity)
+    {
+        const size_t idx = FindVoice(note);
+        state_[idx].note  = note;
+        state_[idx].age   = ++counter_;
+        state_[idx].gate  = true;
+        state_[idx].level = velocity;
+        voices_[idx].NoteOn(note, velocity);
+        return idx;
+    }
+
+    /** Releases every held voice playing the note
+        \param note MIDI note number
+    */
+    void NoteOff(float note)
+    {
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            if(state_[i].gate && state_[i].note == note)
+            {
+                state_[i].gate = false;
+                voices_[i].NoteOff();
+            }
+        }
+    }
+
+    /** Releases every held voice */
+    void AllNotesOff()
+    {
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            if(state_[i].gate)
+            {
+                state_[i].gate = false;
+                voices_[i].NoteOff();
+            }
+        }
+    }
+
+    /** Renders and sums every active voice
+        \param out Output buffer, overwritten
+        \param size Number of samples
+    */
+    void ProcessBlock(float* out, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = 0.f;
+        }
+        while(size > 0)
+        {
+            const size_t n = size < kMaxBlockSize ? size : kMaxBlockSize;
+            for(size_t v = 0; v < num_voices; v++)
+            {
+                if(!voices_[v].IsActive())
+                {
+                    state_[v].level = 0.f;
+                    continue;
+                }
+                voices_[v].ProcessBlock(scratch_, n);
+                float peak = 0.f;
+                for(size_t i = 0; i < n; i++)
+                {
+                    out[i] += scratch_[i];
+                    peak = fmax(peak, fabsf(scratch_[i]));
+                }
+                state_[v].level = peak;
+            }
+            out += n;
+            size -= n;
+        }
+    }
+
+    /** Renders a single sample of every active voice */
+    inline float Process()
+    {
+        float out;
+        ProcessBlock(&out, 1);
+        return out;
+    }
+
+    /** Number of voices currently producing sound */
+    size_t GetNumActiveVoices() const
+    {
+        size_t count = 0;
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            count += voices_[i].IsActive() ? 1 : 0;
+        }
+        return count;
+    }
+
+    /** Access to a voice, e.g. to change its parameters
+        \param idx 0 to num_voices - 1
+    */
+    inline VoiceType& GetVoice(size_t idx) { return voices_[idx]; }
+
+    /** Calls func with a reference to each voice, e.g. to set a parameter on all of them
+        \param func Callable taking a VoiceType&
+    */
+    template <typename F>
+    void ForEach(F func)
+    {
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            func(voices_[i]);
+        }
+    }
+
+  private:
+    static constexpr size_t kMaxBlockSize = 48;
+
+    struct VoiceState
+    {
+        float    note;
+        uint32_t age;   // value of counter_ at note on, lower is older
+        float    level; // peak of the last rendered block
+        bool     gate;
+    };
+
+    size_t FindVoice(float note) const
+    {
+        if(mode_ == STEAL_SAME_NOTE)
+        {
+            for(size_t i = 0; i < num_voices; i++)
+            {
+                if(state_[i].note == note && voices_[i].IsActive())
+                {
+                    return i;
+                }
+            }
+        }
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            if(!voices_[i].IsActive())
+            {
+                return i;
+            }
+        }
+
+        // Prefer voices that have been released over ones still held.
+        size_t best          = 0;
+        bool   best_released = false;
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            const bool released = !state_[i].gate;
+            if(released != best_released)
+            {
+                if(released)
+                {
+                    best          = i;
+                    best_released = true;
+                }
+                continue;
+            }
+            const bool better = mode_ == STEAL_QUIETEST
+                                    ? state_[i].level < state_[best].level
+                                    : state_[i].age - state_[best].age
+                                          > 0x7fffffffu; // wrap-safe older
+            if(better)
+            {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    VoiceType  voices_[num_voices];
+    VoiceState state_[num_voices];
+    float      scratch_[kMaxBlockSize];
+    uint32_t   counter_;
+    StealMode  mode_;
+};
+
+/** Oscillator shaped by an Adsr, for use in a VoicePool.
+    The oscillator and envelope can be reached with GetOscillator() and GetEnvelope().
+*/
+class OscillatorAdsrVoice
+{
+  public:
+    OscillatorAdsrVoice() {}
+    ~OscillatorAdsrVoice() {}
+
+    void Init(float sample_rate)
+    {
+        osc_.Init(sample_rate);
+        env_.Init(sample_rate);
+        gate_     = false;
+        velocity_ = 0.f;
+    }
+
+    void NoteOn(float note, float velocity)
+    {
+        osc_.SetFreq(mtof(note));
+        velocity_ = velocity;
+        gate_     = true;
+        // Soft retrigger, so a stolen voice restarts from its current level.
+        env_.Retrigger(false);
+    }
+
+    void NoteOff() { gate_ = false; }
+
+    bool IsActive() const { return gate_ || env_.IsRunning(); }
+
+    void ProcessBlock(float* out, size_t size)
+    {
+        osc_.ProcessBlock(out, size);
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] *= env_.Process(gate_) * velocity_;
+        }
+    }
+
+    inline Oscillator& GetOscillator() { return osc_; }
+    inline Adsr&       GetEnvelope() { return env_; }
+
+  private:
+    Oscillator osc_;
+    Adsr       env_;
+    bool       gate_;
+    float      velocity_;
+};
+
+/** Adapts a triggered model for use in a VoicePool.
+
+T must have Init(sample_rate), SetFreq(hz), SetAccent(0-1) and Process(bool trigger),
+which covers StringVoice, ModalVoice and the drum models.
+Velocity sets the accent. Since these models have no envelope to query,
+a voice counts as silent once its output has stayed below -80dB for 50ms.
+*/
+template <typename T>
+class TriggeredVoice
+{
+  public:
+    TriggeredVoice() {}
+    ~TriggeredVoice() {}
+
+    void Init(float sample_rate)
+    {
+        model_.Init(sample_rate);
+        hold_samples_   = static_cast<size_t>(sample_rate * 0.05f);
+        silent_samples_ = hold_samples_;
+        trig_           = false;
+    }
+
+    void NoteOn(float note, float velocity)
+    {
+        model_.SetFreq(mtof(note));
+        model_.SetAccent(velocity);
+        silent_samples_ = 0;
+        trig_           = true;
+    }
+
+    void NoteOff() {}
+
+    bool IsActive() const { return silent_samples_ < hold_samples_; }
+
+    void ProcessBlock(float* out, size_t size)
+    {
+        size_t silent = silent_samples_;
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = model_.Process(trig_);
+            trig_  = false;
+            silent = fabsf(out[i]) > kSilence ? 0 : silent + 1;
+        }
+        silent_samples_ = silent;
+    }
+
+    /** Access to the underlying model, e.g. to change its parameters */
+    inline T& GetModel() { return model_; }
+
+  private:
+    static constexpr float kSilence = 1e-4f;
+
+    T      model_;
+    size_t hold_samples_, silent_samples_;
+    bool   trig_;
+};
+
+} // namespace daisysp
+#endif
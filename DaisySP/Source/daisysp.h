@@ -23,6 +23,7 @@
 /** Drum Modules */
 #include "Drums/analogbassdrum.h"
 #include "Drums/analogsnaredrum.h"
+#include "Drums/drumrendercache.h"
 #include "Drums/hihat.h"
 #include "Drums/synthbassdrum.h"
 #include "Drums/synthsnaredrum.h"
@@ -34,6 +35,7 @@
 /** Effects Modules */
 #include "Effects/autowah.h"
 #include "Effects/chorus.h"
+#include "Effects/convolutionreverb.h"
 #include "Effects/decimator.h"
 #include "Effects/flanger.h"
 #include "Effects/overdrive.h"
@@ -44,8 +46,11 @@
 #include "Effects/wavefolder.h"
 
 /** Filter Modules */
+#include "Filters/biquad_fixed.h"
 #include "Filters/onepole.h"
+#include "Filters/onepole_fixed.h"
 #include "Filters/svf.h"
+#include "Filters/svf_fixed.h"
 #include "Filters/fir.h"
 #include "Filters/soap.h"
 
@@ -72,21 +77,33 @@
 #include "Synthesis/formantosc.h"
 #include "Synthesis/harmonic_osc.h"
 #include "Synthesis/oscillator.h"
+#include "Synthesis/oscillator_fixed.h"
 #include "Synthesis/oscillatorbank.h"
 #include "Synthesis/variablesawosc.h"
+#include "Synthesis/wavetableosc.h"
 #include "Synthesis/variableshapeosc.h"
 #include "Synthesis/vosim.h"
 #include "Synthesis/zoscillator.h"
 
 /** Utility Modules */
 #include "Utility/dcblock.h"
+#include "Utility/dcblock_fixed.h"
 #include "Utility/delayline.h"
+#include "Utility/delayline_fixed.h"
+#include "Utility/delayline_pow2.h"
 #include "Utility/dsp.h"
+#include "Utility/fastmath.h"
 #include "Utility/looper.h"
 #include "Utility/maytrig.h"
 #include "Utility/metro.h"
+#include "Utility/multitapdelay.h"
+#include "Utility/oversampler.h"
 #include "Utility/samplehold.h"
+#include "Utility/sequencer.h"
+#include "Utility/simd.h"
 #include "Utility/smooth_random.h"
+#include "Utility/smoothedvalue.h"
+#include "Utility/voicepool.h"
 
 /** LGPL Modules */
 #ifdef USE_DAISYSP_LGPL
@@ -0,0 +1,1751 @@
+/*
+Copyright (c) 2020 Electrosmith, Corp
+
+Use of this source code is governed by an MIT-style
+license that can be found in the LICENSE file or at
+https://opensource.org/licenses/MIT.
+*/
+
+/** Host side benchmark for the DaisySP modules.
+
+Every module is run over the same fixed-seed input at 48kHz,
+in blocks the size of a typical audio callback.
+The results can be written out as JSON, and compared against
+a previously written file to catch performance regressions.
+
+With --accuracy, the fixed point modules are compared against the float
+ones they follow instead, and their error is reported.
+
+Usage:
+    daisysp_bench [--samples N] [--block N] [--repeat N] [--filter text]
+                  [--json out.json] [--baseline in.json] [--threshold percent]
+                  [--accuracy]
+*/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "daisysp.h"
+
+using namespace daisysp;
+
+namespace
+{
+constexpr float  kSampleRate   = 48000.f;
+constexpr size_t kTriggerEvery = 12000; // 4 hits per second at 48kHz
+
+/** Processes one block. in and out never alias, and each call
+    continues where the previous one left off.
+*/
+using BlockFunction = std::function<void(const float* in, float* out, size_t size)>;
+
+/** Optional, called with the whole input before process() is timed */
+using PrepareFunction = std::function<void(const std::vector<float>& input)>;
+
+struct Benchmark
+{
+    Benchmark(std::string     name_    = "",
+              BlockFunction   process_ = nullptr,
+              PrepareFunction prepare_ = nullptr)
+    : name(std::move(name_)),
+      process(std::move(process_)),
+      prepare(std::move(prepare_))
+    {
+    }
+
+    std::string     name;
+    BlockFunction   process;
+    PrepareFunction prepare;
+};
+
+struct Result
+{
+    std::string name;
+    double      ns_per_sample;
+    double      samples_per_sec;
+};
+
+/** Small deterministic noise source, so every run sees the same input */
+class Xorshift
+{
+  public:
+    explicit Xorshift(uint32_t seed) : state_(seed) {}
+
+    float Process()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return static_cast<float>(state_) * (2.f / 4294967295.f) - 1.f;
+    }
+
+  private:
+    uint32_t state_;
+};
+
+/** Counts samples so per-sample modules can be re-triggered at a fixed rate */
+class TriggerClock
+{
+  public:
+    bool Process()
+    {
+        const bool trig = count_ == 0;
+        count_          = count_ + 1 < kTriggerEvery ? count_ + 1 : 0;
+        return trig;
+    }
+
+  private:
+    size_t count_ = 0;
+};
+
+/** Wraps a module with a float Process(float) style call */
+template <typename T, typename F>
+Benchmark MakeBenchmark(const char* name, std::shared_ptr<T> module, F per_sample)
+{
+    auto clock = std::make_shared<TriggerClock>();
+    return {name, [module, clock, per_sample](const float* in, float* out, size_t size) {
+                for(size_t i = 0; i < size; i++)
+                {
+                    out[i] = per_sample(*module, in[i], clock->Process());
+                }
+            }};
+}
+
+/** Runs a fixed point module on float blocks.
+    process is called as process(const T* in, T* out, size).
+    The input is converted up front by prepare(), as a fixed point pipeline
+    wouldn't convert it at all. Only converting the output back is timed.
+*/
+template <typename T, typename F>
+Benchmark MakeFixedBlock(F process)
+{
+    struct Buffers
+    {
+        const float*   input = nullptr;
+        std::vector<T> in, out;
+    };
+    auto buffers = std::make_shared<Buffers>();
+
+    Benchmark b;
+    b.prepare = [buffers](const std::vector<float>& input) {
+        buffers->input = input.data();
+        buffers->in.resize(input.size());
+        for(size_t i = 0; i < input.size(); i++)
+        {
+            buffers->in[i] = float_to_fixed<T>(input[i]);
+        }
+    };
+    b.process = [buffers, process](const float* in, float* out, size_t size) {
+        buffers->out.resize(size);
+        process(buffers->in.data() + (in - buffers->input), buffers->out.data(), size);
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = fixed_to_float(buffers->out[i]);
+        }
+    };
+    return b;
+}
+
+/** A float module and its q15 and q31 versions, all set up the same way.
+    Each factory returns a fresh instance.
+*/
+struct FixedPointComparison
+{
+    std::string                name;
+    bool                       float_is_listed; // as name, in CreateBenchmarks()
+    std::function<Benchmark()> make_float;
+    std::function<Benchmark()> make_q15;
+    std::function<Benchmark()> make_q31;
+};
+
+template <typename T>
+Benchmark MakeFixedOnePole()
+{
+    auto m = std::make_shared<fixed::OnePole<T>>();
+    m->Init();
+    m->SetFrequency(0.05f);
+    return MakeFixedBlock<T>([m](const T* in, T* out, size_t size) {
+        memcpy(out, in, size * sizeof(T));
+        m->ProcessBlock(out, size);
+    });
+}
+
+template <typename T>
+Benchmark MakeFixedSvf()
+{
+    auto m = std::make_shared<fixed::Svf<T>>();
+    m->Init(kSampleRate);
+    m->SetFreq(1000.f);
+    m->SetRes(0.5f);
+    return MakeFixedBlock<T>([m](const T* in, T* out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            m->Process(in[i]);
+            out[i] = m->Low();
+        }
+    });
+}
+
+/** Resonant lowpass at 1kHz, as direct form I biquad coefficients */
+void BiquadCoefficients(float& b0, float& b1, float& b2, float& a1, float& a2)
+{
+    const float w0    = TWOPI_F * 1000.f / kSampleRate;
+    const float alpha = sinf(w0) / (2.f * 2.f); // Q = 2
+    const float a0    = 1.f / (1.f + alpha);
+    b1                = (1.f - cosf(w0)) * a0;
+    b0                = 0.5f * b1;
+    b2                = b0;
+    a1                = -2.f * cosf(w0) * a0;
+    a2                = (1.f - alpha) * a0;
+}
+
+/** The float reference for fixed::Biquad, as DaisySP has no MIT licensed one */
+Benchmark MakeFloatBiquad()
+{
+    auto state = std::make_shared<std::vector<float>>(4, 0.f);
+    float b0, b1, b2, a1, a2;
+    BiquadCoefficients(b0, b1, b2, a1, a2);
+    return {"", [=](const float* in, float* out, size_t size) {
+        float& x1 = (*state)[0];
+        float& x2 = (*state)[1];
+        float& y1 = (*state)[2];
+        float& y2 = (*state)[3];
+        for(size_t i = 0; i < size; i++)
+        {
+            const float y = b0 * in[i] + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+            x2            = x1;
+            x1            = in[i];
+            y2            = y1;
+            y1            = y;
+            out[i]        = y;
+        }
+    }};
+}
+
+template <typename T>
+Benchmark MakeFixedBiquad()
+{
+    auto  m = std::make_shared<fixed::Biquad<T>>();
+    float b0, b1, b2, a1, a2;
+    BiquadCoefficients(b0, b1, b2, a1, a2);
+    m->Init(kSampleRate);
+    m->SetCoefficients(b0, b1, b2, a1, a2);
+    return MakeFixedBlock<T>([m](const T* in, T* out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = m->Process(in[i]);
+        }
+    });
+}
+
+template <typename T>
+Benchmark MakeFixedDcBlock()
+{
+    auto m = std::make_shared<fixed::DcBlock<T>>();
+    m->Init(kSampleRate);
+    return MakeFixedBlock<T>([m](const T* in, T* out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = m->Process(in[i]);
+        }
+    });
+}
+
+template <typename T>
+Benchmark MakeFixedDelayLine()
+{
+    using Delay = fixed::DelayLine<T, 48000>;
+    auto m      = std::make_shared<Delay>();
+    m->Init();
+    m->SetDelay(12000.5f);
+    return MakeFixedBlock<T>([m](const T* in, T* out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[i] = m->Read();
+            m->Write(in[i]);
+        }
+    });
+}
+
+/** Exact phase of a 220Hz oscillator, in cycles. The oscillators are reset to
+    it every block, so the float phase drifting over time doesn't count as error.
+*/
+class OscillatorPhase
+{
+  public:
+    float Advance(size_t size)
+    {
+        const float now = static_cast<float>(phase_);
+        phase_ += 220.0 / kSampleRate * size;
+        phase_ -= floor(phase_);
+        return now;
+    }
+
+  private:
+    double phase_ = 0.0;
+};
+
+template <typename T>
+Benchmark MakeFixedOscillator(uint8_t waveform)
+{
+    auto m     = std::make_shared<fixed::Oscillator<T>>();
+    auto phase = std::make_shared<OscillatorPhase>();
+    m->Init(kSampleRate);
+    m->SetFreq(220.f);
+    m->SetWaveform(waveform);
+    return MakeFixedBlock<T>([m, phase](const T*, T* out, size_t size) {
+        m->Reset(phase->Advance(size));
+        m->ProcessBlock(out, size);
+    });
+}
+
+/** Has to match the settings of the float modules in CreateBenchmarks() */
+std::vector<FixedPointComparison> CreateFixedPointComparisons()
+{
+    std::vector<FixedPointComparison> c;
+
+    c.push_back({"OnePole",
+                 true,
+                 [] {
+                     auto m = std::make_shared<OnePole>();
+                     m->Init();
+                     m->SetFrequency(0.05f);
+                     return Benchmark{"", [m](const float* in, float* out, size_t size) {
+                         memcpy(out, in, size * sizeof(float));
+                         m->ProcessBlock(out, size);
+                     }};
+                 },
+                 MakeFixedOnePole<q15>,
+                 MakeFixedOnePole<q31>});
+    c.push_back({"Svf",
+                 true,
+                 [] {
+                     auto m = std::make_shared<Svf>();
+                     m->Init(kSampleRate);
+                     m->SetFreq(1000.f);
+                     m->SetRes(0.5f);
+                     return Benchmark{"", [m](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             m->Process(in[i]);
+                             out[i] = m->Low();
+                         }
+                     }};
+                 },
+                 MakeFixedSvf<q15>,
+                 MakeFixedSvf<q31>});
+    c.push_back({"Biquad DF1", false, MakeFloatBiquad, MakeFixedBiquad<q15>, MakeFixedBiquad<q31>});
+    c.push_back({"DcBlock",
+                 true,
+                 [] {
+                     auto m = std::make_shared<DcBlock>();
+                     m->Init(kSampleRate);
+                     return Benchmark{"", [m](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Process(in[i]);
+                         }
+                     }};
+                 },
+                 MakeFixedDcBlock<q15>,
+                 MakeFixedDcBlock<q31>});
+    c.push_back({"DelayLine",
+                 true,
+                 [] {
+                     using Delay = DelayLine<float, 48000>;
+                     auto m      = std::make_shared<Delay>();
+                     m->Init();
+                     m->SetDelay(12000.5f);
+                     return Benchmark{"", [m](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Read();
+                             m->Write(in[i]);
+                         }
+                     }};
+                 },
+                 MakeFixedDelayLine<q15>,
+                 MakeFixedDelayLine<q31>});
+
+    const uint8_t kWaveforms[] = {Oscillator::WAVE_SIN, Oscillator::WAVE_POLYBLEP_SAW};
+    const char*   kWaveNames[] = {"Oscillator (sin)", "Oscillator (polyblep saw)"};
+    for(size_t w = 0; w < DSY_COUNTOF(kWaveforms); w++)
+    {
+        const uint8_t waveform = kWaveforms[w];
+        c.push_back({kWaveNames[w],
+                     true,
+                     [waveform] {
+                         auto m     = std::make_shared<Oscillator>();
+                         auto phase = std::make_shared<OscillatorPhase>();
+                         m->Init(kSampleRate);
+                         m->SetFreq(220.f);
+                         m->SetWaveform(waveform);
+                         return Benchmark{"", [m, phase](const float*, float* out, size_t size) {
+                             m->Reset(phase->Advance(size));
+                             m->ProcessBlock(out, size);
+                         }};
+                     },
+                     [waveform] { return MakeFixedOscillator<q15>(waveform); },
+                     [waveform] { return MakeFixedOscillator<q31>(waveform); }});
+    }
+    return c;
+}
+
+std::vector<Benchmark> CreateBenchmarks()
+{
+    std::vector<Benchmark> b;
+
+    // Control
+    {
+        auto m = std::make_shared<AdEnv>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("AdEnv", m, [](AdEnv& e, float, bool trig) {
+            if(trig)
+                e.Trigger();
+            return e.Process();
+        }));
+    }
+    {
+        auto m = std::make_shared<Adsr>();
+        m->Init(kSampleRate);
+        auto gate = std::make_shared<size_t>(0);
+        b.push_back(MakeBenchmark("Adsr", m, [gate](Adsr& e, float, bool) {
+            *gate = (*gate + 1) % kTriggerEvery;
+            return e.Process(*gate < kTriggerEvery / 2);
+        }));
+    }
+    {
+        auto m = std::make_shared<Phasor>();
+        m->Init(kSampleRate, 220.f);
+        b.push_back(MakeBenchmark(
+            "Phasor", m, [](Phasor& p, float, bool) { return p.Process(); }));
+    }
+
+    // Drums
+    {
+        auto m = std::make_shared<AnalogBassDrum>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "AnalogBassDrum", m, [](AnalogBassDrum& d, float, bool trig) {
+                return d.Process(trig);
+            }));
+    }
+    {
+        auto m = std::make_shared<AnalogSnareDrum>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "AnalogSnareDrum", m, [](AnalogSnareDrum& d, float, bool trig) {
+                return d.Process(trig);
+            }));
+    }
+    {
+        auto m = std::make_shared<HiHat<>>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("HiHat", m, [](HiHat<>& d, float, bool trig) {
+            return d.Process(trig);
+        }));
+    }
+    {
+        auto m = std::make_shared<SyntheticBassDrum>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "SyntheticBassDrum", m, [](SyntheticBassDrum& d, float, bool trig) {
+                return d.Process(trig);
+            }));
+    }
+    {
+        auto m = std::make_shared<SyntheticSnareDrum>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "SyntheticSnareDrum",
+            m,
+            [](SyntheticSnareDrum& d, float, bool trig) { return d.Process(trig); }));
+    }
+    {
+        // Six kits, rendered ahead of time and played in turn from the cache
+        using Cache = DrumRenderCache<SyntheticSnareDrum, 2, 6>;
+        auto memory = std::make_shared<std::vector<float>>(6 * 48000);
+        auto m      = std::make_shared<Cache>();
+        auto clock  = std::make_shared<TriggerClock>();
+        auto kit    = std::make_shared<size_t>(0);
+        static const float kKits[6][2]
+            = {{180.f, 0.3f}, {200.f, 0.4f}, {220.f, 0.2f}, {160.f, 0.5f}, {240.f, 0.3f}, {190.f, 0.1f}};
+        m->Init(
+            kSampleRate,
+            [](SyntheticSnareDrum& d, const float* p) {
+                d.SetFreq(p[0]);
+                d.SetDecay(p[1]);
+            },
+            memory->data(),
+            memory->size());
+        for(const auto& params : kKits)
+        {
+            m->Prerender(params);
+        }
+        b.push_back({"DrumRenderCache (6 kits)",
+                     [m, memory, clock, kit](const float*, float* out, size_t size) {
+                         bool trig = false;
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             trig = clock->Process() || trig;
+                         }
+                         if(trig)
+                         {
+                             *kit = (*kit + 1) % 6;
+                             m->SetParams(kKits[*kit]);
+                             m->Trig();
+                         }
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+
+    // Dynamics
+    {
+        auto m = std::make_shared<CrossFade>();
+        m->Init(CROSSFADE_CPOW);
+        m->SetPos(0.3f);
+        b.push_back(MakeBenchmark("CrossFade", m, [](CrossFade& c, float in, bool) {
+            float other = -in;
+            return c.Process(in, other);
+        }));
+    }
+    {
+        auto m = std::make_shared<Limiter>();
+        m->Init();
+        b.push_back({"Limiter", [m](const float* in, float* out, size_t size) {
+                         memcpy(out, in, size * sizeof(float));
+                         m->ProcessBlock(out, size, 2.f);
+                     }});
+    }
+
+    // Effects
+    {
+        auto m = std::make_shared<Autowah>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Autowah", m, [](Autowah& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<Chorus>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Chorus", m, [](Chorus& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        // One second of decaying noise, as a stand-in for a room response.
+        static constexpr size_t kLength = 48000;
+        auto m      = std::make_shared<ConvolutionReverb>();
+        auto buffer = std::make_shared<std::vector<float>>(
+            ConvolutionReverb::GetMemorySize(kLength));
+        std::vector<float> ir(kLength);
+        Xorshift           noise(42);
+        for(size_t i = 0; i < kLength; i++)
+        {
+            ir[i] = noise.Process() * 0.1f * expf(-6.9f * i / kLength);
+        }
+        m->Init(buffer->data(), buffer->size());
+        m->SetIR(ir.data(), kLength);
+        b.push_back({"ConvolutionReverb (1s)",
+                     [m, buffer](const float* in, float* out, size_t size) {
+                         for(size_t done = 0; done < size; done += 48)
+                         {
+                             const size_t n = size - done < 48 ? size - done : 48;
+                             m->ProcessBlock(in + done, out + done, n);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<Decimator>();
+        m->Init();
+        b.push_back(MakeBenchmark("Decimator", m, [](Decimator& e, float in, bool) {
+            return e.Process(in);
+        }));
+    }
+    {
+        auto m = std::make_shared<Flanger>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Flanger", m, [](Flanger& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<Overdrive>();
+        m->Init();
+        b.push_back(MakeBenchmark("Overdrive", m, [](Overdrive& e, float in, bool) {
+            return e.Process(in);
+        }));
+    }
+    {
+        auto m = std::make_shared<Oversampled<Overdrive, 4>>();
+        m->Init();
+        m->GetModel().Init();
+        b.push_back({"Overdrive (4x oversampled)",
+                     [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<Phaser>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Phaser", m, [](Phaser& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<PitchShifter>();
+        m->Init(kSampleRate);
+        m->SetTransposition(7.f);
+        b.push_back(MakeBenchmark(
+            "PitchShifter", m, [](PitchShifter& e, float in, bool) {
+                return e.Process(in);
+            }));
+    }
+    {
+        auto m = std::make_shared<SampleRateReducer>();
+        m->Init();
+        b.push_back(MakeBenchmark(
+            "SampleRateReducer", m, [](SampleRateReducer& e, float in, bool) {
+                return e.Process(in);
+            }));
+    }
+    {
+        auto m = std::make_shared<Tremolo>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Tremolo", m, [](Tremolo& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<Wavefolder>();
+        m->Init();
+        b.push_back(MakeBenchmark(
+            "Wavefolder", m, [](Wavefolder& e, float in, bool) {
+                return e.Process(in);
+            }));
+    }
+    {
+        auto m = std::make_shared<Oversampled<Wavefolder, 8>>();
+        m->Init();
+        m->GetModel().Init();
+        m->GetModel().SetGain(4.f);
+        b.push_back({"Wavefolder (8x oversampled)",
+                     [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+
+    // Filters
+    {
+        static constexpr size_t kTaps = 256;
+        using FirType                 = FIR<kTaps, 48>;
+        auto  m                       = std::make_shared<FirType>();
+        float ir[kTaps];
+        for(size_t i = 0; i < kTaps; i++)
+        {
+            ir[i] = 1.f / kTaps;
+        }
+        m->SetIR(ir, kTaps, false);
+        b.push_back({"FIR256", [m](const float* in, float* out, size_t size) {
+                         for(size_t done = 0; done < size; done += 48)
+                         {
+                             const size_t n = size - done < 48 ? size - done : 48;
+                             m->ProcessBlock(in + done, out + done, n);
+                         }
+                     }});
+    }
+    {
+        // A long filter, direct and with the partitioned FFT implementation
+        static constexpr size_t kTaps = 4096;
+        std::vector<float>      ir(kTaps);
+        Xorshift                noise(42);
+        for(size_t i = 0; i < kTaps; i++)
+        {
+            ir[i] = noise.Process() * 0.01f;
+        }
+        auto direct = std::make_shared<FIR<kTaps, 48>>();
+        direct->SetIR(ir.data(), kTaps, false);
+        b.push_back({"FIR4096", [direct](const float* in, float* out, size_t size) {
+                         for(size_t done = 0; done < size; done += 48)
+                         {
+                             const size_t n = size - done < 48 ? size - done : 48;
+                             direct->ProcessBlock(in + done, out + done, n);
+                         }
+                     }});
+        auto fft = std::make_shared<FIRFilterImplFFT<kTaps, 48>>();
+        fft->SetIR(ir.data(), kTaps, false);
+        b.push_back({"FIR4096 (FFT)", [fft](const float* in, float* out, size_t size) {
+                         for(size_t done = 0; done < size; done += 48)
+                         {
+                             const size_t n = size - done < 48 ? size - done : 48;
+                             fft->ProcessBlock(in + done, out + done, n);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<OnePole>();
+        m->Init();
+        m->SetFrequency(0.05f);
+        b.push_back({"OnePole", [m](const float* in, float* out, size_t size) {
+                         memcpy(out, in, size * sizeof(float));
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<Soap>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("Soap", m, [](Soap& f, float in, bool) {
+            f.Process(in);
+            return f.Bandpass();
+        }));
+    }
+    {
+        auto m = std::make_shared<Svf>();
+        m->Init(kSampleRate);
+        m->SetFreq(1000.f);
+        m->SetRes(0.5f);
+        b.push_back(MakeBenchmark("Svf", m, [](Svf& f, float in, bool) {
+            f.Process(in);
+            return f.Low();
+        }));
+    }
+    {
+        auto m   = std::make_shared<Svf>();
+        auto lfo = std::make_shared<Oscillator>();
+        m->Init(kSampleRate);
+        m->SetRes(0.5f);
+        lfo->Init(kSampleRate);
+        lfo->SetFreq(2.f);
+        b.push_back({"Svf (modulated)", [m, lfo](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             m->SetFreq(1000.f + 800.f * lfo->Process());
+                             m->Process(in[i]);
+                             out[i] = m->Low();
+                         }
+                     }});
+    }
+    {
+        // The same sweep, with the cutoff glided and set once per block
+        auto m      = std::make_shared<Svf>();
+        auto cutoff = std::make_shared<SmoothedValue>();
+        auto phase  = std::make_shared<float>(0.f);
+        m->Init(kSampleRate);
+        m->SetRes(0.5f);
+        cutoff->Init(kSampleRate, 0.005f, SmoothedValue::LINEAR, 1000.f);
+        b.push_back({"Svf (SmoothedValue cutoff)", [m, cutoff, phase](const float* in, float* out, size_t size) {
+                         *phase += TWOPI_F * 2.f * size / kSampleRate;
+                         *phase -= *phase > TWOPI_F ? TWOPI_F : 0.f;
+                         cutoff->SetTarget(1000.f + 800.f * sinf(*phase));
+                         if(cutoff->Advance(size))
+                         {
+                             m->SetFreq(cutoff->GetValue());
+                         }
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             m->Process(in[i]);
+                             out[i] = m->Low();
+                         }
+                     }});
+    }
+
+    // Noise
+    {
+        auto m = std::make_shared<ClockedNoise>();
+        m->Init(kSampleRate);
+        m->SetFreq(1000.f);
+        b.push_back(MakeBenchmark("ClockedNoise", m, [](ClockedNoise& n, float, bool) {
+            return n.Process();
+        }));
+    }
+    {
+        auto m = std::make_shared<Dust>();
+        m->Init();
+        b.push_back(
+            MakeBenchmark("Dust", m, [](Dust& n, float, bool) { return n.Process(); }));
+    }
+    {
+        using Fractal = FractalRandomGenerator<ClockedNoise, 5>;
+        auto m        = std::make_shared<Fractal>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("FractalRandomGenerator", m, [](Fractal& n, float, bool) {
+            return n.Process();
+        }));
+    }
+    {
+        auto m = std::make_shared<GrainletOscillator>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "GrainletOscillator", m, [](GrainletOscillator& n, float, bool) {
+                return n.Process();
+            }));
+    }
+    {
+        auto m = std::make_shared<Particle>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Particle", m, [](Particle& n, float, bool) { return n.Process(); }));
+    }
+    {
+        auto m = std::make_shared<WhiteNoise>();
+        m->Init();
+        b.push_back(MakeBenchmark(
+            "WhiteNoise", m, [](WhiteNoise& n, float, bool) { return n.Process(); }));
+    }
+
+    // Physical modeling
+    {
+        auto m = std::make_shared<Drip>();
+        m->Init(kSampleRate, 0.01f);
+        b.push_back(MakeBenchmark(
+            "Drip", m, [](Drip& d, float, bool trig) { return d.Process(trig); }));
+    }
+    {
+        auto m = std::make_shared<String>();
+        m->Init(kSampleRate);
+        m->SetFreq(110.f);
+        b.push_back(MakeBenchmark("String", m, [](String& s, float in, bool trig) {
+            return s.Process(trig ? in : 0.f);
+        }));
+    }
+    {
+        auto m = std::make_shared<ModalVoice>();
+        m->Init(kSampleRate);
+        m->SetFreq(220.f);
+        b.push_back(MakeBenchmark(
+            "ModalVoice", m, [](ModalVoice& v, float, bool trig) {
+                return v.Process(trig);
+            }));
+    }
+    {
+        auto m = std::make_shared<ModalVoice>();
+        m->Init(kSampleRate);
+        m->SetFreq(220.f);
+        auto clock = std::make_shared<TriggerClock>();
+        b.push_back({"ModalVoice (block)", [m, clock](const float*, float* out, size_t size) {
+                         // The clock only has to fire on block boundaries here.
+                         bool trig = false;
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             trig = clock->Process() || trig;
+                         }
+                         m->ProcessBlock(out, size, trig);
+                     }});
+    }
+    {
+        auto m = std::make_shared<Resonator>();
+        m->Init(0.1f, 24, kSampleRate);
+        m->SetFreq(220.f);
+        b.push_back(MakeBenchmark("Resonator", m, [](Resonator& r, float in, bool) {
+            return r.Process(in);
+        }));
+    }
+    {
+        auto m = std::make_shared<Resonator>();
+        m->Init(0.1f, 24, kSampleRate);
+        m->SetFreq(220.f);
+        b.push_back({"Resonator (block)", [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<Resonator>();
+        m->Init(0.1f, 64, kSampleRate);
+        m->SetFreq(220.f);
+        b.push_back({"Resonator64 (block)", [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<StringVoice>();
+        m->Init(kSampleRate);
+        m->SetFreq(110.f);
+        b.push_back(MakeBenchmark(
+            "StringVoice", m, [](StringVoice& v, float, bool trig) {
+                return v.Process(trig);
+            }));
+    }
+
+    // Sampling
+    {
+        static constexpr int kTableSize = 48000;
+        auto                 table      = std::make_shared<std::vector<float>>(kTableSize);
+        Xorshift             noise(1234);
+        for(auto& s : *table)
+        {
+            s = noise.Process();
+        }
+        auto m = std::make_shared<GranularPlayer>();
+        m->Init(table->data(), kTableSize, kSampleRate);
+        b.push_back({"GranularPlayer", [m, table](const float*, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Process(1.f, 700.f, 50.f);
+                         }
+                     }});
+    }
+
+    // Synthesis
+    {
+        auto m = std::make_shared<Fm2>();
+        m->Init(kSampleRate);
+        b.push_back({"Fm2", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<FormantOscillator>();
+        m->Init(kSampleRate);
+        m->SetCarrierFreq(110.f);
+        m->SetFormantFreq(800.f);
+        b.push_back({"FormantOscillator", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<HarmonicOscillator<16>>();
+        m->Init(kSampleRate);
+        m->SetFreq(110.f);
+        b.push_back(MakeBenchmark(
+            "HarmonicOscillator16", m, [](HarmonicOscillator<16>& o, float, bool) {
+                return o.Process();
+            }));
+    }
+    const uint8_t kWaveforms[] = {Oscillator::WAVE_SIN,
+                                  Oscillator::WAVE_POLYBLEP_SAW,
+                                  Oscillator::WAVE_POLYBLEP_TRI};
+    const char*   kWaveNames[] = {"Oscillator (sin)",
+                                "Oscillator (polyblep saw)",
+                                "Oscillator (polyblep tri)"};
+    for(size_t w = 0; w < DSY_COUNTOF(kWaveforms); w++)
+    {
+        auto m = std::make_shared<Oscillator>();
+        m->Init(kSampleRate);
+        m->SetFreq(220.f);
+        m->SetWaveform(kWaveforms[w]);
+        b.push_back({kWaveNames[w], [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<OscillatorBank>();
+        m->Init(kSampleRate);
+        m->SetFreq(110.f);
+        b.push_back({"OscillatorBank", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<VariableSawOscillator>();
+        m->Init(kSampleRate);
+        b.push_back({"VariableSawOscillator", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<VariableShapeOscillator>();
+        m->Init(kSampleRate);
+        m->SetSyncFreq(220.f);
+        b.push_back({"VariableShapeOscillator",
+                     [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<VosimOscillator>();
+        m->Init(kSampleRate);
+        b.push_back({"VosimOscillator", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        // Eight tables from a sine to a naive saw, morphed by a slow LFO.
+        static constexpr size_t kTableSize = 2048;
+        static constexpr size_t kNumTables = 8;
+        using Bank                         = WavetableBank<kTableSize>;
+        using Osc                          = WavetableOscillator<kTableSize>;
+        std::vector<float> tables(kTableSize * kNumTables);
+        for(size_t t = 0; t < kNumTables; t++)
+        {
+            const float mix = static_cast<float>(t) / (kNumTables - 1);
+            for(size_t i = 0; i < kTableSize; i++)
+            {
+                const float phase = static_cast<float>(i) / kTableSize;
+                const float sine  = sinf(TWOPI_F * phase);
+                const float saw   = 2.f * phase - 1.f;
+                tables[t * kTableSize + i] = sine + (saw - sine) * mix;
+            }
+        }
+        auto mem  = std::make_shared<std::vector<float>>(Bank::GetMemorySize(kNumTables));
+        auto bank = std::make_shared<Bank>();
+        bank->Init(mem->data(), mem->size());
+        bank->Build(tables.data(), kNumTables);
+
+        const Osc::Interpolation kModes[] = {Osc::INTERPOLATION_LINEAR,
+                                             Osc::INTERPOLATION_CUBIC};
+        const char* kModeNames[]          = {"WavetableOscillator (linear)",
+                                    "WavetableOscillator (cubic)"};
+        for(size_t i = 0; i < DSY_COUNTOF(kModes); i++)
+        {
+            auto m     = std::make_shared<Osc>();
+            auto phase = std::make_shared<float>(0.f);
+            m->Init(kSampleRate, bank.get());
+            m->SetFreq(220.f);
+            m->SetInterpolation(kModes[i]);
+            b.push_back({kModeNames[i], [m, phase, bank, mem](const float*, float* out, size_t size) {
+                             *phase += TWOPI_F * 0.5f * size / kSampleRate;
+                             *phase -= *phase > TWOPI_F ? TWOPI_F : 0.f;
+                             m->SetMorph(0.5f + 0.5f * sinf(*phase));
+                             m->ProcessBlock(out, size);
+                         }});
+        }
+    }
+    {
+        auto m = std::make_shared<ZOscillator>();
+        m->Init(kSampleRate);
+        b.push_back({"ZOscillator", [m](const float*, float* out, size_t size) {
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+
+    // Utility
+    {
+        auto m = std::make_shared<DcBlock>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "DcBlock", m, [](DcBlock& d, float in, bool) { return d.Process(in); }));
+    }
+    {
+        using Delay = DelayLine<float, 48000>;
+        auto m      = std::make_shared<Delay>();
+        m->Init();
+        m->SetDelay(12000.5f);
+        b.push_back(MakeBenchmark("DelayLine", m, [](Delay& d, float in, bool) {
+            const float out = d.Read();
+            d.Write(in);
+            return out;
+        }));
+    }
+    {
+        using Delay = DelayLinePow2<float, 48000>;
+        auto m      = std::make_shared<Delay>();
+        m->Init();
+        m->SetDelay(12000.5f);
+        b.push_back(MakeBenchmark("DelayLinePow2", m, [](Delay& d, float in, bool) {
+            const float out = d.Read();
+            d.Write(in);
+            return out;
+        }));
+    }
+    {
+        // One note held at a time out of eight voices, so most voices are idle.
+        using Pool = VoicePool<OscillatorAdsrVoice, 8>;
+        auto m     = std::make_shared<Pool>();
+        auto clock = std::make_shared<TriggerClock>();
+        auto note  = std::make_shared<int>(0);
+        m->Init(kSampleRate);
+        m->ForEach([](OscillatorAdsrVoice& v) {
+            v.GetOscillator().SetWaveform(Oscillator::WAVE_POLYBLEP_SAW);
+            v.GetEnvelope().SetReleaseTime(0.05f);
+        });
+        b.push_back({"VoicePool (8 osc+adsr)", [m, clock, note](const float*, float* out, size_t size) {
+                         bool trig = false;
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             trig = clock->Process() || trig;
+                         }
+                         if(trig)
+                         {
+                             m->NoteOff(48 + *note);
+                             *note = (*note + 7) % 24;
+                             m->NoteOn(48 + *note, 0.8f);
+                         }
+                         m->ProcessBlock(out, size);
+                     }});
+    }
+    {
+        auto buffer = std::make_shared<std::vector<float>>(48000);
+        auto m      = std::make_shared<Looper>();
+        m->Init(buffer->data(), buffer->size());
+        m->TrigRecord();
+        b.push_back({"Looper", [m, buffer](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Process(in[i]);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<Metro>();
+        m->Init(8.f, kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Metro", m, [](Metro& t, float, bool) { return float(t.Process()); }));
+    }
+    {
+        auto m = std::make_shared<Maytrig>();
+        b.push_back(MakeBenchmark(
+            "Maytrig", m, [](Maytrig& t, float, bool) { return t.Process(0.5f); }));
+    }
+    {
+        // Four chorus-like voices, each with its own delay and LFO phase,
+        // read one sample at a time from four lines...
+        using Delay = DelayLine<float, 4000>;
+        auto m      = std::make_shared<std::vector<Delay>>(4);
+        auto phase  = std::make_shared<float>(0.f);
+        for(auto& d : *m)
+        {
+            d.Init();
+        }
+        b.push_back({"DelayLine (4 taps)", [m, phase](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             *phase += 1.f / 48000.f;
+                             *phase -= *phase >= 1.f ? 1.f : 0.f;
+                             float sum = 0.f;
+                             for(size_t t = 0; t < 4; t++)
+                             {
+                                 Delay&      d   = (*m)[t];
+                                 const float lfo = 1.f - 4.f * fabsf(*phase - 0.5f);
+                                 d.SetDelay(1500.f + 500.f * t + 200.f * lfo);
+                                 sum += d.Read();
+                                 d.Write(in[i]);
+                             }
+                             out[i] = sum * 0.25f;
+                         }
+                     }});
+    }
+    {
+        // ...and from one shared line a block at a time.
+        auto memory = std::make_shared<std::vector<float>>(4096);
+        auto m      = std::make_shared<MultiTapDelay>();
+        auto phase  = std::make_shared<float>(0.f);
+        m->Init(memory->data(), memory->size());
+        b.push_back({"MultiTapDelay (4 taps)", [m, memory, phase](const float* in, float* out, size_t size) {
+                         float delay[48], tap[48];
+                         for(size_t done = 0; done < size; done += 48)
+                         {
+                             const size_t n = size - done < 48 ? size - done : 48;
+                             for(size_t i = 0; i < n; i++)
+                             {
+                                 out[done + i] = 0.f;
+                             }
+                             for(size_t t = 0; t < 4; t++)
+                             {
+                                 float p = *phase;
+                                 for(size_t i = 0; i < n; i++)
+                                 {
+                                     p += 1.f / 48000.f;
+                                     p -= p >= 1.f ? 1.f : 0.f;
+                                     const float lfo = 1.f - 4.f * fabsf(p - 0.5f);
+                                     delay[i] = 1500.f + 500.f * t + 200.f * lfo;
+                                 }
+                                 m->ReadTap(t, delay, tap, n);
+                                 for(size_t i = 0; i < n; i++)
+                                 {
+                                     out[done + i] += tap[i] * 0.25f;
+                                 }
+                             }
+                             for(size_t i = 0; i < n; i++)
+                             {
+                                 *phase += 1.f / 48000.f;
+                                 *phase -= *phase >= 1.f ? 1.f : 0.f;
+                             }
+                             m->Write(in + done, n);
+                         }
+                     }});
+    }
+    {
+        // Four tracks of sixteenths at 180 bpm, so most blocks are split
+        using Seq = StepSequencer<4, 16>;
+        auto m    = std::make_shared<Seq>();
+        auto env  = std::make_shared<float>(0.f);
+        m->Init(kSampleRate, 180.f);
+        m->SetSwing(0.6f);
+        for(size_t s = 0; s < 16; s++)
+        {
+            for(size_t t = 0; t < 4; t++)
+            {
+                m->SetStep(t, s, (s + t) % 3 == 0 ? 1.f : 0.f);
+            }
+        }
+        b.push_back({"StepSequencer (4 tracks)", [m, env](const float* in, float* out, size_t size) {
+                         m->Process(
+                             size,
+                             [env](const SequencerEvent& e) { *env += e.value; },
+                             [in, out, env](size_t offset, size_t length) {
+                                 for(size_t i = offset; i < offset + length; i++)
+                                 {
+                                     out[i] = in[i] * *env;
+                                     *env *= 0.999f;
+                                 }
+                             });
+                     }});
+    }
+    {
+        // A gain knob that moves on every block
+        auto m     = std::make_shared<SmoothedValue>();
+        auto count = std::make_shared<size_t>(0);
+        m->Init(kSampleRate, 0.02f);
+        b.push_back({"SmoothedValue (gain)", [m, count](const float* in, float* out, size_t size) {
+                         m->SetTarget((++*count % 100) / 100.f);
+                         m->ProcessBlock(out, size);
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] *= in[i];
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<SampleHold>();
+        b.push_back(MakeBenchmark(
+            "SampleHold", m, [](SampleHold& s, float in, bool trig) {
+                return s.Process(trig, in);
+            }));
+    }
+    {
+        auto m = std::make_shared<SmoothRandomGenerator>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "SmoothRandomGenerator", m, [](SmoothRandomGenerator& s, float, bool) {
+                return s.Process();
+            }));
+    }
+
+    // Fixed point versions, next to the float modules they're compared against
+    for(auto& c : CreateFixedPointComparisons())
+    {
+        if(!c.float_is_listed)
+        {
+            b.push_back(c.make_float());
+            b.back().name = c.name;
+        }
+        b.push_back(c.make_q15());
+        b.back().name = c.name + " [q15]";
+        b.push_back(c.make_q31());
+        b.back().name = c.name + " [q31]";
+    }
+
+#ifdef USE_DAISYSP_LGPL
+    // LGPL modules
+    {
+        auto m = std::make_shared<Balance>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("Balance", m, [](Balance& d, float in, bool) {
+            return d.Process(in, 0.5f);
+        }));
+    }
+    {
+        auto m = std::make_shared<Compressor>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("Compressor", m, [](Compressor& d, float in, bool) {
+            return d.Process(in);
+        }));
+    }
+    {
+        auto m = std::make_shared<Bitcrush>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Bitcrush", m, [](Bitcrush& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<Fold>();
+        m->Init();
+        b.push_back(
+            MakeBenchmark("Fold", m, [](Fold& e, float in, bool) { return e.Process(in); }));
+    }
+    {
+        // Initialized at the higher rate, so the crush rate stays the same
+        auto m = std::make_shared<Oversampled<Bitcrush, 4>>();
+        m->Init();
+        m->GetModel().Init(kSampleRate * 4);
+        b.push_back({"Bitcrush (4x oversampled)",
+                     [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+    {
+        // Holds for 3.5 samples at the base rate, as 14 at the higher one
+        auto m = std::make_shared<Oversampled<Fold, 4>>();
+        m->Init();
+        m->GetModel().Init();
+        m->GetModel().SetIncrement(3.5f * 4);
+        b.push_back({"Fold (4x oversampled)",
+                     [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(in, out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<ReverbSc>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("ReverbSc", m, [](ReverbSc& r, float in, bool) {
+            float out_l, out_r;
+            r.Process(in, in, &out_l, &out_r);
+            return out_l + out_r;
+        }));
+    }
+    {
+        auto buffer = std::make_shared<std::vector<float>>(4800);
+        auto m      = std::make_shared<Allpass>();
+        m->Init(kSampleRate, buffer->data(), buffer->size());
+        b.push_back({"Allpass", [m, buffer](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Process(in[i]);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<ATone>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("ATone", m, [](ATone& f, float in, bool) {
+            return f.Process(in);
+        }));
+    }
+    {
+        auto m = std::make_shared<Biquad>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark(
+            "Biquad", m, [](Biquad& f, float in, bool) { return f.Process(in); }));
+    }
+    {
+        auto buffer = std::make_shared<std::vector<float>>(4800);
+        auto m      = std::make_shared<Comb>();
+        m->Init(kSampleRate, buffer->data(), buffer->size());
+        b.push_back({"Comb", [m, buffer](const float* in, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             out[i] = m->Process(in[i]);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<Mode>();
+        m->Init(kSampleRate);
+        b.push_back(
+            MakeBenchmark("Mode", m, [](Mode& f, float in, bool) { return f.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<MoogLadder>();
+        m->Init(kSampleRate);
+        m->SetFreq(1000.f);
+        m->SetRes(0.5f);
+        b.push_back(MakeBenchmark("MoogLadder", m, [](MoogLadder& f, float in, bool) {
+            return f.Process(in);
+        }));
+    }
+    {
+        // Cutoff swept every sample, as under an envelope or LFO
+        auto m = std::make_shared<MoogLadder>();
+        m->Init(kSampleRate);
+        m->SetRes(0.5f);
+        auto freq  = std::make_shared<std::vector<float>>();
+        auto phase = std::make_shared<float>(0.f);
+        b.push_back({"MoogLadder (block, modulated)",
+                     [m, freq, phase](const float* in, float* out, size_t size) {
+                         freq->resize(size);
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             *phase = fastmod1f(*phase + 1.f / kSampleRate);
+                             (*freq)[i] = 500.f + 4000.f * *phase;
+                         }
+                         m->ProcessBlock(in, freq->data(), out, size);
+                     }});
+    }
+    {
+        // Eight voices fed the same input, summed to one output
+        auto m = std::make_shared<MoogLadderN<8>>();
+        m->Init(kSampleRate);
+        for(int v = 0; v < 8; v++)
+        {
+            m->SetFreq(v, 500.f + 250.f * v);
+            m->SetRes(v, 0.5f);
+        }
+        b.push_back(MakeBenchmark(
+            "MoogLadderN<8> (8 voices)", m, [](MoogLadderN<8>& f, float in, bool) {
+                float voices[8];
+                for(int v = 0; v < 8; v++)
+                {
+                    voices[v] = in;
+                }
+                f.Process(voices, voices);
+                float sum = 0.f;
+                for(int v = 0; v < 8; v++)
+                {
+                    sum += voices[v];
+                }
+                return sum;
+            }));
+    }
+    {
+        auto m = std::make_shared<NlFilt>();
+        m->Init();
+        b.push_back({"NlFilt", [m](const float* in, float* out, size_t size) {
+                         m->ProcessBlock(const_cast<float*>(in), out, size);
+                     }});
+    }
+    {
+        auto m = std::make_shared<Tone>();
+        m->Init(kSampleRate);
+        b.push_back(
+            MakeBenchmark("Tone", m, [](Tone& f, float in, bool) { return f.Process(in); }));
+    }
+    {
+        auto buffer = std::make_shared<std::vector<float>>(256);
+        auto m      = std::make_shared<Pluck>();
+        m->Init(kSampleRate, buffer->data(), buffer->size(), PLUCK_MODE_RECURSIVE);
+        auto clock = std::make_shared<TriggerClock>();
+        b.push_back({"Pluck", [m, buffer, clock](const float*, float* out, size_t size) {
+                         for(size_t i = 0; i < size; i++)
+                         {
+                             float trig = clock->Process() ? 1.f : 0.f;
+                             out[i]     = m->Process(trig);
+                         }
+                     }});
+    }
+    {
+        auto m = std::make_shared<BlOsc>();
+        m->Init(kSampleRate);
+        b.push_back(
+            MakeBenchmark("BlOsc", m, [](BlOsc& o, float, bool) { return o.Process(); }));
+    }
+    {
+        auto m = std::make_shared<Jitter>();
+        m->Init(kSampleRate);
+        b.push_back(
+            MakeBenchmark("Jitter", m, [](Jitter& j, float, bool) { return j.Process(); }));
+    }
+    {
+        auto m = std::make_shared<Port>();
+        m->Init(kSampleRate, 0.02f);
+        b.push_back(
+            MakeBenchmark("Port", m, [](Port& p, float in, bool) { return p.Process(in); }));
+    }
+    {
+        auto m = std::make_shared<Line>();
+        m->Init(kSampleRate);
+        b.push_back(MakeBenchmark("Line", m, [](Line& l, float, bool trig) {
+            uint8_t finished;
+            if(trig)
+            {
+                l.Start(1.f, 0.f, 0.2f);
+            }
+            return l.Process(&finished);
+        }));
+    }
+    {
+        // Four voices, a new note on every trigger
+        auto m = std::make_shared<PolyPluck<4>>();
+        m->Init(kSampleRate);
+        auto note = std::make_shared<float>(48.f);
+        b.push_back(MakeBenchmark("PolyPluck", m, [note](PolyPluck<4>& p, float, bool trig) {
+            float t = trig ? 1.f : 0.f;
+            if(trig)
+            {
+                *note = *note < 72.f ? *note + 7.f : 48.f;
+            }
+            return p.Process(t, *note);
+        }));
+    }
+#endif
+
+    return b;
+}
+
+/** Runs one benchmark, returning the best of repeat passes over the input */
+Result Run(Benchmark& bench, const std::vector<float>& input, size_t block, size_t repeat)
+{
+    std::vector<float> out(block);
+    double             best_ns = 0.0;
+    volatile float     sink    = 0.f;
+    if(bench.prepare)
+    {
+        bench.prepare(input);
+    }
+
+    // One untimed pass to warm up caches and settle the module state.
+    for(size_t pass = 0; pass <= repeat; pass++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(size_t done = 0; done < input.size(); done += block)
+        {
+            const size_t n = input.size() - done < block ? input.size() - done : block;
+            bench.process(input.data() + done, out.data(), n);
+            sink = sink + out[0];
+        }
+        const auto   stop = std::chrono::steady_clock::now();
+        const double ns   = std::chrono::duration<double, std::nano>(stop - start).count();
+        if(pass > 0 && (best_ns == 0.0 || ns < best_ns))
+        {
+            best_ns = ns;
+        }
+    }
+
+    Result r;
+    r.name            = bench.name;
+    r.ns_per_sample   = best_ns / input.size();
+    r.samples_per_sec = 1e9 / r.ns_per_sample;
+    return r;
+}
+
+/** Difference between a fixed point module and the float one it follows */
+struct Accuracy
+{
+    double max_error;
+    double snr_db;
+};
+
+/** Runs both modules over the whole input, in blocks */
+Accuracy Compare(Benchmark reference, Benchmark fixed, const std::vector<float>& input, size_t block)
+{
+    for(Benchmark* bench : {&reference, &fixed})
+    {
+        if(bench->prepare)
+        {
+            bench->prepare(input);
+        }
+    }
+    std::vector<float> ref(block), out(block);
+    double             signal = 0.0, noise = 0.0, max_error = 0.0;
+    for(size_t done = 0; done < input.size(); done += block)
+    {
+        const size_t n = input.size() - done < block ? input.size() - done : block;
+        reference.process(input.data() + done, ref.data(), n);
+        fixed.process(input.data() + done, out.data(), n);
+        for(size_t i = 0; i < n; i++)
+        {
+            const double error = out[i] - ref[i];
+            signal += double(ref[i]) * ref[i];
+            noise += error * error;
+            max_error = fabs(error) > max_error ? fabs(error) : max_error;
+        }
+    }
+    const double snr_db = noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+    return {max_error, snr_db};
+}
+
+void ReportAccuracy(const std::vector<float>& input, size_t block, const char* filter)
+{
+    printf("%-32s %12s %10s %12s %10s\n",
+           "module",
+           "q15 max err",
+           "q15 SNR dB",
+           "q31 max err",
+           "q31 SNR dB");
+    for(auto& c : CreateFixedPointComparisons())
+    {
+        if(filter != nullptr && c.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        const Accuracy q15 = Compare(c.make_float(), c.make_q15(), input, block);
+        const Accuracy q31 = Compare(c.make_float(), c.make_q31(), input, block);
+        printf("%-32s %12.2e %10.1f %12.2e %10.1f\n",
+               c.name.c_str(),
+               q15.max_error,
+               q15.snr_db,
+               q31.max_error,
+               q31.snr_db);
+    }
+}
+
+/** Escapes a module name for use as a JSON key */
+std::string JsonKey(const std::string& name)
+{
+    std::string key;
+    for(char c : name)
+    {
+        if(c == '"' || c == '\\')
+        {
+            key += '\\';
+        }
+        key += c;
+    }
+    return key;
+}
+
+bool WriteJson(const char* path, const std::vector<Result>& results)
+{
+    FILE* f = fopen(path, "w");
+    if(f == nullptr)
+    {
+        return false;
+    }
+    fprintf(f, "{\n");
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        fprintf(f,
+                "  \"%s\": %.4f%s\n",
+                JsonKey(results[i].name).c_str(),
+                results[i].ns_per_sample,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+    return true;
+}
+
+/** Reads the flat {"name": ns_per_sample, ...} object written by WriteJson() */
+bool ReadJson(const char* path, std::map<std::string, double>& baseline)
+{
+    FILE* f = fopen(path, "r");
+    if(f == nullptr)
+    {
+        return false;
+    }
+    std::string text;
+    char        chunk[512];
+    size_t      n;
+    while((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        text.append(chunk, n);
+    }
+    fclose(f);
+
+    size_t pos = 0;
+    while((pos = text.find('"', pos)) != std::string::npos)
+    {
+        std::string key;
+        for(pos++; pos < text.size() && text[pos] != '"'; pos++)
+        {
+            if(text[pos] == '\\' && pos + 1 < text.size())
+            {
+                pos++;
+            }
+            key += text[pos];
+        }
+        pos = text.find(':', pos);
+        if(pos == std::string::npos)
+        {
+            return false;
+        }
+        baseline[key] = strtod(text.c_str() + pos + 1, nullptr);
+    }
+    return true;
+}
+
+void PrintUsage(const char* name)
+{
+    printf("usage: %s [--samples N] [--block N] [--repeat N] [--filter text]\n"
+           "          [--json out.json] [--baseline in.json] [--threshold percent]\n"
+           "          [--accuracy]\n",
+           name);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t      num_samples   = 480000; // 10 seconds at 48kHz
+    size_t      block         = 48;
+    size_t      repeat        = 3;
+    double      threshold     = 10.0;
+    const char* filter        = nullptr;
+    const char* json_path     = nullptr;
+    const char* baseline_path = nullptr;
+    bool        accuracy      = false;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if(has_value && strcmp(argv[i], "--samples") == 0)
+            num_samples = strtoul(argv[++i], nullptr, 10);
+        else if(has_value && strcmp(argv[i], "--block") == 0)
+            block = strtoul(argv[++i], nullptr, 10);
+        else if(has_value && strcmp(argv[i], "--repeat") == 0)
+            repeat = strtoul(argv[++i], nullptr, 10);
+        else if(has_value && strcmp(argv[i], "--filter") == 0)
+            filter = argv[++i];
+        else if(has_value && strcmp(argv[i], "--json") == 0)
+            json_path = argv[++i];
+        else if(has_value && strcmp(argv[i], "--baseline") == 0)
+            baseline_path = argv[++i];
+        else if(has_value && strcmp(argv[i], "--threshold") == 0)
+            threshold = strtod(argv[++i], nullptr);
+        else if(strcmp(argv[i], "--accuracy") == 0)
+            accuracy = true;
+        else
+        {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    if(num_samples == 0 || block == 0 || repeat == 0)
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::map<std::string, double> baseline;
+    if(baseline_path != nullptr && !ReadJson(baseline_path, baseline))
+    {
+        fprintf(stderr, "could not read baseline %s\n", baseline_path);
+        return 2;
+    }
+
+    std::vector<float> input(num_samples);
+    Xorshift           noise(0x1234567u);
+    for(auto& s : input)
+    {
+        s = 0.5f * noise.Process();
+    }
+
+    if(accuracy)
+    {
+        printf("%zu samples at %.0f Hz, fixed point against float\n\n",
+               num_samples,
+               kSampleRate);
+        ReportAccuracy(input, block, filter);
+        return 0;
+    }
+
+    printf("%zu samples at %.0f Hz, block size %zu, best of %zu\n\n",
+           num_samples,
+           kSampleRate,
+           block,
+           repeat);
+    printf("%-32s %12s %14s %10s\n", "module", "ns/sample", "samples/sec", "delta");
+
+    std::vector<Result> results;
+    int                 regressions = 0;
+    for(auto& bench : CreateBenchmarks())
+    {
+        if(filter != nullptr && bench.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        const Result r = Run(bench, input, block, repeat);
+        results.push_back(r);
+
+        char delta[32] = "";
+        auto base      = baseline.find(r.name);
+        if(base != baseline.end() && base->second > 0.0)
+        {
+            const double pct = (r.ns_per_sample - base->second) / base->second * 100.0;
+            const bool   bad = pct > threshold;
+            regressions += bad ? 1 : 0;
+            snprintf(delta, sizeof(delta), "%+.1f%%%s", pct, bad ? " !" : "");
+        }
+        printf("%-32s %12.2f %14.0f %10s\n",
+               r.name.c_str(),
+               r.ns_per_sample,
+               r.samples_per_sec,
+               delta);
+    }
+
+    if(json_path != nullptr && !WriteJson(json_path, results))
+    {
+        fprintf(stderr, "could not write %s\n", json_path);
+        return 2;
+    }
+    if(regressions > 0)
+    {
+        printf("\n%d module(s) slower than the baseline by more than %.1f%%\n",
+               regressions,
+               threshold);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <math.h>
+#include "adsr.h"
+#include "svf.h"
+#include "fastmath.h"
+#include "host_test.h"
+
+/** Host tests of the fast math build, at the LOW accuracy tier.
+    See tests/CMakeLists.txt for the flags.
+*/
+
+using namespace daisysp;
+
+static constexpr float kSampleRate = 48000.f;
+
+/** Envelope and filter times, 1ms to 10s */
+static const float kTimes[]
+    = {0.001f, 0.002f, 0.005f, 0.01f, 0.015f, 0.02f, 0.05f, 0.1f,
+       0.2f,   0.5f,   1.f,    2.f,   5.f,    10.f};
+
+/** One pole coefficients against 1 - expf(), worked out in double so the
+    reference doesn't cancel out itself at long times.
+*/
+static void TestOnePoleCoefficient()
+{
+    for(float t : kTimes)
+    {
+        const float  x     = -1.f / (t * kSampleRate);
+        const float  coeff = -expm1_lut<FastMathAccuracy::LOW>(x);
+        const double ref   = 1.0 - exp(static_cast<double>(x));
+        const double err   = fabs(coeff - ref) / ref;
+        CHECK(err < 1e-5, "%gs: %g instead of %g", t, coeff, ref);
+    }
+    // Past the series, the table is used as before.
+    const float x = -0.5f;
+    CHECK(fabsf(expm1_lut<FastMathAccuracy::HIGH>(x) - expm1f(x)) < 1e-5f,
+          "%g", expm1_lut<FastMathAccuracy::HIGH>(x));
+}
+
+/** Samples the release takes to cover 1 - 1/e of its way down */
+static int ReleaseSamples(float time)
+{
+    Adsr env;
+    env.Init(kSampleRate);
+    env.SetAttackTime(0.f);
+    env.SetSustainLevel(1.f);
+    env.SetReleaseTime(time);
+    for(int i = 0; i < 4; i++)
+    {
+        env.Process(true);
+    }
+    // The release aims for -0.01, so it ends.
+    const float target = 1.01f / static_cast<float>(M_E) - 0.01f;
+    const int   limit  = static_cast<int>(4.f * time * kSampleRate);
+    for(int n = 1; n < limit; n++)
+    {
+        if(env.Process(false) <= target)
+        {
+            return n;
+        }
+    }
+    return limit;
+}
+
+/** Samples the attack takes to reach full scale */
+static int AttackSamples(float time)
+{
+    Adsr env;
+    env.Init(kSampleRate);
+    env.SetAttackTime(time);
+    const int limit = static_cast<int>(4.f * time * kSampleRate);
+    for(int n = 1; n < limit; n++)
+    {
+        if(env.Process(true) >= 1.f)
+        {
+            return n;
+        }
+    }
+    return limit;
+}
+
+static void TestAdsrTimes()
+{
+    // Longer times are dominated by the rounding of the envelope itself.
+    for(float t : kTimes)
+    {
+        if(t > 1.f)
+        {
+            continue;
+        }
+        const float expected = t * kSampleRate;
+        const int   release  = ReleaseSamples(t);
+        CHECK(fabsf(release - expected) <= 0.02f * expected + 1.f,
+              "release of %gs took %d samples instead of %g",
+              t,
+              release,
+              expected);
+        const int attack = AttackSamples(t);
+        CHECK(fabsf(attack - expected) <= 0.02f * expected + 1.f,
+              "attack of %gs took %d samples instead of %g",
+              t,
+              attack,
+              expected);
+    }
+}
+
+/** Lowpass step response after n samples */
+static float SvfStep(float freq, int n)
+{
+    Svf filt;
+    filt.Init(kSampleRate);
+    filt.SetRes(0.f);
+    filt.SetFreq(freq);
+    for(int i = 0; i < n; i++)
+    {
+        filt.Process(1.f);
+    }
+    return filt.Low();
+}
+
+static void TestSvfCutoff()
+{
+    // Low cutoffs still pass DC.
+    const float kLowFreqs[] = {5.f, 20.f, 50.f, 90.f};
+    for(float freq : kLowFreqs)
+    {
+        const float y = SvfStep(freq, static_cast<int>(kSampleRate));
+        CHECK(y > 0.9f, "%gHz lowpass settles at %g", freq, y);
+    }
+    // Close cutoffs still differ, the LOW table steps by about 188Hz.
+    const float kCloseFreqs[] = {1000.f, 1010.f, 1020.f, 1030.f};
+    float       last          = 0.f;
+    for(float freq : kCloseFreqs)
+    {
+        const float y = SvfStep(freq, 20);
+        CHECK(y > last, "%gHz step response %g, not above %g", freq, y, last);
+        last = y;
+    }
+}
+
+int main()
+{
+    TestOnePoleCoefficient();
+    TestAdsrTimes();
+    TestSvfCutoff();
+    return TestResult();
+}
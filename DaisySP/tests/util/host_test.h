@@ -0,0 +1,47 @@
+#pragma once
+#ifndef DSY_HOST_TEST_H
+#define DSY_HOST_TEST_H
+
+#include <stdio.h>
+
+/** Minimal checks for the host tests run by ctest, see tests/CMakeLists.txt.
+    A failed CHECK prints where and why, and the test keeps going so all
+    failures show up in one run. main() returns TestResult().
+*/
+namespace daisysp
+{
+namespace host_test
+{
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+} // namespace host_test
+} // namespace daisysp
+
+#define CHECK(cond, ...)                                                    \
+    do                                                                      \
+    {                                                                       \
+        if(!(cond))                                                         \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                            \
+            printf("\n");                                                   \
+            daisysp::host_test::Failures()++;                               \
+        }                                                                   \
+    } while(0)
+
+inline int TestResult()
+{
+    const int failures = daisysp::host_test::Failures();
+    if(failures > 0)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("passed\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,251 @@
+/** Audio callback conversion benchmark, built for the host.
+
+Times what AudioHandle does around the user callback: converting the SAI's
+interleaved integer samples to float buffers, and back. The per-sample loops
+the audio callback used to run, with their bit depth and channel count
+branches and buffers on the stack, are run next to the conversion kernels
+in hid/audio_convert.h, for a range of block sizes.
+
+The callback in between copies its input to its output, the same for both.
+Reported is the time per block, and its share of the block's time at 48kHz.
+
+Usage:
+    audioconvert_bench [--channels 2|4] [--bits 16|24|32] [--blocks N]
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "hid/audio_convert.h"
+
+using namespace daisy;
+
+namespace
+{
+constexpr float  kSampleRate   = 48000.f;
+constexpr size_t kMaxBlockSize = 256;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    size_t channels = 2;
+    int    bits     = 24;
+    size_t blocks   = 200000;
+};
+
+void PrintUsage(const char* name)
+{
+    printf("usage: %s [--channels 2|4] [--bits 16|24|32] [--blocks N]\n", name);
+}
+
+bool ParseOptions(int argc, char** argv, Options& opt)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const char*       value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(value == nullptr)
+            return false;
+        if(arg == "--channels")
+            opt.channels = strtoul(value, nullptr, 10);
+        else if(arg == "--bits")
+            opt.bits = atoi(value);
+        else if(arg == "--blocks")
+            opt.blocks = strtoul(value, nullptr, 10);
+        else
+            return false;
+        i++;
+    }
+    return (opt.channels == 2 || opt.channels == 4)
+           && (opt.bits == 16 || opt.bits == 24 || opt.bits == 32)
+           && opt.blocks > 0;
+}
+
+/** What the audio callback reads from AudioHandle on every block */
+struct Handle
+{
+    int      bits;
+    size_t   channels;
+    float    postgain_recip;
+    float    output_adjust;
+    int32_t* rx2; // the second codec's buffers
+    int32_t* tx2;
+};
+
+Handle handle;
+
+__attribute__((noinline)) void
+Callback(const float* const* in, float** out, size_t size)
+{
+    for(size_t ch = 0; ch < handle.channels; ch++)
+        for(size_t i = 0; i < size; i++)
+            out[ch][i] = in[ch][i];
+}
+
+/** The conversion as the audio callback used to do it, for 24 bits, with
+    the other bit depths only differing in the conversion functions */
+__attribute__((noinline)) void PerSample(int32_t* in, int32_t* out, size_t size)
+{
+    const size_t chns      = handle.channels;
+    const size_t buff_size = chns > 2 ? size * 2 : size;
+    float        finbuff[buff_size], foutbuff[buff_size];
+    float*       fin[chns];
+    float*       fout[chns];
+    fin[0]  = finbuff;
+    fin[1]  = finbuff + (buff_size / chns);
+    fout[0] = foutbuff;
+    fout[1] = foutbuff + (buff_size / chns);
+    if(chns > 2)
+    {
+        fin[2]  = fin[1] + (buff_size / chns);
+        fin[3]  = fin[2] + (buff_size / chns);
+        fout[2] = fout[1] + (buff_size / chns);
+        fout[3] = fout[2] + (buff_size / chns);
+    }
+    switch(handle.bits)
+    {
+        case 24:
+            for(size_t i = 0; i < size; i += 2)
+            {
+                fin[0][i / 2] = s242f(in[i]) * handle.postgain_recip;
+                fin[1][i / 2] = s242f(in[i + 1]) * handle.postgain_recip;
+                if(chns > 2)
+                {
+                    fin[2][i / 2] = s242f(handle.rx2[i]) * handle.postgain_recip;
+                    fin[3][i / 2]
+                        = s242f(handle.rx2[i + 1]) * handle.postgain_recip;
+                }
+            }
+            break;
+        default: break;
+    }
+    Callback(fin, fout, size / 2);
+    switch(handle.bits)
+    {
+        case 24:
+            for(size_t i = 0; i < size; i += 2)
+            {
+                out[i]     = f2s24(fout[0][i / 2] * handle.output_adjust);
+                out[i + 1] = f2s24(fout[1][i / 2] * handle.output_adjust);
+                if(chns > 2)
+                {
+                    handle.tx2[i] = f2s24(fout[2][i / 2] * handle.output_adjust);
+                    handle.tx2[i + 1]
+                        = f2s24(fout[3][i / 2] * handle.output_adjust);
+                }
+            }
+            break;
+        default: break;
+    }
+}
+
+alignas(16) float float_in[4 * kMaxBlockSize];
+alignas(16) float float_out[4 * kMaxBlockSize];
+
+/** The conversion as AudioHandle does it now, picked ahead of time */
+template <typename Format, size_t chns>
+__attribute__((noinline)) void Kernels(int32_t* in, int32_t* out, size_t size)
+{
+    const size_t frames = size / 2;
+    float*       fin[chns];
+    float*       fout[chns];
+    for(size_t ch = 0; ch < chns; ch++)
+    {
+        fin[ch]  = float_in + ch * kMaxBlockSize;
+        fout[ch] = float_out + ch * kMaxBlockSize;
+    }
+    SaiDeinterleave<Format>(in, fin[0], fin[1], frames, handle.postgain_recip);
+    if(chns > 2)
+        SaiDeinterleave<Format>(
+            handle.rx2, fin[2], fin[3], frames, handle.postgain_recip);
+    Callback(fin, fout, frames);
+    SaiInterleave<Format>(fout[0], fout[1], out, frames, handle.output_adjust);
+    if(chns > 2)
+        SaiInterleave<Format>(
+            fout[2], fout[3], handle.tx2, frames, handle.output_adjust);
+}
+
+typedef void (*ProcessFunction)(int32_t* in, int32_t* out, size_t size);
+
+template <typename Format>
+ProcessFunction SelectKernels(size_t channels)
+{
+    return channels > 2 ? &Kernels<Format, 4> : &Kernels<Format, 2>;
+}
+
+/** \return ns per block */
+double Time(ProcessFunction process, size_t block, size_t blocks)
+{
+    std::vector<int32_t> rx(2 * kMaxBlockSize), tx(2 * kMaxBlockSize);
+    for(size_t i = 0; i < rx.size(); i++)
+        rx[i] = static_cast<int32_t>(i * 40503u) & 0xffffff;
+
+    double best = 1e300;
+    for(int r = 0; r < 3; r++)
+    {
+        const auto start = Clock::now();
+        for(size_t b = 0; b < blocks; b++)
+            process(rx.data(), tx.data(), 2 * block);
+        const std::chrono::duration<double, std::nano> took
+            = Clock::now() - start;
+        best = took.count() < best ? took.count() : best;
+    }
+    return best / blocks;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!ParseOptions(argc, argv, opt))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<int32_t> rx2(2 * kMaxBlockSize), tx2(2 * kMaxBlockSize);
+    handle = {opt.bits, opt.channels, 1.f, 1.f, rx2.data(), tx2.data()};
+
+    ProcessFunction kernels = opt.bits == 16   ? SelectKernels<SaiSampleS16>(
+                                  opt.channels)
+                              : opt.bits == 24 ? SelectKernels<SaiSampleS24>(
+                                  opt.channels)
+                                               : SelectKernels<SaiSampleS32>(
+                                                   opt.channels);
+
+    printf("%zu channels, %d bits, %zu blocks each\n\n",
+           opt.channels,
+           opt.bits,
+           opt.blocks);
+    printf("%6s %14s %14s %10s %10s\n",
+           "block",
+           "per-sample ns",
+           "kernels ns",
+           "speedup",
+           "share");
+    for(size_t block : {1, 2, 4, 8, 16, 32, 48, 64, 128, 256})
+    {
+        const double old_ns = opt.bits == 24
+                                  ? Time(PerSample, block, opt.blocks)
+                                  : 0.0;
+        const double new_ns = Time(kernels, block, opt.blocks);
+        const double budget = 1e9 * block / kSampleRate;
+        if(old_ns > 0.0)
+            printf("%6zu %14.1f %14.1f %9.2fx %9.3f%%\n",
+                   block,
+                   old_ns,
+                   new_ns,
+                   old_ns / new_ns,
+                   100.0 * new_ns / budget);
+        else
+            printf("%6zu %14s %14.1f %10s %9.3f%%\n",
+                   block,
+                   "-",
+                   new_ns,
+                   "-",
+                   100.0 * new_ns / budget);
+    }
+    return 0;
+}
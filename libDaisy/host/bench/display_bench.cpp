@@ -0,0 +1,189 @@
+/** OLED display drawing benchmark, built for the host.
+
+Draws a typical parameter page to a 128x64 display, frame after frame: a
+title, four labelled values with bar meters, and a frame around them. Each
+frame clears the screen and redraws everything, and one value moves every
+few frames, as a knob being turned would.
+
+Two drivers behind OledDisplay are compared. The first is the SSD130x
+driver as it used to be: every pixel is drawn by itself and Update() sends
+the whole buffer. The second is FrameBufferDriver, which draws spans and
+glyphs a byte at a time and only sends the columns that changed. Both send
+to memory instead of a display.
+
+Reported are the time to draw a frame, the bytes sent per frame, and how
+long those take on an SPI bus of the given clock.
+
+Usage:
+    display_bench [--frames N] [--spi-mhz MHZ]
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "hid/disp/oled_display.h"
+#include "hid/disp/paged_framebuffer.h"
+
+using namespace daisy;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    size_t frames  = 20000;
+    double spi_mhz = 12.5;
+};
+
+void PrintUsage(const char* name)
+{
+    printf("usage: %s [--frames N] [--spi-mhz MHZ]\n", name);
+}
+
+bool ParseOptions(int argc, char** argv, Options& opt)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const char*       value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(value == nullptr)
+            return false;
+        if(arg == "--frames")
+            opt.frames = strtoul(value, nullptr, 10);
+        else if(arg == "--spi-mhz")
+            opt.spi_mhz = atof(value);
+        else
+            return false;
+        i++;
+    }
+    return opt.frames > 0 && opt.spi_mhz > 0.0;
+}
+
+/** The SSD130x driver as it used to be, sending to memory */
+class PixelDriver
+{
+  public:
+    struct Config
+    {
+    };
+
+    void Init(Config) { bytes_sent_ = 0; }
+
+    size_t Width() const { return 128; }
+    size_t Height() const { return 64; }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
+    {
+        if(x >= 128 || y >= 64)
+            return;
+        if(on)
+            buffer_[x + (y / 8) * 128] |= (1 << (y % 8));
+        else
+            buffer_[x + (y / 8) * 128] &= ~(1 << (y % 8));
+    }
+
+    void Fill(bool on)
+    {
+        for(size_t i = 0; i < sizeof(buffer_); i++)
+            buffer_[i] = on ? 0xff : 0x00;
+    }
+
+    void Update()
+    {
+        for(size_t page = 0; page < 8; page++)
+        {
+            memcpy(screen_ + page * 128, buffer_ + page * 128, 128);
+            bytes_sent_ += 128;
+        }
+    }
+
+    size_t GetBytesSent() const { return bytes_sent_; }
+
+  private:
+    uint8_t buffer_[1024];
+    uint8_t screen_[1024];
+    size_t  bytes_sent_;
+};
+
+/** Draws frame number frame of the parameter page */
+void DrawPage(OneBitGraphicsDisplay& display, size_t frame)
+{
+    static const char* labels[] = {"Freq", "Res", "Drive", "Mix"};
+    char               text[16];
+
+    display.Fill(false);
+    display.SetCursor(0, 0);
+    display.WriteString("Filter", Font_7x10, true);
+    display.DrawLine(0, 11, 127, 11, true);
+    for(size_t i = 0; i < 4; i++)
+    {
+        // One value moves every 8 frames, the others stand still
+        const size_t value = i == 0 ? (frame / 8) % 100 : 25 * i;
+        const int    y     = 14 + 12 * i;
+        display.SetCursor(2, y);
+        display.WriteString(labels[i], Font_6x8, true);
+        snprintf(text, sizeof(text), "%3zu", value);
+        display.SetCursor(40, y);
+        display.WriteString(text, Font_6x8, true);
+        display.DrawRect(62, y, 125, y + 7, true);
+        display.DrawRect(64, y + 2, 64 + (value * 59) / 100, y + 5, true, true);
+    }
+}
+
+struct Result
+{
+    double ns_per_frame;
+    double bytes_per_frame;
+};
+
+template <typename Driver>
+Result Run(size_t frames)
+{
+    static OledDisplay<Driver> display;
+    display.Init(typename OledDisplay<Driver>::Config());
+
+    const auto start = Clock::now();
+    for(size_t f = 0; f < frames; f++)
+    {
+        DrawPage(display, f);
+        display.Update();
+    }
+    const std::chrono::duration<double, std::nano> took = Clock::now() - start;
+
+    return {took.count() / frames,
+            double(display.GetDriver().GetBytesSent()) / frames};
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!ParseOptions(argc, argv, opt))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    const Result old_result = Run<PixelDriver>(opt.frames);
+    const Result new_result = Run<FrameBufferDriver<128, 64>>(opt.frames);
+
+    printf("%zu frames, SPI at %.1f MHz\n\n", opt.frames, opt.spi_mhz);
+    printf("%-14s %14s %14s %14s\n",
+           "driver",
+           "draw us/frame",
+           "bytes/frame",
+           "SPI us/frame");
+    const Result*     results[] = {&old_result, &new_result};
+    const char* const names[]   = {"per pixel", "frame buffer"};
+    for(size_t i = 0; i < 2; i++)
+    {
+        printf("%-14s %14.2f %14.1f %14.1f\n",
+               names[i],
+               results[i]->ns_per_frame / 1000.0,
+               results[i]->bytes_per_frame,
+               results[i]->bytes_per_frame * 8.0 / opt.spi_mhz);
+    }
+    return 0;
+}
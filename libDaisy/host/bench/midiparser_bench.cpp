@@ -0,0 +1,231 @@
+/** MIDI parsing benchmark, built for the host.
+
+Generates dense MIDI streams as they would come in over a number of DIN
+ports at 31250 baud, and parses them with MidiParser, once a byte at a time
+with Parse(), and once a DMA buffer at a time with ParseBuffer().
+
+The streams are:
+- notes: running status notes and controllers on one channel
+- mpe:   per-note pitch bend, pressure and timbre on 15 channels, with clock
+- sysex: SysEx dumps with clock in between and inside them
+
+Reported are the time per byte and per event, and the share of a core that
+the given number of ports, each running at full speed, would take.
+
+Usage:
+    midiparser_bench [--ports N] [--seconds N] [--dma N] [--repeat N]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "hid/midi_parser.h"
+
+using namespace daisy;
+
+namespace
+{
+constexpr double kBytesPerSecond = 31250.0 / 10.0; // 8N1
+
+using Clock  = std::chrono::steady_clock;
+using Stream = std::vector<uint8_t>;
+
+struct Options
+{
+    int    ports   = 8;
+    float  seconds = 60.f;
+    size_t dma     = 64;
+    int    repeat  = 5;
+};
+
+void PrintUsage(const char* name)
+{
+    printf("usage: %s [--ports N] [--seconds N] [--dma N] [--repeat N]\n",
+           name);
+}
+
+bool ParseOptions(int argc, char** argv, Options& opt)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const char*       value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(value == nullptr)
+            return false;
+        if(arg == "--ports")
+            opt.ports = atoi(value);
+        else if(arg == "--seconds")
+            opt.seconds = strtof(value, nullptr);
+        else if(arg == "--dma")
+            opt.dma = strtoul(value, nullptr, 10);
+        else if(arg == "--repeat")
+            opt.repeat = atoi(value);
+        else
+            return false;
+        i++;
+    }
+    return opt.ports > 0 && opt.seconds > 0.f && opt.dma > 0
+           && opt.repeat > 0;
+}
+
+/** Makes a stream of the given length, by adding messages with add() */
+template <typename F>
+Stream MakeStream(size_t length, unsigned seed, F&& add)
+{
+    std::mt19937 rng(seed);
+    Stream       s;
+    while(s.size() < length)
+        add(rng, s);
+    s.resize(length);
+    return s;
+}
+
+int Random(std::mt19937& rng, int n)
+{
+    return std::uniform_int_distribution<int>(0, n - 1)(rng);
+}
+
+void AddNotes(std::mt19937& rng, Stream& s)
+{
+    if(s.empty())
+        s.push_back(0x90);
+    s.push_back(Random(rng, 128));
+    s.push_back(Random(rng, 128));
+}
+
+void AddMpe(std::mt19937& rng, Stream& s)
+{
+    static const uint8_t kTypes[] = {0x90, 0xE0, 0xE0, 0xD0, 0xB0, 0x80};
+    const uint8_t        type     = kTypes[Random(rng, 6)];
+    s.push_back(type | (1 + Random(rng, 15)));
+    s.push_back(type == 0xB0 ? 74 : Random(rng, 128));
+    if(type != 0xD0)
+        s.push_back(Random(rng, 128));
+    if(Random(rng, 8) == 0)
+        s.push_back(0xF8);
+}
+
+void AddSysEx(std::mt19937& rng, Stream& s)
+{
+    s.push_back(0xF0);
+    const int len = 16 + Random(rng, 240);
+    for(int i = 0; i < len; i++)
+    {
+        s.push_back(Random(rng, 128));
+        if(Random(rng, 32) == 0)
+            s.push_back(0xF8);
+    }
+    s.push_back(0xF7);
+    s.push_back(0xF8);
+}
+
+struct Result
+{
+    double ns;
+    size_t events;
+};
+
+/** Parses every port's stream, a DMA buffer per port in turn */
+template <typename F>
+Result Run(const std::vector<Stream>& ports, size_t dma, int repeat, F&& parse)
+{
+    std::vector<MidiParser> parsers(ports.size());
+    std::vector<MidiEvent>  events(dma);
+    Result                  best = {1e300, 0};
+    for(int r = 0; r < repeat; r++)
+    {
+        for(auto& p : parsers)
+            p.Init();
+        size_t     count = 0;
+        const auto start = Clock::now();
+        for(size_t pos = 0; pos < ports[0].size(); pos += dma)
+        {
+            const size_t n = std::min(dma, ports[0].size() - pos);
+            for(size_t p = 0; p < ports.size(); p++)
+                count += parse(parsers[p], &ports[p][pos], n, events.data());
+        }
+        const std::chrono::duration<double, std::nano> took
+            = Clock::now() - start;
+        best = took.count() < best.ns ? Result{took.count(), count} : best;
+    }
+    return best;
+}
+
+size_t ByteAtATime(MidiParser&    parser,
+                   const uint8_t* data,
+                   size_t         size,
+                   MidiEvent*     events)
+{
+    size_t n = 0;
+    for(size_t i = 0; i < size; i++)
+        n += parser.Parse(data[i], &events[n]) ? 1 : 0;
+    return n;
+}
+
+size_t WholeBuffer(MidiParser&    parser,
+                   const uint8_t* data,
+                   size_t         size,
+                   MidiEvent*     events)
+{
+    // A DMA buffer can't hold more events than bytes.
+    return parser.ParseBuffer(data, size, events, size);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!ParseOptions(argc, argv, opt))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    const size_t length = static_cast<size_t>(opt.seconds * kBytesPerSecond);
+    printf("%d ports, %.0f s of 31250 baud each, %zu byte DMA buffers\n\n",
+           opt.ports,
+           opt.seconds,
+           opt.dma);
+    printf("%-6s %-12s %10s %10s %12s\n",
+           "stream",
+           "method",
+           "ns/byte",
+           "ns/event",
+           "core share");
+
+    const struct
+    {
+        const char* name;
+        void (*add)(std::mt19937&, Stream&);
+    } kinds[] = {{"notes", AddNotes}, {"mpe", AddMpe}, {"sysex", AddSysEx}};
+
+    for(const auto& kind : kinds)
+    {
+        std::vector<Stream> ports;
+        for(int p = 0; p < opt.ports; p++)
+            ports.push_back(MakeStream(length, 1 + p, kind.add));
+        const double bytes = static_cast<double>(length) * opt.ports;
+
+        const struct
+        {
+            const char* name;
+            Result      result;
+        } methods[] = {
+            {"Parse", Run(ports, opt.dma, opt.repeat, ByteAtATime)},
+            {"ParseBuffer", Run(ports, opt.dma, opt.repeat, WholeBuffer)},
+        };
+        for(const auto& m : methods)
+        {
+            printf("%-6s %-12s %10.2f %10.2f %11.4f%%\n",
+                   kind.name,
+                   m.name,
+                   m.result.ns / bytes,
+                   m.result.ns / std::max<size_t>(m.result.events, 1),
+                   100.0 * m.result.ns * 1e-9 / opt.seconds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+/** Multitrack recording benchmark for WavWriter, using the POSIX FatFs stand-in.
+
+One thread plays the audio callback and records a mono track per WavWriter
+with SampleBlock(), like a multitrack recorder on the Daisy would.
+A background thread stands in for the main loop and calls Write() on every
+writer. The audio runs in real time by default, or as fast as it can with
+--speed 0.
+
+Reported are the data rate, the frames lost because the writes fell behind,
+and the longest single Write() call, which decides how many buffers are needed.
+
+Usage:
+    wavwriter_bench [--tracks N] [--bits 16|24|32|f32] [--seconds N]
+                    [--block N] [--speed N] [--dir path]
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "util/WavWriter.h"
+
+using namespace daisy;
+
+namespace
+{
+constexpr float  kSampleRate   = 48000.f;
+constexpr size_t kTransferSize = 32768;
+constexpr size_t kNumBuffers   = 4;
+
+using Writer = WavWriter<kTransferSize, kNumBuffers>;
+using Clock  = std::chrono::steady_clock;
+
+struct Options
+{
+    int         tracks     = 8;
+    int         bits       = 24;
+    bool        float_data = false;
+    float       seconds    = 10.f;
+    size_t      block      = 48;
+    float       speed      = 1.f;
+    std::string dir        = ".";
+};
+
+void PrintUsage(const char* name)
+{
+    printf("usage: %s [--tracks N] [--bits 16|24|32|f32] [--seconds N]\n"
+           "       [--block N] [--speed N (0 for unpaced)] [--dir path]\n",
+           name);
+}
+
+bool ParseOptions(int argc, char** argv, Options& opt)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if(i + 1 >= argc)
+            return false;
+        const char* value = argv[++i];
+        if(arg == "--tracks")
+            opt.tracks = atoi(value);
+        else if(arg == "--bits")
+        {
+            opt.float_data = strcmp(value, "f32") == 0;
+            opt.bits       = opt.float_data ? 32 : atoi(value);
+        }
+        else if(arg == "--seconds")
+            opt.seconds = strtof(value, nullptr);
+        else if(arg == "--block")
+            opt.block = strtoul(value, nullptr, 10);
+        else if(arg == "--speed")
+            opt.speed = strtof(value, nullptr);
+        else if(arg == "--dir")
+            opt.dir = value;
+        else
+            return false;
+    }
+    return opt.tracks > 0 && opt.block > 0 && opt.seconds > 0.f;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!ParseOptions(argc, argv, opt))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    // The writers hold their buffers inline, so they go on the heap.
+    std::vector<std::unique_ptr<Writer>> writers;
+    for(int t = 0; t < opt.tracks; t++)
+    {
+        writers.emplace_back(new Writer);
+        Writer::Config cfg;
+        cfg.samplerate     = kSampleRate;
+        cfg.channels       = 1;
+        cfg.bitspersample  = opt.bits;
+        cfg.floating_point = opt.float_data;
+        const std::string path
+            = opt.dir + "/track" + std::to_string(t + 1) + ".wav";
+        if(writers.back()->Init(cfg) != Writer::Result::OK
+           || writers.back()->OpenFile(path.c_str()) != Writer::Result::OK)
+        {
+            fprintf(stderr, "error: can't record to %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    // Background flushing, as the main loop would do on the Daisy
+    std::atomic<bool> done(false);
+    double            max_write_ms = 0.0;
+    bool              write_error  = false;
+    std::thread       flusher([&]() {
+        while(!done.load())
+        {
+            for(auto& w : writers)
+            {
+                const auto start = Clock::now();
+                write_error |= w->Write() != Writer::Result::OK;
+                const std::chrono::duration<double, std::milli> took
+                    = Clock::now() - start;
+                max_write_ms = std::max(max_write_ms, took.count());
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    // The audio callback, one block at a time
+    const size_t num_blocks = static_cast<size_t>(opt.seconds * kSampleRate)
+                              / opt.block;
+    const std::chrono::duration<double> block_time(
+        opt.speed > 0.f ? opt.block / (kSampleRate * opt.speed) : 0.0);
+    std::vector<float> buffer(opt.block);
+    float              phase = 0.f;
+    const auto         start = Clock::now();
+    for(size_t b = 0; b < num_blocks; b++)
+    {
+        if(opt.speed > 0.f)
+            std::this_thread::sleep_until(
+                start
+                + std::chrono::duration_cast<Clock::duration>(block_time * b));
+        for(size_t i = 0; i < opt.block; i++)
+        {
+            phase     = phase + 440.f / kSampleRate;
+            phase     = phase >= 1.f ? phase - 1.f : phase;
+            buffer[i] = 0.5f * sinf(6.2831853f * phase);
+        }
+        for(auto& w : writers)
+            w->SampleBlock(buffer.data(), opt.block);
+    }
+    done.store(true);
+    flusher.join();
+
+    uint32_t dropped = 0;
+    uint32_t frames  = 0;
+    for(auto& w : writers)
+    {
+        dropped += w->GetDroppedFrames();
+        frames += w->GetLengthSamps();
+        write_error |= w->SaveFile() != Writer::Result::OK;
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    const double bytes = static_cast<double>(frames)
+                         * (opt.float_data ? 4 : opt.bits / 8);
+    printf("%d tracks, %d bit%s, %zu frame blocks, %zu x %zu byte buffers\n",
+           opt.tracks,
+           opt.bits,
+           opt.float_data ? " float" : "",
+           opt.block,
+           kNumBuffers,
+           kTransferSize);
+    printf("recorded %.2f s per track in %.2f s, %.1f MB/s\n",
+           frames / (kSampleRate * opt.tracks),
+           elapsed.count(),
+           bytes / elapsed.count() * 1e-6);
+    printf("dropped frames: %u (%.2f %%)\n",
+           dropped,
+           100.0 * dropped / std::max<double>(dropped + frames, 1.0));
+    printf("longest Write(): %.3f ms, buffers cover %.1f ms per track\n",
+           max_write_ms,
+           1000.0 * kTransferSize * (kNumBuffers - 1)
+               / (kSampleRate * (opt.float_data ? 4 : opt.bits / 8)));
+    if(write_error)
+    {
+        fprintf(stderr, "error: writing failed\n");
+        return 1;
+    }
+    return 0;
+}
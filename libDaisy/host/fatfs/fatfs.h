@@ -0,0 +1,76 @@
+#ifndef __fatfs_H
+#define __fatfs_H /**< & */
+
+#include "ff.h"
+
+namespace daisy
+{
+/** @brief Host stand-in for the Daisy FatFS Driver Interface
+ *  @details Same interface as src/sys/fatfs.h. There is no media to link,
+ *           every volume is the current directory (see ff.h in this directory).
+ */
+class FatFSInterface
+{
+  public:
+    /** Return values specifying specific errors for linking Daisy to FatFS */
+    enum Result
+    {
+        OK,
+        ERR_TOO_MANY_VOLUMES,
+        ERR_NO_MEDIA_SELECTED,
+        ERR_GENERIC,
+    };
+
+    /** Config structure for configuring Daisy to FatFS */
+    struct Config
+    {
+        enum Media : uint8_t
+        {
+            MEDIA_SD  = 0x01,
+            MEDIA_USB = 0x02,
+        };
+
+        uint8_t media;
+    };
+
+    FatFSInterface() {}
+
+    /** Assigns volume paths in the same order as the hardware version */
+    Result Init(const Config& cfg);
+
+    /** Alternate, explicit initialization provided for simplified syntax. */
+    Result Init(const uint8_t media);
+
+    Result DeInit();
+
+    bool Initialized() const { return initialized_; }
+
+    const Config& GetConfig() const { return cfg_; }
+
+    Config& GetMutableConfig() { return cfg_; }
+
+    /** Returns the path to an SD Card volume to use with f_mount */
+    const char* GetSDPath() const { return path_[0]; }
+
+    /** Returns the path to a USB Device volume to use with f_mount */
+    const char* GetUSBPath() const { return path_[1]; }
+
+    FATFS& GetSDFileSystem() { return fs_[0]; }
+
+    FATFS& GetUSBFileSystem() { return fs_[1]; }
+
+  private:
+    Config cfg_;
+    FATFS  fs_[_VOLUMES];
+    char   path_[_VOLUMES][4];
+    bool   initialized_ = false;
+};
+
+} // namespace daisy
+
+/** Implementation of FatFS time method
+ *  @return 0
+*/
+extern "C" DWORD get_fattime(void);
+
+#endif
@@ -0,0 +1,99 @@
+/* Host stand-in for the FatFs API, backed by plain POSIX files.
+ *
+ * Only the file functions libDaisy uses are provided. Paths are used as
+ * given, except that a volume prefix like "0:/" is removed, so every
+ * volume maps onto the current directory.
+ */
+#ifndef _FATFS
+#define _FATFS 68300 /* same revision as Middlewares/Third_Party/FatFs */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef unsigned int UINT;
+    typedef unsigned char BYTE;
+    typedef uint16_t      WORD;
+    typedef uint32_t      DWORD;
+    typedef uint64_t      QWORD;
+    typedef char          TCHAR;
+    typedef DWORD         FSIZE_t;
+
+#define _VOLUMES 2
+
+    /* File system object, nothing to mount on the host */
+    typedef struct
+    {
+        BYTE fs_type;
+    } FATFS;
+
+    typedef struct
+    {
+        FSIZE_t objsize; /* file size */
+    } FFOBJID;
+
+    /* File object */
+    typedef struct
+    {
+        FFOBJID obj;
+        BYTE    flag; /* FA_ mode the file was opened with */
+        BYTE    err;
+        FSIZE_t fptr; /* read/write position */
+        void*   file; /* FILE* */
+    } FIL;
+
+    typedef enum
+    {
+        FR_OK = 0,
+        FR_DISK_ERR,
+        FR_INT_ERR,
+        FR_NOT_READY,
+        FR_NO_FILE,
+        FR_NO_PATH,
+        FR_INVALID_NAME,
+        FR_DENIED,
+        FR_EXIST,
+        FR_INVALID_OBJECT,
+        FR_WRITE_PROTECTED,
+        FR_INVALID_DRIVE,
+        FR_NOT_ENABLED,
+        FR_NO_FILESYSTEM,
+        FR_MKFS_ABORTED,
+        FR_TIMEOUT,
+        FR_LOCKED,
+        FR_NOT_ENOUGH_CORE,
+        FR_TOO_MANY_OPEN_FILES,
+        FR_INVALID_PARAMETER
+    } FRESULT;
+
+    FRESULT f_open(FIL* fp, const TCHAR* path, BYTE mode);
+    FRESULT f_close(FIL* fp);
+    FRESULT f_read(FIL* fp, void* buff, UINT btr, UINT* br);
+    FRESULT f_write(FIL* fp, const void* buff, UINT btw, UINT* bw);
+    FRESULT f_lseek(FIL* fp, FSIZE_t ofs);
+    FRESULT f_sync(FIL* fp);
+    FRESULT f_unlink(const TCHAR* path);
+    FRESULT f_mount(FATFS* fs, const TCHAR* path, BYTE opt);
+
+#define f_eof(fp) ((int)((fp)->fptr == (fp)->obj.objsize))
+#define f_error(fp) ((fp)->err)
+#define f_tell(fp) ((fp)->fptr)
+#define f_size(fp) ((fp)->obj.objsize)
+#define f_rewind(fp) f_lseek((fp), 0)
+
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+#define FA_OPEN_APPEND 0x30
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FATFS */
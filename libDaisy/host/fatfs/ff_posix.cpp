@@ -0,0 +1,195 @@
+#include "fatfs.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace daisy;
+
+namespace
+{
+/** Strips a volume prefix like "0:" or "0:/" */
+const char* HostPath(const TCHAR* path)
+{
+    if(path[0] >= '0' && path[0] <= '9' && path[1] == ':')
+    {
+        path += 2;
+        while(*path == '/')
+            path++;
+    }
+    return path;
+}
+
+FILE* File(FIL* fp)
+{
+    return fp ? static_cast<FILE*>(fp->file) : nullptr;
+}
+
+FRESULT ErrnoResult()
+{
+    switch(errno)
+    {
+        case ENOENT: return FR_NO_FILE;
+        case ENOTDIR: return FR_NO_PATH;
+        case EEXIST: return FR_EXIST;
+        case EACCES:
+        case EPERM: return FR_DENIED;
+        case EROFS: return FR_WRITE_PROTECTED;
+        case EMFILE: return FR_TOO_MANY_OPEN_FILES;
+        default: return FR_DISK_ERR;
+    }
+}
+} // namespace
+
+extern "C"
+{
+    FRESULT f_open(FIL* fp, const TCHAR* path, BYTE mode)
+    {
+        if(!fp)
+            return FR_INVALID_OBJECT;
+        fp->file         = nullptr;
+        const char* name = HostPath(path);
+
+        // Map the FatFs creation modes onto fopen() ones. "r+b" and "w+b"
+        // are used for writing, since "ab" wouldn't allow f_lseek().
+        FILE* f = nullptr;
+        if(mode & FA_CREATE_ALWAYS)
+        {
+            f = fopen(name, "w+b");
+        }
+        else if(mode & FA_CREATE_NEW)
+        {
+            f = fopen(name, "rb");
+            if(f)
+            {
+                fclose(f);
+                return FR_EXIST;
+            }
+            f = fopen(name, "w+b");
+        }
+        else if(mode & FA_OPEN_ALWAYS)
+        {
+            f = fopen(name, "r+b");
+            if(!f && errno == ENOENT)
+                f = fopen(name, "w+b");
+        }
+        else
+        {
+            f = fopen(name, (mode & FA_WRITE) ? "r+b" : "rb");
+        }
+        if(!f)
+            return ErrnoResult();
+
+        fseek(f, 0, SEEK_END);
+        fp->obj.objsize = static_cast<FSIZE_t>(ftell(f));
+        fp->fptr        = 0;
+        // FA_OPEN_APPEND includes the bits of FA_OPEN_ALWAYS
+        if((mode & FA_OPEN_APPEND) == FA_OPEN_APPEND)
+            fp->fptr = fp->obj.objsize;
+        fseek(f, static_cast<long>(fp->fptr), SEEK_SET);
+        fp->flag = mode;
+        fp->err  = 0;
+        fp->file = f;
+        return FR_OK;
+    }
+
+    FRESULT f_close(FIL* fp)
+    {
+        FILE* f = File(fp);
+        if(!f)
+            return FR_INVALID_OBJECT;
+        fp->file = nullptr;
+        return fclose(f) == 0 ? FR_OK : FR_DISK_ERR;
+    }
+
+    FRESULT f_read(FIL* fp, void* buff, UINT btr, UINT* br)
+    {
+        FILE* f = File(fp);
+        *br     = 0;
+        if(!f)
+            return FR_INVALID_OBJECT;
+        if(!(fp->flag & FA_READ))
+            return FR_DENIED;
+        *br = static_cast<UINT>(fread(buff, 1, btr, f));
+        fp->fptr += *br;
+        return ferror(f) ? FR_DISK_ERR : FR_OK;
+    }
+
+    FRESULT f_write(FIL* fp, const void* buff, UINT btw, UINT* bw)
+    {
+        FILE* f = File(fp);
+        *bw     = 0;
+        if(!f)
+            return FR_INVALID_OBJECT;
+        if(!(fp->flag & FA_WRITE))
+            return FR_DENIED;
+        *bw = static_cast<UINT>(fwrite(buff, 1, btw, f));
+        fp->fptr += *bw;
+        if(fp->fptr > fp->obj.objsize)
+            fp->obj.objsize = fp->fptr;
+        // Like FatFs, a full disk is reported through bw, not the result.
+        return ferror(f) && *bw == 0 ? FR_DISK_ERR : FR_OK;
+    }
+
+    FRESULT f_lseek(FIL* fp, FSIZE_t ofs)
+    {
+        FILE* f = File(fp);
+        if(!f)
+            return FR_INVALID_OBJECT;
+        // FatFs doesn't seek past the end of files opened for reading only.
+        if(!(fp->flag & FA_WRITE) && ofs > fp->obj.objsize)
+            ofs = fp->obj.objsize;
+        if(fseek(f, static_cast<long>(ofs), SEEK_SET) != 0)
+            return FR_DISK_ERR;
+        fp->fptr = ofs;
+        return FR_OK;
+    }
+
+    FRESULT f_sync(FIL* fp)
+    {
+        FILE* f = File(fp);
+        if(!f)
+            return FR_INVALID_OBJECT;
+        return fflush(f) == 0 ? FR_OK : FR_DISK_ERR;
+    }
+
+    FRESULT f_unlink(const TCHAR* path)
+    {
+        return remove(HostPath(path)) == 0 ? FR_OK : ErrnoResult();
+    }
+
+    FRESULT f_mount(FATFS*, const TCHAR*, BYTE) { return FR_OK; }
+
+    DWORD get_fattime(void) { return 0; }
+}
+
+FatFSInterface::Result FatFSInterface::Init(const FatFSInterface::Config& cfg)
+{
+    // Volumes are numbered in the order FatFs links them on the hardware.
+    cfg_         = cfg;
+    int volume   = 0;
+    initialized_ = false;
+    for(int i = 0; i < _VOLUMES; i++)
+    {
+        path_[i][0] = '\0';
+        if(cfg_.media & (1 << i))
+            snprintf(path_[i], sizeof(path_[i]), "%d:/", volume++);
+    }
+    if(volume == 0)
+        return Result::ERR_NO_MEDIA_SELECTED;
+    initialized_ = true;
+    return Result::OK;
+}
+
+FatFSInterface::Result FatFSInterface::Init(const uint8_t media)
+{
+    cfg_.media = media;
+    return Init(cfg_);
+}
+
+FatFSInterface::Result FatFSInterface::DeInit()
+{
+    if(!initialized_)
+        return Result::ERR_NO_MEDIA_SELECTED;
+    initialized_ = false;
+    return Result::OK;
+}
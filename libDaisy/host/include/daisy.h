@@ -0,0 +1,33 @@
+#ifndef DSY_LIBDAISY_H
+#define DSY_LIBDAISY_H
+
+/** Host build stand-in for daisy.h.
+ *  Only the parts of libDaisy that don't touch the hardware directly
+ *  are available, see host/README.md.
+ */
+
+#include <stdint.h>
+#include "daisy_core.h"
+#include "sys/system.h"
+#include "per/gpio.h"
+#include "hid/audio.h"
+#include "hid/ctrl.h"
+#include "hid/encoder.h"
+#include "hid/switch.h"
+#include "hid/led.h"
+#include "hid/rgb_led.h"
+#include "util/color.h"
+#include "util/FIFO.h"
+#include "util/FixedCapStr.h"
+#include "util/MappedValue.h"
+#include "util/Stack.h"
+#include "util/ringbuffer.h"
+#include "util/wav_format.h"
+#include "util/WavWriter.h"
+#include "hid/wavsampler.h"
+#include "fatfs.h"
+
+/** SDRAM buffers are ordinary memory on the host */
+#define DSY_SDRAM_BSS
+
+#endif
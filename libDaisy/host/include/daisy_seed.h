@@ -0,0 +1,102 @@
+#pragma once
+#ifndef DSY_SEED_H
+#define DSY_SEED_H
+
+#include <stdio.h>
+#include "daisy.h"
+
+namespace daisy
+{
+/**
+   @brief Host build stand-in for the Daisy Seed. \n
+    Audio runs through the host runtime, see host/README.md.
+    Peripherals other than audio are not available.
+
+   @ingroup boards
+*/
+class DaisySeed
+{
+  public:
+    DaisySeed() {}
+    ~DaisySeed() {}
+
+    /** Does nothing on the host */
+    void Configure() {}
+
+    /** Resets the audio settings to the Seed's defaults */
+    void Init(bool boost = false);
+
+    /** Does nothing on the host */
+    void DeInit() {}
+
+    /** Waits for the audio to advance by del milliseconds */
+    void DelayMs(size_t del);
+
+    /** Starts the callback
+    \param cb Interleaved callback function
+    */
+    void StartAudio(AudioHandle::InterleavingAudioCallback cb);
+
+    /** Starts the callback
+    \param cb multichannel callback function
+    */
+    void StartAudio(AudioHandle::AudioCallback cb);
+
+    /** Switch callback functions
+    \param cb New interleaved callback function.
+    */
+    void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb);
+
+    /** Switch callback functions
+    \param cb New multichannel callback function.
+    */
+    void ChangeAudioCallback(AudioHandle::AudioCallback cb);
+
+    /** Stops the audio, the output is silent from then on */
+    void StopAudio();
+
+    /** Updates the Audio Sample Rate */
+    void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate);
+
+    /** Returns the audio sample rate in Hz as a floating point number. */
+    float AudioSampleRate();
+
+    /** Sets the number of samples processed per channel by the audio callback.
+     *  The host's --block option takes precedence.
+     */
+    void SetAudioBlockSize(size_t blocksize);
+
+    /** Returns the number of samples per channel in a block of audio. */
+    size_t AudioBlockSize();
+
+    /** Returns the rate in Hz that the Audio callback is called */
+    float AudioCallbackRate() const;
+
+    /** Does nothing on the host */
+    void SetLed(bool state) { (void)state; }
+
+    /** Does nothing on the host */
+    void SetTestPoint(bool state) { (void)state; }
+
+    /** Print formatted debug log message to stdout */
+    template <typename... VA>
+    static void Print(const char* format, VA... va)
+    {
+        printf(format, va...);
+    }
+
+    /** Print formatted debug log message with automatic line termination */
+    template <typename... VA>
+    static void PrintLine(const char* format, VA... va)
+    {
+        printf(format, va...);
+        printf("\n");
+    }
+
+    /** Does nothing on the host, stdout is always connected */
+    static void StartLog(bool wait_for_pc = false) { (void)wait_for_pc; }
+};
+
+} // namespace daisy
+
+#endif
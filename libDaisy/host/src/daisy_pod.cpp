@@ -0,0 +1,122 @@
+#include "daisy_pod.h"
+#include "host_runtime.h"
+
+using namespace daisy;
+using namespace daisy::host;
+
+void DaisyPod::Init(bool boost)
+{
+    Runtime& runtime = Runtime::Get();
+    seed.Configure();
+    seed.Init(boost);
+
+    dsy_gpio_pin enc_a, enc_b;
+    runtime.AddEncoder("encoder", &enc_a, &enc_b);
+    encoder.Init(enc_a, enc_b, runtime.AddSwitch("encoder_button"));
+
+    button1.Init(runtime.AddSwitch("button1"));
+    button2.Init(runtime.AddSwitch("button2"));
+    buttons[BUTTON_1] = &button1;
+    buttons[BUTTON_2] = &button2;
+
+    led1.Init(runtime.AddOutput(), runtime.AddOutput(), runtime.AddOutput(), true);
+    led2.Init(runtime.AddOutput(), runtime.AddOutput(), runtime.AddOutput(), true);
+    ClearLeds();
+    UpdateLeds();
+
+    knobs[KNOB_1] = &knob1;
+    knobs[KNOB_2] = &knob2;
+    knob1.Init(runtime.AddKnob("knob1"), seed.AudioCallbackRate());
+    knob2.Init(runtime.AddKnob("knob2"), seed.AudioCallbackRate());
+}
+
+void DaisyPod::DelayMs(size_t del)
+{
+    seed.DelayMs(del);
+}
+
+void DaisyPod::StartAudio(AudioHandle::InterleavingAudioCallback cb)
+{
+    seed.StartAudio(cb);
+}
+
+void DaisyPod::StartAudio(AudioHandle::AudioCallback cb)
+{
+    seed.StartAudio(cb);
+}
+
+void DaisyPod::ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb)
+{
+    seed.ChangeAudioCallback(cb);
+}
+
+void DaisyPod::ChangeAudioCallback(AudioHandle::AudioCallback cb)
+{
+    seed.ChangeAudioCallback(cb);
+}
+
+void DaisyPod::StopAudio()
+{
+    seed.StopAudio();
+}
+
+void DaisyPod::SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate)
+{
+    seed.SetAudioSampleRate(samplerate);
+    knob1.SetSampleRate(AudioCallbackRate());
+    knob2.SetSampleRate(AudioCallbackRate());
+}
+
+float DaisyPod::AudioSampleRate()
+{
+    return seed.AudioSampleRate();
+}
+
+void DaisyPod::SetAudioBlockSize(size_t blocksize)
+{
+    seed.SetAudioBlockSize(blocksize);
+    knob1.SetSampleRate(AudioCallbackRate());
+    knob2.SetSampleRate(AudioCallbackRate());
+}
+
+size_t DaisyPod::AudioBlockSize()
+{
+    return seed.AudioBlockSize();
+}
+
+float DaisyPod::AudioCallbackRate()
+{
+    return seed.AudioCallbackRate();
+}
+
+void DaisyPod::ProcessAnalogControls()
+{
+    knob1.Process();
+    knob2.Process();
+}
+
+float DaisyPod::GetKnobValue(Knob k)
+{
+    size_t idx;
+    idx = k < KNOB_LAST ? k : KNOB_1;
+    return knobs[idx]->Value();
+}
+
+void DaisyPod::ProcessDigitalControls()
+{
+    encoder.Debounce();
+    button1.Debounce();
+    button2.Debounce();
+}
+
+void DaisyPod::ClearLeds()
+{
+    led1.Set(0.0f, 0.0f, 0.0f);
+    led2.Set(0.0f, 0.0f, 0.0f);
+}
+
+void DaisyPod::UpdateLeds()
+{
+    led1.Update();
+    led2.Update();
+}
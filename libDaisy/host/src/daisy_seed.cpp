@@ -0,0 +1,76 @@
+#include "daisy_seed.h"
+#include "host_runtime.h"
+
+using namespace daisy;
+using namespace daisy::host;
+
+void DaisySeed::Init(bool boost)
+{
+    (void)boost;
+    Runtime::Get().SetSampleRate(48000.f);
+    Runtime::Get().SetBlockSize(48);
+}
+
+void DaisySeed::DelayMs(size_t del)
+{
+    System::Delay(del);
+}
+
+void DaisySeed::StartAudio(AudioHandle::InterleavingAudioCallback cb)
+{
+    Runtime::Get().SetCallback(cb);
+}
+
+void DaisySeed::StartAudio(AudioHandle::AudioCallback cb)
+{
+    Runtime::Get().SetCallback(cb);
+}
+
+void DaisySeed::ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb)
+{
+    Runtime::Get().SetCallback(cb);
+}
+
+void DaisySeed::ChangeAudioCallback(AudioHandle::AudioCallback cb)
+{
+    Runtime::Get().SetCallback(cb);
+}
+
+void DaisySeed::StopAudio()
+{
+    Runtime::Get().StopAudio();
+}
+
+void DaisySeed::SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate)
+{
+    float sr;
+    switch(samplerate)
+    {
+        case SaiHandle::Config::SampleRate::SAI_8KHZ: sr = 8000.f; break;
+        case SaiHandle::Config::SampleRate::SAI_16KHZ: sr = 16000.f; break;
+        case SaiHandle::Config::SampleRate::SAI_32KHZ: sr = 32000.f; break;
+        case SaiHandle::Config::SampleRate::SAI_96KHZ: sr = 96000.f; break;
+        default: sr = 48000.f; break;
+    }
+    Runtime::Get().SetSampleRate(sr);
+}
+
+float DaisySeed::AudioSampleRate()
+{
+    return Runtime::Get().GetSampleRate();
+}
+
+void DaisySeed::SetAudioBlockSize(size_t blocksize)
+{
+    Runtime::Get().SetBlockSize(blocksize);
+}
+
+size_t DaisySeed::AudioBlockSize()
+{
+    return Runtime::Get().GetBlockSize();
+}
+
+float DaisySeed::AudioCallbackRate() const
+{
+    return Runtime::Get().GetSampleRate() / Runtime::Get().GetBlockSize();
+}
@@ -0,0 +1,17 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_runtime.h"
+
+/** The patch's main(), renamed by the host Makefile */
+int DaisyHostPatchMain();
+
+int main(int argc, char** argv)
+{
+    const int result = daisy::host::Runtime::Get().Run(
+        argc, argv, DaisyHostPatchMain);
+    fflush(stdout);
+    fflush(stderr);
+    // The patch's main loop is still running on its thread,
+    // so skip the static destructors.
+    _Exit(result);
+}
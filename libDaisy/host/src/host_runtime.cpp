@@ -0,0 +1,626 @@
+#include "host_runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "host_wav.h"
+#include "per/gpio.h"
+#include "sys/system.h"
+
+using namespace daisy;
+using namespace daisy::host;
+
+namespace
+{
+/** Block size of the Daisy Seed until the patch sets one */
+constexpr size_t kDefaultBlockSize = 48;
+/** Largest block size the hardware's AudioHandle allows */
+constexpr size_t kMaxBlockSize = 256;
+constexpr size_t kNumChannels  = 2;
+
+/** How long the render loop waits for a main loop that has slept before,
+ *  in case it stopped calling System::Delay() */
+constexpr auto kMainLoopTimeout = std::chrono::milliseconds(100);
+
+dsy_gpio_pin ToPin(uint8_t idx)
+{
+    dsy_gpio_pin pin;
+    pin.port = static_cast<dsy_gpio_port>(idx / 16);
+    pin.pin  = idx % 16;
+    return pin;
+}
+
+uint8_t ToIndex(dsy_gpio_pin pin)
+{
+    return static_cast<uint8_t>(pin.port * 16 + pin.pin);
+}
+
+void PrintUsage(const char* name)
+{
+    printf(
+        "usage: %s [options]\n"
+        "  -i, --input FILE       WAV file fed to the audio inputs\n"
+        "  -o, --output FILE      WAV file for the audio outputs (32 bit float)\n"
+        "  -a, --automation FILE  control changes, one \"seconds control value\" per "
+        "line\n"
+        "  -b, --block N          block size, overriding the patch's\n"
+        "  -s, --seconds N        length to render, defaults to the input's\n"
+        "  -t, --timing FILE      write the time of each block as CSV\n",
+        name);
+}
+} // namespace
+
+Runtime& Runtime::Get()
+{
+    static Runtime runtime;
+    return runtime;
+}
+
+Runtime::Runtime()
+: next_event_(0),
+  num_pins_(0),
+  callback_(nullptr),
+  interleaved_callback_(nullptr),
+  sample_rate_(48000.f),
+  block_size_(kDefaultBlockSize),
+  now_us_(0),
+  wake_us_(0),
+  audio_started_(false),
+  loop_sleeping_(false),
+  loop_cooperative_(true),
+  loop_done_(false),
+  finished_(false)
+{
+    // Undriven inputs read high, like the pull-ups on the hardware.
+    memset(pins_, 1, sizeof(pins_));
+}
+
+int Runtime::Run(int argc, char** argv, int (*patch_main)())
+{
+    if(!ParseOptions(argc, argv))
+    {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    std::string error;
+    if(!LoadAutomation(error))
+    {
+        fprintf(stderr, "error: %s\n", error.c_str());
+        return 1;
+    }
+
+    // The patch's main() normally never returns, so it isn't joined.
+    std::thread([this, patch_main]() {
+#ifdef __linux__
+        // Busy main loops would otherwise preempt the callback and
+        // show up in its timing.
+        sched_param param = {};
+        pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+        patch_main();
+        std::lock_guard<std::mutex> lock(mutex_);
+        loop_done_ = true;
+        cv_.notify_all();
+    }).detach();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return audio_started_ || loop_done_; });
+        if(!audio_started_)
+        {
+            fprintf(stderr, "error: main() returned without starting audio\n");
+            return 1;
+        }
+    }
+    return Render() ? 0 : 1;
+}
+
+bool Runtime::ParseOptions(int argc, char** argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg   = argv[i];
+        const char*       value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(arg == "-h" || arg == "--help" || value == nullptr)
+            return false;
+        if(arg == "-i" || arg == "--input")
+            options_.input = value;
+        else if(arg == "-o" || arg == "--output")
+            options_.output = value;
+        else if(arg == "-a" || arg == "--automation")
+            options_.automation = value;
+        else if(arg == "-t" || arg == "--timing")
+            options_.timing = value;
+        else if(arg == "-b" || arg == "--block")
+            options_.block_size
+                = std::min<size_t>(strtoul(value, nullptr, 10), kMaxBlockSize);
+        else if(arg == "-s" || arg == "--seconds")
+            options_.seconds = strtof(value, nullptr);
+        else
+            return false;
+        i++;
+    }
+    return !options_.input.empty() || options_.seconds > 0.f;
+}
+
+bool Runtime::LoadAutomation(std::string& error)
+{
+    if(options_.automation.empty())
+        return true;
+    std::ifstream file(options_.automation);
+    if(!file)
+    {
+        error = "can't open " + options_.automation;
+        return false;
+    }
+    std::string line;
+    for(int line_num = 1; std::getline(file, line); line_num++)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        Event              event;
+        if(!(fields >> event.time))
+            continue; // blank or comment
+        if(!(fields >> event.control >> event.value))
+        {
+            error = options_.automation + ":" + std::to_string(line_num)
+                    + ": expected \"seconds control value\"";
+            return false;
+        }
+        events_.push_back(event);
+    }
+    std::stable_sort(
+        events_.begin(), events_.end(), [](const Event& a, const Event& b) {
+            return a.time < b.time;
+        });
+    return true;
+}
+
+void Runtime::ApplyEvents(double time)
+{
+    // The patch's main loop reads the pins and encoders through ReadPin(),
+    // and doesn't necessarily run in step with the render loop.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(; next_event_ < events_.size() && events_[next_event_].time <= time;
+        next_event_++)
+    {
+        const Event& event = events_[next_event_];
+        for(Control& c : controls_)
+        {
+            if(c.name != event.control)
+                continue;
+            switch(c.type)
+            {
+                case ControlType::KNOB:
+                {
+                    const float v = std::min(std::max(event.value, 0.f), 1.f);
+                    // AnalogControl reads this through a plain pointer, from
+                    // either thread, so the store can't be behind the lock.
+                    __atomic_store_n(&c.adc,
+                                     static_cast<uint16_t>(v * 65535.f),
+                                     __ATOMIC_RELAXED);
+                    break;
+                }
+                case ControlType::SWITCH:
+                    pins_[c.pin_a] = event.value >= 0.5f ? 0 : 1;
+                    break;
+                case ControlType::ENCODER:
+                    c.pending += static_cast<int32_t>(event.value);
+                    break;
+            }
+        }
+    }
+}
+
+void Runtime::SetCallback(AudioHandle::AudioCallback cb)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_             = cb;
+    interleaved_callback_ = nullptr;
+    audio_started_        = true;
+    cv_.notify_all();
+}
+
+void Runtime::SetCallback(AudioHandle::InterleavingAudioCallback cb)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_             = nullptr;
+    interleaved_callback_ = cb;
+    audio_started_        = true;
+    cv_.notify_all();
+}
+
+void Runtime::StopAudio()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_             = nullptr;
+    interleaved_callback_ = nullptr;
+}
+
+void Runtime::SetBlockSize(size_t size)
+{
+    block_size_ = size > 0 ? std::min(size, kMaxBlockSize) : 1;
+}
+
+size_t Runtime::GetBlockSize() const
+{
+    // The options are parsed before the patch starts, so it sees the
+    // override from its first call to AudioBlockSize() on.
+    return options_.block_size > 0 ? options_.block_size : block_size_;
+}
+
+uint16_t* Runtime::AddKnob(const char* name)
+{
+    Control c = {};
+    c.name    = name;
+    c.type    = ControlType::KNOB;
+    controls_.push_back(c);
+    return &controls_.back().adc;
+}
+
+dsy_gpio_pin Runtime::AddSwitch(const char* name)
+{
+    Control c = {};
+    c.name    = name;
+    c.type    = ControlType::SWITCH;
+    c.pin_a   = AllocatePin();
+    controls_.push_back(c);
+    return ToPin(c.pin_a);
+}
+
+void Runtime::AddEncoder(const char* name, dsy_gpio_pin* a, dsy_gpio_pin* b)
+{
+    Control c = {};
+    c.name    = name;
+    c.type    = ControlType::ENCODER;
+    c.pin_a   = AllocatePin();
+    c.pin_b   = AllocatePin();
+    controls_.push_back(c);
+    *a = ToPin(c.pin_a);
+    *b = ToPin(c.pin_b);
+}
+
+dsy_gpio_pin Runtime::AddOutput()
+{
+    return ToPin(AllocatePin());
+}
+
+uint8_t Runtime::AllocatePin()
+{
+    return num_pins_ < kNumPins - 1 ? num_pins_++ : num_pins_;
+}
+
+uint64_t Runtime::GetNowUs()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_us_;
+}
+
+void Runtime::Delay(uint64_t us)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(!audio_started_ && !finished_)
+    {
+        // Nothing to wait for before the audio starts.
+        now_us_ += us;
+        return;
+    }
+    // From now on the render loop keeps in step with this loop.
+    loop_cooperative_ = true;
+    loop_sleeping_    = true;
+    wake_us_          = now_us_ + us;
+    cv_.notify_all();
+    // Once rendering has finished the loop stays asleep until the process exits.
+    cv_.wait(lock, [this]() { return now_us_ >= wake_us_ && !finished_; });
+    loop_sleeping_ = false;
+}
+
+uint8_t Runtime::ReadPin(dsy_gpio_pin pin)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint8_t               idx = ToIndex(pin);
+    for(Control& c : controls_)
+    {
+        // Reading A steps a pending encoder turn, B follows in the same read.
+        if(c.type != ControlType::ENCODER || c.pin_a != idx || c.pending == 0)
+            continue;
+        // Gray code of one detent, A leads B when turning clockwise.
+        static const uint8_t kLeading[4]  = {1, 0, 0, 1};
+        static const uint8_t kTrailing[4] = {0, 0, 1, 1};
+        const bool           cw           = c.pending > 0;
+        pins_[c.pin_a] = cw ? kLeading[c.phase] : kTrailing[c.phase];
+        pins_[c.pin_b] = cw ? kTrailing[c.phase] : kLeading[c.phase];
+        if(++c.phase == 4)
+        {
+            c.phase = 0;
+            c.pending += cw ? -1 : 1;
+        }
+    }
+    return pins_[idx];
+}
+
+void Runtime::WritePin(dsy_gpio_pin pin, uint8_t state)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pins_[ToIndex(pin)] = state;
+}
+
+void Runtime::WaitForMainLoop()
+{
+    // A main loop that sleeps with System::Delay() gets to run up to the
+    // current time before each block, so its control handling is
+    // repeatable. Loops that don't sleep within the timeout just run
+    // alongside, until they call System::Delay() again.
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool in_step = cv_.wait_for(lock, kMainLoopTimeout, [this]() {
+        return !loop_cooperative_ || loop_done_
+               || (loop_sleeping_ && wake_us_ > now_us_);
+    });
+    if(!in_step)
+        loop_cooperative_ = false;
+}
+
+bool Runtime::Render()
+{
+    for(const Event& event : events_)
+    {
+        const bool known = std::any_of(
+            controls_.begin(), controls_.end(), [&](const Control& c) {
+                return c.name == event.control;
+            });
+        if(!known)
+        {
+            fprintf(stderr, "error: unknown control \"%s\", available:",
+                    event.control.c_str());
+            for(const Control& c : controls_)
+                fprintf(stderr, " %s", c.name.c_str());
+            fprintf(stderr, "\n");
+            return false;
+        }
+    }
+
+    WavData in;
+    if(!options_.input.empty())
+    {
+        std::string error;
+        if(!ReadWav(options_.input, in, error))
+        {
+            fprintf(stderr, "error: %s\n", error.c_str());
+            return false;
+        }
+        if(in.sample_rate != static_cast<uint32_t>(sample_rate_))
+        {
+            fprintf(stderr,
+                    "warning: %s is %u Hz, the patch runs at %.0f Hz\n",
+                    options_.input.c_str(),
+                    in.sample_rate,
+                    sample_rate_);
+        }
+    }
+
+    const size_t num_frames
+        = options_.seconds > 0.f
+              ? static_cast<size_t>(options_.seconds * sample_rate_)
+              : in.GetNumFrames();
+    const size_t block_size = GetBlockSize();
+
+    // Mono files feed both inputs.
+    std::vector<std::vector<float>> in_buf(kNumChannels,
+                                           std::vector<float>(block_size));
+    std::vector<std::vector<float>> out_buf(kNumChannels,
+                                            std::vector<float>(block_size));
+    std::vector<float>  in_interleaved(block_size * kNumChannels);
+    std::vector<float>  out_interleaved(block_size * kNumChannels);
+    const float*        in_ptrs[kNumChannels];
+    float*              out_ptrs[kNumChannels];
+    WavData             out;
+    std::vector<double> block_ns;
+    out.sample_rate = static_cast<uint32_t>(sample_rate_);
+    out.channels.assign(kNumChannels, std::vector<float>(num_frames));
+    block_ns.reserve(num_frames / block_size + 1);
+    for(size_t c = 0; c < kNumChannels; c++)
+    {
+        in_ptrs[c]  = in_buf[c].data();
+        out_ptrs[c] = out_buf[c].data();
+    }
+
+    // Whole blocks are rendered like on the hardware, the last one is
+    // cut short in the output file.
+    for(size_t frame = 0; frame < num_frames; frame += block_size)
+    {
+        WaitForMainLoop();
+        ApplyEvents(frame / static_cast<double>(sample_rate_));
+
+        for(size_t c = 0; c < kNumChannels; c++)
+        {
+            for(size_t i = 0; i < block_size; i++)
+            {
+                const size_t src = frame + i;
+                in_buf[c][i]
+                    = in.channels.empty() || src >= in.GetNumFrames()
+                          ? 0.f
+                          : in.channels[c % in.channels.size()][src];
+                out_buf[c][i] = 0.f;
+            }
+        }
+
+        AudioHandle::AudioCallback             cb;
+        AudioHandle::InterleavingAudioCallback icb;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cb  = callback_;
+            icb = interleaved_callback_;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if(cb)
+        {
+            cb(in_ptrs, out_ptrs, block_size);
+        }
+        else if(icb)
+        {
+            for(size_t i = 0; i < block_size; i++)
+                for(size_t c = 0; c < kNumChannels; c++)
+                    in_interleaved[i * kNumChannels + c] = in_buf[c][i];
+            icb(in_interleaved.data(),
+                out_interleaved.data(),
+                block_size * kNumChannels);
+            for(size_t i = 0; i < block_size; i++)
+                for(size_t c = 0; c < kNumChannels; c++)
+                    out_buf[c][i] = out_interleaved[i * kNumChannels + c];
+        }
+        const auto end = std::chrono::steady_clock::now();
+        block_ns.push_back(
+            std::chrono::duration<double, std::nano>(end - start).count());
+
+        const size_t n = std::min(block_size, num_frames - frame);
+        for(size_t c = 0; c < kNumChannels; c++)
+            std::copy(out_buf[c].begin(),
+                      out_buf[c].begin() + n,
+                      out.channels[c].begin() + frame);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        now_us_ = static_cast<uint64_t>((frame + block_size) * 1e6
+                                        / sample_rate_);
+        cv_.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+
+    if(!options_.output.empty() && !WriteWav(options_.output, out))
+    {
+        fprintf(stderr, "error: can't write %s\n", options_.output.c_str());
+        return false;
+    }
+    if(!options_.timing.empty())
+    {
+        FILE* f = fopen(options_.timing.c_str(), "w");
+        if(!f)
+        {
+            fprintf(stderr, "error: can't write %s\n", options_.timing.c_str());
+            return false;
+        }
+        fprintf(f, "block,frame,ns\n");
+        for(size_t i = 0; i < block_ns.size(); i++)
+            fprintf(f, "%zu,%zu,%.0f\n", i, i * block_size, block_ns[i]);
+        fclose(f);
+    }
+    Report(block_ns, num_frames);
+    return true;
+}
+
+void Runtime::Report(const std::vector<double>& block_ns, size_t num_frames)
+{
+    if(block_ns.empty())
+    {
+        printf("nothing rendered\n");
+        return;
+    }
+    const size_t        block_size = GetBlockSize();
+    std::vector<double> sorted = block_ns;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for(double ns : sorted)
+        total += ns;
+    const double mean      = total / sorted.size();
+    const double budget_ns = block_size * 1e9 / sample_rate_;
+    const double seconds   = num_frames / static_cast<double>(sample_rate_);
+
+    printf("rendered %.2f s (%zu frames at %.0f Hz) in %.3f s of callback "
+           "time, %.1fx real time\n",
+           seconds,
+           num_frames,
+           sample_rate_,
+           total * 1e-9,
+           seconds / (total * 1e-9));
+    printf("%zu blocks of %zu frames, %.1f us budget each\n",
+           sorted.size(),
+           block_size,
+           budget_ns * 1e-3);
+    printf("callback time: mean %.2f us, median %.2f us, p99 %.2f us, max "
+           "%.2f us\n",
+           mean * 1e-3,
+           sorted[sorted.size() / 2] * 1e-3,
+           sorted[sorted.size() * 99 / 100] * 1e-3,
+           sorted.back() * 1e-3);
+    printf("host CPU load: mean %.2f %%, max %.2f %%\n",
+           100.0 * mean / budget_ns,
+           100.0 * sorted.back() / budget_ns);
+}
+
+// Hardware layer stand-ins
+
+uint32_t System::GetNow()
+{
+    return static_cast<uint32_t>(Runtime::Get().GetNowUs() / 1000);
+}
+
+uint32_t System::GetUs()
+{
+    return static_cast<uint32_t>(Runtime::Get().GetNowUs());
+}
+
+uint32_t System::GetTick()
+{
+    // Ticks run at 1MHz on the host.
+    return GetUs();
+}
+
+uint32_t System::GetTickFreq()
+{
+    return 1000000;
+}
+
+void System::Delay(uint32_t delay_ms)
+{
+    Runtime::Get().Delay(delay_ms * 1000ull);
+}
+
+void System::DelayUs(uint32_t delay_us)
+{
+    Runtime::Get().Delay(delay_us);
+}
+
+void System::DelayTicks(uint32_t delay_ticks)
+{
+    Runtime::Get().Delay(delay_ticks);
+}
+
+extern "C"
+{
+    void dsy_gpio_init(const dsy_gpio* p)
+    {
+        (void)p;
+    }
+
+    void dsy_gpio_deinit(const dsy_gpio* p)
+    {
+        (void)p;
+    }
+
+    uint8_t dsy_gpio_read(const dsy_gpio* p)
+    {
+        return Runtime::Get().ReadPin(p->pin);
+    }
+
+    void dsy_gpio_write(const dsy_gpio* p, uint8_t state)
+    {
+        Runtime::Get().WritePin(p->pin, state);
+    }
+
+    void dsy_gpio_toggle(const dsy_gpio* p)
+    {
+        Runtime::Get().WritePin(p->pin, !Runtime::Get().ReadPin(p->pin));
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+#ifndef DSY_HOST_RUNTIME_H
+#define DSY_HOST_RUNTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "daisy_core.h"
+#include "hid/audio.h"
+
+namespace daisy
+{
+namespace host
+{
+/** Command line options of a host build */
+struct Options
+{
+    std::string input;      /**< WAV file fed to the audio inputs, empty for silence */
+    std::string output;     /**< WAV file for the audio outputs, empty to discard */
+    std::string automation; /**< control automation file, see README.md */
+    std::string timing;     /**< CSV file for the per-block timing, empty to skip */
+    size_t      block_size = 0; /**< overrides the patch's block size if > 0 */
+    float       seconds    = 0.f; /**< render length, defaults to the input's length */
+};
+
+/** Runs a patch written against DaisySeed/DaisyPod on the host.
+ *
+ *  The audio callback is called from the host's main thread as fast as
+ *  the CPU allows, while the patch's main() runs on a thread of its own.
+ *  Time, as seen by System::GetNow() and friends, follows the audio that
+ *  has been rendered, not the wall clock.
+ *
+ *  Controls are backed by virtual ADC channels and GPIO pins,
+ *  so the regular AnalogControl, Switch and Encoder classes read them
+ *  like on hardware. Their values come from the automation file and
+ *  change at block boundaries.
+ */
+class Runtime
+{
+  public:
+    /** \return the runtime used by the host DaisySeed and DaisyPod */
+    static Runtime& Get();
+
+    /** Parses the command line, runs patch_main and renders the audio.
+     *  \return exit code of the process
+     */
+    int Run(int argc, char** argv, int (*patch_main)());
+
+    // Audio, called by the host DaisySeed
+
+    void   SetCallback(AudioHandle::AudioCallback cb);
+    void   SetCallback(AudioHandle::InterleavingAudioCallback cb);
+    void   StopAudio();
+    void   SetSampleRate(float sample_rate) { sample_rate_ = sample_rate; }
+    float  GetSampleRate() const { return sample_rate_; }
+    void   SetBlockSize(size_t size);
+    size_t GetBlockSize() const; // the -b/--block size if given
+
+    // Controls, registered by the host boards under the names used in the
+    // automation file
+
+    /** \return pointer to a virtual ADC reading, for AnalogControl::Init */
+    uint16_t* AddKnob(const char* name);
+
+    /** \return virtual pin of a pull-up switch, pressed when the automation value is 1 */
+    dsy_gpio_pin AddSwitch(const char* name);
+
+    /** Virtual pins of a quadrature encoder. The automation value is the
+     *  number of detents to turn, negative for counter-clockwise.
+     *  Each detent takes four reads of the pins.
+     */
+    void AddEncoder(const char* name, dsy_gpio_pin* a, dsy_gpio_pin* b);
+
+    /** \return a virtual pin for an output, e.g. an LED */
+    dsy_gpio_pin AddOutput();
+
+    // Hardware layer, called from the System and dsy_gpio stand-ins
+
+    uint64_t GetNowUs();
+    void     Delay(uint64_t us);
+    uint8_t  ReadPin(dsy_gpio_pin pin);
+    void     WritePin(dsy_gpio_pin pin, uint8_t state);
+
+  private:
+    enum class ControlType
+    {
+        KNOB,
+        SWITCH,
+        ENCODER,
+    };
+
+    struct Control
+    {
+        std::string name;
+        ControlType type;
+        uint16_t    adc;          // knob reading, stored atomically
+        uint8_t     pin_a, pin_b; // switch pin, or encoder A/B pins
+        int32_t     pending;      // encoder detents still to turn
+        uint8_t     phase;        // position in the current detent
+    };
+
+    struct Event
+    {
+        double      time;
+        std::string control;
+        float       value;
+    };
+
+    Runtime();
+
+    bool    ParseOptions(int argc, char** argv);
+    bool    LoadAutomation(std::string& error);
+    void    ApplyEvents(double time);
+    void    WaitForMainLoop();
+    bool    Render();
+    void    Report(const std::vector<double>& block_ns, size_t num_frames);
+    uint8_t AllocatePin();
+
+    static constexpr size_t kNumPins = 256;
+
+    Options             options_;
+    std::deque<Control> controls_; // stable addresses for AddKnob()
+    std::vector<Event>  events_;
+    size_t              next_event_;
+    uint8_t             pins_[kNumPins]; // guarded by mutex_
+    uint8_t             num_pins_;
+
+    AudioHandle::AudioCallback             callback_;
+    AudioHandle::InterleavingAudioCallback interleaved_callback_;
+    float                                  sample_rate_;
+    size_t                                 block_size_;
+
+    // Shared between the render loop and the patch's main loop
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    uint64_t                now_us_;
+    uint64_t                wake_us_;
+    bool                    audio_started_;
+    bool                    loop_sleeping_;
+    bool                    loop_cooperative_;
+    bool                    loop_done_;
+    bool                    finished_;
+};
+
+} // namespace host
+} // namespace daisy
+
+#endif
@@ -0,0 +1,157 @@
+#include "host_wav.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "daisy_core.h"
+
+using namespace daisy;
+using namespace daisy::host;
+
+namespace
+{
+uint32_t ReadLe(const uint8_t* p, size_t bytes)
+{
+    uint32_t v = 0;
+    for(size_t i = 0; i < bytes; i++)
+        v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+float DecodeSample(const uint8_t* p, uint16_t format, uint16_t bits)
+{
+    if(format == WAVE_FORMAT_IEEE_FLOAT)
+    {
+        float    f;
+        uint32_t v = ReadLe(p, 4);
+        memcpy(&f, &v, sizeof(f));
+        return f;
+    }
+    switch(bits)
+    {
+        case 16: return static_cast<int16_t>(ReadLe(p, 2)) * S162F_SCALE;
+        case 24:
+        {
+            // sign extend from 24 bits
+            int32_t v = static_cast<int32_t>(ReadLe(p, 3) << 8) >> 8;
+            return v * S242F_SCALE;
+        }
+        case 32: return static_cast<int32_t>(ReadLe(p, 4)) * S322F_SCALE;
+        default: return 0.f;
+    }
+}
+} // namespace
+
+bool daisy::host::ReadWav(const std::string& path,
+                          WavData&           data,
+                          std::string&       error)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if(!f)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+    std::vector<uint8_t> file;
+    uint8_t              chunk[4096];
+    size_t               n;
+    while((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        file.insert(file.end(), chunk, chunk + n);
+    fclose(f);
+
+    if(file.size() < 12 || ReadLe(&file[0], 4) != kWavFileChunkId
+       || ReadLe(&file[8], 4) != kWavFileWaveId)
+    {
+        error = path + " is not a WAV file";
+        return false;
+    }
+
+    uint16_t       format = 0, num_channels = 0, bits = 0;
+    const uint8_t* samples    = nullptr;
+    size_t         data_bytes = 0;
+    for(size_t pos = 12; pos + 8 <= file.size();)
+    {
+        const uint32_t id   = ReadLe(&file[pos], 4);
+        const size_t   size = ReadLe(&file[pos + 4], 4);
+        const size_t   body = pos + 8;
+        if(id == kWavFileSubChunk1Id && size >= 16 && body + 16 <= file.size())
+        {
+            format            = ReadLe(&file[body], 2);
+            num_channels      = ReadLe(&file[body + 2], 2);
+            data.sample_rate  = ReadLe(&file[body + 4], 4);
+            bits              = ReadLe(&file[body + 14], 2);
+            // the real format follows the cbSize field in extensible headers
+            if(format == WAVE_FORMAT_EXTENSIBLE && size >= 26)
+                format = ReadLe(&file[body + 24], 2);
+        }
+        else if(id == kWavFileSubChunk2Id)
+        {
+            samples    = &file[body];
+            data_bytes = std::min(size, file.size() - body);
+        }
+        // chunks are padded to an even size
+        pos = body + size + (size & 1);
+    }
+
+    const bool supported
+        = (format == WAVE_FORMAT_PCM
+           && (bits == 16 || bits == 24 || bits == 32))
+          || (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32);
+    if(!supported || num_channels == 0 || samples == nullptr)
+    {
+        error = path
+                + ": only 16/24/32 bit PCM and 32 bit float WAV files "
+                  "are supported";
+        return false;
+    }
+
+    const size_t frame_bytes = num_channels * (bits / 8);
+    const size_t num_frames  = data_bytes / frame_bytes;
+    data.channels.assign(num_channels, std::vector<float>(num_frames));
+    for(size_t i = 0; i < num_frames; i++)
+    {
+        for(size_t c = 0; c < num_channels; c++)
+        {
+            data.channels[c][i] = DecodeSample(
+                samples + i * frame_bytes + c * (bits / 8), format, bits);
+        }
+    }
+    return true;
+}
+
+bool daisy::host::WriteWav(const std::string& path, const WavData& data)
+{
+    const uint16_t num_channels = data.channels.size();
+    const uint32_t num_frames   = data.GetNumFrames();
+    const uint32_t data_bytes   = num_frames * num_channels * sizeof(float);
+
+    WAV_FormatTypeDef header;
+    header.ChunkId       = kWavFileChunkId;
+    header.FileSize      = sizeof(header) - 8 + data_bytes;
+    header.FileFormat    = kWavFileWaveId;
+    header.SubChunk1ID   = kWavFileSubChunk1Id;
+    header.SubChunk1Size = 16;
+    header.AudioFormat   = WAVE_FORMAT_IEEE_FLOAT;
+    header.NbrChannels   = num_channels;
+    header.SampleRate    = data.sample_rate;
+    header.ByteRate      = data.sample_rate * num_channels * sizeof(float);
+    header.BlockAlign    = num_channels * sizeof(float);
+    header.BitPerSample  = 32;
+    header.SubChunk2ID   = kWavFileSubChunk2Id;
+    header.SubCHunk2Size = data_bytes;
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if(!f)
+        return false;
+    // The host is little endian like the Daisy, so the header can be written as is.
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    std::vector<float> frames(num_channels);
+    for(uint32_t i = 0; ok && i < num_frames; i++)
+    {
+        for(uint16_t c = 0; c < num_channels; c++)
+            frames[c] = data.channels[c][i];
+        ok = fwrite(frames.data(), sizeof(float), num_channels, f)
+             == num_channels;
+    }
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef DSY_HOST_WAV_H
+#define DSY_HOST_WAV_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "util/wav_format.h"
+
+namespace daisy
+{
+namespace host
+{
+/** Deinterleaved audio loaded from, or to be written to, a WAV file */
+struct WavData
+{
+    uint32_t                        sample_rate = 48000;
+    std::vector<std::vector<float>> channels;
+
+    /** \return number of sample frames */
+    size_t GetNumFrames() const
+    {
+        return channels.empty() ? 0 : channels[0].size();
+    }
+};
+
+/** Reads a WAV file with 16, 24 or 32 bit PCM, or 32 bit float samples.
+ *  Chunks other than "fmt " and "data" are skipped.
+ *  \param path file to read
+ *  \param data filled with the samples, scaled to -1 to 1
+ *  \param error set to a description when the file can't be read
+ *  \return true on success
+ */
+bool ReadWav(const std::string& path, WavData& data, std::string& error);
+
+/** Writes 32 bit float samples to a WAV file, using WAV_FormatTypeDef
+ *  as the header.
+ *  \return true on success
+ */
+bool WriteWav(const std::string& path, const WavData& data);
+
+} // namespace host
+} // namespace daisy
+
+#endif
@@ -39,6 +39,7 @@
 #include "hid/disp/oled_display.h"
 #include "hid/disp/graphics_common.h"
 #include "hid/wavplayer.h"
+#include "hid/wavsampler.h"
 #include "hid/led.h"
 #include "hid/rgb_led.h"
 #include "dev/sr_595.h"
@@ -6,6 +6,7 @@
 #include "per/spi.h"
 #include "per/gpio.h"
 #include "sys/system.h"
+#include "hid/disp/paged_framebuffer.h"
 
 namespace daisy
 {
@@ -253,6 +254,7 @@ class SSD130xDriver
     void Init(Config config)
     {
         transport_.Init(config.transport_config);
+        buffer_.Invalidate();
 
         // Init routine...
 
@@ -351,47 +353,53 @@ class SSD130xDriver
 
     void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
     {
-        if(x >= width || y >= height)
-            return;
-        if(on)
-            buffer_[x + (y / 8) * width] |= (1 << (y % 8));
-        else
-            buffer_[x + (y / 8) * width] &= ~(1 << (y % 8));
+        buffer_.DrawPixel(x, y, on);
     }
 
-    void Fill(bool on)
+    void Fill(bool on) { buffer_.Fill(on); };
+
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
     {
-        for(size_t i = 0; i < sizeof(buffer_); i++)
-        {
-            buffer_[i] = on ? 0xff : 0x00;
-        }
-    };
+        buffer_.FillRect(x1, y1, x2, y2, on);
+    }
+
+    void DrawGlyph(uint_fast8_t    x,
+                   uint_fast8_t    y,
+                   const uint16_t* rows,
+                   uint_fast8_t    glyph_width,
+                   uint_fast8_t    glyph_height,
+                   bool            on)
+    {
+        buffer_.DrawGlyph(x, y, rows, glyph_width, glyph_height, on);
+    }
 
     /**
-     * Update the display 
+     * Update the display. Only the columns of each page that changed
+     * since the last update are sent.
     */
     void Update()
     {
-        uint8_t i;
-        uint8_t high_column_addr;
-        switch(height)
-        {
-            case 32: high_column_addr = 0x12; break;
-
-            default: high_column_addr = 0x10; break;
-        }
-        for(i = 0; i < (height / 8); i++)
-        {
-            transport_.SendCommand(0xB0 + i);
-            transport_.SendCommand(0x00);
-            transport_.SendCommand(high_column_addr);
-            transport_.SendData(&buffer_[width * i], width);
-        }
+        // 32 pixel high displays start at column 32
+        const size_t column_offset = height == 32 ? 32 : 0;
+        buffer_.Flush(
+            [this, column_offset](
+                size_t page, size_t column, uint8_t* data, size_t size)
+            {
+                const size_t start = column + column_offset;
+                transport_.SendCommand(0xB0 + page);
+                transport_.SendCommand(0x00 | (start & 0x0f));
+                transport_.SendCommand(0x10 | (start >> 4));
+                transport_.SendData(data, size);
+            });
     };
 
   private:
-    Transport transport_;
-    uint8_t   buffer_[width * height / 8];
+    Transport                       transport_;
+    PagedFrameBuffer<width, height> buffer_;
 };
 
 /**
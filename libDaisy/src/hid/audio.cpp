@@ -1,4 +1,5 @@
 #include "hid/audio.h"
+#include "hid/audio_convert.h"
 
 namespace daisy
 {
@@ -22,6 +23,15 @@ static int32_t DMA_BUFFER_MEM_SECTION
 static int32_t DMA_BUFFER_MEM_SECTION
     dsy_audio_tx_buffer[kAudioMaxChannels / 2][kAudioMaxBufferSize];
 
+// Float buffers handed to the callback, sized for the largest block.
+// Channels follow each other, or are interleaved for the interleaving
+// callback.
+static const size_t kAudioMaxBlockSize = kAudioMaxBufferSize / 4;
+alignas(16) static float
+    dsy_audio_float_in[kAudioMaxChannels * kAudioMaxBlockSize];
+alignas(16) static float
+    dsy_audio_float_out[kAudioMaxChannels * kAudioMaxBlockSize];
+
 // ================================================================
 // Private Implementation Definition
 // ================================================================
@@ -52,7 +62,7 @@ class AudioHandle::Impl
 
     AudioHandle::Result SetBlockSize(size_t size)
     {
-        size_t maxSize    = kAudioMaxBufferSize / 4;
+        size_t maxSize    = kAudioMaxBlockSize;
         config_.blocksize = size <= maxSize ? size : maxSize;
         return size <= maxSize ? AudioHandle::Result::OK
                                : AudioHandle::Result::ERR;
@@ -85,7 +95,21 @@ class AudioHandle::Impl
     // Internal Callback
     static void InternalCallback(int32_t* in, int32_t* out, size_t size);
 
+    // Converts a DMA half buffer for the user callback, calls it, and
+    // converts its output back. One is picked for the bit depth, the number
+    // of channels and the kind of callback when either of them is set.
+    typedef void (*ProcessFunction)(int32_t* in, int32_t* out, size_t size);
+
+    template <typename Format>
+    static void ProcessInterleaved(int32_t* in, int32_t* out, size_t size);
+    template <typename Format, size_t chns>
+    static void ProcessPlanar(int32_t* in, int32_t* out, size_t size);
+    template <typename Format>
+    ProcessFunction SelectProcess(bool interleaved) const;
+    void            SelectProcess(bool interleaved);
+
     void *callback_, *interleaved_callback_;
+    ProcessFunction process_;
 
     // Data
     AudioHandle::Config config_;
@@ -169,6 +193,9 @@ AudioHandle::Result AudioHandle::Impl::DeInit()
 AudioHandle::Result
 AudioHandle::Impl::Start(AudioHandle::AudioCallback callback)
 {
+    callback_ = (void*)callback;
+    SelectProcess(false);
+    interleaved_callback_ = nullptr;
     // Get instance of object
     if(sai2_.IsInitialized())
     {
@@ -180,21 +207,20 @@ AudioHandle::Impl::Start(AudioHandle::AudioCallback callback)
                    buff_tx_[0],
                    config_.blocksize * 2 * 2,
                    audio_handle.InternalCallback);
-    callback_             = (void*)callback;
-    interleaved_callback_ = nullptr;
     return Result::OK;
 }
 
 AudioHandle::Result
 AudioHandle::Impl::Start(AudioHandle::InterleavingAudioCallback callback)
 {
+    interleaved_callback_ = (void*)callback;
+    SelectProcess(true);
+    callback_ = nullptr;
     // Get instance of object
     sai1_.StartDma(buff_rx_[0],
                    buff_tx_[0],
                    config_.blocksize * 2 * 2,
                    audio_handle.InternalCallback);
-    interleaved_callback_ = (void*)callback;
-    callback_             = nullptr;
     return Result::OK;
 }
 
@@ -212,7 +238,10 @@ AudioHandle::Impl::ChangeCallback(AudioHandle::AudioCallback callback)
 {
     if(callback != nullptr)
     {
-        callback_             = (void*)callback;
+        // The new callback is in place before the function that calls it,
+        // and the old one is cleared after, for a block that's running.
+        callback_ = (void*)callback;
+        SelectProcess(false);
         interleaved_callback_ = nullptr;
         return Result::OK;
     }
@@ -228,7 +257,8 @@ AudioHandle::Result AudioHandle::Impl::ChangeCallback(
     if(callback != nullptr)
     {
         interleaved_callback_ = (void*)callback;
-        callback_             = nullptr;
+        SelectProcess(true);
+        callback_ = nullptr;
         return Result::OK;
     }
     else
@@ -266,219 +296,96 @@ AudioHandle::Impl::SetSampleRate(SaiHandle::Config::SampleRate samplerate)
     return Result::OK;
 }
 
-// This turned into a very large function due to the bit-depth conversions..
-// I didn't want to do a conditional conversion in a single loop because it seemed
-// far less efficient, so this is where I landed.
-//
-// Using function pointers for the x2f and f2x functions would have been ideal, but
-// wasn't possible due to the different parameter/return types for each function.
 void AudioHandle::Impl::InternalCallback(int32_t* in, int32_t* out, size_t size)
 {
-    // Convert from sai format to float, and call user callback
-    size_t                      chns;
-    SaiHandle::Config::BitDepth bd;
-    bd   = audio_handle.sai1_.GetConfig().bit_depth;
-    chns = audio_handle.GetChannels();
-    if(chns == 0)
-        return;
-    // Handle Interleaved / Non Interleaved separate
-    if(audio_handle.interleaved_callback_)
+    ProcessFunction process = audio_handle.process_;
+    if(process)
+        process(in, out, size);
+}
+
+template <typename Format>
+void AudioHandle::Impl::ProcessInterleaved(int32_t* in,
+                                           int32_t* out,
+                                           size_t   size)
+{
+    InterleavingAudioCallback cb
+        = (InterleavingAudioCallback)audio_handle.interleaved_callback_;
+    float* fin  = dsy_audio_float_in;
+    float* fout = dsy_audio_float_out;
+    SaiToFloat<Format>(in, fin, size / 2, audio_handle.postgain_recip_);
+    cb(fin, fout, size);
+    SaiFromFloat<Format>(fout, out, size / 2, audio_handle.output_adjust_);
+}
+
+template <typename Format, size_t chns>
+void AudioHandle::Impl::ProcessPlanar(int32_t* in, int32_t* out, size_t size)
+{
+    AudioCallback cb       = (AudioCallback)audio_handle.callback_;
+    const size_t  frames   = size / 2;
+    const float   in_gain  = audio_handle.postgain_recip_;
+    const float   out_gain = audio_handle.output_adjust_;
+    float*        fin[chns];
+    float*        fout[chns];
+    for(size_t ch = 0; ch < chns; ch++)
     {
-        InterleavingAudioCallback cb
-            = (InterleavingAudioCallback)audio_handle.interleaved_callback_;
-        float fin[size];
-        float fout[size];
-        // There _must_ be a more elegant way to do this....
-        // Convert from int to float
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s162f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s162f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s242f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s242f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s322f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s322f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            default: break;
-        }
-        cb(fin, fout, size);
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s16(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s16(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s24(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s24(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s32(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s32(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            default: break;
-        }
+        fin[ch]  = dsy_audio_float_in + ch * kAudioMaxBlockSize;
+        fout[ch] = dsy_audio_float_out + ch * kAudioMaxBlockSize;
     }
-    else if(audio_handle.callback_)
+
+    // The 2nd audio codec runs in step, at the same offset in its buffers.
+    SaiDeinterleave<Format>(in, fin[0], fin[1], frames, in_gain);
+    if(chns > 2)
     {
-        AudioCallback cb = (AudioCallback)audio_handle.callback_;
-        // offset needed for 2nd audio codec.
-        size_t offset    = audio_handle.sai2_.GetOffset();
-        size_t buff_size = chns > 2 ? size * 2 : size;
-        float  finbuff[buff_size], foutbuff[buff_size];
-        float* fin[chns];
-        float* fout[chns];
-        fin[0]  = finbuff;
-        fin[1]  = finbuff + (buff_size / chns);
-        fout[0] = foutbuff;
-        fout[1] = foutbuff + (buff_size / chns);
-        if(chns > 2)
-        {
-            fin[2]  = fin[1] + (buff_size / chns);
-            fin[3]  = fin[2] + (buff_size / chns);
-            fout[2] = fout[1] + (buff_size / chns);
-            fout[3] = fout[2] + (buff_size / chns);
-        }
-        // Deinterleave and scale
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s162f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s162f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s162f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s162f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s242f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s242f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s242f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s242f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s322f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s322f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s322f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s322f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            default: break;
-        }
-        cb(fin, fout, size / 2);
-        // Reinterleave and scale
-        switch(bd)
+        const size_t offset = audio_handle.sai2_.GetOffset();
+        SaiDeinterleave<Format>(audio_handle.buff_rx_[1] + offset,
+                                fin[2],
+                                fin[3],
+                                frames,
+                                in_gain);
+    }
+    cb(fin, fout, frames);
+    SaiInterleave<Format>(fout[0], fout[1], out, frames, out_gain);
+    if(chns > 2)
+    {
+        const size_t offset = audio_handle.sai2_.GetOffset();
+        SaiInterleave<Format>(fout[2],
+                              fout[3],
+                              audio_handle.buff_tx_[1] + offset,
+                              frames,
+                              out_gain);
+    }
+}
+
+template <typename Format>
+AudioHandle::Impl::ProcessFunction
+AudioHandle::Impl::SelectProcess(bool interleaved) const
+{
+    if(interleaved)
+        return &ProcessInterleaved<Format>;
+    return GetChannels() > 2 ? &ProcessPlanar<Format, 4>
+                             : &ProcessPlanar<Format, 2>;
+}
+
+void AudioHandle::Impl::SelectProcess(bool interleaved)
+{
+    ProcessFunction process = nullptr;
+    if(GetChannels() > 0)
+    {
+        switch(sai1_.GetConfig().bit_depth)
         {
             case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s16(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s16(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s16(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s16(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
+                process = SelectProcess<SaiSampleS16>(interleaved);
                 break;
             case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s24(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s24(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s24(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s24(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
+                process = SelectProcess<SaiSampleS24>(interleaved);
                 break;
             case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s32(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s32(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s32(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s32(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
+                process = SelectProcess<SaiSampleS32>(interleaved);
                 break;
             default: break;
         }
     }
+    process_ = process;
 }
 
 // ================================================================
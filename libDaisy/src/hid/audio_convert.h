@@ -0,0 +1,159 @@
+#pragma once
+#ifndef DSY_AUDIO_CONVERT_H
+#define DSY_AUDIO_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_core.h"
+
+/** @addtogroup audio
+    @{
+*/
+
+namespace daisy
+{
+/** @defgroup sai_sample_formats SAI sample formats
+ ** The SAI's DMA words as template arguments for the conversion kernels.
+ ** Each one gives the scale to and from floats, and how a DMA word is sign
+ ** extended.
+ ** @{
+ */
+
+/** 16 bit samples, in the low half of the word */
+struct SaiSampleS16
+{
+    static constexpr float kToFloat   = S162F_SCALE;
+    static constexpr float kFromFloat = F2S16_SCALE;
+    static inline int32_t  Extend(int32_t x) { return static_cast<int16_t>(x); }
+};
+
+/** 24 bit samples, in the low three bytes of the word */
+struct SaiSampleS24
+{
+    static constexpr float kToFloat   = S242F_SCALE;
+    static constexpr float kFromFloat = F2S24_SCALE;
+    static inline int32_t  Extend(int32_t x) { return (x ^ S24SIGN) - S24SIGN; }
+};
+
+/** 32 bit samples */
+struct SaiSampleS32
+{
+    static constexpr float kToFloat   = S322F_SCALE;
+    static constexpr float kFromFloat = F2S32_SCALE;
+    static inline int32_t  Extend(int32_t x) { return x; }
+};
+
+/** @} */
+
+/** @defgroup sai_conversion_kernels SAI conversion kernels
+ ** Conversions between the SAI's interleaved stereo DMA buffers and float
+ ** buffers, with a gain folded into the scale so each sample takes a single
+ ** multiply. The loops have no branches and no aliasing, so the compiler
+ ** can unroll and vectorize them.
+ **
+ ** Output samples are clamped to FBIPMIN..FBIPMAX after the gain, the same
+ ** as f2s16(), f2s24() and f2s32().
+ ** @{
+ */
+
+/** Interleaved words to interleaved floats
+    \param in 2 * frames words
+    \param out 2 * frames floats
+    \param frames Number of stereo frames
+    \param gain Multiplies every sample
+*/
+template <typename Format>
+inline void SaiToFloat(const int32_t* __restrict in,
+                       float* __restrict out,
+                       size_t frames,
+                       float  gain)
+{
+    const float scale = Format::kToFloat * gain;
+    for(size_t i = 0; i < 2 * frames; i++)
+    {
+        out[i] = static_cast<float>(Format::Extend(in[i])) * scale;
+    }
+}
+
+/** Interleaved floats to interleaved words
+    \param in 2 * frames floats
+    \param out 2 * frames words
+    \param frames Number of stereo frames
+    \param gain Multiplies every sample, before clamping
+*/
+template <typename Format>
+inline void SaiFromFloat(const float* __restrict in,
+                         int32_t* __restrict out,
+                         size_t frames,
+                         float  gain)
+{
+    const float scale = Format::kFromFloat * gain;
+    const float max   = Format::kFromFloat * FBIPMAX;
+    for(size_t i = 0; i < 2 * frames; i++)
+    {
+        float x = in[i] * scale;
+        x       = x < -max ? -max : x;
+        x       = x > max ? max : x;
+        out[i]  = static_cast<int32_t>(x);
+    }
+}
+
+/** Interleaved words to one float buffer per channel
+    \param in 2 * frames words
+    \param left frames floats
+    \param right frames floats
+    \param frames Number of stereo frames
+    \param gain Multiplies every sample
+*/
+template <typename Format>
+inline void SaiDeinterleave(const int32_t* __restrict in,
+                            float* __restrict left,
+                            float* __restrict right,
+                            size_t frames,
+                            float  gain)
+{
+    const float scale = Format::kToFloat * gain;
+    for(size_t i = 0; i < frames; i++)
+    {
+        left[i]  = static_cast<float>(Format::Extend(in[2 * i])) * scale;
+        right[i] = static_cast<float>(Format::Extend(in[2 * i + 1])) * scale;
+    }
+}
+
+/** One float buffer per channel to interleaved words
+    \param left frames floats
+    \param right frames floats
+    \param out 2 * frames words
+    \param frames Number of stereo frames
+    \param gain Multiplies every sample, before clamping
+*/
+template <typename Format>
+inline void SaiInterleave(const float* __restrict left,
+                          const float* __restrict right,
+                          int32_t* __restrict out,
+                          size_t frames,
+                          float  gain)
+{
+    const float scale = Format::kFromFloat * gain;
+    const float max   = Format::kFromFloat * FBIPMAX;
+    for(size_t i = 0; i < frames; i++)
+    {
+        float l = left[i] * scale;
+        float r = right[i] * scale;
+        l       = l < -max ? -max : l;
+        l       = l > max ? max : l;
+        r       = r < -max ? -max : r;
+        r       = r > max ? max : r;
+
+        out[2 * i]     = static_cast<int32_t>(l);
+        out[2 * i + 1] = static_cast<int32_t>(r);
+    }
+}
+
+/** @} */
+
+} // namespace daisy
+
+/** @} */
+
+#endif
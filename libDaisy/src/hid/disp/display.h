@@ -210,6 +210,9 @@ class OneBitGraphicsDisplay
  *          void Update() override { ... }
  *      };
  *  
+ *  Filled rectangles, straight lines and characters are drawn with FillRect() and DrawGlyph(), which
+ *  draw pixel by pixel here. A child class with a frame buffer can hide them with versions of its own
+ *  that write whole bytes of the buffer at a time.
  */
 template <class ChildType>
 class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
@@ -224,6 +227,17 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
                   uint_fast8_t y2,
                   bool         on) override
     {
+        if(x1 == x2 || y1 == y2)
+        {
+            ((ChildType*)(this))
+                ->ChildType::FillRect(x1 < x2 ? x1 : x2,
+                                      y1 < y2 ? y1 : y2,
+                                      x1 < x2 ? x2 : x1,
+                                      y1 < y2 ? y2 : y1,
+                                      on);
+            return;
+        }
+
         int_fast16_t deltaX = abs((int_fast16_t)x2 - (int_fast16_t)x1);
         int_fast16_t deltaY = abs((int_fast16_t)y2 - (int_fast16_t)y1);
         int_fast16_t signX  = ((x1 < x2) ? 1 : -1);
@@ -263,20 +277,22 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
     {
         if(fill)
         {
-            for(uint_fast8_t x = x1; x <= x2; x++)
-            {
-                for(uint_fast8_t y = y1; y <= y2; y++)
-                {
-                    ((ChildType*)(this))->ChildType::DrawPixel(x, y, on);
-                }
-            }
+            ((ChildType*)(this))->ChildType::FillRect(x1, y1, x2, y2, on);
         }
         else
         {
-            ((ChildType*)(this))->ChildType::DrawLine(x1, y1, x2, y1, on);
-            ((ChildType*)(this))->ChildType::DrawLine(x2, y1, x2, y2, on);
-            ((ChildType*)(this))->ChildType::DrawLine(x2, y2, x1, y2, on);
-            ((ChildType*)(this))->ChildType::DrawLine(x1, y2, x1, y1, on);
+            const uint_fast8_t left   = x1 < x2 ? x1 : x2;
+            const uint_fast8_t right  = x1 < x2 ? x2 : x1;
+            const uint_fast8_t top    = y1 < y2 ? y1 : y2;
+            const uint_fast8_t bottom = y1 < y2 ? y2 : y1;
+            ((ChildType*)(this))
+                ->ChildType::FillRect(left, top, right, top, on);
+            ((ChildType*)(this))
+                ->ChildType::FillRect(left, bottom, right, bottom, on);
+            ((ChildType*)(this))
+                ->ChildType::FillRect(left, top, left, bottom, on);
+            ((ChildType*)(this))
+                ->ChildType::FillRect(right, top, right, bottom, on);
         }
     }
 
@@ -395,8 +411,6 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
 
     char WriteChar(char ch, FontDef font, bool on) override
     {
-        uint32_t i, b, j;
-
         // Check if character is valid
         if(ch < 32 || ch > 126)
             return 0;
@@ -410,25 +424,13 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
         }
 
         // Use the font to write
-        for(i = 0; i < font.FontHeight; i++)
-        {
-            b = font.data[(ch - 32) * font.FontHeight + i];
-            for(j = 0; j < font.FontWidth; j++)
-            {
-                if((b << j) & 0x8000)
-                {
-                    ((ChildType*)(this))
-                        ->ChildType::DrawPixel(
-                            currentX_ + j, (currentY_ + i), on);
-                }
-                else
-                {
-                    ((ChildType*)(this))
-                        ->ChildType::DrawPixel(
-                            currentX_ + j, (currentY_ + i), !on);
-                }
-            }
-        }
+        ((ChildType*)(this))
+            ->ChildType::DrawGlyph(currentX_,
+                                   currentY_,
+                                   &font.data[(ch - 32) * font.FontHeight],
+                                   font.FontWidth,
+                                   font.FontHeight,
+                                   on);
 
         // The current space is now taken
         SetCursor(currentX_ + font.FontWidth, currentY_);
@@ -470,6 +472,59 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
         return alignedRect;
     }
 
+    /**
+    Sets all pixels from (x1, y1) to (x2, y2), both included. Nothing is
+    drawn if x1 > x2 or y1 > y2.
+    \param x1 x Coordinate of the top left corner
+    \param y1 y Coordinate of the top left corner
+    \param x2 x Coordinate of the bottom right corner
+    \param y2 y Coordinate of the bottom right corner
+    \param on on or off
+    */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        for(uint_fast8_t x = x1; x <= x2; x++)
+        {
+            for(uint_fast8_t y = y1; y <= y2; y++)
+            {
+                ((ChildType*)(this))->ChildType::DrawPixel(x, y, on);
+            }
+        }
+    }
+
+    /**
+    Draws a glyph, setting its pixels to on and the rest of its box to !on.
+    \param x            x Coordinate of the left edge
+    \param y            y Coordinate of the top edge
+    \param rows         glyph_height rows, the leftmost pixel in the MSB,
+                        as in FontDef
+    \param glyph_width  width in pixels, at most 16
+    \param glyph_height height in pixels
+    \param on           on or off
+    */
+    void DrawGlyph(uint_fast8_t    x,
+                   uint_fast8_t    y,
+                   const uint16_t* rows,
+                   uint_fast8_t    glyph_width,
+                   uint_fast8_t    glyph_height,
+                   bool            on)
+    {
+        for(uint_fast8_t i = 0; i < glyph_height; i++)
+        {
+            const uint32_t b = rows[i];
+            for(uint_fast8_t j = 0; j < glyph_width; j++)
+            {
+                const bool set = (b << j) & 0x8000;
+                ((ChildType*)(this))
+                    ->ChildType::DrawPixel(x + j, y + i, set ? on : !on);
+            }
+        }
+    }
+
   private:
     uint32_t strlen(const char* string)
     {
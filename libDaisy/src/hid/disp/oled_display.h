@@ -44,15 +44,99 @@ class OledDisplay : public OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>
         driver_.DrawPixel(x, y, on);
     }
 
+    /**
+    Sets all pixels from (x1, y1) to (x2, y2), both included, a byte at a
+    time if the driver has a FillRect() of its own.
+    */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        DriverFillRect(driver_, x1, y1, x2, y2, on, 0);
+    }
+
+    /**
+    Draws a glyph, a byte at a time if the driver has a DrawGlyph() of its
+    own.
+    */
+    void DrawGlyph(uint_fast8_t    x,
+                   uint_fast8_t    y,
+                   const uint16_t* rows,
+                   uint_fast8_t    glyph_width,
+                   uint_fast8_t    glyph_height,
+                   bool            on)
+    {
+        DriverDrawGlyph(driver_, x, y, rows, glyph_width, glyph_height, on, 0);
+    }
+
     /** 
     Writes the current display buffer to the OLED device using SPI or I2C depending on 
     how the object was initialized.
     */
     void Update() override { driver_.Update(); }
 
+    /** \return the driver, e.g. to read back a FrameBufferDriver */
+    const DisplayDriver& GetDriver() const { return driver_; }
+
   private:
+    using Base = OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>;
+
     DisplayDriver driver_;
 
+    // Drivers without FillRect() and DrawGlyph() are drawn to pixel by pixel.
+    template <typename Driver>
+    auto DriverFillRect(Driver&      driver,
+                        uint_fast8_t x1,
+                        uint_fast8_t y1,
+                        uint_fast8_t x2,
+                        uint_fast8_t y2,
+                        bool         on,
+                        int) -> decltype(driver.FillRect(x1, y1, x2, y2, on))
+    {
+        driver.FillRect(x1, y1, x2, y2, on);
+    }
+
+    template <typename Driver>
+    void DriverFillRect(Driver&,
+                        uint_fast8_t x1,
+                        uint_fast8_t y1,
+                        uint_fast8_t x2,
+                        uint_fast8_t y2,
+                        bool         on,
+                        long)
+    {
+        Base::FillRect(x1, y1, x2, y2, on);
+    }
+
+    template <typename Driver>
+    auto DriverDrawGlyph(Driver&         driver,
+                         uint_fast8_t    x,
+                         uint_fast8_t    y,
+                         const uint16_t* rows,
+                         uint_fast8_t    w,
+                         uint_fast8_t    h,
+                         bool            on,
+                         int)
+        -> decltype(driver.DrawGlyph(x, y, rows, w, h, on))
+    {
+        driver.DrawGlyph(x, y, rows, w, h, on);
+    }
+
+    template <typename Driver>
+    void DriverDrawGlyph(Driver&,
+                         uint_fast8_t    x,
+                         uint_fast8_t    y,
+                         const uint16_t* rows,
+                         uint_fast8_t    w,
+                         uint_fast8_t    h,
+                         bool            on,
+                         long)
+    {
+        Base::DrawGlyph(x, y, rows, w, h, on);
+    }
+
     void Reset() { driver_.Reset(); };
     void SendCommand(uint8_t cmd) { driver_.SendCommand(cmd); };
     void SendData(uint8_t* buff, size_t size) { driver_.SendData(buff, size); };
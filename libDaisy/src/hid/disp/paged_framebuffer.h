@@ -0,0 +1,324 @@
+#pragma once
+#ifndef DSY_PAGED_FRAMEBUFFER_H
+#define DSY_PAGED_FRAMEBUFFER_H /**< Macro */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace daisy
+{
+/**
+ * A 1 bit per pixel frame buffer in the page layout of the SSD130x and
+ * similar display controllers: each byte is a column of 8 pixels, the least
+ * significant bit at the top, and each page is a row of width bytes, 8 pixels
+ * high.
+ *
+ * Spans and glyphs are written a byte at a time, instead of reading and
+ * writing a byte for every pixel. Every write marks the columns it touched
+ * in its pages. Flush() only hands the parts of pages that differ from what
+ * it handed out last to the display, so a UI that clears and redraws the
+ * whole screen every frame only sends what actually changed.
+ *
+ * The buffer keeps a copy of what was sent to the display, so it takes
+ * twice width * height / 8 bytes.
+ * @ingroup device
+ */
+template <size_t width, size_t height>
+class PagedFrameBuffer
+{
+  public:
+    static_assert(height % 8 == 0, "height must be a multiple of 8");
+    static_assert(width <= 256, "columns are addressed with a uint8_t");
+
+    static constexpr size_t kNumPages = height / 8;
+
+    PagedFrameBuffer()
+    {
+        for(size_t page = 0; page < kNumPages; page++)
+        {
+            dirty_first_[page] = width;
+            dirty_last_[page]  = 0;
+        }
+        Fill(false);
+        Invalidate();
+    }
+
+    size_t Width() const { return width; }
+    size_t Height() const { return height; }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
+    {
+        if(x >= width || y >= height)
+            return;
+        const uint8_t mask = 1 << (y % 8);
+        uint8_t&      dst  = buffer_[x + (y / 8) * width];
+        dst                = on ? dst | mask : dst & ~mask;
+        MarkDirty(y / 8, x, x);
+    }
+
+    void Fill(bool on)
+    {
+        memset(buffer_, on ? 0xff : 0x00, sizeof(buffer_));
+        for(size_t page = 0; page < kNumPages; page++)
+            MarkDirty(page, 0, width - 1);
+    }
+
+    /** Sets all pixels from (x1, y1) to (x2, y2), both included, clipped to
+        the buffer. Nothing is drawn if x1 > x2 or y1 > y2.
+    */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        if(x1 > x2 || y1 > y2 || x1 >= width || y1 >= height)
+            return;
+        if(x2 >= width)
+            x2 = width - 1;
+        if(y2 >= height)
+            y2 = height - 1;
+
+        const size_t first_page = y1 / 8;
+        const size_t last_page  = y2 / 8;
+        for(size_t page = first_page; page <= last_page; page++)
+        {
+            uint8_t mask = 0xff;
+            if(page == first_page)
+                mask &= 0xff << (y1 % 8);
+            if(page == last_page)
+                mask &= 0xff >> (7 - y2 % 8);
+
+            uint8_t* dst = buffer_ + page * width;
+            if(on)
+            {
+                for(size_t x = x1; x <= x2; x++)
+                    dst[x] |= mask;
+            }
+            else
+            {
+                for(size_t x = x1; x <= x2; x++)
+                    dst[x] &= ~mask;
+            }
+            MarkDirty(page, x1, x2);
+        }
+    }
+
+    /** Draws a glyph, setting its pixels to on and the rest of its box to
+        !on, clipped to the buffer.
+        \param x Left edge
+        \param y Top edge
+        \param rows glyph_height rows, the leftmost pixel in the MSB, as in
+        FontDef
+        \param glyph_width At most 16
+        \param glyph_height Number of rows
+        \param on on or off
+    */
+    void DrawGlyph(uint_fast8_t    x,
+                   uint_fast8_t    y,
+                   const uint16_t* rows,
+                   uint_fast8_t    glyph_width,
+                   uint_fast8_t    glyph_height,
+                   bool            on)
+    {
+        if(x >= width || y >= height)
+            return;
+        size_t w = glyph_width > 16 ? 16 : glyph_width;
+        size_t h = glyph_height;
+        if(x + w > width)
+            w = width - x;
+        if(y + h > height)
+            h = height - y;
+        if(w == 0 || h == 0)
+            return;
+
+        const size_t first_page = y / 8;
+        const size_t last_page  = (y + h - 1) / 8;
+        for(size_t page = first_page; page <= last_page; page++)
+        {
+            // The glyph rows that fall into this page
+            const size_t top     = page * 8;
+            const size_t first   = top > y ? top - y : 0;
+            const size_t last    = top + 8 - y < h ? top + 8 - y : h;
+            uint8_t      mask    = 0;
+            uint8_t      col[16] = {};
+            for(size_t i = first; i < last; i++)
+            {
+                const uint8_t  bit = 1 << ((y + i) % 8);
+                const uint16_t row = rows[i];
+                mask |= bit;
+                for(size_t j = 0; j < w; j++)
+                    col[j] |= bit & -((row >> (15 - j)) & 1);
+            }
+
+            uint8_t* dst = buffer_ + page * width + x;
+            for(size_t j = 0; j < w; j++)
+            {
+                const uint8_t bits = on ? col[j] : ~col[j];
+                dst[j]             = (dst[j] & ~mask) | (bits & mask);
+            }
+            MarkDirty(page, x, x + w - 1);
+        }
+    }
+
+    /** Hands the changed parts of the pages to the display, and remembers
+        them as sent.
+        \param send Called as send(page, column, data, size) for each run of
+        changed bytes, at most once per page
+    */
+    template <typename SendFunction>
+    void Flush(SendFunction&& send)
+    {
+        for(size_t page = 0; page < kNumPages; page++)
+        {
+            if(dirty_first_[page] > dirty_last_[page])
+                continue;
+            size_t first = dirty_first_[page];
+            size_t last  = dirty_last_[page];
+
+            uint8_t* data  = buffer_ + page * width;
+            uint8_t* shown = shown_ + page * width;
+            if(!invalid_)
+            {
+                // Trim to the bytes that differ from the display
+                while(first <= last && data[first] == shown[first])
+                    first++;
+                while(last > first && data[last] == shown[last])
+                    last--;
+            }
+            if(first <= last)
+            {
+                const size_t size = last - first + 1;
+                send(page, first, data + first, size);
+                memcpy(shown + first, data + first, size);
+            }
+            dirty_first_[page] = width;
+            dirty_last_[page]  = 0;
+        }
+        invalid_ = false;
+    }
+
+    /** Makes the next Flush() send the whole buffer, e.g. after the
+        display was reset
+    */
+    void Invalidate()
+    {
+        invalid_ = true;
+        for(size_t page = 0; page < kNumPages; page++)
+            MarkDirty(page, 0, width - 1);
+    }
+
+    /** \return the pixel at (x, y) in the buffer */
+    bool GetPixel(uint_fast8_t x, uint_fast8_t y) const
+    {
+        return x < width && y < height
+               && (buffer_[x + (y / 8) * width] >> (y % 8)) & 1;
+    }
+
+    /** \return the buffer, kNumPages pages of width bytes */
+    const uint8_t* GetData() const { return buffer_; }
+
+  private:
+    void MarkDirty(size_t page, size_t first, size_t last)
+    {
+        if(first < dirty_first_[page])
+            dirty_first_[page] = first;
+        if(last > dirty_last_[page])
+            dirty_last_[page] = last;
+    }
+
+    uint8_t  buffer_[width * kNumPages];
+    uint8_t  shown_[width * kNumPages];
+    uint16_t dirty_first_[kNumPages];
+    uint16_t dirty_last_[kNumPages];
+    bool     invalid_;
+};
+
+/**
+ * A display driver for OledDisplay that sends its pages to memory instead
+ * of a display. It stands in for a real display in tests and benchmarks on
+ * the host, or to capture the screen for a preview.
+ * @ingroup device
+ */
+template <size_t width, size_t height>
+class FrameBufferDriver
+{
+  public:
+    struct Config
+    {
+    };
+
+    void Init(Config config)
+    {
+        (void)config;
+        memset(screen_, 0, sizeof(screen_));
+        buffer_.Invalidate();
+        bytes_sent_ = 0;
+    }
+
+    size_t Width() const { return width; };
+    size_t Height() const { return height; };
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
+    {
+        buffer_.DrawPixel(x, y, on);
+    }
+
+    void Fill(bool on) { buffer_.Fill(on); }
+
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        buffer_.FillRect(x1, y1, x2, y2, on);
+    }
+
+    void DrawGlyph(uint_fast8_t    x,
+                   uint_fast8_t    y,
+                   const uint16_t* rows,
+                   uint_fast8_t    glyph_width,
+                   uint_fast8_t    glyph_height,
+                   bool            on)
+    {
+        buffer_.DrawGlyph(x, y, rows, glyph_width, glyph_height, on);
+    }
+
+    /** Copies the changed parts of the buffer to the screen */
+    void Update()
+    {
+        buffer_.Flush(
+            [this](size_t page, size_t column, const uint8_t* data, size_t size)
+            {
+                memcpy(screen_ + page * width + column, data, size);
+                bytes_sent_ += size;
+            });
+    }
+
+    /** \return the pixel at (x, y) as of the last Update() */
+    bool GetScreenPixel(uint_fast8_t x, uint_fast8_t y) const
+    {
+        return x < width && y < height
+               && (screen_[x + (y / 8) * width] >> (y % 8)) & 1;
+    }
+
+    /** \return the pixel at (x, y) in the buffer */
+    bool GetPixel(uint_fast8_t x, uint_fast8_t y) const
+    {
+        return buffer_.GetPixel(x, y);
+    }
+
+    /** \return the number of data bytes Update() has sent since Init() */
+    size_t GetBytesSent() const { return bytes_sent_; }
+
+  private:
+    PagedFrameBuffer<width, height> buffer_;
+    uint8_t                         screen_[width * height / 8];
+    size_t                          bytes_sent_;
+};
+
+} // namespace daisy
+
+#endif
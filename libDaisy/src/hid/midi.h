@@ -105,6 +105,11 @@ class MidiUartTransport
     /** @brief sends the buffer of bytes out of the UART peripheral */
     inline void Tx(uint8_t* buff, size_t size) { uart_.PollTx(buff, size); }
 
+    /** Time a byte takes on the wire at 31250 baud: 10 bits of 32us.
+     *  Bytes that arrive together in one DMA callback were received this far apart,
+     *  and the last one this long before the callback. */
+    static constexpr uint32_t kRxByteTimeUs = 320;
+
   private:
     UartHandler         uart_;
     uint8_t*            rx_buffer;
@@ -140,10 +145,37 @@ class MidiUartTransport
     }
 };
 
+/** @brief MidiEvent with the time it was received
+ *  @ingroup midi
+ */
+struct TimedMidiEvent
+{
+    MidiEvent event;     /**< & */
+    uint32_t  timestamp; /**< System::GetUs() when the last byte arrived */
+};
+
 /**
     @brief Simple MIDI Handler \n
     Parses bytes from an input into valid MidiEvents. \n
-    The MidiEvents fill a FIFO queue that the user can pop messages from.
+    The MidiEvents fill a queue that the user can pop messages from.
+    The queue is lock-free, so the events can be popped in the main loop,
+    or in the audio callback with ProcessEvents().
+
+    Every event is stamped with the time its last byte arrived, so the
+    audio callback can play it at the matching sample instead of at the
+    start of the block:
+    \code
+    void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size)
+    {
+        size_t hit = size; // none
+        hw.midi.ProcessEvents(size, [&](const MidiEvent& e, size_t offset) {
+            if(e.type == NoteOn)
+                hit = offset;
+        });
+        for(size_t i = 0; i < size; i++)
+            out[0][i] = out[1][i] = drum.Process(i == hit);
+    }
+    \endcode
     @author shensley
     @date March 2020
     @ingroup midi
@@ -168,6 +200,10 @@ class MidiHandler
         config_ = config;
         transport_.Init(config_.transport_config);
         parser_.Init();
+        event_q_.Init();
+        dropped_    = 0;
+        last_block_ = 0;
+        started_    = false;
     }
 
     /** Starts listening on the selected input mode(s).
@@ -194,13 +230,63 @@ class MidiHandler
     /** Checks if there are unhandled messages in the queue
     \return True if there are events to be handled, else false.
      */
-    bool HasEvents() const { return event_q_.GetNumElements() > 0; }
+    bool HasEvents() const { return !event_q_.isEmpty(); }
 
 
     /** Pops the oldest unhandled MidiEvent from the internal queue
-    \return The event to be handled
+    \return The event to be handled, or a default event if there is none
      */
-    MidiEvent PopEvent() { return event_q_.PopFront(); }
+    MidiEvent PopEvent() { return PopTimedEvent().event; }
+
+    /** Pops the oldest unhandled MidiEvent, with the time it arrived
+    \return The event to be handled, or a default event if there is none
+     */
+    TimedMidiEvent PopTimedEvent()
+    {
+        if(event_q_.isEmpty())
+            return TimedMidiEvent();
+        return event_q_.ImmediateRead();
+    }
+
+    /** Pops the events for an audio block. Call it at the start of the audio
+    callback, before rendering the block.
+
+    The events that arrived during the previous block are spread over this
+    one by their arrival times, so they all come exactly one block late,
+    instead of up to a block late depending on when they arrived.
+
+    \param size Block size
+    \param on_event Called as on_event(const MidiEvent&, size_t offset) for
+    each event, in order, with the sample of the block it falls on
+     */
+    template <typename F>
+    void ProcessEvents(size_t size, F&& on_event)
+    {
+        const uint32_t now     = System::GetUs();
+        const uint32_t elapsed = now - last_block_;
+        while(!event_q_.isEmpty())
+        {
+            const TimedMidiEvent& e = event_q_.Peek();
+            // Events that arrived after now are for the next block.
+            if(static_cast<int32_t>(e.timestamp - now) >= 0 && started_)
+                break;
+            size_t offset = 0;
+            if(started_ && elapsed > 0
+               && static_cast<int32_t>(e.timestamp - last_block_) > 0)
+            {
+                offset = static_cast<size_t>(
+                    static_cast<uint64_t>(e.timestamp - last_block_) * size
+                    / elapsed);
+            }
+            on_event(e.event, offset < size ? offset : size - 1);
+            event_q_.ImmediateRead();
+        }
+        last_block_ = now;
+        started_    = true;
+    }
+
+    /** \return The number of events dropped because the queue was full */
+    uint32_t GetDroppedEvents() const { return dropped_; }
 
     /** SendMessage
     Send raw bytes as message
@@ -211,33 +297,67 @@ class MidiHandler
     }
 
     /** Feed in bytes to parser state machine from an external source.
-        Populates internal FIFO queue with MIDI Messages.
+        Populates internal queue with MIDI Messages.
 
         \note  Normally application code won't need to use this method directly.
         \param byte MIDI byte to be parsed
     */
-    void Parse(uint8_t byte)
+    void Parse(uint8_t byte) { Parse(&byte, 1, System::GetUs(), 0); }
+
+  private:
+    Config                          config_;
+    Transport                       transport_;
+    MidiParser                      parser_;
+    RingBuffer<TimedMidiEvent, 256> event_q_;
+    uint32_t                        dropped_;
+    uint32_t                        last_block_; // at the last ProcessEvents()
+    bool                            started_;
+
+    /** Parses straight into the queue, without waiting, as this runs in the
+     *  transport's interrupt. When the queue is full, events are dropped.
+     *  \param data Bytes received
+     *  \param size Number of bytes
+     *  \param timestamp Time the last byte arrived
+     *  \param byte_time Time between the bytes
+     */
+    void Parse(const uint8_t* data,
+               size_t         size,
+               uint32_t       timestamp,
+               uint32_t       byte_time)
     {
-        MidiEvent event;
-        if(parser_.Parse(byte, &event))
+        size_t pos = 0;
+        while(pos < size)
         {
-            event_q_.PushBack(event);
+            // One event at a time, to stamp each with its own time
+            const auto slot = event_q_.GetWriteSpan(1);
+            MidiEvent  scratch;
+            MidiEvent* event = slot.length > 0 ? &slot.data->event : &scratch;
+            size_t     parsed;
+            const bool complete
+                = parser_.ParseBuffer(data + pos, size - pos, event, 1, &parsed);
+            pos += parsed;
+            if(!complete)
+                break;
+            if(slot.length == 0)
+            {
+                dropped_++;
+                continue;
+            }
+            slot.data->timestamp
+                = timestamp - static_cast<uint32_t>(size - pos) * byte_time;
+            event_q_.CommitWrite(1);
         }
     }
 
-  private:
-    Config               config_;
-    Transport            transport_;
-    MidiParser           parser_;
-    FIFO<MidiEvent, 256> event_q_;
-
     static void ParseCallback(uint8_t* data, size_t size, void* context)
     {
         MidiHandler* handler = reinterpret_cast<MidiHandler*>(context);
-        for(size_t i = 0; i < size; i++)
-        {
-            handler->Parse(data[i]);
-        }
+        // The bytes of a DMA buffer arrived one after the other. The UART
+        // mostly calls back once the line has been idle for a byte's time,
+        // as MIDI comes in short messages, so the last byte ended that long
+        // before the callback. On a half or full buffer, it's off by a byte.
+        const uint32_t step = Transport::kRxByteTimeUs;
+        handler->Parse(data, size, System::GetUs() - step, step);
     }
 };
 
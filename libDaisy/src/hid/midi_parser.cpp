@@ -1,194 +1,180 @@
 #include "midi_parser.h"
+#include <string.h>
 
 using namespace daisy;
 
-bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
+namespace
 {
-    // reset parser when status byte is received
-    bool did_parse = false;
+/** Data bytes after a channel status byte, by its upper nibble */
+const uint8_t kChannelDataLength[8] = {
+    2, // NoteOff
+    2, // NoteOn
+    2, // PolyphonicKeyPressure
+    2, // ControlChange
+    1, // ProgramChange
+    1, // ChannelPressure
+    2, // PitchBend
+    0, // System
+};
 
-    if((byte & kStatusByteMask) && pstate_ != ParserSysEx)
-    {
-        pstate_ = ParserEmpty;
-    }
-    switch(pstate_)
-    {
-        case ParserEmpty:
-            // check byte for valid Status Byte
-            if(byte & kStatusByteMask)
-            {
-                // Get MessageType, and Channel
-                incoming_message_.channel = byte & kChannelMask;
-                incoming_message_.type
-                    = static_cast<MidiMessageType>((byte & kMessageMask) >> 4);
-                if((byte & 0xF8) == 0xF8)
-                    incoming_message_.type = SystemRealTime;
+/** Data bytes after a system common status byte, by its lower nibble */
+const uint8_t kSystemCommonDataLength[8] = {
+    0, // SystemExclusive, handled separately
+    1, // MTCQuarterFrame
+    2, // SongPositionPointer
+    1, // SongSelect
+    0, // SCUndefined0
+    0, // SCUndefined1
+    0, // TuneRequest
+    0, // SysExEnd
+};
 
-                // Validate, and move on.
-                if(incoming_message_.type < MessageLast)
-                {
-                    pstate_ = ParserHasStatus;
+constexpr uint8_t kStatusByteMask = 0x80;
+constexpr uint8_t kChannelMask    = 0x0F;
+constexpr uint8_t kSystemMask     = 0x07;
+constexpr uint8_t kSysExStart     = 0xF0;
+constexpr uint8_t kSysExEnd       = 0xF7;
+constexpr uint8_t kRealTimeStart  = 0xF8;
+} // namespace
 
-                    if(incoming_message_.type == SystemCommon)
-                    {
-                        incoming_message_.channel = 0;
-                        incoming_message_.sc_type
-                            = static_cast<SystemCommonType>(byte & 0x07);
-                        //sysex
-                        if(incoming_message_.sc_type == SystemExclusive)
-                        {
-                            pstate_                             = ParserSysEx;
-                            incoming_message_.sysex_message_len = 0;
-                        }
-                        //short circuit
-                        else if(incoming_message_.sc_type > SongSelect)
-                        {
-                            pstate_ = ParserEmpty;
-                            if(event_out != nullptr)
-                            {
-                                *event_out = incoming_message_;
-                            }
-                            did_parse = true;
-                        }
-                    }
-                    else if(incoming_message_.type == SystemRealTime)
-                    {
-                        incoming_message_.srt_type
-                            = static_cast<SystemRealTimeType>(
-                                byte & kSystemRealTimeMask);
+bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
+{
+    MidiEvent scratch;
+    return ParseBuffer(&byte, 1, event_out ? event_out : &scratch, 1) > 0;
+}
 
-                        //short circuit to start
-                        pstate_ = ParserEmpty;
-                        if(event_out != nullptr)
-                        {
-                            *event_out = incoming_message_;
-                        }
-                        did_parse = true;
-                    }
-                    else // Channel Voice or Channel Mode
-                    {
-                        running_status_ = incoming_message_.type;
-                    }
-                }
-                // Else we'll keep waiting for a valid incoming status byte
-            }
-            else
+size_t MidiParser::ParseBuffer(const uint8_t* data,
+                               size_t         size,
+                               MidiEvent*     events,
+                               size_t         max_events,
+                               size_t*        bytes_parsed)
+{
+    size_t num_events = 0;
+    size_t i          = 0;
+    while(i < size && num_events < max_events)
+    {
+        const uint8_t byte = data[i++];
+        if((byte & kStatusByteMask) == 0)
+        {
+            // Data bytes are by far the most common, so they come first.
+            if(in_sysex_)
             {
-                // Handle as running status
-                incoming_message_.type    = running_status_;
-                incoming_message_.data[0] = byte & kDataByteMask;
-                //check for single byte running status, really this only applies to channel pressure though
-                if(running_status_ == ChannelPressure
-                   || running_status_ == ProgramChange
-                   || incoming_message_.sc_type == MTCQuarterFrame
-                   || incoming_message_.sc_type == SongSelect)
-                {
-                    //Send the single byte update
-                    pstate_ = ParserEmpty;
-                    if(event_out != nullptr)
-                    {
-                        *event_out = incoming_message_;
-                    }
-                    did_parse = true;
-                }
-                else
-                {
-                    pstate_ = ParserHasData0; //we need to get the 2nd byte yet.
-                }
+                if(sysex_length_ < SYSEX_BUFFER_LEN)
+                    sysex_data_[sysex_length_++] = byte;
+                continue;
             }
-            break;
-        case ParserHasStatus:
-            if((byte & kStatusByteMask) == 0)
-            {
-                incoming_message_.data[0] = byte & kDataByteMask;
-                if(running_status_ == ChannelPressure
-                   || running_status_ == ProgramChange
-                   || incoming_message_.sc_type == MTCQuarterFrame
-                   || incoming_message_.sc_type == SongSelect)
-                {
-                    //these are just one data byte, so we short circuit back to start
-                    pstate_ = ParserEmpty;
-                    if(event_out != nullptr)
-                    {
-                        *event_out = incoming_message_;
-                    }
-                    did_parse = true;
-                }
-                else
-                {
-                    pstate_ = ParserHasData0;
-                }
+            // without a status, there's nothing to go with
+            if(status_ == 0)
+                continue;
 
-                //ChannelModeMessages (reserved Control Changes)
-                if(running_status_ == ControlChange
-                   && incoming_message_.data[0] > 119)
-                {
-                    incoming_message_.type    = ChannelMode;
-                    running_status_           = ChannelMode;
-                    incoming_message_.cm_type = static_cast<ChannelModeType>(
-                        incoming_message_.data[0] - 120);
-                }
-            }
-            else
-            {
-                // invalid message go back to start ;p
-                pstate_ = ParserEmpty;
-            }
-            break;
-        case ParserHasData0:
-            if((byte & kStatusByteMask) == 0)
-            {
-                incoming_message_.data[1] = byte & kDataByteMask;
+            data_[data_count_++] = byte;
+            if(data_count_ < data_length_)
+                continue;
 
-                //velocity 0 NoteOns are NoteOffs
-                if(running_status_ == NoteOn && incoming_message_.data[1] == 0)
-                {
-                    incoming_message_.type = NoteOff;
-                }
-
-                // At this point the message is valid, and we can complete this MidiEvent
-                if(event_out != nullptr)
-                {
-                    *event_out = incoming_message_;
-                }
-                did_parse = true;
+            // Complete. The status stays for running status, except for
+            // system common messages, which cancel it.
+            data_count_ = 0;
+            if(status_ < kSysExStart)
+            {
+                ChannelEvent(&events[num_events++]);
             }
             else
             {
-                // invalid message go back to start ;p
-                pstate_ = ParserEmpty;
+                SystemCommonEvent(&events[num_events++]);
+                status_ = 0;
             }
-            // Regardless, of whether the data was valid or not we go back to empty
-            // because either the message is queued for handling or its not.
-            pstate_ = ParserEmpty;
-            break;
-        case ParserSysEx:
-            // end of sysex
-            if(byte == 0xf7)
+        }
+        else if(byte >= kRealTimeStart)
+        {
+            // Real time messages can come at any time, and leave the
+            // message in progress alone.
+            MidiEvent& event = events[num_events++];
+            event.type       = SystemRealTime;
+            event.channel    = 0;
+            event.srt_type
+                = static_cast<SystemRealTimeType>(byte & kSystemMask);
+        }
+        else if(in_sysex_)
+        {
+            // Only 0xF7 ends SysEx. Other status bytes are ignored.
+            if(byte == kSysExEnd)
             {
-                pstate_ = ParserEmpty;
-                if(event_out != nullptr)
-                {
-                    *event_out = incoming_message_;
-                }
-                did_parse = true;
+                in_sysex_ = false;
+                SysExEvent(&events[num_events++]);
             }
-            else if(incoming_message_.sysex_message_len < SYSEX_BUFFER_LEN)
+        }
+        else if(byte < kSysExStart)
+        {
+            status_      = byte;
+            data_length_ = kChannelDataLength[(byte >> 4) & kSystemMask];
+            data_count_  = 0;
+        }
+        else if(byte == kSysExStart)
+        {
+            status_       = 0;
+            in_sysex_     = true;
+            sysex_length_ = 0;
+        }
+        else
+        {
+            status_      = byte;
+            data_length_ = kSystemCommonDataLength[byte & kSystemMask];
+            data_count_  = 0;
+            if(data_length_ == 0)
             {
-                incoming_message_
-                    .sysex_data[incoming_message_.sysex_message_len]
-                    = byte;
-                incoming_message_.sysex_message_len++;
+                SystemCommonEvent(&events[num_events++]);
+                status_ = 0;
             }
-            break;
-        default: break;
+        }
     }
-
-    return did_parse;
+    if(bytes_parsed != nullptr)
+        *bytes_parsed = i;
+    return num_events;
 }
 
 void MidiParser::Reset()
 {
-    pstate_                = ParserEmpty;
-    incoming_message_.type = MessageLast;
+    status_       = 0;
+    data_length_  = 0;
+    data_count_   = 0;
+    in_sysex_     = false;
+    sysex_length_ = 0;
+}
+
+void MidiParser::ChannelEvent(MidiEvent* event) const
+{
+    event->type    = static_cast<MidiMessageType>((status_ >> 4) & kSystemMask);
+    event->channel = status_ & kChannelMask;
+    event->data[0] = data_[0];
+    event->data[1] = data_length_ > 1 ? data_[1] : 0;
+
+    //velocity 0 NoteOns are NoteOffs
+    if(event->type == NoteOn && event->data[1] == 0)
+    {
+        event->type = NoteOff;
+    }
+    //ChannelModeMessages (reserved Control Changes)
+    else if(event->type == ControlChange && event->data[0] > 119)
+    {
+        event->type    = ChannelMode;
+        event->cm_type = static_cast<ChannelModeType>(event->data[0] - 120);
+    }
+}
+
+void MidiParser::SystemCommonEvent(MidiEvent* event) const
+{
+    event->type    = SystemCommon;
+    event->channel = 0;
+    event->sc_type = static_cast<SystemCommonType>(status_ & kSystemMask);
+    event->data[0] = data_length_ > 0 ? data_[0] : 0;
+    event->data[1] = data_length_ > 1 ? data_[1] : 0;
+}
+
+void MidiParser::SysExEvent(MidiEvent* event) const
+{
+    event->type              = SystemCommon;
+    event->channel           = 0;
+    event->sc_type           = SystemExclusive;
+    event->sysex_message_len = sysex_length_;
+    memcpy(event->sysex_data, sysex_data_, sysex_length_);
 }
@@ -9,7 +9,15 @@
 namespace daisy
 {
 /** @brief   Utility class for parsing raw byte streams into MIDI messages
- *  @details Implemented as a state machine designed to parse one byte at a time
+ *  @details Implemented as a state machine that can be fed one byte at a time,
+ *           or a whole buffer at once. The number of data bytes that follow
+ *           each status byte comes from a lookup table. \n
+ *           Running status is supported for channel messages. System real
+ *           time messages are passed on wherever they appear, also in the
+ *           middle of other messages and SysEx, without disturbing them.
+ *           Any other status byte cancels an incomplete message. SysEx runs
+ *           until 0xF7, ignoring any other status bytes on the way, and keeps
+ *           the first SYSEX_BUFFER_LEN data bytes.
  *  @ingroup midi
  */
 class MidiParser
@@ -33,30 +41,42 @@ class MidiParser
      */
     bool Parse(uint8_t byte, MidiEvent *event_out);
 
+    /**
+     * @brief Parse a buffer of MIDI bytes, e.g. a whole DMA transfer, into
+     *        events. Parsing stops early once events is full, and carries on
+     *        from there with the next call.
+     *
+     * @param data         Raw MIDI bytes to parse
+     * @param size         Number of bytes
+     * @param events       Output events, in the order they were completed
+     * @param max_events   Room in events
+     * @param bytes_parsed If not null, set to the number of bytes parsed. Less
+     *                     than size when parsing stopped early.
+     * @return The number of events written
+     */
+    size_t ParseBuffer(const uint8_t *data,
+                       size_t         size,
+                       MidiEvent     *events,
+                       size_t         max_events,
+                       size_t        *bytes_parsed = nullptr);
+
     /**
      * @brief Reset parser to default state
      */
     void Reset();
 
   private:
-    enum ParserState
-    {
-        ParserEmpty,
-        ParserHasStatus,
-        ParserHasData0,
-        ParserSysEx,
-    };
-
-    ParserState     pstate_;
-    MidiEvent       incoming_message_;
-    MidiMessageType running_status_;
+    void ChannelEvent(MidiEvent *event) const;
+    void SystemCommonEvent(MidiEvent *event) const;
+    void SysExEvent(MidiEvent *event) const;
 
-    // Masks to check for message type, and byte content
-    const uint8_t kStatusByteMask     = 0x80;
-    const uint8_t kMessageMask        = 0x70;
-    const uint8_t kDataByteMask       = 0x7F;
-    const uint8_t kChannelMask        = 0x0F;
-    const uint8_t kSystemRealTimeMask = 0x07;
+    uint8_t status_;      // status of the message being received, 0 for none
+    uint8_t data_length_; // data bytes the message takes
+    uint8_t data_count_;  // data bytes received so far
+    uint8_t data_[2];
+    bool    in_sysex_;
+    uint8_t sysex_length_;
+    uint8_t sysex_data_[SYSEX_BUFFER_LEN];
 };
 
 } // namespace daisy
@@ -11,25 +11,29 @@ void Parameter::Init(AnalogControl input, float min, float max, Curve curve)
     in_     = input;
     lmin_   = logf(min < 0.0000001f ? 0.0000001f : min);
     lmax_   = logf(max);
+
+    // Out of any control's range, so the first Process() maps the control
+    in_val_    = 1e6f;
+    threshold_ = 0.f;
+    changed_   = false;
+    val_       = min;
 }
 
 float Parameter::Process()
 {
+    const float in = in_.Process();
+    changed_       = fabsf(in - in_val_) > threshold_;
+    if(!changed_)
+        return val_;
+    in_val_ = in;
+
     switch(pcurve_)
     {
-        case LINEAR: val_ = (in_.Process() * (pmax_ - pmin_)) + pmin_; break;
-        case EXPONENTIAL:
-            val_ = in_.Process();
-            val_ = ((val_ * val_) * (pmax_ - pmin_)) + pmin_;
-            break;
-        case LOGARITHMIC:
-            val_ = expf((in_.Process() * (lmax_ - lmin_)) + lmin_);
-            break;
-        case CUBE:
-            val_ = in_.Process();
-            val_ = ((val_ * (val_ * val_)) * (pmax_ - pmin_)) + pmin_;
-            break;
+        case LINEAR: val_ = (in * (pmax_ - pmin_)) + pmin_; break;
+        case EXPONENTIAL: val_ = ((in * in) * (pmax_ - pmin_)) + pmin_; break;
+        case LOGARITHMIC: val_ = expf((in * (lmax_ - lmin_)) + lmin_); break;
+        case CUBE: val_ = ((in * (in * in)) * (pmax_ - pmin_)) + pmin_; break;
         default: break;
     }
     return val_;
-}
\ No newline at end of file
+}
@@ -39,6 +39,24 @@ class Parameter
     */
     float Process();
 
+    /** Sets how far the control has to move before the value follows it.
+    Knobs and CV inputs jitter a little all the time, and with a threshold the
+    value stays put until the control is really moved.
+    \param threshold - distance in the control's 0 to 1 range. 0 (the default) follows every change.
+    */
+    inline void SetThreshold(float threshold) { threshold_ = threshold; }
+
+    /** 
+    \return whether the last call to Process() changed the value.
+    Use it to only recompute coefficients (e.g. Svf::SetFreq) when the control moved:
+    \code
+    cutoff.Process();
+    if(cutoff.HasChanged())
+        filter.SetFreq(cutoff.Value());
+    \endcode
+    */
+    inline bool HasChanged() const { return changed_; }
+
     /** 
     \return the current value from the parameter without processing another sample.
     this is useful if you need to use the value multiple times, and don't store
@@ -52,6 +70,9 @@ class Parameter
     float         pmin_, pmax_;
     float         lmin_, lmax_; // for log range
     float         val_;
+    float         in_val_; // control value the current val_ was mapped from
+    float         threshold_;
+    bool          changed_;
     Curve         pcurve_;
 };
 /** @} */
@@ -50,6 +50,9 @@ class MidiUsbTransport
     void FlushRx();
     void Tx(uint8_t* buffer, size_t size);
 
+    /** Bytes of a USB packet arrive all at once */
+    static constexpr uint32_t kRxByteTimeUs = 0;
+
     class Impl;
 
     MidiUsbTransport() : pimpl_(nullptr) {}
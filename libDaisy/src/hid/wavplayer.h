@@ -4,6 +4,9 @@
 - Only 1 file playing back at a time.
 - Not sure how this would interfere with trying to use the SDCard/FatFs outside of
 this module. However, by using the extern'd SDFile, etc. I think that would break things.
+
+See WavSampler (hid/wavsampler.h) for several voices, variable speed, and
+24 bit or float files.
 */
 #pragma once
 #ifndef DSY_WAVPLAYER_H
@@ -0,0 +1,533 @@
+#pragma once
+#ifndef DSY_WAVSAMPLER_H
+#define DSY_WAVSAMPLER_H /**< Macro */
+#include <stdint.h>
+#include <atomic>
+#include "daisy_core.h"
+#include "util/ringbuffer.h"
+#include "util/wav_format.h"
+#include "ff.h"
+
+namespace daisy
+{
+/** Streams several WAV files from an SD Card at once, each at its own speed.
+
+Every voice has its own file and a ring of decoded frames. The main loop keeps
+the rings full with Prepare(), reading for the voice closest to running out
+first, while the audio callback mixes the voices with Process(). Playback
+speed is variable, using 4 point Hermite interpolation, and sample rates that
+differ from the output's are converted on the way.
+
+Mono and stereo files of 16, 24 or 32 bit integer or 32 bit float samples are
+supported.
+
+\code
+WavSampler<4> sampler;
+
+void AudioCallback(AudioHandle::InputBuffer  in,
+                   AudioHandle::OutputBuffer out,
+                   size_t                    size)
+{
+    sampler.Process(out[0], out[1], size);
+}
+
+int main()
+{
+    // ... init hardware, mount the SD Card
+    sampler.Init(hw.AudioSampleRate());
+    hw.StartAudio(AudioCallback);
+    sampler.Play("kick.wav");
+    sampler.Play("pad.wav", 0.5f, true); // an octave down, looping
+    while(1)
+        sampler.Prepare();
+}
+\endcode
+
+\tparam num_voices Number of files that can play at the same time
+\tparam ring_frames Frames of stereo audio buffered per voice, a power of two.
+        Mono voices buffer twice as many. Larger rings survive longer SD Card
+        stalls and faster playback.
+*/
+template <size_t num_voices, size_t ring_frames = 4096>
+class WavSampler
+{
+  public:
+    /** Bytes read from the file at a time */
+    static constexpr size_t kReadBytes = 4096;
+
+    WavSampler() {}
+    ~WavSampler() {}
+
+    /** Stops all voices, and sets the output sample rate.
+    \param sample_rate Sample rate of the audio callback
+     */
+    void Init(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        underruns_.store(0, std::memory_order_relaxed);
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            Voice& v = voices_[i];
+            if(v.state.load(std::memory_order_acquire) != VoiceState::IDLE)
+                f_close(&v.file);
+            v.state.store(VoiceState::IDLE, std::memory_order_release);
+        }
+    }
+
+    /** Starts playing a file on a free voice. The ring of the voice is filled
+    before playback starts, so this reads from the card. Main loop only.
+    \param path File to play
+    \param speed Playback speed, 1 for the original pitch
+    \param loop Whether to start over at the end of the file
+    \param gain Gain of the voice
+    \return The voice playing the file, or -1 if no voice is free or the file
+    can't be played.
+     */
+    int Play(const char* path,
+             float       speed = 1.f,
+             bool        loop  = false,
+             float       gain  = 1.f)
+    {
+        ReleaseEndedVoices();
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            Voice& v = voices_[i];
+            if(v.state.load(std::memory_order_acquire) != VoiceState::IDLE)
+                continue;
+            if(f_open(&v.file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+                return -1;
+            if(!ReadHeader(v))
+            {
+                f_close(&v.file);
+                return -1;
+            }
+
+            // One silent frame leads, to interpolate the first one from.
+            v.ring.Init();
+            for(size_t c = 0; c < v.channels; c++)
+                v.ring.Write(0.f);
+            v.loop = loop;
+            v.speed.store(speed, std::memory_order_relaxed);
+            v.gain.store(gain, std::memory_order_relaxed);
+            v.stop.store(false, std::memory_order_relaxed);
+            v.decoded.store(false, std::memory_order_relaxed);
+            v.frac = 0.f;
+            while(Refill(v)) {}
+            v.state.store(VoiceState::PLAYING, std::memory_order_release);
+            return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    /** Stops a voice at the next audio callback. Main loop only.
+    \param voice Voice returned by Play()
+     */
+    void Stop(int voice)
+    {
+        if(voice >= 0 && static_cast<size_t>(voice) < num_voices)
+            voices_[voice].stop.store(true, std::memory_order_relaxed);
+    }
+
+    /** \param voice Voice returned by Play()
+    \param speed Playback speed, 1 for the original pitch
+     */
+    void SetSpeed(int voice, float speed)
+    {
+        if(voice >= 0 && static_cast<size_t>(voice) < num_voices)
+            voices_[voice].speed.store(speed, std::memory_order_relaxed);
+    }
+
+    /** \param voice Voice returned by Play()
+    \param gain Gain of the voice
+     */
+    void SetGain(int voice, float gain)
+    {
+        if(voice >= 0 && static_cast<size_t>(voice) < num_voices)
+            voices_[voice].gain.store(gain, std::memory_order_relaxed);
+    }
+
+    /** \param voice Voice returned by Play()
+    \return Whether the voice is still playing
+     */
+    bool IsPlaying(int voice) const
+    {
+        return voice >= 0 && static_cast<size_t>(voice) < num_voices
+               && voices_[voice].state.load(std::memory_order_acquire)
+                      == VoiceState::PLAYING
+               && !voices_[voice].stop.load(std::memory_order_relaxed);
+    }
+
+    /** Reads from the card for the voices that need it, most urgent first:
+    the voice with the fewest output samples left in its ring goes first.
+    Voices that finished are closed. Main loop only.
+    \param max_reads Limits the number of reads, to bound the time spent
+    \return The number of reads done
+     */
+    size_t Prepare(size_t max_reads = SIZE_MAX)
+    {
+        ReleaseEndedVoices();
+        size_t reads = 0;
+        while(reads < max_reads)
+        {
+            Voice* next      = nullptr;
+            float  remaining = 0.f;
+            for(size_t i = 0; i < num_voices; i++)
+            {
+                Voice& v = voices_[i];
+                if(v.state.load(std::memory_order_acquire)
+                       != VoiceState::PLAYING
+                   || !NeedsRefill(v))
+                    continue;
+                const float r = TimeLeft(v);
+                if(!next || r < remaining)
+                {
+                    next      = &v;
+                    remaining = r;
+                }
+            }
+            if(!next || !Refill(*next))
+                break;
+            reads++;
+        }
+        return reads;
+    }
+
+    /** Mixes the playing voices. Mono voices play on both outputs.
+    From the audio callback.
+    \param out_left Left output, overwritten
+    \param out_right Right output, overwritten
+    \param size Number of samples
+     */
+    void Process(float* out_left, float* out_right, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            out_left[i]  = 0.f;
+            out_right[i] = 0.f;
+        }
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            Voice& v = voices_[i];
+            if(v.state.load(std::memory_order_acquire) != VoiceState::PLAYING)
+                continue;
+            if(v.stop.load(std::memory_order_relaxed))
+            {
+                v.state.store(VoiceState::ENDED, std::memory_order_release);
+                continue;
+            }
+            if(v.channels == 2)
+                ProcessVoice<2>(v, out_left, out_right, size);
+            else
+                ProcessVoice<1>(v, out_left, out_right, size);
+        }
+    }
+
+    /** \return The number of times a voice ran out of data, and went silent
+    for the rest of a callback. */
+    uint32_t GetUnderruns() const
+    {
+        return underruns_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    enum class VoiceState
+    {
+        IDLE,    /**< Free, owned by the main loop */
+        PLAYING, /**< Read by the audio callback */
+        ENDED,   /**< Done playing, to be closed by the main loop */
+    };
+
+    typedef void (*DecodeFunction)(const uint8_t* in, float* out, size_t n);
+
+    struct Voice
+    {
+        FIL            file;
+        DecodeFunction decode;
+        size_t         channels;
+        size_t         block_align;
+        float          file_rate;
+        FSIZE_t        data_start;
+        uint32_t       data_bytes;
+        uint32_t       bytes_left;
+        bool           loop;
+
+        /** Decoded, interleaved frames. The frame before the one playing
+        stays in the ring for the interpolation. */
+        RingBuffer<float, ring_frames * 2> ring;
+        float                              frac;
+
+        std::atomic<VoiceState> state{VoiceState::IDLE};
+        std::atomic<bool>       decoded{false};
+        std::atomic<bool>       stop{false};
+        std::atomic<float>      speed{1.f};
+        std::atomic<float>      gain{1.f};
+    };
+
+    template <typename Format>
+    static void Decode(const uint8_t* in, float* out, size_t n)
+    {
+        for(size_t i = 0; i < n; i++)
+            out[i] = Format::Load(in + i * Format::kBytes);
+    }
+
+    static inline uint16_t Read16(const uint8_t* p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    static inline uint32_t Read32(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(Read16(p))
+               | (static_cast<uint32_t>(Read16(p + 2)) << 16);
+    }
+
+    /** Walks the chunks of the file up to the data, and picks the decoder.
+    Leaves the file at the start of the data. */
+    bool ReadHeader(Voice& v)
+    {
+        uint8_t buf[40];
+        UINT    br;
+        v.data_start = 0;
+        if(f_read(&v.file, buf, 12, &br) != FR_OK || br != 12
+           || Read32(buf) != kWavFileChunkId
+           || Read32(buf + 8) != kWavFileWaveId)
+            return false;
+
+        bool     have_fmt = false;
+        uint16_t format = 0, bits = 0;
+        while(f_read(&v.file, buf, 8, &br) == FR_OK && br == 8)
+        {
+            const uint32_t id   = Read32(buf);
+            const uint32_t size = Read32(buf + 4);
+            if(id == kWavFileSubChunk1Id)
+            {
+                const UINT n = size < sizeof(buf) ? size : sizeof(buf);
+                if(n < 16 || f_read(&v.file, buf, n, &br) != FR_OK || br != n)
+                    return false;
+                format        = Read16(buf);
+                v.channels    = Read16(buf + 2);
+                v.file_rate   = static_cast<float>(Read32(buf + 4));
+                v.block_align = Read16(buf + 12);
+                bits          = Read16(buf + 14);
+                // The real format follows the extension
+                if(format == WAVE_FORMAT_EXTENSIBLE && n >= 26)
+                    format = Read16(buf + 24);
+                have_fmt = true;
+                if(f_lseek(&v.file, f_tell(&v.file) + size - n + (size & 1))
+                   != FR_OK)
+                    return false;
+            }
+            else if(id == kWavFileSubChunk2Id)
+            {
+                v.data_start = f_tell(&v.file);
+                v.data_bytes = size;
+                break;
+            }
+            else if(f_lseek(&v.file, f_tell(&v.file) + size + (size & 1))
+                    != FR_OK)
+            {
+                return false;
+            }
+        }
+        if(!have_fmt || v.channels < 1 || v.channels > 2
+           || v.file_rate <= 0.f || v.data_start == 0)
+            return false;
+
+        if(format == WAVE_FORMAT_PCM && bits == 16)
+            v.decode = Decode<WavSampleS16>;
+        else if(format == WAVE_FORMAT_PCM && bits == 24)
+            v.decode = Decode<WavSampleS24>;
+        else if(format == WAVE_FORMAT_PCM && bits == 32)
+            v.decode = Decode<WavSampleS32>;
+        else if(format == WAVE_FORMAT_IEEE_FLOAT && bits == 32)
+            v.decode = Decode<WavSampleF32>;
+        else
+            return false;
+        if(v.block_align != v.channels * bits / 8)
+            return false;
+
+        // Whole frames only, in case the file was cut short
+        v.data_bytes -= v.data_bytes % v.block_align;
+        v.bytes_left = v.data_bytes;
+        return true;
+    }
+
+    /** \return The smallest read worth making for the voice, in frames */
+    size_t MinReadFrames(const Voice& v) const
+    {
+        const size_t capacity = v.ring.capacity() / v.channels;
+        const size_t chunk    = kReadBytes / v.block_align;
+        return chunk < capacity / 2 ? chunk : capacity / 2;
+    }
+
+    bool NeedsRefill(const Voice& v) const
+    {
+        if(v.decoded.load(std::memory_order_relaxed))
+            return false;
+        const size_t writable = v.ring.writable() / v.channels;
+        // The end of the file comes in smaller pieces, with the padding
+        return writable >= MinReadFrames(v)
+               || (!v.loop && v.bytes_left / v.block_align + 2 <= writable);
+    }
+
+    /** \return Frames of the file per output sample, never negative */
+    float Step(const Voice& v) const
+    {
+        const float step
+            = v.speed.load(std::memory_order_relaxed) * v.file_rate
+              / sample_rate_;
+        return step > 0.f ? step : 0.f;
+    }
+
+    /** \return Output samples until the voice runs out of data */
+    float TimeLeft(const Voice& v) const
+    {
+        const float step   = Step(v);
+        const float frames
+            = static_cast<float>(v.ring.readable() / v.channels);
+        return step > 0.f ? frames / step : frames * 1.0e6f;
+    }
+
+    /** Reads and decodes one chunk into the ring of the voice, or finishes
+    the voice at the end of the file.
+    \return Whether anything was added to the ring
+     */
+    bool Refill(Voice& v)
+    {
+        if(v.decoded.load(std::memory_order_relaxed))
+            return false;
+        if(v.bytes_left == 0)
+        {
+            if(v.loop && v.data_bytes > 0)
+            {
+                if(f_lseek(&v.file, v.data_start) != FR_OK)
+                    return Finish(v);
+                v.bytes_left = v.data_bytes;
+            }
+            else
+            {
+                return Finish(v);
+            }
+        }
+
+        size_t frames = v.ring.writable() / v.channels;
+        if(frames > kReadBytes / v.block_align)
+            frames = kReadBytes / v.block_align;
+        if(frames > v.bytes_left / v.block_align)
+            frames = v.bytes_left / v.block_align;
+        if(frames == 0)
+            return false;
+
+        const UINT btr = static_cast<UINT>(frames * v.block_align);
+        UINT       br;
+        if(f_read(&v.file, read_buffer_, btr, &br) != FR_OK || br != btr)
+            return Finish(v);
+        v.bytes_left -= br;
+
+        // Decode straight into the ring, in two pieces around the wrap
+        const size_t   bytes   = v.block_align / v.channels;
+        size_t         samples = frames * v.channels;
+        const uint8_t* in      = read_buffer_;
+        while(samples > 0)
+        {
+            const auto span = v.ring.GetWriteSpan(samples);
+            v.decode(in, span.data, span.length);
+            v.ring.CommitWrite(span.length);
+            in += span.length * bytes;
+            samples -= span.length;
+        }
+        return true;
+    }
+
+    /** Ends the data with two silent frames, for the interpolation around
+    the last one. Skipped until there is room. */
+    bool Finish(Voice& v)
+    {
+        if(v.ring.writable() < 2 * v.channels)
+            return false;
+        for(size_t i = 0; i < 2 * v.channels; i++)
+            v.ring.Write(0.f);
+        v.bytes_left = 0;
+        v.decoded.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void ReleaseEndedVoices()
+    {
+        for(size_t i = 0; i < num_voices; i++)
+        {
+            Voice& v = voices_[i];
+            if(v.state.load(std::memory_order_acquire) == VoiceState::ENDED)
+            {
+                f_close(&v.file);
+                v.state.store(VoiceState::IDLE, std::memory_order_release);
+            }
+        }
+    }
+
+    template <size_t channels>
+    void
+    ProcessVoice(Voice& v, float* out_left, float* out_right, size_t size)
+    {
+        // Check for the end of the file before counting what's left, so the
+        // trailing frames are counted too.
+        const bool  decoded = v.decoded.load(std::memory_order_acquire);
+        size_t      avail   = v.ring.readable() / channels;
+        const float step    = Step(v);
+        const float gain    = v.gain.load(std::memory_order_relaxed);
+        float       frac    = v.frac;
+        size_t      pos     = 0;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            if(avail < 4)
+            {
+                if(decoded)
+                    v.state.store(VoiceState::ENDED,
+                                  std::memory_order_release);
+                else
+                    underruns_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            float out[channels];
+            for(size_t c = 0; c < channels; c++)
+            {
+                const float xm1 = v.ring.Peek(pos * channels + c);
+                const float x0  = v.ring.Peek((pos + 1) * channels + c);
+                const float x1  = v.ring.Peek((pos + 2) * channels + c);
+                const float x2  = v.ring.Peek((pos + 3) * channels + c);
+                out[c]          = Hermite(xm1, x0, x1, x2, frac) * gain;
+            }
+            out_left[i] += out[0];
+            out_right[i] += out[channels - 1];
+
+            frac += step;
+            size_t advance = static_cast<size_t>(frac);
+            frac -= static_cast<float>(advance);
+            if(advance > avail)
+                advance = avail;
+            pos += advance;
+            avail -= advance;
+        }
+        v.frac = frac;
+        v.ring.CommitRead(pos * channels);
+    }
+
+    static inline float
+    Hermite(float xm1, float x0, float x1, float x2, float t)
+    {
+        const float c1 = 0.5f * (x1 - xm1);
+        const float c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+        const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * t + c2) * t + c1) * t + x0;
+    }
+
+    Voice                 voices_[num_voices];
+    float                 sample_rate_ = 48000.f;
+    std::atomic<uint32_t> underruns_{0};
+    uint8_t               read_buffer_[kReadBytes];
+};
+
+} // namespace daisy
+
+#endif
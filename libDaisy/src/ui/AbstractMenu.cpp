@@ -9,6 +9,7 @@ void AbstractMenu::SelectItem(uint16_t itemIdx)
         return;
     selectedItemIdx_ = itemIdx;
     isEditing_       = false;
+    Invalidate();
 }
 
 // inherited from UiPage
@@ -19,6 +20,7 @@ bool AbstractMenu::OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
     if(numberOfPresses < 1)
         return true;
 
+    Invalidate();
     if(allowEntering_ && CanItemBeEnteredForEditing(selectedItemIdx_))
     {
         isEditing_ = !isEditing_;
@@ -38,6 +40,7 @@ bool AbstractMenu::OnCancelButton(uint8_t numberOfPresses, bool isRetriggering)
     if(numberOfPresses < 1)
         return true;
 
+    Invalidate();
     if(isEditing_)
         isEditing_ = false;
     else
@@ -54,6 +57,7 @@ bool AbstractMenu::OnArrowButton(ArrowButtonType arrowType,
     if(numberOfPresses < 1)
         return true;
 
+    Invalidate();
     if(orientation_ == Orientation::leftRightSelectUpDownModify)
     {
         if(arrowType == ArrowButtonType::down)
@@ -114,6 +118,7 @@ bool AbstractMenu::OnFunctionButton(uint8_t numberOfPresses,
 bool AbstractMenu::OnMenuEncoderTurned(int16_t  turns,
                                        uint16_t stepsPerRevolution)
 {
+    Invalidate();
     // edit value
     if(isEditing_)
         ModifyItemValue(
@@ -132,6 +137,7 @@ bool AbstractMenu::OnMenuEncoderTurned(int16_t  turns,
 bool AbstractMenu::OnValueEncoderTurned(int16_t  turns,
                                         uint16_t stepsPerRevolution)
 {
+    Invalidate();
     ModifyItemValue(
         selectedItemIdx_, turns, stepsPerRevolution, isFuncButtonDown_);
     return true;
@@ -139,6 +145,7 @@ bool AbstractMenu::OnValueEncoderTurned(int16_t  turns,
 
 bool AbstractMenu::OnValuePotMoved(float newPosition)
 {
+    Invalidate();
     ModifyItemValue(selectedItemIdx_, newPosition, isFuncButtonDown_);
     return true;
 }
@@ -148,6 +155,51 @@ void AbstractMenu::OnShow()
     isEditing_        = false;
     isFuncButtonDown_ = false;
     selectedItemIdx_  = 0;
+    Invalidate();
+}
+
+bool AbstractMenu::NeedsRedraw(const UiCanvasDescriptor& canvas)
+{
+    (void)(canvas); // silence unused variable warning
+
+    // Values and checkboxes can also be changed from outside the menu. The
+    // change counts of the values only go up, so their sum changes whenever
+    // one of them changes. A value that doesn't count its changes could
+    // have changed at any time.
+    uint32_t valueItemsState    = 0;
+    uint32_t checkboxItemsState = 0;
+    bool     needsRedraw        = false;
+    for(uint16_t i = 0; i < numItems_; i++)
+    {
+        const auto& item = items_[i];
+        switch(item.type)
+        {
+            case ItemType::checkboxItem:
+                checkboxItemsState = checkboxItemsState * 31
+                                     + (*item.asCheckboxItem.valueToModify);
+                break;
+            case ItemType::valueItem:
+            {
+                const auto& value = *item.asMappedValueItem.valueToModify;
+                valueItemsState += value.GetChangeCount();
+                needsRedraw |= !value.CountsChanges();
+            }
+            break;
+            case ItemType::customItem:
+                needsRedraw |= item.asCustomItem.itemObject->NeedsRedraw();
+                break;
+            default: break;
+        }
+    }
+
+    if(valueItemsState != valueItemsState_
+       || checkboxItemsState != checkboxItemsState_)
+    {
+        valueItemsState_    = valueItemsState;
+        checkboxItemsState_ = checkboxItemsState;
+        Invalidate();
+    }
+    return needsRedraw;
 }
 
 void AbstractMenu::Init(const ItemConfig* items,
@@ -163,6 +215,7 @@ void AbstractMenu::Init(const ItemConfig* items,
     selectedItemIdx_  = 0;
     isEditing_        = false;
     isFuncButtonDown_ = false;
+    Invalidate();
 }
 
 bool AbstractMenu::CanItemBeEnteredForEditing(uint16_t itemIdx)
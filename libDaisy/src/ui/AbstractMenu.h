@@ -133,6 +133,12 @@ class AbstractMenu : public UiPage
 
         /** Called when the okay button is pressed (and CanBeEnteredForEditing() returns false). */
         virtual void OnOkayButton(){};
+
+        /** Returns true if the item must be redrawn, even though the menu didn't
+         *  change. The default returns true, so that the menu is redrawn at the 
+         *  update rate of the canvas. Return false if the item only changes through
+         *  the functions above. */
+        virtual bool NeedsRedraw() const { return true; }
     };
 
     struct ItemConfig
@@ -210,6 +216,7 @@ class AbstractMenu : public UiPage
                               uint16_t stepsPerRevolution) override;
     bool OnValuePotMoved(float newPosition) override;
     void OnShow() override;
+    bool NeedsRedraw(const UiCanvasDescriptor& canvas) override;
 
   protected:
     /** Call this from your child class to initialize the menu. It's okay to
@@ -267,6 +274,11 @@ class AbstractMenu : public UiPage
     void TriggerItemAction(uint16_t itemIdx);
 
     bool isFuncButtonDown_ = false;
+
+    /** The values and checkboxes of all items when they were last checked
+     *  for changes in NeedsRedraw() */
+    uint32_t valueItemsState_    = 0;
+    uint32_t checkboxItemsState_ = 0;
 };
 
 
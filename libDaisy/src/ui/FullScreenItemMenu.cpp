@@ -157,10 +157,16 @@ void FullScreenItemMenu::DrawValueItem(OneBitGraphicsDisplay& display,
                topRowRect,
                !isEditing);
 
-    // draw the value
-    FixedCapStr<20> valueStr;
-    value.AppentToString(valueStr);
-    DrawValueText(display, isVertical, valueStr, remainingBounds, isEditing);
+    // draw the value, formatted again if it changed or can't tell
+    if(!value.CountsChanges() || &value != valueStrSource_
+       || value.GetChangeCount() != valueStrChangeCount_)
+    {
+        valueStr_.Clear();
+        value.AppentToString(valueStr_);
+        valueStrSource_      = &value;
+        valueStrChangeCount_ = value.GetChangeCount();
+    }
+    DrawValueText(display, isVertical, valueStr_, remainingBounds, isEditing);
 }
 
 void FullScreenItemMenu::DrawOpenUiPageItem(OneBitGraphicsDisplay& display,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AbstractMenu.h"
+#include "util/FixedCapStr.h"
 
 namespace daisy
 {
@@ -59,6 +60,12 @@ class FullScreenItemMenu : public AbstractMenu
   private:
     uint16_t canvasIdToDrawTo_ = UI::invalidCanvasId;
 
+    /** The string drawn for the last value item, formatted again only when 
+     *  the value changes, see `MappedValue::CountsChanges()` */
+    mutable FixedCapStr<20>    valueStr_;
+    mutable const MappedValue* valueStrSource_      = nullptr;
+    mutable uint32_t           valueStrChangeCount_ = 0;
+
     //////////////////////////////////////////////////////////////////////
     // Drawing routines
     //////////////////////////////////////////////////////////////////////
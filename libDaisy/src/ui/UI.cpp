@@ -28,7 +28,11 @@ void UI::Init(UiEventQueue&                             inputQueue,
     primaryOneBitGraphicsDisplayId_ = primaryOneBitGraphicsDisplayId;
 
     for(int i = 0; i < kMaxNumCanvases; i++)
-        lastUpdateTimes_[i] = 0;
+    {
+        lastUpdateTimes_[i]   = 0;
+        drawnStates_[i]       = 0;
+        canvasNeedsRedraw_[i] = true;
+    }
 }
 
 UI::~UI()
@@ -53,6 +57,7 @@ void UI::Process()
                 {
                     eventQueue_->GetAndRemoveNextEvent();
                     canvases_[i].screenSaverOn = false;
+                    canvasNeedsRedraw_[i]      = true;
                     break;
                 }
             }
@@ -82,10 +87,10 @@ void UI::Process()
                   < canvases_[i].screenSaverTimeOut)
         {
             const uint32_t timeDiff = currentTimeInMs - lastUpdateTimes_[i];
-            if(timeDiff > canvases_[i].updateRateMs_)
+            if(timeDiff > canvases_[i].updateRateMs_ && CanvasNeedsRedraw(i))
                 RedrawCanvas(i, currentTimeInMs);
         }
-        else
+        else if(!canvases_[i].screenSaverOn)
         { // turn off oled
             canvases_[i].clearFunction_(canvases_[i]);
             canvases_[i].flushFunction_(canvases_[i]);
@@ -119,6 +124,7 @@ void UI::OpenPage(UiPage& page)
     pages_.PushBack(&page);
     page.parent_ = this;
     page.OnShow();
+    InvalidateAllCanvases();
 
     // was there a page below?
     if(pages_.GetNumElements() > 1)
@@ -160,6 +166,7 @@ void UI::ClosePage(UiPage& page)
     // close the page
     page.OnHide();
     page.parent_ = nullptr;
+    InvalidateAllCanvases();
 }
 
 void UI::ProcessEvent(const UiEventQueue::Event& e)
@@ -252,11 +259,9 @@ void UI::ProcessEvent(const UiEventQueue::Event& e)
     }
 }
 
-void UI::RedrawCanvas(uint8_t index, uint32_t currentTimeInSysticks)
+int UI::GetFirstPageToDraw(const UiCanvasDescriptor& canvas)
 {
-    UiCanvasDescriptor& canvas = canvases_[index];
-
-    // find the bottom most page to draw, then draw the pages upwards from there
+    // find the bottom most page to draw, the pages are drawn upwards from there
     int firstToDraw;
     for(firstToDraw = int(pages_.GetNumElements()) - 1; firstToDraw >= 0;
         firstToDraw--)
@@ -268,6 +273,48 @@ void UI::RedrawCanvas(uint8_t index, uint32_t currentTimeInSysticks)
     // all pages are transparent - start with the page on the bottom
     if(firstToDraw < 0)
         firstToDraw = 0;
+    return firstToDraw;
+}
+
+uint32_t UI::GetDrawState(int firstPageToDraw) const
+{
+    // Invalidation counts only go up, so their sum changes whenever one of
+    // the pages was invalidated.
+    uint32_t state = 0;
+    for(uint32_t i = firstPageToDraw; i < pages_.GetNumElements(); i++)
+        state += pages_[i]->invalidationCount_;
+    return state;
+}
+
+bool UI::CanvasNeedsRedraw(uint8_t index)
+{
+    const UiCanvasDescriptor& canvas      = canvases_[index];
+    const int                 firstToDraw = GetFirstPageToDraw(canvas);
+
+    // Every page is asked, as it may invalidate itself from NeedsRedraw().
+    bool needsRedraw = canvasNeedsRedraw_[index];
+    for(uint32_t i = firstToDraw; i < pages_.GetNumElements(); i++)
+    {
+        if(pages_[i]->NeedsRedraw(canvas))
+            needsRedraw = true;
+    }
+    return needsRedraw || GetDrawState(firstToDraw) != drawnStates_[index];
+}
+
+void UI::InvalidateAllCanvases()
+{
+    for(int i = 0; i < kMaxNumCanvases; i++)
+        canvasNeedsRedraw_[i] = true;
+}
+
+void UI::RedrawCanvas(uint8_t index, uint32_t currentTimeInSysticks)
+{
+    UiCanvasDescriptor& canvas      = canvases_[index];
+    const int           firstToDraw = GetFirstPageToDraw(canvas);
+
+    // Pages that invalidate themselves while drawing are drawn again.
+    drawnStates_[index]       = GetDrawState(firstToDraw);
+    canvasNeedsRedraw_[index] = false;
 
     // clear canvas
     canvas.clearFunction_(canvas);
@@ -329,6 +329,24 @@ class UiPage
      */
     virtual void Draw(const UiCanvasDescriptor& canvas) = 0;
 
+    /** Marks the page to be redrawn on all canvases the next time they're 
+     *  updated. Call this whenever something changes that the page displays.
+     */
+    void Invalidate() { invalidationCount_++; }
+
+    /** Called before a canvas is updated, for each page that's visible on it.
+     *  Returns true if the page must be redrawn even though Invalidate() 
+     *  wasn't called. A page can also call Invalidate() from here, e.g. when
+     *  a value it displays was changed somewhere else.
+     *  The default returns true, so that pages that don't use Invalidate()
+     *  are redrawn at the update rate of the canvas.
+     */
+    virtual bool NeedsRedraw(const UiCanvasDescriptor& canvas)
+    {
+        (void)(canvas); // silence unused variable warnings
+        return true;
+    }
+
     /** Returns a reference to the parent UI object, or nullptr if not added to any UI at the moment. */
     UI* GetParentUI() { return parent_; }
     /** Returns a reference to the parent UI object, or nullptr if not added to any UI at the moment. */
@@ -336,7 +354,8 @@ class UiPage
 
   private:
     friend class UI;
-    UI* parent_;
+    UI*      parent_;
+    uint32_t invalidationCount_ = 0;
 };
 
 /** @brief A generic UI system
@@ -356,7 +375,9 @@ class UiPage
  *  used for the drawing, where each canvas could be a graphics display, 
  *  LEDs, alphanumeric displays, etc. The UI system makes sure that drawing 
  *  is executed with a constant refresh rate that can be individually 
- *  specified for each canvas.
+ *  specified for each canvas. A canvas is only redrawn and flushed when
+ *  one of the pages visible on it has changed, see UiPage::Invalidate()
+ *  and UiPage::NeedsRedraw().
  */
 class UI
 {
@@ -453,6 +474,8 @@ class UI
     Stack<UiPage*, kMaxNumPages>               pages_;
     Stack<UiCanvasDescriptor, kMaxNumCanvases> canvases_;
     uint32_t          lastUpdateTimes_[kMaxNumCanvases];
+    uint32_t          drawnStates_[kMaxNumCanvases];
+    bool              canvasNeedsRedraw_[kMaxNumCanvases];
     uint32_t          lastEventTime_;
     UiEventQueue*     eventQueue_;
     SpecialControlIds specialControlIds_;
@@ -467,6 +490,11 @@ class UI
                                 uint8_t  numberOfPresses,
                                 bool     isRetriggering);
     void RebuildPageVisibilities();
+
+    bool     CanvasNeedsRedraw(uint8_t index);
+    int      GetFirstPageToDraw(const UiCanvasDescriptor& canvas);
+    uint32_t GetDrawState(int firstPageToDraw) const;
+    void     InvalidateAllCanvases();
 };
 
 } // namespace daisy
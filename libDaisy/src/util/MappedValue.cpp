@@ -28,7 +28,7 @@ MappedFloatValue::MappedFloatValue(float       min,
 
 void MappedFloatValue::Set(float newValue)
 {
-    value_ = std::max(min_, std::min(max_, newValue));
+    ChangeValue(value_, std::max(min_, std::min(max_, newValue)));
 }
 
 void MappedFloatValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -39,7 +39,7 @@ void MappedFloatValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedFloatValue::ResetToDefault()
 {
-    value_ = default_;
+    ChangeValue(value_, default_);
 }
 
 float MappedFloatValue::GetAs0to1() const
@@ -81,9 +81,9 @@ void MappedFloatValue::SetFrom0to1(float normalizedValue0to1)
             v                   = min_ + valueSq * (max_ - min_);
         }
         break;
-        default: value_ = 0.0f; return;
+        default: ChangeValue(value_, 0.0f); return;
     }
-    value_ = std::max(min_, std::min(max_, v));
+    ChangeValue(value_, std::max(min_, std::min(max_, v)));
 }
 
 void MappedFloatValue::Step(int16_t numSteps, bool useCoarseStepSize)
@@ -119,7 +119,7 @@ MappedIntValue::MappedIntValue(int         min,
 
 void MappedIntValue::Set(int newValue)
 {
-    value_ = std::max(min_, std::min(max_, newValue));
+    ChangeValue(value_, std::max(min_, std::min(max_, newValue)));
 }
 
 void MappedIntValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -130,7 +130,7 @@ void MappedIntValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedIntValue::ResetToDefault()
 {
-    value_ = default_;
+    ChangeValue(value_, default_);
 }
 
 float MappedIntValue::GetAs0to1() const
@@ -141,14 +141,15 @@ float MappedIntValue::GetAs0to1() const
 void MappedIntValue::SetFrom0to1(float normalizedValue0to1)
 {
     const auto v = int(normalizedValue0to1 * (max_ - min_) + 0.5f) + min_;
-    value_       = std::max(min_, std::min(max_, v));
+    ChangeValue(value_, std::max(min_, std::min(max_, v)));
 }
 
 
 void MappedIntValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
 {
     const auto stepsize = useCoarseStepSize ? stepSizeCoarse_ : stepSizeFine_;
-    value_ = std::max(min_, std::min(max_, value_ + numStepsUp * stepsize));
+    ChangeValue(value_,
+                std::max(min_, std::min(max_, value_ + numStepsUp * stepsize)));
 }
 
 // ==========================================================================
@@ -166,7 +167,7 @@ MappedStringListValue::MappedStringListValue(const char** itemStrings,
 
 void MappedStringListValue::SetIndex(uint32_t index)
 {
-    index_ = std::min(uint32_t(numItems_ - 1), index);
+    ChangeValue(index_, std::min(uint32_t(numItems_ - 1), index));
 }
 
 void MappedStringListValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -176,7 +177,7 @@ void MappedStringListValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedStringListValue::ResetToDefault()
 {
-    index_ = defaultIndex_;
+    ChangeValue(index_, defaultIndex_);
 }
 
 float MappedStringListValue::GetAs0to1() const
@@ -186,26 +187,31 @@ float MappedStringListValue::GetAs0to1() const
 
 void MappedStringListValue::SetFrom0to1(float normalizedValue0to1)
 {
-    index_ = std::max(
-        0, std::min(int(normalizedValue0to1 * numItems_), numItems_ - 1));
+    ChangeValue(index_,
+                uint32_t(std::max(
+                    0,
+                    std::min(int(normalizedValue0to1 * numItems_),
+                             numItems_ - 1))));
 }
 
 void MappedStringListValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
 {
+    uint32_t index;
     if(numStepsUp > 0)
     {
         if(useCoarseStepSize)
-            index_ = numItems_ - 1;
+            index = numItems_ - 1;
         else
-            index_ = std::min(uint32_t(numItems_ - 1), index_ + numStepsUp);
+            index = std::min(uint32_t(numItems_ - 1), index_ + numStepsUp);
     }
     else
     {
         if(useCoarseStepSize)
-            index_ = 0;
+            index = 0;
         else
-            index_ = uint32_t(std::max(0, int(index_) + numStepsUp));
+            index = uint32_t(std::max(0, int(index_) + numStepsUp));
     }
+    ChangeValue(index_, index);
 }
 
 } // namespace daisy
\ No newline at end of file
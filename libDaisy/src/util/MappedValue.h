@@ -32,6 +32,38 @@ class MappedValue
      *  to increment/decrement the value with buttons/encoders while making use 
      *  of the specific mapping. */
     virtual void Step(int16_t numStepsUp, bool useCoarseStepSize) = 0;
+
+    /** Returns true if `GetChangeCount()` goes up with every change of the
+     *  value. The default returns false, so that a value which doesn't 
+     *  count its changes is treated as changed all the time, e.g. the menus
+     *  format and draw it again on every update.
+     *  
+     *  To avoid that, an implementation changes its value only through 
+     *  `ChangeValue()`, including changes made from outside the menu, and 
+     *  overrides this to return true. The values in this file do so. */
+    virtual bool CountsChanges() const { return false; }
+
+    /** Returns a number that goes up whenever the value changes, if 
+     *  `CountsChanges()` returns true. Compare it with an earlier result to 
+     *  find out if a string or a drawing of the value must be updated. */
+    uint32_t GetChangeCount() const { return changeCount_; }
+
+  protected:
+    /** Sets `value` to `newValue` and counts the change, if there is one.
+     *  Implementations that return true from `CountsChanges()` use this 
+     *  for every change of the value. */
+    template <typename ValueType>
+    void ChangeValue(ValueType& value, ValueType newValue)
+    {
+        if(newValue != value)
+        {
+            value = newValue;
+            changeCount_++;
+        }
+    }
+
+  private:
+    uint32_t changeCount_ = 0;
 };
 
 /** @brief A `MappedValue` that maps a float value using various mapping functions.
@@ -111,6 +143,9 @@ class MappedFloatValue : public MappedValue
      */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    // inherited form MappedValue
+    bool CountsChanges() const override { return true; }
+
   private:
     float                  value_;
     const float            min_;
@@ -185,6 +220,9 @@ class MappedIntValue : public MappedValue
     /** Steps the value up or down using the step sizes specified in the constructor. */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    // inherited form MappedValue
+    bool CountsChanges() const override { return true; }
+
   private:
     int         value_;
     const int   min_;
@@ -254,6 +292,9 @@ class MappedStringListValue : public MappedValue
      *  value will jump to the first or last item. */
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
+    // inherited form MappedValue
+    bool CountsChanges() const override { return true; }
+
   private:
     uint32_t     index_;
     const char** itemStrings_;
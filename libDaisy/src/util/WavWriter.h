@@ -1,38 +1,46 @@
 #pragma once
-#pragma once
+#include <atomic>
 #include "fatfs.h"
+#include "util/wav_format.h"
 
 namespace daisy
 {
 /** Audio Recording Module
- ** 
- ** Record audio into a working buffer that is gradually written to a WAV file on an SD Card. 
  **
- ** Recordings are made with floating point input, and will be converted to the 
- ** specified bits per sample internally 
+ ** Record audio into a working buffer that is gradually written to a WAV file on an SD Card.
  **
- ** For now only 16-bit and 32-bit (signed int) formats are supported
- ** f32 and s24 formats will be added next
+ ** Recordings are made with floating point input, and will be converted to the
+ ** specified format internally: 16, 24 or 32 bit signed integers, or 32 bit float.
+ ** The conversion is picked once in Init(), so recording doesn't branch on the format.
  **
- ** The transfer size determines the amount of internal memory used, and can have an
- ** effect on the performance of the streaming behavior of the WavWriter.
- ** Memory use can be calculated as: (2 * transfer_size) bytes
+ ** The working buffer is split into num_buffers transfers of transfer_size bytes.
+ ** Audio fills them in turn, while Write() copies each full one to the file.
+ ** More buffers give the SD card more time to catch up after a slow write.
+ ** Memory use can be calculated as: (num_buffers * transfer_size) bytes
  ** Performance optimal with sizes: 16384, 32768
- ** 
+ **
+ ** If the buffers are all full when new audio arrives, that audio is dropped
+ ** and counted in GetDroppedFrames(). The file stays a valid WAV file.
+ **
  ** To use:
  ** 1. Create a WavWriter<size> object (e.g. WavWriter<32768> writer)
  ** 2. Configure the settings as desired by creating a WavWriter<32768>::Config struct and setting the settings.
  ** 3. Initialize the object with the configuration struct.
  ** 4. Open a new file for writing with: writer.OpenFile("FileName.wav")
- ** 5. Write to it within your audio callback using: writer.Sample(value)
+ ** 5. Write to it within your audio callback using: writer.Sample(value),
+ **    or writer.SampleBlock(buffer, size) for a whole block.
  ** 6. Fill the Wav File on the SD Card with data from your main loop by running: writer.Write()
  ** 7. When finished with the recording finalize, and close the file with: writer.SaveFile();
- ** 
+ **
+ ** Sample() and SampleBlock() may run in an interrupt while Write() runs in the main loop.
+ ** SaveFile() must not overlap with either of them.
  ** */
-template <size_t transfer_size>
+template <size_t transfer_size, size_t num_buffers = 2>
 class WavWriter
 {
   public:
+    static_assert(num_buffers >= 2, "WavWriter needs at least two buffers");
+
     WavWriter() {}
     ~WavWriter() {}
 
@@ -49,120 +57,185 @@ class WavWriter
     {
         float   samplerate;
         int32_t channels;
-        int32_t bitspersample;
-    };
-
-    /** State of the internal Writing mechanism. 
-	 ** When the buffer is a certain amount full one section will write its contents
-	 ** while the other is still being written to. This is performed circularly
-	 ** so that audio will be uninterrupted during writing. */
-    enum class BufferState
-    {
-        IDLE,
-        FLUSH0,
-        FLUSH1,
+        int32_t bitspersample; /**< 16, 24 or 32 */
+        bool floating_point = false; /**< store 32 bit float instead of integers */
     };
 
-    /**  Initializes the WavFile header, and prepares the object for recording. */
-    void Init(const Config &cfg)
+    /** Initializes the WavFile header, and prepares the object for recording.
+     ** \return ERROR if the sample format isn't supported */
+    Result Init(const Config &cfg)
     {
         cfg_       = cfg;
         num_samps_ = 0;
+        dropped_   = 0;
+        recording_ = false;
+        write_pos_ = 0;
+        flush_pos_ = 0;
+        filled_.store(0);
+
+        Result result = Result::OK;
+        switch(cfg_.bitspersample)
+        {
+            case 16: SetFormat<WavSampleS16>(); break;
+            case 24: SetFormat<WavSampleS24>(); break;
+            case 32:
+                if(cfg_.floating_point)
+                    SetFormat<WavSampleF32>();
+                else
+                    SetFormat<WavSampleS32>();
+                break;
+            default:
+                SetFormat<WavSampleS16>();
+                cfg_.bitspersample = 16;
+                result             = Result::ERROR;
+                break;
+        }
+        frame_bytes_ = cfg_.channels * sample_bytes_;
+
         // Prep the wav header according to config.
         // Certain things (i.e. Size, etc. will have to wait until the finalization of the file, or be updated while streaming).
         wavheader_.ChunkId       = kWavFileChunkId;     /** "RIFF" */
         wavheader_.FileFormat    = kWavFileWaveId;      /** "WAVE" */
         wavheader_.SubChunk1ID   = kWavFileSubChunk1Id; /** "fmt " */
         wavheader_.SubChunk1Size = 16;                  // for PCM
-        wavheader_.AudioFormat   = WAVE_FORMAT_PCM;
-        wavheader_.NbrChannels   = cfg.channels;
-        wavheader_.SampleRate    = static_cast<int>(cfg.samplerate);
+        wavheader_.NbrChannels   = cfg_.channels;
+        wavheader_.SampleRate    = static_cast<int>(cfg_.samplerate);
         wavheader_.ByteRate      = CalcByteRate();
-        wavheader_.BlockAlign    = cfg_.channels * cfg_.bitspersample / 8;
+        wavheader_.BlockAlign    = frame_bytes_;
         wavheader_.BitPerSample  = cfg_.bitspersample;
         wavheader_.SubChunk2ID   = kWavFileSubChunk2Id; /** "data" */
         /** Also calcs SubChunk2Size */
         wavheader_.FileSize = CalcFileSize();
         // This is calculated as part of the subchunk size
+        return result;
     }
 
     /** Records the current sample into the working buffer,
-     ** queues writes to media when necessary. 
-     ** 
+     ** queues writes to media when necessary.
+     **
      ** \param in should be a pointer to an array of samples */
-    void Sample(const float *in)
+    void Sample(const float *in) { SampleBlock(in, 1); }
+
+    /** Records a block of interleaved frames.
+     ** \param in cfg.channels samples per frame
+     ** \param frames number of frames in the block */
+    void SampleBlock(const float *in, size_t frames)
     {
-        for(size_t i = 0; i < cfg_.channels; i++)
+        if(!Reserve(frames))
+            return;
+        size_t samples = frames * cfg_.channels;
+        while(samples > 0)
         {
-            switch(cfg_.bitspersample)
+            const size_t contiguous = (kBufferBytes - write_pos_) / sample_bytes_;
+            if(contiguous == 0)
             {
-                case 16:
-                {
-                    int16_t *tp;
-                    tp            = (int16_t *)transfer_buff;
-                    tp[wptr_ + i] = f2s16(in[i]);
-                }
-                break;
-                case 32: transfer_buff[wptr_ + i] = f2s32(in[i]); break;
-                default: break;
+                // One sample straddles the end of the buffer.
+                uint8_t tmp[4];
+                encode_interleaved_(in, tmp, 1);
+                Put(tmp, sample_bytes_);
+                in++;
+                samples--;
+                continue;
             }
+            const size_t n = samples < contiguous ? samples : contiguous;
+            encode_interleaved_(in, &buffer_[write_pos_], n);
+            Advance(n * sample_bytes_);
+            in += n;
+            samples -= n;
         }
-        num_samps_++;
-        wptr_ += cfg_.channels;
-        size_t cap_point
-            = cfg_.bitspersample == 16 ? kTransferSamps * 2 : kTransferSamps;
-        if(wptr_ == cap_point)
-        {
-            bstate_ = BufferState::FLUSH0;
-        }
-        if(wptr_ >= cap_point * 2)
+        Commit(frames);
+    }
+
+    /** Records a block with one buffer per channel.
+     ** \param in cfg.channels pointers to the channel buffers
+     ** \param frames number of samples in each buffer */
+    void SampleBlock(const float *const *in, size_t frames)
+    {
+        if(!Reserve(frames))
+            return;
+        size_t offset = 0;
+        while(offset < frames)
         {
-            wptr_   = 0;
-            bstate_ = BufferState::FLUSH1;
+            const size_t contiguous = (kBufferBytes - write_pos_) / frame_bytes_;
+            if(contiguous == 0)
+            {
+                // One frame straddles the end of the buffer.
+                for(int32_t c = 0; c < cfg_.channels; c++)
+                {
+                    uint8_t tmp[4];
+                    encode_interleaved_(&in[c][offset], tmp, 1);
+                    Put(tmp, sample_bytes_);
+                }
+                offset++;
+                continue;
+            }
+            const size_t remaining = frames - offset;
+            const size_t n = remaining < contiguous ? remaining : contiguous;
+            encode_planar_(in, offset, &buffer_[write_pos_], n, cfg_.channels);
+            Advance(n * frame_bytes_);
+            offset += n;
         }
+        Commit(frames);
     }
 
-    /** Check buffer state and write */
-    void Write()
+    /** Writes every full transfer buffer to the file.
+     ** Call this regularly from the main loop while recording. */
+    Result Write()
     {
-        if(bstate_ != BufferState::IDLE && IsRecording())
+        while(filled_.load(std::memory_order_acquire) >= transfer_size)
         {
-            uint32_t     offset;
-            unsigned int bw = 0;
-            //offset          = bstate_ == BufferState::FLUSH0 ? 0 : transfer_size;
-            offset  = bstate_ == BufferState::FLUSH0 ? 0 : kTransferSamps;
-            bstate_ = BufferState::IDLE;
-            f_write(&fp_, &transfer_buff[offset], transfer_size, &bw);
+            if(Flush(transfer_size) != Result::OK)
+                return Result::ERROR;
         }
+        return Result::OK;
     }
 
     /** Finalizes the writing of the WAV file.
-	 ** This overwrites the WAV Header with the correct
-	 ** final size, and closes the fptr. */
-    void SaveFile()
+	 ** This writes out the remaining audio, overwrites the WAV Header
+	 ** with the correct final size, and closes the fptr. */
+    Result SaveFile()
     {
+        if(!recording_)
+            return Result::ERROR;
+        recording_    = false;
+        Result result = Write();
+        // Whatever's left is less than one transfer, and never wraps,
+        // as the flushes so far were whole transfers.
+        const size_t tail = filled_.load(std::memory_order_acquire);
+        if(result == Result::OK && tail > 0)
+            result = Flush(tail);
+
         unsigned int bw = 0;
-        recording_      = false;
-        // We _should_ flush whatever's left in the transfer buff
-        // TODO: that.
         wavheader_.FileSize = CalcFileSize();
-        f_lseek(&fp_, 0);
-        f_write(&fp_, &wavheader_, sizeof(wavheader_), &bw);
-        f_close(&fp_);
+        if(f_lseek(&fp_, 0) != FR_OK
+           || f_write(&fp_, &wavheader_, sizeof(wavheader_), &bw) != FR_OK
+           || bw != sizeof(wavheader_))
+            result = Result::ERROR;
+        if(f_close(&fp_) != FR_OK)
+            result = Result::ERROR;
+        return result;
     }
 
     /** Opens a file for writing. Writes the initial WAV Header, and gets ready for stream-based recording. */
-    void OpenFile(const char *name)
+    Result OpenFile(const char *name)
     {
         if(f_open(&fp_, name, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK)
         {
+            num_samps_          = 0;
+            dropped_            = 0;
+            write_pos_          = 0;
+            flush_pos_          = 0;
+            wavheader_.FileSize = CalcFileSize();
+            filled_.store(0);
             unsigned int bw = 0;
             if(f_write(&fp_, &wavheader_, sizeof(wavheader_), &bw) == FR_OK)
             {
                 recording_ = true;
-                num_samps_ = 0;
+                return Result::OK;
             }
+            f_close(&fp_);
         }
+        return Result::ERROR;
     }
 
     /** Returns whether recording is currently active or not. */
@@ -177,30 +250,127 @@ class WavWriter
         return (float)num_samps_ / (float)cfg_.samplerate;
     }
 
+    /** Returns the number of frames lost because Write() fell behind. */
+    inline uint32_t GetDroppedFrames() const { return dropped_; }
+
   private:
+    using InterleavedEncoder = void (*)(const float *in, uint8_t *out, size_t count);
+    using PlanarEncoder      = void (*)(const float *const *in,
+                                   size_t              offset,
+                                   uint8_t            *out,
+                                   size_t              frames,
+                                   size_t              channels);
+
+    template <typename Format>
+    static void EncodeInterleaved(const float *in, uint8_t *out, size_t count)
+    {
+        for(size_t i = 0; i < count; i++)
+            Format::Store(in[i], out + i * Format::kBytes);
+    }
+
+    template <typename Format>
+    static void EncodePlanar(const float *const *in,
+                             size_t              offset,
+                             uint8_t            *out,
+                             size_t              frames,
+                             size_t              channels)
+    {
+        for(size_t i = 0; i < frames; i++)
+        {
+            for(size_t c = 0; c < channels; c++)
+            {
+                Format::Store(in[c][offset + i], out);
+                out += Format::kBytes;
+            }
+        }
+    }
+
+    template <typename Format>
+    void SetFormat()
+    {
+        encode_interleaved_    = &EncodeInterleaved<Format>;
+        encode_planar_         = &EncodePlanar<Format>;
+        sample_bytes_          = Format::kBytes;
+        wavheader_.AudioFormat = Format::kFormat;
+    }
+
+    /** Checks there's room for the frames, counting them as dropped if not */
+    bool Reserve(size_t frames)
+    {
+        if(!recording_)
+            return false;
+        const size_t free
+            = kBufferBytes - filled_.load(std::memory_order_acquire);
+        if(frames * frame_bytes_ > free)
+        {
+            dropped_ += frames;
+            return false;
+        }
+        return true;
+    }
+
+    /** Hands the frames written since Reserve() to Write() */
+    void Commit(size_t frames)
+    {
+        filled_.fetch_add(frames * frame_bytes_, std::memory_order_release);
+        num_samps_ += frames;
+    }
+
+    void Advance(size_t bytes)
+    {
+        write_pos_ += bytes;
+        if(write_pos_ >= kBufferBytes)
+            write_pos_ -= kBufferBytes;
+    }
+
+    /** Copies bytes that may wrap around the end of the buffer */
+    void Put(const uint8_t *data, size_t bytes)
+    {
+        for(size_t i = 0; i < bytes; i++)
+        {
+            buffer_[write_pos_] = data[i];
+            Advance(1);
+        }
+    }
+
+    Result Flush(size_t bytes)
+    {
+        unsigned int bw  = 0;
+        FRESULT      res = f_write(&fp_, &buffer_[flush_pos_], bytes, &bw);
+        flush_pos_ += bytes;
+        if(flush_pos_ >= kBufferBytes)
+            flush_pos_ -= kBufferBytes;
+        filled_.fetch_sub(bytes, std::memory_order_release);
+        return res == FR_OK && bw == bytes ? Result::OK : Result::ERROR;
+    }
+
     /** Calculate the file size based on current recording */
     inline uint32_t CalcFileSize()
     {
-        wavheader_.SubCHunk2Size
-            = num_samps_ * cfg_.channels * cfg_.bitspersample / 8;
+        wavheader_.SubCHunk2Size = num_samps_ * frame_bytes_;
         return 36 + wavheader_.SubCHunk2Size;
     }
 
     /** Compute the byte rate given the user settings. */
     inline uint32_t CalcByteRate()
     {
-        return cfg_.samplerate * cfg_.channels * cfg_.bitspersample / 8;
+        return cfg_.samplerate * cfg_.channels * sample_bytes_;
     }
 
-    static constexpr int kTransferSamps = transfer_size / sizeof(int32_t);
+    static constexpr size_t kBufferBytes = transfer_size * num_buffers;
 
-    WAV_FormatTypeDef wavheader_;
-    uint32_t          num_samps_, wptr_;
-    Config            cfg_;
-    int32_t           transfer_buff[kTransferSamps * 2];
-    BufferState       bstate_;
-    bool              recording_;
-    FIL               fp_;
+    WAV_FormatTypeDef   wavheader_;
+    uint32_t            num_samps_, dropped_;
+    Config              cfg_;
+    InterleavedEncoder  encode_interleaved_;
+    PlanarEncoder       encode_planar_;
+    size_t              sample_bytes_, frame_bytes_;
+    size_t              write_pos_; // only used by Sample()/SampleBlock()
+    size_t              flush_pos_; // only used by Write()/SaveFile()
+    std::atomic<size_t> filled_;    // bytes waiting to be written to the file
+    alignas(4) uint8_t  buffer_[kBufferBytes];
+    bool                recording_;
+    FIL                 fp_;
 };
 
 } // namespace daisy
@@ -2,6 +2,8 @@
 #ifndef DSY_RINGBUFFER_H
 #define DSY_RINGBUFFER_H
 
+#include <stddef.h>
+#include <atomic>
 #include <algorithm>
 
 namespace daisy
@@ -11,34 +13,74 @@ namespace daisy
 */
 
 /**
-Utility Ring Buffer \n 
-imported from pichenettes/stmlib
+Lock-free single-producer/single-consumer Ring Buffer \n
+originally imported from pichenettes/stmlib
+
+One context (e.g. an interrupt or DMA callback) may write while
+another (e.g. the main loop or audio callback) reads, without
+disabling interrupts. Functions are documented as writer or
+reader side; calling a writer function from the reader (or the
+other way around) is only safe when both run in the same context.
+
+The read and write counters run freely and are masked into the
+buffer, so size must be a power of two and all size elements
+can be used.
+
+Blocks can be exchanged without copying through
+GetWriteSpan()/CommitWrite() and GetReadSpan()/CommitRead(),
+which hand out the largest contiguous region at the current
+position. A region that wraps around the end of the buffer
+takes two calls.
+
+\code
+// SD card streaming: fill as much as fits in one contiguous read
+auto span = buffer.GetWriteSpan();
+f_read(&file, span.data, span.length * sizeof(int16_t), &bytes_read);
+buffer.CommitWrite(bytes_read / sizeof(int16_t));
+\endcode
 */
 template <typename T, size_t size>
 class RingBuffer
 {
   public:
+    static_assert((size & (size - 1)) == 0,
+                  "RingBuffer size must be a power of two");
+
+    /** A contiguous region of the buffer */
+    struct Span
+    {
+        T*     data;   /**< First element of the region */
+        size_t length; /**< Number of elements in the region */
+    };
+
     RingBuffer() {}
 
     /** Initializes the Ring Buffer */
-    inline void Init() { read_ptr_ = write_ptr_ = 0; }
+    inline void Init()
+    {
+        read_ptr_.store(0, std::memory_order_relaxed);
+        write_ptr_.store(0, std::memory_order_release);
+    }
 
     /** \return The total size of the ring buffer */
     inline size_t capacity() const { return size; }
 
-    /** \return the number of samples that can be written to ring buffer without overwriting unread data. */
-    inline size_t writable() const
-    {
-        return (read_ptr_ - write_ptr_ - 1) % size;
-    }
+    /** \return the number of elements that can be written to ring buffer without overwriting unread data. */
+    inline size_t writable() const { return size - readable(); }
 
     /** \return number of unread elements in ring buffer */
-    inline size_t readable() const { return (write_ptr_ - read_ptr_) % size; }
+    inline size_t readable() const
+    {
+        // Read the reader's counter first, so the difference never exceeds size.
+        const size_t r = read_ptr_.load(std::memory_order_acquire);
+        return write_ptr_.load(std::memory_order_acquire) - r;
+    }
 
     /** \returns True, if the buffer is empty. */
-    inline bool isEmpty() const { return write_ptr_ == read_ptr_; }
+    inline bool isEmpty() const { return readable() == 0; }
 
-    /** Writes the value to the next available position in the ring buffer
+    /** Writes the value to the next available position in the ring buffer,
+    waiting for the reader to make room. Writer side.
     \param v Value to write
     */
     inline void Write(T v)
@@ -48,17 +90,24 @@ class RingBuffer
         Overwrite(v);
     }
 
-    /** Writes the new element to the ring buffer, overwriting unread data if necessary. 
+    /** Writes the new element to the ring buffer, discarding the oldest
+    unread element if it is full. Writer side, and only safe against
+    the reader when the buffer is not full.
     \param v Value to overwrite
      */
     inline void Overwrite(T v)
     {
-        size_t w   = write_ptr_;
-        buffer_[w] = v;
-        write_ptr_ = (w + 1) % size;
+        const size_t w = write_ptr_.load(std::memory_order_relaxed);
+        if(w - read_ptr_.load(std::memory_order_acquire) == size)
+        {
+            read_ptr_.store(w - size + 1, std::memory_order_release);
+        }
+        buffer_[w & kMask] = v;
+        write_ptr_.store(w + 1, std::memory_order_release);
     }
 
-    /** Reads the first available element from the ring buffer
+    /** Reads the first available element from the ring buffer,
+    waiting for the writer if it is empty. Reader side.
     \return read value
      */
     inline T Read()
@@ -68,85 +117,138 @@ class RingBuffer
         return ImmediateRead();
     }
 
-    /** Reads next element from ring buffer immediately
+    /** Reads next element from ring buffer immediately. Reader side,
+    the buffer must not be empty.
     \return read value
      */
     inline T ImmediateRead()
     {
-        size_t r      = read_ptr_;
-        T      result = buffer_[r];
-        read_ptr_     = (r + 1) % size;
+        const size_t r      = read_ptr_.load(std::memory_order_relaxed);
+        T            result = buffer_[r & kMask];
+        read_ptr_.store(r + 1, std::memory_order_release);
         return result;
     }
 
-    /** Flushes unread elements from the ring buffer */
-    inline void Flush() { write_ptr_ = read_ptr_; }
+    /** Returns an unread element without removing it. Reader side.
+    \param offset position after the oldest unread element,
+    must be less than readable()
+    \return the element
+     */
+    inline const T& Peek(size_t offset = 0) const
+    {
+        return buffer_[(read_ptr_.load(std::memory_order_relaxed) + offset)
+                       & kMask];
+    }
 
-    /** Read enough samples to make it possible to read 1 sample. 
-    \param n Size of T ?
+    /** Flushes unread elements from the ring buffer. Reader side. */
+    inline void Flush()
+    {
+        read_ptr_.store(write_ptr_.load(std::memory_order_acquire),
+                        std::memory_order_release);
+    }
+
+    /** Discards the oldest unread elements until at least n elements
+    can be written. Writer side, only safe when the reader is not
+    running concurrently.
+    \param n Number of elements to make room for
      */
     inline void Swallow(size_t n)
     {
+        n = std::min(n, size);
         if(writable() >= n)
         {
             return;
         }
-        read_ptr_ = (write_ptr_ + 1 + n) % size;
+        read_ptr_.store(write_ptr_.load(std::memory_order_relaxed) - size + n,
+                        std::memory_order_release);
     }
 
-    /** Reads a number of elements into a buffer immediately
+    /** Reads a number of elements into a buffer immediately. Reader side.
     \param destination buffer to write to
-    \param num_elements number of elements in buffer    
+    \param num_elements number of elements to read, at most readable()
      */
     inline void ImmediateRead(T* destination, size_t num_elements)
     {
-        size_t r    = read_ptr_;
-        size_t read = num_elements;
-
-        if(r + read > size)
-        {
-            read = size - r;
-        }
-        std::copy(&buffer_[r], &buffer_[r + read], destination);
-        if(read != num_elements)
-        {
-            std::copy(
-                &buffer_[0], &buffer_[num_elements - read], destination + read);
-        }
-        read_ptr_ = (r + num_elements) % size;
+        const size_t r     = read_ptr_.load(std::memory_order_relaxed);
+        const size_t start = r & kMask;
+        const size_t first = std::min(num_elements, size - start);
+        std::copy(&buffer_[start], &buffer_[start + first], destination);
+        std::copy(
+            &buffer_[0], &buffer_[num_elements - first], destination + first);
+        read_ptr_.store(r + num_elements, std::memory_order_release);
     }
 
-    /** Overwrites a number of elements using the source buffer as input. 
+    /** Writes a number of elements using the source buffer as input,
+    without checking for room. Writer side.
     \param source Input buffer
-    \param num_elements Number of elements in source
+    \param num_elements Number of elements in source, at most writable()
      */
     inline void Overwrite(const T* source, size_t num_elements)
     {
-        size_t w       = write_ptr_;
-        size_t written = num_elements;
+        const size_t w     = write_ptr_.load(std::memory_order_relaxed);
+        const size_t start = w & kMask;
+        const size_t first = std::min(num_elements, size - start);
+        std::copy(source, source + first, &buffer_[start]);
+        std::copy(source + first, source + num_elements, &buffer_[0]);
+        write_ptr_.store(w + num_elements, std::memory_order_release);
+    }
 
-        if(w + written > size)
-        {
-            written = size - w;
-        }
-        std::copy(source, source + written, &buffer_[w]);
-        if(written != num_elements)
-        {
-            std::copy(source + written, source + num_elements, &buffer_[0]);
-        }
+    /** \return The largest contiguous region that can be written at the
+    write position. Fill it, then publish the elements with CommitWrite().
+    Writer side.
+    \param max_elements Limits the size of the region
+     */
+    inline Span GetWriteSpan(size_t max_elements = size)
+    {
+        const size_t w     = write_ptr_.load(std::memory_order_relaxed);
+        const size_t start = w & kMask;
+        const size_t free
+            = size - (w - read_ptr_.load(std::memory_order_acquire));
+        return {&buffer_[start],
+                std::min(std::min(free, size - start), max_elements)};
+    }
 
-        write_ptr_ = (w + num_elements) % size;
+    /** Makes elements written to the region from GetWriteSpan()
+    available to the reader. Writer side.
+    \param num_elements Number of elements written, at most the span size
+     */
+    inline void CommitWrite(size_t num_elements)
+    {
+        write_ptr_.store(write_ptr_.load(std::memory_order_relaxed)
+                             + num_elements,
+                         std::memory_order_release);
+    }
+
+    /** \return The largest contiguous region of unread elements at the
+    read position. Process it, then free the elements with CommitRead().
+    Reader side.
+    \param max_elements Limits the size of the region
+     */
+    inline Span GetReadSpan(size_t max_elements = size)
+    {
+        const size_t r     = read_ptr_.load(std::memory_order_relaxed);
+        const size_t start = r & kMask;
+        const size_t avail = write_ptr_.load(std::memory_order_acquire) - r;
+        return {&buffer_[start],
+                std::min(std::min(avail, size - start), max_elements)};
     }
 
-    /**Advances the write pointer, for when a peripheral is writing to the buffer. */
+    /** Returns elements of the region from GetReadSpan() to the writer.
+    Reader side.
+    \param num_elements Number of elements consumed, at most the span size
+     */
+    inline void CommitRead(size_t num_elements)
+    {
+        read_ptr_.store(read_ptr_.load(std::memory_order_relaxed)
+                            + num_elements,
+                        std::memory_order_release);
+    }
+
+    /**Advances the write pointer, for when a peripheral is writing to the buffer.
+    Clamped to the available room. Writer side. */
     inline void Advance(size_t num_elements)
     {
-        size_t free;
-        free         = this->writable();
-        num_elements = num_elements < free ? num_elements : free;
-        write_ptr_   = write_ptr_ + num_elements;
-        if(write_ptr_ > size)
-            write_ptr_ = write_ptr_ - size;
+        CommitWrite(std::min(num_elements, writable()));
     }
 
     /**Returns a pointer to the actual Ring Buffer
@@ -154,9 +256,11 @@ class RingBuffer
     inline T* GetMutableBuffer() { return buffer_; }
 
   private:
-    T               buffer_[size];
-    volatile size_t read_ptr_;
-    volatile size_t write_ptr_;
+    static constexpr size_t kMask = size - 1;
+
+    T                   buffer_[size];
+    std::atomic<size_t> read_ptr_{0};
+    std::atomic<size_t> write_ptr_{0};
 };
 
 /** Utility Ring Buffer
@@ -179,6 +283,7 @@ class RingBuffer<T, 0>
     }                                   /**< \param v Value to overwrite */
     inline T    Read() { return T(0); } /**< \return Read value */
     inline T    ImmediateRead() { return T(0); } /**< \return Read value */
+    inline T    Peek(size_t) const { return T(0); } /**< \return 0 */
     inline void Flush() {}                       /**< Flush the buffer */
     inline void ImmediateRead(T* destination, size_t num_elements)
     {
@@ -3,6 +3,8 @@
 #define DSY_WAV_FORMAT_H
 
 #include <stdint.h>
+#include <string.h>
+#include "daisy_core.h"
 
 /** @addtogroup utility
     @{
@@ -52,6 +54,90 @@ typedef struct
     uint32_t SubCHunk2Size; /**< & */
 } WAV_FormatTypeDef;
 
+/** @defgroup wav_sample_formats WAV sample formats
+ ** Conversions between floats from -1 to 1 and little-endian WAV samples,
+ ** as template arguments for code that handles several formats.
+ ** @{
+ */
+
+/** 16 bit signed integer samples */
+struct WavSampleS16
+{
+    static constexpr size_t   kBytes  = 2;
+    static constexpr uint16_t kFormat = WAVE_FORMAT_PCM;
+    static inline void        Store(float in, uint8_t *out)
+    {
+        const int16_t s = f2s16(in);
+        memcpy(out, &s, kBytes);
+    }
+    static inline float Load(const uint8_t *in)
+    {
+        int16_t s;
+        memcpy(&s, in, kBytes);
+        return s162f(s);
+    }
+};
+
+/** 24 bit signed integer samples, packed into 3 bytes */
+struct WavSampleS24
+{
+    static constexpr size_t   kBytes  = 3;
+    static constexpr uint16_t kFormat = WAVE_FORMAT_PCM;
+    static inline void        Store(float in, uint8_t *out)
+    {
+        const int32_t s = f2s24(in);
+        out[0]          = static_cast<uint8_t>(s);
+        out[1]          = static_cast<uint8_t>(s >> 8);
+        out[2]          = static_cast<uint8_t>(s >> 16);
+    }
+    static inline float Load(const uint8_t *in)
+    {
+        // Assemble in the top bytes, so the shift sign-extends.
+        const int32_t s = static_cast<int32_t>(
+                              (static_cast<uint32_t>(in[0]) << 8)
+                              | (static_cast<uint32_t>(in[1]) << 16)
+                              | (static_cast<uint32_t>(in[2]) << 24))
+                          >> 8;
+        return s242f(s);
+    }
+};
+
+/** 32 bit signed integer samples */
+struct WavSampleS32
+{
+    static constexpr size_t   kBytes  = 4;
+    static constexpr uint16_t kFormat = WAVE_FORMAT_PCM;
+    static inline void        Store(float in, uint8_t *out)
+    {
+        const int32_t s = f2s32(in);
+        memcpy(out, &s, kBytes);
+    }
+    static inline float Load(const uint8_t *in)
+    {
+        int32_t s;
+        memcpy(&s, in, kBytes);
+        return s322f(s);
+    }
+};
+
+/** 32 bit float samples, stored unchanged */
+struct WavSampleF32
+{
+    static constexpr size_t   kBytes  = 4;
+    static constexpr uint16_t kFormat = WAVE_FORMAT_IEEE_FLOAT;
+    static inline void        Store(float in, uint8_t *out)
+    {
+        memcpy(out, &in, kBytes);
+    }
+    static inline float Load(const uint8_t *in)
+    {
+        float s;
+        memcpy(&s, in, kBytes);
+        return s;
+    }
+};
+/** @} */
+
 } // namespace daisy
 
 #endif
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "hid/audio_convert.h"
+
+using namespace daisy;
+
+// The kernels are checked against the per-sample conversions in
+// daisy_core.h, which the audio callback used before.
+class hid_AudioConvert : public ::testing::Test
+{
+  protected:
+    static constexpr size_t frames_ = 37; // not a multiple of any vector width
+
+    void SetUp() override
+    {
+        srand(7);
+        for(size_t i = 0; i < 2 * frames_; i++)
+        {
+            // Words as the SAI leaves them, only the low bits are set.
+            words16_.push_back(rand() & 0xffff);
+            words24_.push_back(rand() & 0xffffff);
+            words32_.push_back(static_cast<int32_t>(rand() * 2u + (i & 1)));
+            // A few samples past full scale, to be clamped.
+            floats_.push_back(1.2f * sinf(0.37f * i));
+        }
+    }
+
+    std::vector<int32_t> words16_, words24_, words32_;
+    std::vector<float>   floats_;
+};
+
+TEST_F(hid_AudioConvert, a_toFloatMatchesPerSample)
+{
+    const float          gain = 0.5f;
+    std::vector<float>   out(2 * frames_), left(frames_), right(frames_);
+    std::vector<int32_t> in = words24_;
+
+    SaiToFloat<SaiSampleS24>(in.data(), out.data(), frames_, gain);
+    SaiDeinterleave<SaiSampleS24>(
+        in.data(), left.data(), right.data(), frames_, gain);
+    for(size_t i = 0; i < frames_; i++)
+    {
+        const float l = s242f(in[2 * i]) * gain;
+        const float r = s242f(in[2 * i + 1]) * gain;
+        EXPECT_FLOAT_EQ(out[2 * i], l);
+        EXPECT_FLOAT_EQ(out[2 * i + 1], r);
+        EXPECT_FLOAT_EQ(left[i], l);
+        EXPECT_FLOAT_EQ(right[i], r);
+    }
+
+    SaiToFloat<SaiSampleS16>(words16_.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_FLOAT_EQ(out[i], s162f(words16_[i]) * gain);
+
+    SaiToFloat<SaiSampleS32>(words32_.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_FLOAT_EQ(out[i], s322f(words32_[i]) * gain);
+}
+
+TEST_F(hid_AudioConvert, b_fromFloatMatchesPerSample)
+{
+    // Folding the gain into the scale may round differently, by at most
+    // one step.
+    const float          gain = 0.9f;
+    std::vector<int32_t> out(2 * frames_);
+    std::vector<float>   left(frames_), right(frames_);
+    for(size_t i = 0; i < frames_; i++)
+    {
+        left[i]  = floats_[2 * i];
+        right[i] = floats_[2 * i + 1];
+    }
+
+    SaiFromFloat<SaiSampleS24>(floats_.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_NEAR(out[i], f2s24(floats_[i] * gain), 1);
+
+    SaiInterleave<SaiSampleS24>(
+        left.data(), right.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_NEAR(out[i], f2s24(floats_[i] * gain), 1);
+
+    SaiFromFloat<SaiSampleS16>(floats_.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_NEAR(out[i], f2s16(floats_[i] * gain), 1);
+
+    // At 32 bits a float step is 128 or more near full scale.
+    SaiFromFloat<SaiSampleS32>(floats_.data(), out.data(), frames_, gain);
+    for(size_t i = 0; i < 2 * frames_; i++)
+        EXPECT_NEAR(out[i], f2s32(floats_[i] * gain), 256);
+}
+
+TEST_F(hid_AudioConvert, c_fullScaleIsClamped)
+{
+    const float   in[4] = {2.f, -2.f, 1.f, -1.f};
+    int32_t       out[4];
+    const int32_t max24 = f2s24(1.f);
+    const int32_t max16 = f2s16(1.f);
+
+    SaiFromFloat<SaiSampleS24>(in, out, 2, 1.f);
+    EXPECT_EQ(out[0], max24);
+    EXPECT_EQ(out[1], -max24);
+    EXPECT_EQ(out[2], max24);
+    EXPECT_EQ(out[3], -max24);
+
+    SaiFromFloat<SaiSampleS16>(in, out, 2, 1.f);
+    EXPECT_EQ(out[0], max16);
+    EXPECT_EQ(out[1], -max16);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "ui/FullScreenItemMenu.h"
+#include "util/MappedValue.h"
+
+using namespace daisy;
+
+namespace
+{
+/** Keeps the pixels drawn by the menu, so that two drawings can be
+ *  compared. */
+class MenuTestDisplay : public OneBitGraphicsDisplayImpl<MenuTestDisplay>
+{
+  public:
+    uint16_t Height() const override { return 64; }
+    uint16_t Width() const override { return 128; }
+
+    void Fill(bool on) override { memset(pixels_, on, sizeof(pixels_)); }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) override
+    {
+        if(x < 128 && y < 64)
+            pixels_[x][y] = on;
+    }
+
+    void Update() override {}
+
+    bool pixels_[128][64];
+};
+
+/** A value written by a user, that doesn't count its changes. */
+class UncountedValue : public MappedValue
+{
+  public:
+    void AppentToString(FixedCapStrBase<char>& string) const override
+    {
+        string.AppendInt(value_);
+    }
+    void  ResetToDefault() override { value_ = 0; }
+    float GetAs0to1() const override { return value_ / 100.0f; }
+    void  SetFrom0to1(float normalizedValue0to1) override
+    {
+        value_ = int(normalizedValue0to1 * 100.0f);
+    }
+    void Step(int16_t numStepsUp, bool) override { value_ += numStepsUp; }
+
+    int value_ = 0;
+};
+} // namespace
+
+TEST(ui_FullScreenItemMenu, a_valueWithoutChangeCount)
+{
+    // draws a value item of a MappedValue that doesn't count its changes,
+    // and changes the value from outside the menu.
+
+    constexpr uint8_t  canvasId = 0;
+    MenuTestDisplay    display;
+    UiCanvasDescriptor canvas{};
+    canvas.id_     = canvasId;
+    canvas.handle_ = &display;
+
+    UncountedValue value;
+    value.value_ = 12;
+
+    AbstractMenu::ItemConfig item;
+    item.type                            = AbstractMenu::ItemType::valueItem;
+    item.text                            = "value";
+    item.asMappedValueItem.valueToModify = &value;
+
+    FullScreenItemMenu menu;
+    menu.Init(&item, 1);
+    menu.SetOneBitGraphicsDisplayToDrawTo(canvasId);
+
+    EXPECT_FALSE(value.CountsChanges());
+    EXPECT_EQ(value.GetChangeCount(), 0u);
+
+    display.Fill(false);
+    menu.Draw(canvas);
+    bool before[128][64];
+    memcpy(before, display.pixels_, sizeof(before));
+
+    // the menu can't tell if the value changed, so it must ask for a redraw
+    value.value_ = 34;
+    EXPECT_TRUE(menu.NeedsRedraw(canvas));
+
+    // ... and show the new value, not the string it formatted before
+    display.Fill(false);
+    menu.Draw(canvas);
+    EXPECT_NE(memcmp(before, display.pixels_, sizeof(before)), 0);
+
+    // back to the old value draws the old string again
+    value.value_ = 12;
+    display.Fill(false);
+    menu.Draw(canvas);
+    EXPECT_EQ(memcmp(before, display.pixels_, sizeof(before)), 0);
+}
+
+TEST(ui_FullScreenItemMenu, b_valueWithChangeCount)
+{
+    // the values of libDaisy count their changes, so the menu doesn't
+    // ask for a redraw on every update. A change invalidates it instead.
+
+    UiCanvasDescriptor canvas{};
+    MappedIntValue     value(0, 100, 12, 1, 10);
+    EXPECT_TRUE(value.CountsChanges());
+
+    AbstractMenu::ItemConfig item;
+    item.type                            = AbstractMenu::ItemType::valueItem;
+    item.text                            = "value";
+    item.asMappedValueItem.valueToModify = &value;
+
+    FullScreenItemMenu menu;
+    menu.Init(&item, 1);
+
+    EXPECT_FALSE(menu.NeedsRedraw(canvas));
+    value.Set(34);
+    EXPECT_FALSE(menu.NeedsRedraw(canvas));
+}
@@ -495,4 +495,38 @@ TEST(util_MappedStringListValue, e_stepUpDown)
     val = 4;
     val.Step(-100, false);
     EXPECT_EQ(val, 0);
-}
\ No newline at end of file
+}
+TEST(util_MappedValue, a_changeCount)
+{
+    // The change count goes up when the value changes, and
+    // only then.
+
+    MappedFloatValue floatVal(-1.0f, 1.0f, 0.0f);
+    EXPECT_EQ(floatVal.GetChangeCount(), 0u);
+    floatVal = 0.5f;
+    EXPECT_EQ(floatVal.GetChangeCount(), 1u);
+    floatVal = 0.5f;
+    EXPECT_EQ(floatVal.GetChangeCount(), 1u);
+    floatVal = 2.0f; // clamped to 1.0f
+    floatVal = 3.0f; // clamped to 1.0f, no change
+    EXPECT_EQ(floatVal.GetChangeCount(), 2u);
+    floatVal.Step(1, false); // already at max
+    EXPECT_EQ(floatVal.GetChangeCount(), 2u);
+    floatVal.ResetToDefault();
+    EXPECT_EQ(floatVal.GetChangeCount(), 3u);
+
+    MappedIntValue intVal(0, 10, 5, 1, 5);
+    intVal.Step(1, false);
+    intVal.SetFrom0to1(0.6f);
+    EXPECT_EQ(intVal.GetChangeCount(), 1u);
+    intVal.Step(-1, true);
+    EXPECT_EQ(intVal.GetChangeCount(), 2u);
+
+    const char*           items[] = {"A", "B", "C"};
+    MappedStringListValue listVal(items, 3, 0);
+    listVal.Step(-1, false);
+    EXPECT_EQ(listVal.GetChangeCount(), 0u);
+    listVal.Step(1, true);
+    listVal = 2;
+    EXPECT_EQ(listVal.GetChangeCount(), 1u);
+}
@@ -1,4 +1,8 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
 #include "hid/midi.h"
 #include "sys/system.h"
 
@@ -13,14 +17,29 @@ class MidiTestTransport
     MidiTestTransport() {}
     ~MidiTestTransport() {}
 
+    typedef void (*MidiRxParseCallback)(uint8_t* data,
+                                        size_t   size,
+                                        void*    context);
+
     struct Config
     {
     };
 
     void Init(Config conf) { UNUSED(conf); }
 
+    // hands the bytes to the handler, like a DMA callback
+    static void Receive(uint8_t* data, size_t size)
+    {
+        callback_(data, size, context_);
+    }
+
+    void StartRx(MidiRxParseCallback callback, void* context)
+    {
+        callback_ = callback;
+        context_  = context;
+    }
+
     //stubs to make the handler happy
-    void   StartRx(){};
     size_t Readable() { return 1; }
     void   FlushRx() {}
     void   Tx(uint8_t* buff, size_t size)
@@ -31,8 +50,14 @@ class MidiTestTransport
     uint8_t Rx() { return 1; }
     bool    RxActive() { return true; }
 
+    static constexpr uint32_t kRxByteTimeUs = 320;
+
   private:
+    static MidiRxParseCallback callback_;
+    static void*               context_;
 };
+MidiTestTransport::MidiRxParseCallback MidiTestTransport::callback_ = nullptr;
+void*                                  MidiTestTransport::context_  = nullptr;
 
 class MidiTest : public ::testing::Test
 {
@@ -781,4 +806,411 @@ TEST_F(MidiTest, singleByteRunningStatusTest)
     }
 
     EXPECT_FALSE(midi.HasEvents());
-}
\ No newline at end of file
+}
+// ================ Timing ================
+
+TEST_F(MidiTest, eventsAreTimestamped)
+{
+    uint8_t msgs[] = {0x90, 60, 100};
+    System::SetUsForUnitTest(1234);
+    Parse(msgs, 3);
+    TimedMidiEvent ev = midi.PopTimedEvent();
+    EXPECT_EQ(ev.event.type, NoteOn);
+    EXPECT_EQ(ev.timestamp, 1234u);
+
+    // The bytes of a received buffer came in 320us apart, the last one
+    // 320us before the callback.
+    uint8_t twoNotes[] = {0x90, 60, 100, 0x80, 60, 0};
+    midi.StartReceive();
+    System::SetUsForUnitTest(10000);
+    MidiTestTransport::Receive(twoNotes, 6);
+    EXPECT_EQ(midi.PopTimedEvent().timestamp, 10000u - 4 * 320);
+    EXPECT_EQ(midi.PopTimedEvent().timestamp, 10000u - 320);
+    EXPECT_FALSE(midi.HasEvents());
+}
+
+TEST_F(MidiTest, lastReceivedByteIsStampedAByteBeforeTheCallback)
+{
+    // The UART calls back once the line was idle for a byte's time, so
+    // an event that ends the buffer is stamped that long before the
+    // callback, whatever the length of the buffer.
+    midi.StartReceive();
+    uint8_t clock[] = {0xf8};
+    System::SetUsForUnitTest(5000);
+    MidiTestTransport::Receive(clock, 1);
+    EXPECT_EQ(midi.PopTimedEvent().timestamp,
+              5000u - MidiTestTransport::kRxByteTimeUs);
+
+    uint8_t note[] = {0x90, 60, 100};
+    System::SetUsForUnitTest(6000);
+    MidiTestTransport::Receive(note, 3);
+    EXPECT_EQ(midi.PopTimedEvent().timestamp,
+              6000u - MidiTestTransport::kRxByteTimeUs);
+
+    // A message split over two callbacks gets the time of its last byte.
+    System::SetUsForUnitTest(7000);
+    MidiTestTransport::Receive(note, 2);
+    EXPECT_FALSE(midi.HasEvents());
+    System::SetUsForUnitTest(7640);
+    MidiTestTransport::Receive(note + 2, 1);
+    EXPECT_EQ(midi.PopTimedEvent().timestamp,
+              7640u - MidiTestTransport::kRxByteTimeUs);
+    EXPECT_FALSE(midi.HasEvents());
+}
+
+TEST_F(MidiTest, processEventsGivesSampleOffsets)
+{
+    // Blocks of 48 samples every millisecond
+    struct Played
+    {
+        uint8_t note;
+        size_t  offset;
+    };
+    std::vector<Played> played;
+    auto on_event = [&](const MidiEvent& e, size_t offset) {
+        played.push_back({e.data[0], offset});
+    };
+
+    System::SetUsForUnitTest(0);
+    midi.ProcessEvents(48, on_event);
+    EXPECT_TRUE(played.empty());
+
+    for(uint32_t us : {250u, 500u, 999u, 1000u})
+    {
+        uint8_t msgs[] = {0x90, static_cast<uint8_t>(us / 10), 100};
+        System::SetUsForUnitTest(us);
+        Parse(msgs, 3);
+    }
+
+    // The last event arrived after the block started, so it waits.
+    midi.ProcessEvents(48, on_event);
+    ASSERT_EQ(played.size(), 3u);
+    EXPECT_EQ(played[0].note, 25);
+    EXPECT_EQ(played[0].offset, 12u);
+    EXPECT_EQ(played[1].offset, 24u);
+    EXPECT_EQ(played[2].offset, 47u);
+
+    System::SetUsForUnitTest(2000);
+    midi.ProcessEvents(48, on_event);
+    ASSERT_EQ(played.size(), 4u);
+    EXPECT_EQ(played[3].note, 100);
+    EXPECT_EQ(played[3].offset, 0u);
+    EXPECT_FALSE(midi.HasEvents());
+}
+
+TEST_F(MidiTest, fullQueueDropsEvents)
+{
+    uint8_t msgs[] = {0x90, 60, 100};
+    for(int i = 0; i < 300; i++)
+        Parse(msgs, 3);
+    EXPECT_EQ(midi.GetDroppedEvents(), 300u - 256u);
+
+    int count = 0;
+    while(midi.HasEvents())
+    {
+        EXPECT_EQ(midi.PopEvent().type, NoteOn);
+        count++;
+    }
+    EXPECT_EQ(count, 256);
+
+    // Running status carries on after the drops
+    uint8_t data[] = {61, 100};
+    Parse(data, 2);
+    EXPECT_EQ(midi.PopEvent().data[0], 61);
+}
+
+// ================ Buffer Parsing ================
+
+/** Parses generated streams of valid messages with real time bytes mixed in
+ *  anywhere, and checks the events against the ones the stream was made from.
+ */
+class MidiParserTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override { parser_.Init(); }
+
+    /** Adds a random message, and the event it should give */
+    void AddMessage(bool mpe)
+    {
+        const int kind = mpe ? 0 : Random(10);
+        if(kind < 7)
+            AddChannelMessage(mpe);
+        else if(kind < 9)
+            AddSystemCommon();
+        else
+            AddSysEx();
+    }
+
+    void AddChannelMessage(bool mpe)
+    {
+        // MPE: a note per channel, each with its own bend and pressure
+        static const uint8_t kMpeTypes[] = {0x90, 0x90, 0xE0, 0xD0, 0xB0, 0x80};
+        const uint8_t        type        = mpe ? kMpeTypes[Random(6)]
+                                               : 0x80 + 0x10 * Random(7);
+        const uint8_t status = type | (mpe ? 1 + Random(15) : Random(16));
+
+        MidiEvent expected = {};
+        expected.type      = static_cast<MidiMessageType>((type >> 4) & 7);
+        expected.channel   = status & 0x0F;
+        expected.data[0]   = Random(128);
+        const bool two     = type != 0xC0 && type != 0xD0;
+        expected.data[1]   = two ? Random(128) : 0;
+        if(type == 0x90 && expected.data[1] == 0)
+            expected.type = NoteOff;
+        if(type == 0xB0 && expected.data[0] > 119)
+        {
+            expected.type    = ChannelMode;
+            expected.cm_type = static_cast<ChannelModeType>(expected.data[0]
+                                                            - 120);
+        }
+
+        std::vector<uint8_t> bytes;
+        if(status != running_status_ || Random(4) == 0)
+            bytes.push_back(status);
+        bytes.push_back(expected.data[0]);
+        if(two)
+            bytes.push_back(expected.data[1]);
+        running_status_ = status;
+        AddBytes(bytes, expected);
+    }
+
+    void AddSystemCommon()
+    {
+        static const uint8_t kStatus[] = {0xF1, 0xF2, 0xF3, 0xF6};
+        static const uint8_t kLength[] = {1, 2, 1, 0};
+        const int            idx       = Random(4);
+
+        MidiEvent expected = {};
+        expected.type      = SystemCommon;
+        expected.sc_type   = static_cast<SystemCommonType>(kStatus[idx] & 7);
+        std::vector<uint8_t> bytes = {kStatus[idx]};
+        for(int i = 0; i < kLength[idx]; i++)
+        {
+            expected.data[i] = Random(128);
+            bytes.push_back(expected.data[i]);
+        }
+        running_status_ = 0; // cancelled
+        AddBytes(bytes, expected);
+    }
+
+    void AddSysEx()
+    {
+        MidiEvent expected         = {};
+        expected.type              = SystemCommon;
+        expected.sc_type           = SystemExclusive;
+        const int            len   = Random(160);
+        std::vector<uint8_t> bytes = {0xF0};
+        for(int i = 0; i < len; i++)
+        {
+            bytes.push_back(Random(128));
+            if(i < SYSEX_BUFFER_LEN)
+                expected.sysex_data[i] = bytes.back();
+        }
+        bytes.push_back(0xF7);
+        expected.sysex_message_len = std::min(len, SYSEX_BUFFER_LEN);
+        running_status_            = 0;
+        AddBytes(bytes, expected);
+    }
+
+    /** Adds the bytes with clock and other real time bytes in between */
+    void AddBytes(const std::vector<uint8_t>& bytes, const MidiEvent& event)
+    {
+        for(uint8_t byte : bytes)
+        {
+            if(Random(100) < realtime_percent_)
+            {
+                const uint8_t rt = Random(3) == 0 ? 0xF8 + Random(8) : 0xF8;
+                stream_.push_back(rt);
+                MidiEvent clock = {};
+                clock.type      = SystemRealTime;
+                clock.srt_type  = static_cast<SystemRealTimeType>(rt & 7);
+                expected_.push_back(clock);
+            }
+            stream_.push_back(byte);
+        }
+        expected_.push_back(event);
+    }
+
+    int Random(int n)
+    {
+        return std::uniform_int_distribution<int>(0, n - 1)(rng_);
+    }
+
+    static void ExpectSame(const MidiEvent& a, const MidiEvent& b, size_t idx)
+    {
+        ASSERT_EQ(a.type, b.type) << "event " << idx;
+        switch(a.type)
+        {
+            case SystemRealTime:
+                EXPECT_EQ(a.srt_type, b.srt_type) << "event " << idx;
+                break;
+            case SystemCommon:
+                ASSERT_EQ(a.sc_type, b.sc_type) << "event " << idx;
+                if(a.sc_type == SystemExclusive)
+                {
+                    ASSERT_EQ(a.sysex_message_len, b.sysex_message_len);
+                    EXPECT_EQ(0,
+                              memcmp(a.sysex_data,
+                                     b.sysex_data,
+                                     a.sysex_message_len))
+                        << "event " << idx;
+                }
+                else
+                {
+                    EXPECT_EQ(a.data[0], b.data[0]) << "event " << idx;
+                    EXPECT_EQ(a.data[1], b.data[1]) << "event " << idx;
+                }
+                break;
+            default:
+                EXPECT_EQ(a.channel, b.channel) << "event " << idx;
+                EXPECT_EQ(a.data[0], b.data[0]) << "event " << idx;
+                EXPECT_EQ(a.data[1], b.data[1]) << "event " << idx;
+                if(a.type == ChannelMode)
+                {
+                    EXPECT_EQ(a.cm_type, b.cm_type) << "event " << idx;
+                }
+                break;
+        }
+    }
+
+    void ExpectEvents(const std::vector<MidiEvent>& events)
+    {
+        ASSERT_EQ(events.size(), expected_.size());
+        for(size_t i = 0; i < events.size(); i++)
+            ExpectSame(events[i], expected_[i], i);
+    }
+
+    /** Parses the stream in chunks of random size, into event buffers of
+     *  random size */
+    std::vector<MidiEvent> ParseInChunks()
+    {
+        std::vector<MidiEvent> events;
+        MidiEvent              buffer[8];
+        size_t                 pos = 0;
+        while(pos < stream_.size())
+        {
+            const size_t chunk
+                = std::min<size_t>(1 + Random(300), stream_.size() - pos);
+            size_t done = 0;
+            while(done < chunk)
+            {
+                size_t       parsed;
+                const size_t n = parser_.ParseBuffer(&stream_[pos + done],
+                                                     chunk - done,
+                                                     buffer,
+                                                     1 + Random(8),
+                                                     &parsed);
+                events.insert(events.end(), buffer, buffer + n);
+                done += parsed;
+            }
+            pos += chunk;
+        }
+        return events;
+    }
+
+    MidiParser             parser_;
+    std::mt19937           rng_{1234};
+    std::vector<uint8_t>   stream_;
+    std::vector<MidiEvent> expected_;
+    uint8_t                running_status_   = 0;
+    int                    realtime_percent_ = 5;
+};
+
+TEST_F(MidiParserTest, realTimeInsideMessages)
+{
+    // clock in the middle of a note, and of a SysEx message
+    const uint8_t bytes[] = {0x90, 0x40, 0xF8, 0x64, 0x41, 0xFA, 0x00,
+                             0xF0, 0x01, 0x02, 0xFC, 0x03, 0xF7};
+    MidiEvent     events[8];
+    ASSERT_EQ(parser_.ParseBuffer(bytes, sizeof(bytes), events, 8), 6u);
+    EXPECT_EQ(events[0].srt_type, TimingClock);
+    EXPECT_EQ(events[1].type, NoteOn);
+    EXPECT_EQ(events[1].data[1], 0x64);
+    EXPECT_EQ(events[2].srt_type, Start);
+    EXPECT_EQ(events[3].type, NoteOff); // running status, velocity 0
+    EXPECT_EQ(events[4].srt_type, Stop);
+    EXPECT_EQ(events[5].sc_type, SystemExclusive);
+    EXPECT_EQ(events[5].sysex_message_len, 3);
+    EXPECT_EQ(events[5].sysex_data[2], 0x03);
+}
+
+TEST_F(MidiParserTest, stopsWhenEventsAreFull)
+{
+    const uint8_t bytes[] = {0x90, 60, 100, 61, 100, 62, 100, 0xF8};
+    MidiEvent     events[2];
+    size_t        parsed;
+    ASSERT_EQ(parser_.ParseBuffer(bytes, sizeof(bytes), events, 2, &parsed),
+              2u);
+    EXPECT_EQ(parsed, 5u);
+    EXPECT_EQ(events[1].data[0], 61);
+
+    ASSERT_EQ(parser_.ParseBuffer(
+                  bytes + parsed, sizeof(bytes) - parsed, events, 2, &parsed),
+              2u);
+    EXPECT_EQ(parsed, 3u);
+    EXPECT_EQ(events[0].data[0], 62);
+    EXPECT_EQ(events[1].type, SystemRealTime);
+}
+
+TEST_F(MidiParserTest, fuzzMixedStreams)
+{
+    for(int i = 0; i < 5000; i++)
+        AddMessage(false);
+
+    // All at once
+    std::vector<MidiEvent> events(expected_.size() + 1);
+    EXPECT_EQ(parser_.ParseBuffer(
+                  stream_.data(), stream_.size(), events.data(), events.size()),
+              expected_.size());
+    events.resize(expected_.size());
+    ExpectEvents(events);
+
+    // A byte at a time
+    events.clear();
+    MidiEvent event;
+    for(uint8_t byte : stream_)
+    {
+        if(parser_.Parse(byte, &event))
+            events.push_back(event);
+    }
+    ExpectEvents(events);
+
+    // In pieces
+    ExpectEvents(ParseInChunks());
+}
+
+TEST_F(MidiParserTest, fuzzMpeWithClock)
+{
+    // Dense per-note expression on 15 channels, with lots of clock
+    realtime_percent_ = 20;
+    for(int i = 0; i < 20000; i++)
+        AddMessage(true);
+    ExpectEvents(ParseInChunks());
+}
+
+TEST_F(MidiParserTest, fuzzGarbageGivesValidEvents)
+{
+    MidiEvent events[16];
+    for(int round = 0; round < 2000; round++)
+    {
+        uint8_t bytes[64];
+        for(auto& b : bytes)
+            b = Random(256);
+        const size_t n = parser_.ParseBuffer(bytes, sizeof(bytes), events, 16);
+        for(size_t i = 0; i < n; i++)
+        {
+            const MidiEvent& e = events[i];
+            ASSERT_LT(e.type, MessageLast);
+            if(e.type == SystemCommon && e.sc_type == SystemExclusive)
+            {
+                ASSERT_LE(e.sysex_message_len, SYSEX_BUFFER_LEN);
+            }
+            else if(e.type != SystemRealTime)
+            {
+                ASSERT_LT(e.channel, 16);
+                ASSERT_LT(e.data[0], 128);
+                ASSERT_LT(e.data[1], 128);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "hid/disp/oled_display.h"
+#include "hid/disp/paged_framebuffer.h"
+
+using namespace daisy;
+
+// Draws every pixel by itself, through the default FillRect() and
+// DrawGlyph() of OneBitGraphicsDisplayImpl.
+class PixelDisplay : public OneBitGraphicsDisplayImpl<PixelDisplay>
+{
+  public:
+    uint16_t Height() const override { return 64; }
+    uint16_t Width() const override { return 128; }
+
+    void Fill(bool on) override
+    {
+        for(auto& column : pixels_)
+            for(auto& pixel : column)
+                pixel = on;
+    }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) override
+    {
+        if(x < 128 && y < 64)
+            pixels_[x][y] = on;
+    }
+
+    void Update() override {}
+
+    bool GetPixel(uint_fast8_t x, uint_fast8_t y) const
+    {
+        return pixels_[x][y];
+    }
+
+  private:
+    bool pixels_[128][64];
+};
+
+using FrameBufferDisplay = OledDisplay<FrameBufferDriver<128, 64>>;
+
+class hid_OledDisplay : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        display_.Init(FrameBufferDisplay::Config());
+        display_.Fill(false);
+        reference_.Fill(false);
+    }
+
+    /** Draws the same to both displays */
+    template <typename DrawFunction>
+    void Draw(DrawFunction&& draw)
+    {
+        draw(display_);
+        draw(reference_);
+    }
+
+    void ExpectSameAsReference()
+    {
+        for(uint_fast8_t x = 0; x < 128; x++)
+            for(uint_fast8_t y = 0; y < 64; y++)
+                ASSERT_EQ(display_.GetDriver().GetPixel(x, y),
+                          reference_.GetPixel(x, y))
+                    << "at " << int(x) << ", " << int(y);
+    }
+
+    FrameBufferDisplay display_;
+    PixelDisplay       reference_;
+};
+
+TEST_F(hid_OledDisplay, a_rectsMatchPixels)
+{
+    srand(3);
+    for(int i = 0; i < 200; i++)
+    {
+        const uint_fast8_t x1   = rand() % 128;
+        const uint_fast8_t y1   = rand() % 64;
+        const uint_fast8_t x2   = rand() % 128;
+        const uint_fast8_t y2   = rand() % 64;
+        const bool         on   = rand() & 1;
+        const bool         fill = rand() & 1;
+        Draw([&](OneBitGraphicsDisplay& d) {
+            d.DrawRect(x1, y1, x2, y2, on, fill);
+        });
+    }
+    ExpectSameAsReference();
+}
+
+TEST_F(hid_OledDisplay, b_linesMatchPixels)
+{
+    srand(5);
+    for(int i = 0; i < 200; i++)
+    {
+        const uint_fast8_t x1 = rand() % 128;
+        const uint_fast8_t y1 = rand() % 64;
+        // Mostly straight lines, which are drawn as rectangles
+        const uint_fast8_t x2 = (i % 3 == 0) ? x1 : rand() % 128;
+        const uint_fast8_t y2 = (i % 3 == 1) ? y1 : rand() % 64;
+        const bool         on = i % 4 != 0;
+        Draw([&](OneBitGraphicsDisplay& d) { d.DrawLine(x1, y1, x2, y2, on); });
+    }
+    ExpectSameAsReference();
+}
+
+TEST_F(hid_OledDisplay, c_charsMatchPixels)
+{
+    // Text across page boundaries, over a pattern so the cleared pixels of
+    // the glyphs show
+    Draw([](OneBitGraphicsDisplay& d) { d.Fill(true); });
+    Draw([](OneBitGraphicsDisplay& d) {
+        d.DrawRect(10, 3, 100, 40, false, true);
+    });
+    const FontDef* fonts[] = {&Font_6x8, &Font_7x10, &Font_11x18, &Font_16x26};
+    uint_fast8_t   y       = 0;
+    for(const FontDef* font : fonts)
+    {
+        for(bool on : {true, false})
+        {
+            Draw([&](OneBitGraphicsDisplay& d) {
+                d.SetCursor(y % 5, y);
+                d.WriteString("Daisy 0123", *font, on);
+            });
+            y = (y + font->FontHeight / 2 + 3) % 48;
+        }
+    }
+    // Up against the right edge
+    Draw([](OneBitGraphicsDisplay& d) {
+        d.SetCursor(120, 50);
+        d.WriteChar('W', Font_7x10, true);
+    });
+    ExpectSameAsReference();
+}
+
+TEST_F(hid_OledDisplay, d_updateSendsChangedColumns)
+{
+    auto& driver = display_.GetDriver();
+
+    // Everything is sent the first time
+    display_.Update();
+    EXPECT_EQ(driver.GetBytesSent(), 128u * 8u);
+
+    // Redrawing the same frame sends nothing
+    display_.Fill(false);
+    display_.Update();
+    EXPECT_EQ(driver.GetBytesSent(), 128u * 8u);
+
+    // A rect from column 20 to 29, over pages 1 and 2
+    display_.DrawRect(20, 12, 29, 20, true, true);
+    display_.Update();
+    EXPECT_EQ(driver.GetBytesSent(), 128u * 8u + 2u * 10u);
+
+    // Moving it a column sends the run from the first to the last column
+    // that changed, on each page
+    display_.Fill(false);
+    display_.DrawRect(21, 12, 30, 20, true, true);
+    display_.Update();
+    EXPECT_EQ(driver.GetBytesSent(), 128u * 8u + 2u * 10u + 2u * 11u);
+
+    for(uint_fast8_t x = 0; x < 128; x++)
+        for(uint_fast8_t y = 0; y < 64; y++)
+            ASSERT_EQ(driver.GetScreenPixel(x, y), driver.GetPixel(x, y));
+}
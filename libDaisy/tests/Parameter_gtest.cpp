@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "hid/parameter.h"
+
+using namespace daisy;
+
+class hid_Parameter : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        adc_ = 0;
+        // No slew, so the control follows the ADC at once
+        AnalogControl ctrl;
+        ctrl.Init(&adc_, 1000.f);
+        ctrl.SetCoeff(1.f);
+        param_.Init(ctrl, 100.f, 200.f, Parameter::LINEAR);
+    }
+
+    void SetAdc(float value) { adc_ = static_cast<uint16_t>(value * 65536.f); }
+
+    uint16_t  adc_;
+    Parameter param_;
+};
+
+TEST_F(hid_Parameter, a_firstProcessMapsTheControl)
+{
+    SetAdc(0.5f);
+    EXPECT_FLOAT_EQ(param_.Process(), 150.f);
+    EXPECT_TRUE(param_.HasChanged());
+
+    // Unchanged controls don't report a change
+    EXPECT_FLOAT_EQ(param_.Process(), 150.f);
+    EXPECT_FALSE(param_.HasChanged());
+
+    SetAdc(0.25f);
+    EXPECT_FLOAT_EQ(param_.Process(), 125.f);
+    EXPECT_TRUE(param_.HasChanged());
+}
+
+TEST_F(hid_Parameter, b_thresholdIgnoresJitter)
+{
+    param_.SetThreshold(0.01f);
+    SetAdc(0.5f);
+    param_.Process();
+    EXPECT_TRUE(param_.HasChanged());
+
+    // Jitter of less than 1% holds the value
+    for(float jitter : {0.005f, -0.008f, 0.002f})
+    {
+        SetAdc(0.5f + jitter);
+        EXPECT_FLOAT_EQ(param_.Process(), 150.f);
+        EXPECT_FALSE(param_.HasChanged());
+    }
+
+    // ... and moving the knob further is followed
+    SetAdc(0.52f);
+    EXPECT_NEAR(param_.Process(), 152.f, 0.01f);
+    EXPECT_TRUE(param_.HasChanged());
+}
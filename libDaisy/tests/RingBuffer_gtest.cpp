@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <algorithm>
+#include "util/ringbuffer.h"
+
+using namespace daisy;
+
+class util_RingBuffer : public ::testing::Test
+{
+  protected:
+    void SetUp() override { buffer_.Init(); }
+
+    static constexpr size_t      bufferSize_ = 8;
+    RingBuffer<int, bufferSize_> buffer_;
+};
+constexpr size_t util_RingBuffer::bufferSize_; // requried for C++14...
+
+TEST_F(util_RingBuffer, a_emptyAfterInit)
+{
+    EXPECT_EQ(buffer_.capacity(), bufferSize_);
+    EXPECT_TRUE(buffer_.isEmpty());
+    EXPECT_EQ(buffer_.readable(), 0u);
+    EXPECT_EQ(buffer_.writable(), bufferSize_);
+}
+
+TEST_F(util_RingBuffer, b_writeAndReadWrapsAround)
+{
+    // the whole capacity is usable
+    for(int i = 0; i < (int)bufferSize_; i++)
+        buffer_.Write(i);
+    EXPECT_EQ(buffer_.readable(), bufferSize_);
+    EXPECT_EQ(buffer_.writable(), 0u);
+
+    // keep the fill level while the positions go around several times
+    for(int i = 0; i < 3 * (int)bufferSize_; i++)
+    {
+        EXPECT_EQ(buffer_.Read(), i);
+        buffer_.Write(i + (int)bufferSize_);
+    }
+    EXPECT_EQ(buffer_.readable(), bufferSize_);
+
+    buffer_.Flush();
+    EXPECT_TRUE(buffer_.isEmpty());
+}
+
+TEST_F(util_RingBuffer, c_overwriteDiscardsOldest)
+{
+    for(int i = 0; i < (int)bufferSize_ + 3; i++)
+        buffer_.Overwrite(i);
+    EXPECT_EQ(buffer_.readable(), bufferSize_);
+    for(int i = 3; i < (int)bufferSize_ + 3; i++)
+        EXPECT_EQ(buffer_.ImmediateRead(), i);
+    EXPECT_TRUE(buffer_.isEmpty());
+}
+
+TEST_F(util_RingBuffer, d_swallowMakesRoom)
+{
+    for(int i = 0; i < (int)bufferSize_; i++)
+        buffer_.Write(i);
+    buffer_.Swallow(3);
+    EXPECT_EQ(buffer_.writable(), 3u);
+    EXPECT_EQ(buffer_.Read(), 3);
+
+    // no change when there is enough room already
+    buffer_.Swallow(2);
+    EXPECT_EQ(buffer_.writable(), 4u);
+}
+
+TEST_F(util_RingBuffer, e_bulkCopyAcrossTheEnd)
+{
+    const int in[6] = {1, 2, 3, 4, 5, 6};
+    int       out[6];
+
+    // move the positions close to the end first
+    buffer_.Overwrite(in, 5);
+    buffer_.ImmediateRead(out, 5);
+
+    buffer_.Overwrite(in, 6);
+    EXPECT_EQ(buffer_.readable(), 6u);
+    buffer_.ImmediateRead(out, 6);
+    for(int i = 0; i < 6; i++)
+        EXPECT_EQ(out[i], in[i]);
+    EXPECT_TRUE(buffer_.isEmpty());
+}
+
+TEST_F(util_RingBuffer, f_spansAreContiguous)
+{
+    // advance to position 6, so 2 elements remain before the end
+    for(int i = 0; i < 6; i++)
+        buffer_.Write(i);
+    buffer_.CommitRead(buffer_.GetReadSpan().length);
+
+    auto w = buffer_.GetWriteSpan();
+    EXPECT_EQ(w.data, buffer_.GetMutableBuffer() + 6);
+    EXPECT_EQ(w.length, 2u);
+    w.data[0] = 10;
+    w.data[1] = 11;
+    buffer_.CommitWrite(2);
+
+    // the rest of the free space starts at the beginning
+    w = buffer_.GetWriteSpan(3);
+    EXPECT_EQ(w.data, buffer_.GetMutableBuffer());
+    EXPECT_EQ(w.length, 3u);
+    for(size_t i = 0; i < w.length; i++)
+        w.data[i] = 12 + (int)i;
+    buffer_.CommitWrite(w.length);
+    EXPECT_EQ(buffer_.readable(), 5u);
+
+    auto r = buffer_.GetReadSpan();
+    ASSERT_EQ(r.length, 2u);
+    EXPECT_EQ(r.data[0], 10);
+    EXPECT_EQ(r.data[1], 11);
+    buffer_.CommitRead(r.length);
+
+    r = buffer_.GetReadSpan();
+    ASSERT_EQ(r.length, 3u);
+    EXPECT_EQ(r.data[2], 14);
+    buffer_.CommitRead(r.length);
+    EXPECT_TRUE(buffer_.isEmpty());
+}
+
+TEST_F(util_RingBuffer, g_advanceIsClamped)
+{
+    buffer_.Write(0);
+    buffer_.Advance(100);
+    EXPECT_EQ(buffer_.readable(), bufferSize_);
+    EXPECT_EQ(buffer_.writable(), 0u);
+}
+
+TEST_F(util_RingBuffer, h_peekLeavesElements)
+{
+    // past the end of the storage, so the offsets wrap
+    for(int i = 0; i < 6; i++)
+        buffer_.Write(i);
+    for(int i = 0; i < 5; i++)
+        buffer_.Read();
+    for(int i = 6; i < 10; i++)
+        buffer_.Write(i);
+    for(int i = 0; i < 5; i++)
+        EXPECT_EQ(buffer_.Peek(i), 5 + i);
+    EXPECT_EQ(buffer_.readable(), 5u);
+    EXPECT_EQ(buffer_.Read(), 5);
+}
+
+TEST(util_RingBuffer_Threads, a_elementsArriveInOrder)
+{
+    // The reader sees every element exactly once and in order,
+    // while the writer runs concurrently on another thread.
+    // Both threads yield when they can't make progress, so the test
+    // also finishes quickly on a single core.
+    static RingBuffer<uint32_t, 64> buffer;
+    buffer.Init();
+    constexpr uint32_t numElements = 1000000;
+
+    std::thread writer([]() {
+        for(uint32_t i = 0; i < numElements; i++)
+        {
+            while(buffer.writable() == 0)
+                std::this_thread::yield();
+            buffer.Write(i);
+        }
+    });
+
+    uint32_t expected = 0;
+    bool     inOrder  = true;
+    while(expected < numElements)
+    {
+        if(buffer.readable() > 0)
+            inOrder &= buffer.ImmediateRead() == expected++;
+        else
+            std::this_thread::yield();
+    }
+    writer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(buffer.isEmpty());
+}
+
+TEST(util_RingBuffer_Threads, b_spansExchangeBlocks)
+{
+    // Blocks of varying size pass through the zero-copy span functions
+    // in both threads.
+    static RingBuffer<uint32_t, 256> buffer;
+    buffer.Init();
+    constexpr uint32_t numElements = 2000000;
+
+    std::thread writer([]() {
+        uint32_t next      = 0;
+        uint32_t blockSize = 1;
+        while(next < numElements)
+        {
+            auto span = buffer.GetWriteSpan(
+                std::min<uint32_t>(blockSize, numElements - next));
+            for(size_t i = 0; i < span.length; i++)
+                span.data[i] = next++;
+            buffer.CommitWrite(span.length);
+            if(span.length == 0)
+                std::this_thread::yield();
+            blockSize = blockSize % 97 + 1;
+        }
+    });
+
+    uint32_t expected  = 0;
+    uint32_t errors    = 0;
+    uint32_t blockSize = 1;
+    while(expected < numElements)
+    {
+        auto span = buffer.GetReadSpan(blockSize);
+        for(size_t i = 0; i < span.length; i++)
+            errors += span.data[i] != expected++;
+        buffer.CommitRead(span.length);
+        if(span.length == 0)
+            std::this_thread::yield();
+        blockSize = blockSize % 61 + 1;
+    }
+    writer.join();
+
+    EXPECT_EQ(errors, 0u);
+    EXPECT_TRUE(buffer.isEmpty());
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "ui/UI.h"
+#include "ui/FullScreenItemMenu.h"
+#include "hid/disp/oled_display.h"
+#include "hid/disp/paged_framebuffer.h"
+#include "sys/system.h"
+
+using namespace daisy;
+
+namespace
+{
+using FrameBufferDisplay = OledDisplay<FrameBufferDriver<128, 64>>;
+
+/** The canvas handle: a display that counts how often it's flushed */
+struct CountingCanvas
+{
+    FrameBufferDisplay display;
+    int                numFlushes = 0;
+
+    static void Clear(const UiCanvasDescriptor& canvas)
+    {
+        ((CountingCanvas*)canvas.handle_)->display.Fill(false);
+    }
+    static void Flush(const UiCanvasDescriptor& canvas)
+    {
+        auto& self = *((CountingCanvas*)canvas.handle_);
+        self.display.Update();
+        self.numFlushes++;
+    }
+};
+
+/** A page that counts its Draw() calls and only changes when invalidated */
+class CountingPage : public UiPage
+{
+  public:
+    explicit CountingPage(bool usesInvalidation)
+    : usesInvalidation_(usesInvalidation)
+    {
+    }
+
+    bool NeedsRedraw(const UiCanvasDescriptor&) override
+    {
+        return !usesInvalidation_;
+    }
+
+    void Draw(const UiCanvasDescriptor&) override { numDraws_++; }
+
+    int numDraws_ = 0;
+
+  private:
+    bool usesInvalidation_;
+};
+
+/** A value that counts how often it's formatted */
+class CountingIntValue : public MappedIntValue
+{
+  public:
+    CountingIntValue() : MappedIntValue(0, 100, 50, 1, 10, "%") {}
+
+    void AppentToString(FixedCapStrBase<char>& string) const override
+    {
+        numFormats_++;
+        MappedIntValue::AppentToString(string);
+    }
+
+    mutable int numFormats_ = 0;
+};
+
+class TestMenu : public FullScreenItemMenu
+{
+  public:
+    void Init()
+    {
+        items_[0].type                            = ItemType::valueItem;
+        items_[0].text                            = "Level";
+        items_[0].asMappedValueItem.valueToModify = &value_;
+        items_[1].type                            = ItemType::checkboxItem;
+        items_[1].text                            = "Mute";
+        items_[1].asCheckboxItem.valueToModify    = &checkbox_;
+        FullScreenItemMenu::Init(items_, 2);
+    }
+
+    void Draw(const UiCanvasDescriptor& canvas) override
+    {
+        numDraws_++;
+        FullScreenItemMenu::Draw(canvas);
+    }
+
+    CountingIntValue value_;
+    bool             checkbox_ = false;
+    int              numDraws_ = 0;
+
+  private:
+    ItemConfig items_[2];
+};
+} // namespace
+
+class ui_UI : public ::testing::Test
+{
+  protected:
+    static constexpr uint16_t menuEncoderId_  = 0;
+    static constexpr uint16_t valueEncoderId_ = 1;
+    static constexpr uint32_t updateRateMs_   = 20;
+
+    void SetUp() override
+    {
+        System::SetUsForUnitTest(0);
+        canvas_.display.Init(FrameBufferDisplay::Config());
+
+        UiCanvasDescriptor descriptor;
+        descriptor.id_            = 0;
+        descriptor.handle_        = &canvas_;
+        descriptor.updateRateMs_  = updateRateMs_;
+        descriptor.clearFunction_ = &CountingCanvas::Clear;
+        descriptor.flushFunction_ = &CountingCanvas::Flush;
+
+        UI::SpecialControlIds ids;
+        ids.menuEncoderId  = menuEncoderId_;
+        ids.valueEncoderId = valueEncoderId_;
+        ui_.Init(events_, ids, {descriptor}, 0);
+    }
+
+    /** Calls UI::Process() every millisecond, like a main loop, and turns
+     *  the value encoder every inputIntervalMs, if it's nonzero. */
+    void Run(uint32_t durationMs, uint32_t inputIntervalMs = 0)
+    {
+        for(uint32_t ms = 0; ms < durationMs; ms++)
+        {
+            nowMs_++;
+            System::SetUsForUnitTest(nowMs_ * 1000);
+            if(inputIntervalMs > 0 && ms % inputIntervalMs == 0)
+                events_.AddEncoderTurned(valueEncoderId_, 1, 24);
+            ui_.Process();
+        }
+    }
+
+    UiEventQueue   events_;
+    UI             ui_;
+    CountingCanvas canvas_;
+    uint32_t       nowMs_ = 0;
+};
+
+TEST_F(ui_UI, a_idlePagesAreNotRedrawn)
+{
+    CountingPage page(true);
+    ui_.OpenPage(page);
+
+    // Drawn once after being opened, then never while idle
+    Run(1000);
+    EXPECT_EQ(page.numDraws_, 1);
+    EXPECT_EQ(canvas_.numFlushes, 1);
+
+    // Drawn once more after invalidating itself
+    page.Invalidate();
+    Run(1000);
+    EXPECT_EQ(page.numDraws_, 2);
+    EXPECT_EQ(canvas_.numFlushes, 2);
+
+    ui_.ClosePage(page);
+}
+
+TEST_F(ui_UI, b_otherPagesAreRedrawnAtTheUpdateRate)
+{
+    CountingPage page(false);
+    ui_.OpenPage(page);
+
+    // A redraw every updateRateMs_ + 1 ms
+    Run(1000);
+    EXPECT_EQ(page.numDraws_, 1000 / int(updateRateMs_ + 1));
+
+    ui_.ClosePage(page);
+}
+
+TEST_F(ui_UI, c_menuDrawCallsPerSecond)
+{
+    TestMenu menu;
+    menu.Init();
+    ui_.OpenPage(menu);
+    Run(100);
+    const int    drawsAfterOpening = menu.numDraws_;
+    const size_t bytesAfterOpening
+        = canvas_.display.GetDriver().GetBytesSent();
+    EXPECT_EQ(drawsAfterOpening, 1);
+
+    // Idle: nothing is drawn or sent
+    Run(1000);
+    EXPECT_EQ(menu.numDraws_, drawsAfterOpening);
+    EXPECT_EQ(canvas_.display.GetDriver().GetBytesSent(), bytesAfterOpening);
+
+    // Turning the value encoder every 10 ms: redrawn at the update rate,
+    // but no faster
+    Run(1000, 10);
+    const int activeDraws = menu.numDraws_ - drawsAfterOpening;
+    EXPECT_GE(activeDraws, 1000 / int(updateRateMs_ + 1) - 1);
+    EXPECT_LE(activeDraws, 1000 / int(updateRateMs_ + 1) + 1);
+    EXPECT_EQ(menu.value_.Get(), 100); // 50 + 100 steps, clamped
+
+    // Idle again, once the last change was drawn
+    Run(100);
+    const int drawsAfterInput = menu.numDraws_;
+    Run(1000);
+    EXPECT_EQ(menu.numDraws_, drawsAfterInput);
+
+    ui_.ClosePage(menu);
+}
+
+TEST_F(ui_UI, d_externalChangesRedrawTheMenu)
+{
+    TestMenu menu;
+    menu.Init();
+    ui_.OpenPage(menu);
+    Run(100);
+    EXPECT_EQ(menu.numDraws_, 1);
+
+    // A value that's changed elsewhere, e.g. by MIDI
+    menu.value_.Set(10);
+    Run(100);
+    EXPECT_EQ(menu.numDraws_, 2);
+
+    // Setting the same value again changes nothing
+    menu.value_.Set(10);
+    Run(100);
+    EXPECT_EQ(menu.numDraws_, 2);
+
+    menu.checkbox_ = true;
+    Run(100);
+    EXPECT_EQ(menu.numDraws_, 3);
+
+    ui_.ClosePage(menu);
+}
+
+TEST_F(ui_UI, e_valueStringIsOnlyFormattedOnChange)
+{
+    TestMenu menu;
+    menu.Init();
+    ui_.OpenPage(menu);
+    Run(100);
+    EXPECT_EQ(menu.value_.numFormats_, 1);
+
+    // The menu encoder can't select past the first item here, but still
+    // makes the menu redraw. The value didn't change, so it isn't
+    // formatted again.
+    for(int i = 0; i < 5; i++)
+    {
+        events_.AddEncoderTurned(menuEncoderId_, -1, 24);
+        Run(100);
+    }
+    EXPECT_EQ(menu.numDraws_, 6);
+    EXPECT_EQ(menu.value_.numFormats_, 1);
+
+    events_.AddEncoderTurned(valueEncoderId_, 1, 24);
+    Run(100);
+    EXPECT_EQ(menu.numDraws_, 7);
+    EXPECT_EQ(menu.value_.numFormats_, 2);
+
+    ui_.ClosePage(menu);
+}
@@ -0,0 +1,314 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "hid/wavsampler.h"
+#include "util/WavWriter.h"
+
+using namespace daisy;
+
+// Rings of 64 stereo or 128 mono frames, so the tests go around them often
+using SmallSampler = WavSampler<2, 64>;
+using SmallWriter  = WavWriter<64, 4>;
+
+class hid_WavSampler : public ::testing::Test
+{
+  protected:
+    static constexpr size_t blockSize_ = 16;
+
+    void SetUp() override { sampler_.Init(48000.f); }
+
+    void TearDown() override
+    {
+        sampler_.Init(48000.f); // closes the files
+        for(const auto& path : paths_)
+            remove(path.c_str());
+    }
+
+    /** Writes interleaved samples to a new file
+    \return The path of the file
+     */
+    std::string WriteFile(const char*               name,
+                          const std::vector<float>& samples,
+                          int32_t                   channels,
+                          int32_t                   bits,
+                          bool                      floating_point = false,
+                          float                     samplerate     = 48000.f)
+    {
+        const std::string   path = ::testing::TempDir() + name;
+        SmallWriter         writer;
+        SmallWriter::Config cfg;
+        cfg.samplerate     = samplerate;
+        cfg.channels       = channels;
+        cfg.bitspersample  = bits;
+        cfg.floating_point = floating_point;
+        EXPECT_EQ(writer.Init(cfg), SmallWriter::Result::OK);
+        EXPECT_EQ(writer.OpenFile(path.c_str()), SmallWriter::Result::OK);
+        const size_t frames = samples.size() / channels;
+        for(size_t i = 0; i < frames; i += 8)
+        {
+            writer.SampleBlock(&samples[i * channels],
+                               std::min<size_t>(8, frames - i));
+            writer.Write();
+        }
+        EXPECT_EQ(writer.SaveFile(), SmallWriter::Result::OK);
+        paths_.push_back(path);
+        return path;
+    }
+
+    static std::vector<float> Sine(size_t length, float freq, float offset)
+    {
+        std::vector<float> samples;
+        for(size_t i = 0; i < length; i++)
+            samples.push_back(0.5f * sinf(freq * i) + offset);
+        return samples;
+    }
+
+    /** Renders a number of samples, calling Prepare() after every block */
+    void Render(size_t length, bool prepare = true)
+    {
+        left_.clear();
+        right_.clear();
+        float l[blockSize_], r[blockSize_];
+        for(size_t i = 0; i < length; i += blockSize_)
+        {
+            const size_t n = std::min(blockSize_, length - i);
+            sampler_.Process(l, r, n);
+            left_.insert(left_.end(), l, l + n);
+            right_.insert(right_.end(), r, r + n);
+            if(prepare)
+                sampler_.Prepare();
+        }
+    }
+
+    SmallSampler             sampler_;
+    std::vector<float>       left_, right_;
+    std::vector<std::string> paths_;
+};
+constexpr size_t hid_WavSampler::blockSize_; // requried for C++14...
+
+TEST_F(hid_WavSampler, a_unitSpeedPlaysTheSamples)
+{
+    // Longer than the ring, so it has to be refilled along the way
+    const auto samples = Sine(500, 0.03f, 0.f);
+    const auto path    = WriteFile("a.wav", samples, 1, 16);
+    const int  voice   = sampler_.Play(path.c_str());
+    ASSERT_EQ(voice, 0);
+    EXPECT_TRUE(sampler_.IsPlaying(voice));
+
+    Render(samples.size() + 40);
+    size_t mismatches = 0;
+    for(size_t i = 0; i < samples.size(); i++)
+    {
+        const float expected = s162f(f2s16(samples[i]));
+        mismatches += left_[i] != expected || right_[i] != expected;
+    }
+    EXPECT_EQ(mismatches, 0u);
+    for(size_t i = samples.size(); i < left_.size(); i++)
+        EXPECT_EQ(left_[i], 0.f);
+    EXPECT_FALSE(sampler_.IsPlaying(voice));
+    EXPECT_EQ(sampler_.GetUnderruns(), 0u);
+}
+
+TEST_F(hid_WavSampler, b_eachFormatPlaysInStereo)
+{
+    struct
+    {
+        int32_t bits;
+        bool    floating_point;
+    } formats[] = {{16, false}, {24, false}, {32, false}, {32, true}};
+
+    std::vector<float> samples;
+    const auto         l = Sine(300, 0.05f, 0.f), r = Sine(300, 0.02f, 0.3f);
+    for(size_t i = 0; i < l.size(); i++)
+    {
+        samples.push_back(l[i]);
+        samples.push_back(r[i]);
+    }
+    for(const auto& f : formats)
+    {
+        const auto path
+            = WriteFile("b.wav", samples, 2, f.bits, f.floating_point);
+        ASSERT_EQ(sampler_.Play(path.c_str()), 0);
+        Render(l.size());
+
+        size_t mismatches = 0;
+        for(size_t i = 0; i < l.size(); i++)
+        {
+            float el = l[i], er = r[i];
+            if(f.bits == 16)
+            {
+                el = s162f(f2s16(el));
+                er = s162f(f2s16(er));
+            }
+            else if(f.bits == 24)
+            {
+                el = s242f(f2s24(el));
+                er = s242f(f2s24(er));
+            }
+            else if(!f.floating_point)
+            {
+                el = s322f(f2s32(el));
+                er = s322f(f2s32(er));
+            }
+            mismatches += left_[i] != el || right_[i] != er;
+        }
+        EXPECT_EQ(mismatches, 0u) << f.bits << " bit";
+        Render(blockSize_); // ends the voice
+        sampler_.Prepare();
+    }
+}
+
+TEST_F(hid_WavSampler, c_voicesAreMixed)
+{
+    const auto a = Sine(400, 0.03f, 0.f), b = Sine(250, 0.07f, 0.2f);
+    ASSERT_EQ(sampler_.Play(WriteFile("c_a.wav", a, 1, 32, true).c_str()), 0);
+    const auto path = WriteFile("c_b.wav", b, 1, 32, true);
+    ASSERT_EQ(sampler_.Play(path.c_str(), 1.f, false, 0.5f), 1);
+    // Both voices are busy
+    EXPECT_EQ(sampler_.Play(paths_[0].c_str()), -1);
+
+    Render(a.size());
+    size_t mismatches = 0;
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        float expected = 0.f;
+        expected += a[i];
+        if(i < b.size())
+            expected += b[i] * 0.5f;
+        mismatches += left_[i] != expected;
+    }
+    EXPECT_EQ(mismatches, 0u);
+
+    // The shorter voice is free again
+    EXPECT_FALSE(sampler_.IsPlaying(1));
+    EXPECT_EQ(sampler_.Play(paths_[1].c_str()), 1);
+}
+
+TEST_F(hid_WavSampler, d_loopingUntilStopped)
+{
+    const auto samples = Sine(50, 0.2f, 0.f);
+    const auto path    = WriteFile("d.wav", samples, 1, 32, true);
+    const int  voice   = sampler_.Play(path.c_str(), 1.f, true);
+    Render(500);
+    size_t mismatches = 0;
+    for(size_t i = 0; i < left_.size(); i++)
+        mismatches += left_[i] != samples[i % samples.size()];
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_TRUE(sampler_.IsPlaying(voice));
+
+    sampler_.Stop(voice);
+    EXPECT_FALSE(sampler_.IsPlaying(voice));
+    Render(blockSize_);
+    for(float s : left_)
+        EXPECT_EQ(s, 0.f);
+    sampler_.Prepare();
+    EXPECT_EQ(sampler_.Play(paths_[0].c_str()), voice);
+}
+
+TEST_F(hid_WavSampler, e_speedAndRateInterpolate)
+{
+    // A straight line comes out of the interpolation unchanged
+    std::vector<float> ramp;
+    for(size_t i = 0; i < 200; i++)
+        ramp.push_back(i / 256.f);
+    const auto full = WriteFile("e_48k.wav", ramp, 1, 32, true, 48000.f);
+    const auto half = WriteFile("e_24k.wav", ramp, 1, 32, true, 24000.f);
+
+    // Half speed, and half the sample rate, both take two samples per frame
+    for(const auto& setup : {std::make_pair(full, 0.5f),
+                             std::make_pair(half, 1.f)})
+    {
+        ASSERT_EQ(sampler_.Play(setup.first.c_str(), setup.second), 0);
+        // up to where the trailing silence bends the line
+        Render(2 * ramp.size() - 4);
+        for(size_t i = 2; i < left_.size(); i++)
+            EXPECT_NEAR(left_[i], i / 512.f, 1e-6f) << i;
+        Render(blockSize_);
+        sampler_.Prepare();
+    }
+
+    // Speeding up on the way
+    ASSERT_EQ(sampler_.Play(full.c_str()), 0);
+    Render(32);
+    sampler_.SetSpeed(0, 2.f);
+    Render(32);
+    for(size_t i = 0; i < left_.size(); i++)
+        EXPECT_NEAR(left_[i], (32 + 2 * i) / 256.f, 1e-6f) << i;
+}
+
+TEST_F(hid_WavSampler, f_underrunsAreCounted)
+{
+    const auto samples = Sine(1000, 0.03f, 0.f);
+    const auto path    = WriteFile("f.wav", samples, 1, 16);
+    const int  voice   = sampler_.Play(path.c_str());
+
+    // Without Prepare(), the ring runs dry, and the voice goes quiet
+    Render(256, false);
+    EXPECT_GT(sampler_.GetUnderruns(), 0u);
+    EXPECT_TRUE(sampler_.IsPlaying(voice));
+    EXPECT_EQ(left_.back(), 0.f);
+
+    // ... and carries on where it stopped once it's fed again
+    sampler_.Prepare();
+    Render(blockSize_);
+    EXPECT_EQ(left_[0], s162f(f2s16(samples[125])));
+}
+
+TEST_F(hid_WavSampler, g_mostUrgentVoiceIsReadFirst)
+{
+    // Constant files, to tell the voices apart in the mix
+    const auto a = WriteFile("g_a.wav", std::vector<float>(1000, 0.25f), 1, 32,
+                             true);
+    const auto b = WriteFile("g_b.wav", std::vector<float>(1000, 0.5f), 1, 32,
+                             true);
+    ASSERT_EQ(sampler_.Play(a.c_str()), 0);
+    ASSERT_EQ(sampler_.Play(b.c_str(), 1.5f), 1);
+
+    // After 64 samples, voice 0 has 64 frames left, and voice 1 has 32
+    // frames, which last 21 samples at its speed.
+    float l[64], r[64];
+    sampler_.Process(l, r, 64);
+    EXPECT_EQ(sampler_.Prepare(1), 1u);
+
+    // Only voice 0 runs out in the next 64 samples
+    sampler_.Process(l, r, 64);
+    EXPECT_EQ(sampler_.GetUnderruns(), 1u);
+    EXPECT_EQ(l[63], 0.5f);
+}
+
+TEST_F(hid_WavSampler, h_unplayableFiles)
+{
+    EXPECT_EQ(sampler_.Play("no/such/file.wav"), -1);
+
+    // 8 bit isn't supported
+    // clang-format off
+    std::vector<uint8_t> header = {
+        'R', 'I', 'F', 'F', 40, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0,
+        1, 0,             // PCM
+        1, 0,             // channels
+        0x80, 0xbb, 0, 0, // sample rate
+        0x80, 0xbb, 0, 0, // byte rate
+        1, 0,             // block align
+        8, 0,             // bits per sample
+        'd', 'a', 't', 'a', 4, 0, 0, 0,
+        1, 2, 3, 4};
+    // clang-format on
+    const std::string path = ::testing::TempDir() + "h.wav";
+    FILE*             f    = fopen(path.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    fwrite(header.data(), 1, header.size(), f);
+    fclose(f);
+    paths_.push_back(path);
+    EXPECT_EQ(sampler_.Play(path.c_str()), -1);
+
+    // The same file as 16 bit plays
+    header[32] = 2;
+    header[34] = 16;
+    f          = fopen(path.c_str(), "wb");
+    fwrite(header.data(), 1, header.size(), f);
+    fclose(f);
+    EXPECT_EQ(sampler_.Play(path.c_str()), 0);
+}
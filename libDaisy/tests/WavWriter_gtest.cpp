@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "util/WavWriter.h"
+
+using namespace daisy;
+
+// Small transfers, so a few hundred frames go around the buffers several
+// times, and neither 24 bit samples nor frames of 3 channels divide the
+// buffer size.
+using SmallWriter = WavWriter<64, 4>;
+
+class util_WavWriter : public ::testing::Test
+{
+  protected:
+    static constexpr int32_t numChannels_ = 3;
+    static constexpr size_t  numFrames_   = 301;
+
+    void SetUp() override
+    {
+        for(size_t i = 0; i < numFrames_; i++)
+            for(int32_t c = 0; c < numChannels_; c++)
+                planar_[c].push_back(
+                    0.9f * sinf(0.05f * i * (c + 1)) + (c == 2 ? 0.5f : 0.f));
+        for(size_t i = 0; i < numFrames_; i++)
+            for(int32_t c = 0; c < numChannels_; c++)
+                interleaved_.push_back(planar_[c][i]);
+    }
+
+    std::string Path(const char* name) const
+    {
+        return ::testing::TempDir() + name;
+    }
+
+    static std::vector<uint8_t> ReadFile(const std::string& path)
+    {
+        std::vector<uint8_t> data;
+        FILE*                f = fopen(path.c_str(), "rb");
+        if(!f)
+            return data;
+        int c;
+        while((c = fgetc(f)) != EOF)
+            data.push_back(static_cast<uint8_t>(c));
+        fclose(f);
+        return data;
+    }
+
+    /** Records the test signal, calling Write() after every block */
+    void Record(SmallWriter&       writer,
+                const std::string& path,
+                int32_t            bits,
+                bool               floating_point,
+                bool               planar)
+    {
+        SmallWriter::Config cfg;
+        cfg.samplerate     = 48000.f;
+        cfg.channels       = numChannels_;
+        cfg.bitspersample  = bits;
+        cfg.floating_point = floating_point;
+        ASSERT_EQ(writer.Init(cfg), SmallWriter::Result::OK);
+        ASSERT_EQ(writer.OpenFile(path.c_str()), SmallWriter::Result::OK);
+
+        const size_t blockSize = 7;
+        for(size_t i = 0; i < numFrames_; i += blockSize)
+        {
+            const size_t n = std::min(blockSize, numFrames_ - i);
+            if(planar)
+            {
+                const float* in[numChannels_];
+                for(int32_t c = 0; c < numChannels_; c++)
+                    in[c] = &planar_[c][i];
+                writer.SampleBlock(in, n);
+            }
+            else
+            {
+                writer.SampleBlock(&interleaved_[i * numChannels_], n);
+            }
+            EXPECT_EQ(writer.Write(), SmallWriter::Result::OK);
+        }
+        EXPECT_EQ(writer.GetDroppedFrames(), 0u);
+        EXPECT_EQ(writer.SaveFile(), SmallWriter::Result::OK);
+    }
+
+    /** Checks the header, and that every sample matches its input */
+    void CheckFile(const std::string& path, int32_t bits, bool floating_point)
+    {
+        const auto        file = ReadFile(path);
+        WAV_FormatTypeDef header;
+        ASSERT_GE(file.size(), sizeof(header));
+        memcpy(&header, file.data(), sizeof(header));
+
+        const size_t bytes     = bits / 8;
+        const size_t dataBytes = numFrames_ * numChannels_ * bytes;
+        EXPECT_EQ(file.size(), sizeof(header) + dataBytes);
+        EXPECT_EQ(header.ChunkId, kWavFileChunkId);
+        EXPECT_EQ(header.FileSize, 36 + dataBytes);
+        EXPECT_EQ(header.AudioFormat,
+                  floating_point ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+        EXPECT_EQ(header.NbrChannels, numChannels_);
+        EXPECT_EQ(header.SampleRate, 48000u);
+        EXPECT_EQ(header.ByteRate, 48000u * numChannels_ * bytes);
+        EXPECT_EQ(header.BlockAlign, numChannels_ * bytes);
+        EXPECT_EQ(header.BitPerSample, bits);
+        EXPECT_EQ(header.SubCHunk2Size, dataBytes);
+
+        if(file.size() != sizeof(header) + dataBytes)
+            return;
+        size_t mismatches = 0;
+        for(size_t i = 0; i < interleaved_.size(); i++)
+        {
+            const uint8_t* p  = &file[sizeof(header) + i * bytes];
+            const float    in = interleaved_[i];
+            switch(bits)
+            {
+                case 16:
+                {
+                    int16_t s;
+                    memcpy(&s, p, 2);
+                    mismatches += s != f2s16(in);
+                }
+                break;
+                case 24:
+                {
+                    const int32_t s
+                        = static_cast<int32_t>(
+                              (p[0] << 8) | (p[1] << 16) | (p[2] << 24))
+                          >> 8;
+                    mismatches += s != f2s24(in);
+                }
+                break;
+                case 32:
+                {
+                    if(floating_point)
+                    {
+                        float s;
+                        memcpy(&s, p, 4);
+                        mismatches += s != in;
+                    }
+                    else
+                    {
+                        int32_t s;
+                        memcpy(&s, p, 4);
+                        mismatches += s != f2s32(in);
+                    }
+                }
+                break;
+            }
+        }
+        EXPECT_EQ(mismatches, 0u);
+    }
+
+    std::vector<float> planar_[numChannels_];
+    std::vector<float> interleaved_;
+    SmallWriter        writer_;
+};
+constexpr int32_t util_WavWriter::numChannels_; // requried for C++14...
+constexpr size_t  util_WavWriter::numFrames_;
+
+TEST_F(util_WavWriter, a_eachFormatRoundTrips)
+{
+    struct
+    {
+        int32_t bits;
+        bool    floating_point;
+    } formats[] = {{16, false}, {24, false}, {32, false}, {32, true}};
+    for(const auto& f : formats)
+    {
+        const auto path = Path("wavwriter_a.wav");
+        Record(writer_, path, f.bits, f.floating_point, false);
+        CheckFile(path, f.bits, f.floating_point);
+        remove(path.c_str());
+    }
+}
+
+TEST_F(util_WavWriter, b_planarMatchesInterleaved)
+{
+    const auto a = Path("wavwriter_b_interleaved.wav");
+    const auto b = Path("wavwriter_b_planar.wav");
+    Record(writer_, a, 24, false, false);
+    Record(writer_, b, 24, false, true);
+    const auto fileA = ReadFile(a);
+    EXPECT_FALSE(fileA.empty());
+    EXPECT_EQ(fileA, ReadFile(b));
+    remove(a.c_str());
+    remove(b.c_str());
+}
+
+TEST_F(util_WavWriter, c_sampleMatchesBlock)
+{
+    // One frame at a time gives the same file as whole blocks
+    const auto a = Path("wavwriter_c_block.wav");
+    const auto b = Path("wavwriter_c_sample.wav");
+    Record(writer_, a, 16, false, false);
+
+    SmallWriter::Config cfg = {48000.f, numChannels_, 16};
+    ASSERT_EQ(writer_.Init(cfg), SmallWriter::Result::OK);
+    ASSERT_EQ(writer_.OpenFile(b.c_str()), SmallWriter::Result::OK);
+    for(size_t i = 0; i < numFrames_; i++)
+    {
+        writer_.Sample(&interleaved_[i * numChannels_]);
+        writer_.Write();
+    }
+    EXPECT_EQ(writer_.SaveFile(), SmallWriter::Result::OK);
+    EXPECT_EQ(ReadFile(a), ReadFile(b));
+    remove(a.c_str());
+    remove(b.c_str());
+}
+
+TEST_F(util_WavWriter, d_fullBuffersDropFrames)
+{
+    // Without Write(), only the 256 byte buffer's worth of frames fit.
+    const auto          path = Path("wavwriter_d.wav");
+    SmallWriter::Config cfg  = {48000.f, 1, 16};
+    ASSERT_EQ(writer_.Init(cfg), SmallWriter::Result::OK);
+    ASSERT_EQ(writer_.OpenFile(path.c_str()), SmallWriter::Result::OK);
+    for(size_t i = 0; i < 160; i++)
+        writer_.Sample(&interleaved_[i]);
+    EXPECT_EQ(writer_.GetLengthSamps(), 128u);
+    EXPECT_EQ(writer_.GetDroppedFrames(), 32u);
+
+    // The file holds what was kept.
+    EXPECT_EQ(writer_.SaveFile(), SmallWriter::Result::OK);
+    EXPECT_EQ(ReadFile(path).size(), sizeof(WAV_FormatTypeDef) + 128 * 2);
+    remove(path.c_str());
+}
+
+TEST_F(util_WavWriter, e_unsupportedFormats)
+{
+    SmallWriter::Config cfg = {48000.f, 2, 8};
+    EXPECT_EQ(writer_.Init(cfg), SmallWriter::Result::ERROR);
+    cfg.bitspersample  = 16;
+    cfg.floating_point = true; // only 32 bit floats
+    EXPECT_EQ(writer_.Init(cfg), SmallWriter::Result::OK);
+
+    // Nothing is recorded before a file is open
+    writer_.Sample(interleaved_.data());
+    EXPECT_EQ(writer_.GetLengthSamps(), 0u);
+    EXPECT_EQ(writer_.SaveFile(), SmallWriter::Result::ERROR);
+    EXPECT_EQ(writer_.OpenFile(Path("no/such/dir/x.wav").c_str()),
+              SmallWriter::Result::ERROR);
+}
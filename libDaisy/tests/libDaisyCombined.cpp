@@ -1,7 +1,11 @@
 #include "sys/system.cpp"
 #include "ui/AbstractMenu.cpp"
 #include "ui/UI.cpp"
+#include "ui/FullScreenItemMenu.cpp"
 #include "util/MappedValue.cpp"
 #include "util/oled_fonts.c"
 #include "per/qspi.cpp"
 #include "hid/midi_parser.cpp"
+#include "hid/ctrl.cpp"
+#include "hid/parameter.cpp"
+#include "ff_posix.cpp"
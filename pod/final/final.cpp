@@ -9,26 +9,113 @@ static float sampleRate;
 
 //— DSP objects —//
 // Kick drum: sine oscillator + percussive envelope
-static Oscillator    kickOsc;
-static Adsr          kickEnv;
+struct KickVoice
+{
+    Oscillator osc;
+    Adsr       env;
+
+    void Init(float sr)
+    {
+        osc.Init(sr);
+        osc.SetWaveform(Oscillator::WAVE_SIN);
+        env.Init(sr);
+        env.SetAttackTime(0.001f);  // 1 ms attack
+        env.SetSustainLevel(0.0f);
+    }
+
+    float Process(bool trigger)
+    {
+        if (trigger) env.Retrigger(false);
+        return osc.Process() * env.Process(false) * 2.0f;
+    }
+};
 
 // Snare drum: white noise → bandpass filter + percussive envelope
-static WhiteNoise    snareNoise;
-static Adsr          snareEnv;
-static Svf           snareFilter;
+struct SnareVoice
+{
+    WhiteNoise noise;
+    Adsr       env;
+    Svf        filter;
 
-// Metronome click: high-frequency sine + very short envelope
-static Oscillator    clickOsc;
-static Adsr          clickEnv;
+    void Init(float sr)
+    {
+        noise.Init();
+        env.Init(sr);
+        env.SetAttackTime(0.001f);  // 1 ms attack
+        env.SetSustainLevel(0.0f);
+        filter.Init(sr);
+        filter.SetRes(0.7f);
+    }
+
+    float Process(bool trigger)
+    {
+        if (trigger) env.Retrigger(false);
+        filter.Process(noise.Process());
+        return filter.Band() * env.Process(false);
+    }
+};
 
 // Hi-Hat: white noise → highpass filter + percussive envelope
-static WhiteNoise    hiHatNoise;
-static Adsr          hiHatEnv;
-static Svf           hiHatFilter;
+struct HiHatVoice
+{
+    WhiteNoise noise;
+    Adsr       env;
+    Svf        filter;
+
+    void Init(float sr)
+    {
+        noise.Init();
+        env.Init(sr);
+        env.SetAttackTime(0.001f);  // 1 ms attack
+        env.SetSustainLevel(0.0f);
+        filter.Init(sr);
+        filter.SetRes(0.7f);
+    }
+
+    float Process(bool trigger)
+    {
+        if (trigger) env.Retrigger(false);
+        filter.Process(noise.Process());
+        return filter.High() * env.Process(false);
+    }
+};
 
-// Timing / state
-static float         beatIntervalSamples = 0.0f;
-static float         beatCounter         = 0.0f;
+// Parameters of a hit: {frequency (Hz), decay time (sec)}
+static void SetKick(KickVoice& v, const float* p)
+{
+    v.osc.SetFreq(p[0]);
+    v.env.SetDecayTime(p[1]);
+}
+static void SetSnare(SnareVoice& v, const float* p)
+{
+    v.filter.SetFreq(p[0]);
+    v.env.SetDecayTime(p[1]);
+}
+static void SetHiHat(HiHatVoice& v, const float* p)
+{
+    v.filter.SetFreq(p[0]);
+    v.env.SetDecayTime(p[1]);
+}
+
+// The drums play their hits back from SDRAM, one slot per drum set,
+// instead of synthesizing every hit again.
+// A hit only fits its slot once it has decayed to -80 dB, which takes
+// ln(10^4) = 9.2 decay times, e.g. 7.4 s for the 0.8 s kick of the 808 set.
+constexpr size_t CACHE_SLOTS        = 6;
+constexpr size_t KICK_CACHE_SAMPLES = CACHE_SLOTS * 8 * 48000; // 8 s per hit
+constexpr size_t CACHE_SAMPLES      = CACHE_SLOTS * 2 * 48000; // 2 s per hit
+
+static DrumRenderCache<KickVoice, 2, CACHE_SLOTS>  kick;
+static DrumRenderCache<SnareVoice, 2, CACHE_SLOTS> snare;
+static DrumRenderCache<HiHatVoice, 2, CACHE_SLOTS> hiHat;
+
+static float DSY_SDRAM_BSS kickMemory[KICK_CACHE_SAMPLES];
+static float DSY_SDRAM_BSS snareMemory[CACHE_SAMPLES];
+static float DSY_SDRAM_BSS hiHatMemory[CACHE_SAMPLES];
+
+// Metronome click: high-frequency sine + very short envelope
+static Oscillator    clickOsc;
+static Adsr          clickEnv;
 
 // Track button/encoder states for edge detection
 static bool          lastButtonKick        = false;
@@ -81,12 +168,27 @@ static inline float KnobToVolume(float k) { return k; }
 // ==================== Global additions ====================
 static bool  presetMode            = false;
 static bool  presetPlaying         = false;
-static int   presetStep            = 0;
-static float subdivCounter         = 0.0f;
-static float subdivIntervalSamples = 0.0f;
 
 constexpr int PRESET_STEPS = 64;
 
+// The sequencer triggers the click and the preset on the exact sample of
+// each 1/16 step, so the callback can render whole blocks.
+enum Track
+{
+    TRACK_CLICK,
+    TRACK_KICK,
+    TRACK_SNARE,
+    TRACK_HIHAT,
+    NUM_TRACKS
+};
+static StepSequencer<NUM_TRACKS, PRESET_STEPS> sequencer;
+
+// The volume knob is read once per block, and glides to each new reading
+// over the block, so turning it doesn't click.
+constexpr size_t MAX_BLOCK_SIZE = 256;
+static SmoothedValue volume;
+static float         volumeBuf[MAX_BLOCK_SIZE];
+
 // Four bars of 64-step preset rhythm
 // B row: Bass drum (kick)
 static const uint8_t presetBass[PRESET_STEPS] = {
@@ -121,155 +223,132 @@ static const uint8_t presetClick[PRESET_STEPS] = {
     1,0,1,0, 1,0,1,0, 1,0,0,0, 1,0,1,0
 };
 
-void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size)
+// Called by the sequencer on the sample a step starts
+static void OnStep(const SequencerEvent& e)
 {
-    for (size_t i = 0; i < size; i++)
+    if (e.track == TRACK_CLICK)
     {
-        // 1) Read all control inputs each sample
-        pod.ProcessAnalogControls();   // updates pod.GetKnobValue()
-        pod.ProcessDigitalControls();  // updates pod.GetButton()
-
-        // Read tempo & volume knobs
-        float tempoKnob  = pod.GetKnobValue(DaisyPod::KNOB_1);   // Pot 1 → Tempo
-        float volumeKnob = pod.GetKnobValue(DaisyPod::KNOB_2);   // Pot 2 → Volume
-
-        // Convert to BPM & master volume
-        float bpm    = KnobToBPM(tempoKnob);
-        float volume = KnobToVolume(volumeKnob);
-
-        // Update beat interval (samples per beat)
-        beatIntervalSamples = sampleRate * (60.0f / bpm);
+        clickEnv.Retrigger(false);
+        return;
+    }
+    if (!presetMode || !presetPlaying)
+        return;
 
-        // 2) Metronome: trigger click on each beat
-        float clkSample = 0.0f;
-        beatCounter += 1.0f;
-        if (beatCounter >= beatIntervalSamples)
-        {
-            beatCounter -= beatIntervalSamples;
-            clickEnv.Retrigger(false);
-        }
-        clkSample = clickOsc.Process() * clickEnv.Process(false);
+    // Exit after playing 64 steps
+    if (e.step >= PRESET_STEPS)
+    {
+        presetPlaying = false;
+        pod.led1.Set(drumSetColors[currentDrumSet][0] / 255.0f,
+                     drumSetColors[currentDrumSet][1] / 255.0f,
+                     drumSetColors[currentDrumSet][2] / 255.0f);
+        pod.led1.Update();
+        return;
+    }
+    switch (e.track)
+    {
+        case TRACK_KICK:  kick.Trig();  break;
+        case TRACK_SNARE: snare.Trig(); break;
+        case TRACK_HIHAT: hiHat.Trig(); break;
+        default: break;
+    }
+}
 
-        // Generate Hi-Hat noise sample
-        float noiseSample = hiHatNoise.Process();
-        hiHatFilter.Process(noiseSample);
-        float hHatSample = hiHatFilter.High() * hiHatEnv.Process(false);
+void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size)
+{
+    // 1) Read all control inputs once per block
+    pod.ProcessAnalogControls();   // updates pod.GetKnobValue()
+    pod.ProcessDigitalControls();  // updates pod.GetButton()
+
+    // Read tempo & volume knobs
+    float tempoKnob  = pod.GetKnobValue(DaisyPod::KNOB_1);   // Pot 1 → Tempo
+    float volumeKnob = pod.GetKnobValue(DaisyPod::KNOB_2);   // Pot 2 → Volume
+
+    // Convert to BPM & master volume
+    float bpm = KnobToBPM(tempoKnob);
+    sequencer.GetClock().SetTempo(bpm);
+    volume.SetTarget(KnobToVolume(volumeKnob));
+    volume.ProcessBlock(volumeBuf, size);
+
+    // 2) Drum-set switching via encoder rotation
+    int32_t encoderIncrement = pod.encoder.Increment();
+    if (encoderIncrement != 0)
+    {
+        currentDrumSet = (currentDrumSet + encoderIncrement + NUM_DRUM_SETS) % NUM_DRUM_SETS;
+        // Apply new parameters immediately
+        kick.SetParams(  &drumParams[currentDrumSet][0] );
+        snare.SetParams( &drumParams[currentDrumSet][2] );
+        hiHat.SetParams( hiHatParams[currentDrumSet] );
+
+        // Update LED color for the current drum set
+        pod.led1.Set(drumSetColors[currentDrumSet][0] / 255.0f,
+                     drumSetColors[currentDrumSet][1] / 255.0f,
+                     drumSetColors[currentDrumSet][2] / 255.0f);
+        pod.led1.Update();
+    }
 
-        // 3) Drum-set switching via encoder rotation
-        int32_t encoderIncrement = pod.encoder.Increment();
-        if (encoderIncrement != 0)
-        {
-            currentDrumSet = (currentDrumSet + encoderIncrement + NUM_DRUM_SETS) % NUM_DRUM_SETS;
-            // Apply new parameters immediately
-            kickOsc.SetFreq(       drumParams[currentDrumSet][0] );
-            kickEnv.SetDecayTime(  drumParams[currentDrumSet][1] );
-            snareFilter.SetFreq(   drumParams[currentDrumSet][2] );
-            snareEnv.SetDecayTime( drumParams[currentDrumSet][3] );
-            hiHatFilter.SetFreq(   hiHatParams[currentDrumSet][0] );
-            hiHatEnv.SetDecayTime( hiHatParams[currentDrumSet][1] );
-
-            // Update LED color for the current drum set
+    // 3) Detect encoder button rising edge
+    bool thisEncoderBtn = pod.encoder.Pressed();
+    if (thisEncoderBtn && !lastEncoderButton)
+    {
+        presetMode = !presetMode;  // Toggle preset mode
+        if (presetMode)
+            pod.led1.Set(1.0f, 1.0f, 1.0f);  // White for preset mode
+        else
             pod.led1.Set(drumSetColors[currentDrumSet][0] / 255.0f,
                          drumSetColors[currentDrumSet][1] / 255.0f,
                          drumSetColors[currentDrumSet][2] / 255.0f);
-            pod.led1.Update();
-        }
-
-        // Recalculate sample interval for 1/16 note
-        subdivIntervalSamples = beatIntervalSamples * 0.25f;
+        pod.led1.Update();
+    }
+    lastEncoderButton = thisEncoderBtn;
 
-        // New: 1/16 subdivision timing
-        subdivCounter += 1.0f;
-        bool newSubdivision = false;
-        if (subdivCounter >= subdivIntervalSamples)
-        {
-            subdivCounter -= subdivIntervalSamples;
-            newSubdivision = true;
-        }
+    // 4) Buttons: manual hits, or starting the preset
+    bool thisKickBtn  = pod.button1.Pressed();
+    bool thisSnareBtn = pod.button2.Pressed();
 
-        // New: detect encoder button rising edge
-        bool thisEncoderBtn = pod.encoder.Pressed();
-        if (thisEncoderBtn && !lastEncoderButton)
+    if (!presetMode)
+    {
+        if (thisKickBtn  && !lastButtonKick)  kick.Trig();
+        if (thisSnareBtn && !lastButtonSnare) snare.Trig();
+    }
+    else
+    {
+        // Preset mode: single click on Kick starts playback from step 0,
+        // with the metronome restarting along with it
+        if (thisKickBtn && !lastButtonKick && !presetPlaying)
         {
-            presetMode = !presetMode;  // Toggle preset mode
-            if (presetMode)
-                pod.led1.Set(1.0f, 1.0f, 1.0f);  // White for preset mode
-            else
-                pod.led1.Set(drumSetColors[currentDrumSet][0] / 255.0f,
-                             drumSetColors[currentDrumSet][1] / 255.0f,
-                             drumSetColors[currentDrumSet][2] / 255.0f);
-            pod.led1.Update();
+            presetPlaying = true;
+            sequencer.Restart();
         }
-        lastEncoderButton = thisEncoderBtn;
-
-        // New: handle buttons in preset mode
-        bool thisKickBtn  = pod.button1.Pressed();
-        bool thisSnareBtn = pod.button2.Pressed();
+    }
+    lastButtonKick  = thisKickBtn;
+    lastButtonSnare = thisSnareBtn;
 
-        if (!presetMode)
+    // 5) Render the block, split at the steps
+    sequencer.Process(size, OnStep, [&](size_t offset, size_t length) {
+        for (size_t i = offset; i < offset + length; i++)
         {
-            if (thisKickBtn  && !lastButtonKick)  kickEnv.Retrigger(false);
-            if (thisSnareBtn && !lastButtonSnare) snareEnv.Retrigger(false);
-        }
-        else
-        {
-            // Preset mode: single click on Kick starts playback
-            if (thisKickBtn && !lastButtonKick && !presetPlaying)
+            // Drum samples, from the cache once a drum set has been heard
+            float k          = kick.Process();
+            float s          = snare.Process();
+            float hHatSample = hiHat.Process();
+            float clkSample  = clickOsc.Process() * clickEnv.Process(false);
+
+            // Mix kick + snare + click (and hi-hat in preset mode), apply volume
+            float outSample;
+            if (!presetMode)
             {
-                presetPlaying = true;
-                presetStep    = 0;
-                subdivCounter = 0.0f;
+                outSample = (k + s + clkSample) * volumeBuf[i];
             }
-        }
-        lastButtonKick  = thisKickBtn;
-        lastButtonSnare = thisSnareBtn;
-
-        // New: trigger drum voices on each 1/8 subdivision in preset playback
-        if (presetMode && presetPlaying && newSubdivision)
-        {
-            if (presetBass[presetStep])  kickEnv.Retrigger(false);
-            if (presetSnare[presetStep]) snareEnv.Retrigger(false);
-            if (presetClick[presetStep]) hiHatEnv.Retrigger(false);
-
-            // Exit after playing 64 steps
-            presetStep++;
-            if (presetStep >= PRESET_STEPS)
+            else
             {
-                presetPlaying = false;
-                pod.led1.Set(drumSetColors[currentDrumSet][0] / 255.0f,
-                             drumSetColors[currentDrumSet][1] / 255.0f,
-                             drumSetColors[currentDrumSet][2] / 255.0f);
-                pod.led1.Update();
+                outSample = (k + s + clkSample + hHatSample) * volumeBuf[i];
             }
-        }
-
-        // 5) Generate kick sample
-        float k = kickOsc.Process() * kickEnv.Process(false) * 2.0f;
-
-        // 6) Generate snare sample
-        float noise   = snareNoise.Process();
-        snareFilter.Process(noise);
-        float filtered = snareFilter.Band();
-        float s       = filtered * snareEnv.Process(false);
 
-        // 7) Mix kick + snare + click (and hi-hat in preset mode), apply volume
-        float outSample;
-        if (!presetMode)
-        {
-            outSample = (k + s + clkSample) * volume;
-        }
-        else
-        {
-            outSample = (k + s + clkSample + hHatSample) * volume;
+            // Mix generated audio with input pass-through
+            out[0][i] = outSample + in[0][i];
+            out[1][i] = outSample + in[1][i];
         }
-
-        // Mix generated audio with input pass-through
-        float inputL = in[0][i];
-        float inputR = in[1][i];
-
-        out[0][i] = outSample + inputL;
-        out[1][i] = outSample + inputR;
-    }
+    });
 }
 
 int main(void)
@@ -286,24 +365,33 @@ int main(void)
     // Initialize encoder button state
     lastEncoderButton = pod.encoder.Pressed();
 
-    // Kick drum initial setup (parameters from set 0)
-    kickOsc.Init(sampleRate);
-    kickOsc.SetWaveform(Oscillator::WAVE_SIN);
-    kickOsc.SetFreq(       drumParams[0][0] );
-    kickEnv.Init(sampleRate);
-    kickEnv.SetAttackTime( 0.001f );  // 1 ms attack
-    kickEnv.SetDecayTime(  drumParams[0][1] );
-    kickEnv.SetSustainLevel(0.0f);
-
-    // Snare drum initial setup (parameters from set 0)
-    snareNoise.Init();
-    snareEnv.Init(sampleRate);
-    snareEnv.SetAttackTime( 0.001f );  // 1 ms attack
-    snareEnv.SetDecayTime(  drumParams[0][3] );
-    snareEnv.SetSustainLevel(0.0f);
-    snareFilter.Init(sampleRate);
-    snareFilter.SetFreq( drumParams[0][2] );
-    snareFilter.SetRes(  0.7f );
+    // Drums, with every drum set rendered ahead of time
+    kick.Init(sampleRate, SetKick, kickMemory, KICK_CACHE_SAMPLES);
+    snare.Init(sampleRate, SetSnare, snareMemory, CACHE_SAMPLES);
+    hiHat.Init(sampleRate, SetHiHat, hiHatMemory, CACHE_SAMPLES);
+    for (int set = 0; set < NUM_DRUM_SETS; set++)
+    {
+        kick.Prerender(  &drumParams[set][0] );
+        snare.Prerender( &drumParams[set][2] );
+        hiHat.Prerender( hiHatParams[set] );
+    }
+
+    // Parameters from set 0
+    kick.SetParams(  &drumParams[0][0] );
+    snare.SetParams( &drumParams[0][2] );
+    hiHat.SetParams( hiHatParams[0] );
+
+    // Click on every beat, and the preset rows on their 1/16 steps
+    sequencer.Init(sampleRate, KnobToBPM(0.0f));
+    for (int step = 0; step < PRESET_STEPS; step++)
+    {
+        sequencer.SetStep(TRACK_CLICK, step, step % 4 == 0 ? 1.0f : 0.0f);
+        sequencer.SetStep(TRACK_KICK,  step, presetBass[step]);
+        sequencer.SetStep(TRACK_SNARE, step, presetSnare[step]);
+        sequencer.SetStep(TRACK_HIHAT, step, presetClick[step]);
+    }
+
+    volume.Init(sampleRate, 0.02f);  // 20 ms glide
 
     // Metronome click setup
     clickOsc.Init(sampleRate);
@@ -314,16 +402,6 @@ int main(void)
     clickEnv.SetDecayTime(   0.01f );  // 10 ms decay
     clickEnv.SetSustainLevel(0.0f);
 
-    // Hi-Hat initial setup
-    hiHatNoise.Init();
-    hiHatEnv.Init(sampleRate);
-    hiHatEnv.SetAttackTime(0.001f);    // 1 ms attack
-    hiHatEnv.SetDecayTime(0.05f);      // Short decay
-    hiHatEnv.SetSustainLevel(0.0f);
-    hiHatFilter.Init(sampleRate);
-    hiHatFilter.SetFreq(8000.0f);
-    hiHatFilter.SetRes(0.7f);
-
     pod.StartAdc();       // enable knob/button scanning
     pod.StartAudio(AudioCallback);
 
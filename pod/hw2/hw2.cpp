@@ -5,15 +5,18 @@
 using namespace daisy;
 using namespace daisysp;
 
-static const int DELAY_BUFFER_SIZE = 48000;
+// Delay memory lives in SDRAM, 65536 samples is the power of two above 1s
+static const size_t DELAY_BUFFER_SIZE = 65536;
+static const size_t MAX_BLOCK_SIZE = 48;
 static const float PI = 3.14159265359f;
 static const float TWO_PI = 2.0f * PI;
 
+static float DSY_SDRAM_BSS delay_memory[DELAY_BUFFER_SIZE];
+
 class ModulatedDelay {
 private:
-    // Delay line buffer and parameters
-    float delay_buffer_[DELAY_BUFFER_SIZE];
-    int write_index_;
+    // Delay line, read with a modulated tap a block at a time
+    MultiTapDelay delay_;
     float delay_time_samples_;
     float feedback_amount_;
     float wet_dry_mix_;
@@ -26,13 +29,18 @@ private:
     // Input filtering for stability
     float input_filter_state_;
     float feedback_filter_state_;
+
+    // Per-block working buffers
+    float filtered_[MAX_BLOCK_SIZE];
+    float delay_times_[MAX_BLOCK_SIZE];
+    float delayed_[MAX_BLOCK_SIZE];
+    float write_[MAX_BLOCK_SIZE];
     
 public:
     void Init(float sample_rate) {
         sample_rate_ = sample_rate;
         
         // Initialize all variables to safe defaults
-        write_index_ = 0;
         delay_time_samples_ = 0.1f * sample_rate;  // 100ms default delay
         feedback_amount_ = 0.3f;  // 30% feedback
         wet_dry_mix_ = 0.5f;      // 50/50 wet/dry mix
@@ -46,10 +54,8 @@ public:
         lfo_.SetFreq(0.5f);  // 0.5 Hz default
         lfo_.SetAmp(1.0f);
         
-        // Clear delay buffer
-        for(int i = 0; i < DELAY_BUFFER_SIZE; i++) {
-            delay_buffer_[i] = 0.0f;
-        }
+        // Clears the delay memory
+        delay_.Init(delay_memory, DELAY_BUFFER_SIZE);
     }
     
     // Set delay parameters with safety bounds checking
@@ -76,43 +82,37 @@ public:
         lfo_depth_ = daisysp::fmax(0.0f, daisysp::fmin(0.8f, depth));  // 0% to 80% modulation
     }
     
-    float Process(float input) {
-        // Apply gentle high-pass filter to input to remove DC offset
-        input_filter_state_ += 0.001f * (input - input_filter_state_);
-        float filtered_input = input - input_filter_state_;
-        
-        // Generate LFO modulation
-        float lfo_value = lfo_.Process();
-        
-        // Calculate modulated delay time
-        float modulated_delay = delay_time_samples_ * (1.0f + lfo_depth_ * lfo_value);
-        modulated_delay = daisysp::fmax(1.0f, daisysp::fmin(DELAY_BUFFER_SIZE - 1.0f, modulated_delay));
-        
-        // Calculate read position with linear interpolation
-        float read_pos = write_index_ - modulated_delay;
-        if(read_pos < 0) {
-            read_pos += DELAY_BUFFER_SIZE;
+    // Processes up to MAX_BLOCK_SIZE samples
+    void ProcessBlock(const float* in, float* out, size_t size) {
+        // The tap is read before the block is written, so it has to reach
+        // back at least a block
+        const float min_delay = static_cast<float>(MAX_BLOCK_SIZE);
+        const float max_delay = static_cast<float>(DELAY_BUFFER_SIZE - MAX_BLOCK_SIZE - 2);
+
+        for(size_t i = 0; i < size; i++) {
+            // Apply gentle high-pass filter to input to remove DC offset
+            input_filter_state_ += 0.001f * (in[i] - input_filter_state_);
+            filtered_[i] = in[i] - input_filter_state_;
+            
+            // Calculate modulated delay time from the LFO
+            float modulated_delay = delay_time_samples_ * (1.0f + lfo_depth_ * lfo_.Process());
+            delay_times_[i] = daisysp::fmax(min_delay, daisysp::fmin(max_delay, modulated_delay));
         }
-        
-        // Linear interpolation between adjacent samples
-        int read_index1 = (int)read_pos;
-        int read_index2 = (read_index1 + 1) % DELAY_BUFFER_SIZE;
-        float frac = read_pos - read_index1;
-        
-        float delayed_sample = delay_buffer_[read_index1] * (1.0f - frac) + 
-                              delay_buffer_[read_index2] * frac;
-        
-        // Apply feedback filtering to prevent high-frequency buildup
-        feedback_filter_state_ += 0.3f * (delayed_sample * feedback_amount_ - feedback_filter_state_);
-        
-        // Write new sample to delay buffer (input + filtered feedback)
-        delay_buffer_[write_index_] = filtered_input + feedback_filter_state_;
-        
-        // Advance write index
-        write_index_ = (write_index_ + 1) % DELAY_BUFFER_SIZE;
-        
-        // Mix wet and dry signals
-        return filtered_input * (1.0f - wet_dry_mix_) + delayed_sample * wet_dry_mix_;
+
+        // Read the whole block from the modulated tap, with linear interpolation
+        delay_.ReadTap(0, delay_times_, delayed_, size);
+
+        for(size_t i = 0; i < size; i++) {
+            // Apply feedback filtering to prevent high-frequency buildup
+            feedback_filter_state_ += 0.3f * (delayed_[i] * feedback_amount_ - feedback_filter_state_);
+            
+            // Input + filtered feedback goes back into the delay
+            write_[i] = filtered_[i] + feedback_filter_state_;
+            
+            // Mix wet and dry signals
+            out[i] = filtered_[i] * (1.0f - wet_dry_mix_) + delayed_[i] * wet_dry_mix_;
+        }
+        delay_.Write(write_, size);
     }
 };
 
@@ -126,24 +126,33 @@ float lfo_rate_hz = 0.5f;
 float lfo_depth = 0.2f;
 
 void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
-    for(size_t i = 0; i < size; i++) {
+    float mono[MAX_BLOCK_SIZE];
+    float processed[MAX_BLOCK_SIZE];
+
+    for(size_t done = 0; done < size; done += MAX_BLOCK_SIZE) {
+        size_t n = size - done < MAX_BLOCK_SIZE ? size - done : MAX_BLOCK_SIZE;
+
         // Get mono input (average L+R if stereo input)
-        float input_sample = (in[0][i] + in[1][i]) * 0.5f;
+        for(size_t i = 0; i < n; i++) {
+            mono[i] = (in[0][done + i] + in[1][done + i]) * 0.5f;
+        }
         
         // Process through modulated delay
-        float output_sample = delay_processor.Process(input_sample);
+        delay_processor.ProcessBlock(mono, processed, n);
         
-        // Apply soft limiting to prevent clipping
-        output_sample = tanhf(output_sample * 0.8f);
-        
-        out[0][i] = output_sample;
-        out[1][i] = output_sample;
+        for(size_t i = 0; i < n; i++) {
+            // Apply soft limiting to prevent clipping
+            float output_sample = tanhf(processed[i] * 0.8f);
+            
+            out[0][done + i] = output_sample;
+            out[1][done + i] = output_sample;
+        }
     }
 }
 
 int main(void) {
     hw.Init();
-    hw.SetAudioBlockSize(48);
+    hw.SetAudioBlockSize(MAX_BLOCK_SIZE);
     float sample_rate = hw.AudioSampleRate();
     
     delay_processor.Init(sample_rate);